@@ -1,21 +1,684 @@
 #include "pch.h"
 #include "AssetManager.h"
 #include "Engine/Core/Log.h"
+#include "Engine/Core/Hash.h"
+#include "Engine/Renderer/TextureStreamer.h"
+#include "Engine/Renderer/Mesh.h"
+#include "Engine/Renderer/MeshFactory.h"
+
+#include <filesystem>
+#include <fstream>
+#include <mutex>
 
 namespace Engine
 {
 	std::unordered_map<AssetHandle, Ref<Asset>> AssetManager::s_LoadedAssets;
 	std::unordered_map<AssetHandle, Ref<Asset>> AssetManager::s_MemoryAssets;
+	Scope<ThreadPool> AssetManager::s_WorkerPool;
+	std::unordered_map<std::string, AssetHandle> AssetManager::s_TexturePaths;
+	TextureCacheStatistics AssetManager::s_TextureCacheStatistics;
+	std::unordered_map<std::string, AssetHandle> AssetManager::s_MeshPaths;
+	AssetRegistry AssetManager::s_Registry;
+	std::unordered_map<AssetType, uint64_t> AssetManager::s_MemoryBudgets;
+	std::unordered_map<AssetType, uint64_t> AssetManager::s_MemoryUsage;
+	uint64_t AssetManager::s_Frame = 0;
+
+	static const char* s_RegistryPath = "assets/Assets.registry";
+	//Frames between memory budget checks, measuring every asset is not free
+	static const uint64_t s_EvictionInterval = 60;
+
+	//Mesh imports done on the workers, waiting for the main thread
+	struct CompletedMeshLoad
+	{
+		AssetHandle Handle;
+		std::string Path;
+		Ref<Engine::Mesh> Mesh;
+	};
+	static std::mutex s_CompletedMutex;
+	static std::vector<CompletedMeshLoad> s_CompletedMeshLoads;
+	//Texture files with the same content as a loaded texture, found by the content jobs
+	struct TextureAlias
+	{
+		AssetHandle Duplicate;
+		AssetHandle Original;
+	};
+	static std::vector<TextureAlias> s_CompletedTextureAliases;
+	//Asynchronous textures still decoding
+	static std::vector<AssetHandle> s_LoadingTextures;
+	static std::unordered_map<AssetHandle, std::vector<AssetLoadCallback>> s_LoadCallbacks;
+	static std::unordered_map<AssetType, Ref<Asset>> s_Placeholders;
+
+	//Content key (size, hash and settings) -> first texture loaded with it. Shared with the content jobs.
+	struct TextureContent
+	{
+		AssetHandle Handle;
+		std::string Path;
+	};
+	static std::mutex s_TextureContentMutex;
+	static std::unordered_map<std::string, TextureContent> s_TextureContents;
+	//Handle of a dropped copy -> handle of the texture it shares
+	static std::unordered_map<AssetHandle, AssetHandle> s_TextureAliases;
+
+	static std::string GetCanonicalPath(const std::string& path)
+	{
+		std::error_code error;
+		std::string canonicalPath = std::filesystem::weakly_canonical(path, error).generic_string();
+		if (error)
+			canonicalPath = std::filesystem::absolute(path, error).lexically_normal().generic_string();
+
+		//Relative to the working directory, so registered paths stay valid when the project moves
+		std::string relativePath = std::filesystem::path(canonicalPath).lexically_relative(std::filesystem::current_path(error)).generic_string();
+		if (!error && !relativePath.empty())
+			canonicalPath = relativePath;
+#ifdef ENGINE_PLATFORM_WINDOWS
+		//Paths are case insensitive
+		std::transform(canonicalPath.begin(), canonicalPath.end(), canonicalPath.begin(), [](char c) { return (char)std::tolower((uint8_t)c); });
+#endif
+		return canonicalPath;
+	}
+
+	//Settings that change the uploaded texture. Async and Priority only change when it is ready.
+	static std::string GetTextureSettingsKey(bool srgb, const TextureSpecification& spec)
+	{
+		return "|" + std::to_string(srgb) + std::to_string((int)spec.Flip) + std::to_string((int)spec.Wrap) + std::to_string((int)spec.Usage);
+	}
+
+	static bool ParseTextureSettingsKey(const std::string& key, bool& srgb, TextureSpecification& spec)
+	{
+		if (key.size() != 5 || key[0] != '|')
+			return false;
+		srgb = key[1] == '1';
+		spec.Flip = (TextureFlip)(key[2] - '0');
+		spec.Wrap = (TextureWrap)(key[3] - '0');
+		spec.Usage = (TextureUsage)(key[4] - '0');
+		return true;
+	}
+
+	static bool ReadFileBytes(const std::string& path, std::vector<uint8_t>& bytes)
+	{
+		std::ifstream in(path, std::ios::in | std::ios::binary | std::ios::ate);
+		if (!in)
+			return false;
+		bytes.resize((size_t)in.tellg());
+		in.seekg(0);
+		in.read((char*)bytes.data(), bytes.size());
+		return (bool)in;
+	}
+
+	static uint64_t GetTextureSize(const Texture2D& texture)
+	{
+		return TextureStreamer::CalculateResidentSize(texture, texture.GetResidentMip());
+	}
+
+	static uint64_t GetAssetSize(const Asset& asset)
+	{
+		switch (asset.GetAssetType())
+		{
+		case AssetType::Texture:
+			return GetTextureSize((const Texture2D&)asset);
+		case AssetType::Mesh:
+		{
+			MeshMemoryStatistics statistics = ((const Mesh&)asset).GetMemoryStatistics();
+			return statistics.GPU + statistics.GetCPUTotal();
+		}
+		default:
+			ENGINE_ASSERT(false, "Only textures and meshes are loaded by the asset manager!");
+			return 0;
+		}
+	}
 
 	void Engine::AssetManager::Init()
 	{
+		s_WorkerPool = CreateScope<ThreadPool>();
 
+		s_Registry.Load(s_RegistryPath);
+		s_MemoryBudgets.try_emplace(AssetType::Texture, 1024ull * 1024 * 1024);
+		s_MemoryBudgets.try_emplace(AssetType::Mesh, 512ull * 1024 * 1024);
 	}
 
 	void Engine::AssetManager::Shutdown()
 	{
+		ReportDuplicateTextures();
+		ReportMeshMemory();
+
+		//Stop workers first, jobs may still reference assets
+		s_WorkerPool.reset();
+		s_CompletedMeshLoads.clear();
+		s_CompletedTextureAliases.clear();
+		s_LoadingTextures.clear();
+		s_LoadCallbacks.clear();
+		s_Placeholders.clear();
+		s_TexturePaths.clear();
+		s_TextureContents.clear();
+		s_TextureAliases.clear();
+		s_MeshPaths.clear();
 		s_LoadedAssets.clear();
 		s_MemoryAssets.clear();
+
+		if (s_Registry.IsDirty())
+			s_Registry.Save(s_RegistryPath);
+	}
+
+	void AssetManager::Update()
+	{
+		s_Frame++;
+		FinishAsyncLoads();
+		ClearUnusedMemoryAsset();
+
+		//The manager holds one reference, anything more is a user
+		for (auto& [handle, asset] : s_LoadedAssets)
+		{
+			if (asset.use_count() == 1)
+				continue;
+			if (AssetMetadata* metadata = s_Registry.Find(handle))
+				metadata->LastUsedFrame = s_Frame;
+		}
+
+		if (s_Frame % s_EvictionInterval != 0)
+			return;
+
+		//Only registered assets are evicted, the others could not be loaded again
+		std::vector<AssetMetadata*> candidates;
+		s_MemoryUsage.clear();
+		for (auto& [handle, asset] : s_LoadedAssets)
+		{
+			AssetMetadata* metadata = s_Registry.Find(handle);
+			if (!metadata)
+				continue;
+
+			metadata->MemorySize = GetAssetSize(*asset);
+			s_MemoryUsage[metadata->Type] += metadata->MemorySize;
+			//Textures still decoding would be decoded for nothing
+			bool ready = asset->GetAssetType() != AssetType::Texture || ((const Texture2D&)*asset).IsReady();
+			if (asset.use_count() == 1 && ready)
+				candidates.push_back(metadata);
+		}
+
+		std::sort(candidates.begin(), candidates.end(), [](const AssetMetadata* a, const AssetMetadata* b)
+			{
+				return a->LastUsedFrame < b->LastUsedFrame;
+			});
+
+		uint32_t evictedCount = 0;
+		uint64_t evictedBytes = 0;
+		for (AssetMetadata* metadata : candidates)
+		{
+			uint64_t budget = GetMemoryBudget(metadata->Type);
+			uint64_t& usage = s_MemoryUsage[metadata->Type];
+			if (budget == 0 || usage <= budget)
+				continue;
+
+			usage -= metadata->MemorySize;
+			evictedCount++;
+			evictedBytes += metadata->MemorySize;
+			EvictAsset(*metadata);
+		}
+
+		if (evictedCount > 0)
+			ENGINE_INFO("Evicted {0} unused assets over the memory budget, {1} KB", evictedCount, evictedBytes / 1024);
+	}
+
+	uint64_t AssetManager::GetMemoryBudget(AssetType type)
+	{
+		auto it = s_MemoryBudgets.find(type);
+		return it != s_MemoryBudgets.end() ? it->second : 0;
+	}
+
+	uint64_t AssetManager::GetMemoryUsage(AssetType type)
+	{
+		auto it = s_MemoryUsage.find(type);
+		return it != s_MemoryUsage.end() ? it->second : 0;
+	}
+
+	Ref<Asset> AssetManager::LoadAsset(AssetHandle handle)
+	{
+		auto alias = s_TextureAliases.find(handle);
+		if (alias != s_TextureAliases.end())
+			return GetAsset<Asset>(alias->second);
+
+		AssetMetadata* metadata = s_Registry.Find(handle);
+		if (!metadata)
+		{
+			ENGINE_ERROR("Asset {0} is not registered", (uint64_t)handle);
+			return nullptr;
+		}
+
+		switch (metadata->Type)
+		{
+		case AssetType::Texture:
+		{
+			bool srgb = false;
+			TextureSpecification spec;
+			if (!ParseTextureSettingsKey(metadata->Variant, srgb, spec))
+				break;
+			return LoadTexture(metadata->FilePath, srgb, spec);
+		}
+		case AssetType::Mesh:
+			return LoadMesh(metadata->FilePath);
+		default:
+			ENGINE_ASSERT(false, "Only textures and meshes are registered!");
+			break;
+		}
+
+		ENGINE_ERROR("Asset '{0}' ({1}) can not be loaded from the registry", metadata->FilePath, AssetTypeToString(metadata->Type));
+		return nullptr;
+	}
+
+	AssetHandle AssetManager::LoadMeshAsync(const std::string& path, AssetLoadPriority priority)
+	{
+		std::string canonicalPath = GetCanonicalPath(path);
+		AssetMetadata& metadata = s_Registry.GetOrCreate(canonicalPath, "", AssetType::Mesh);
+		if (metadata.State == AssetLoadState::Loading)
+			return metadata.Handle;
+		if (FindMesh(path))
+		{
+			metadata.State = AssetLoadState::Loaded;
+			return metadata.Handle;
+		}
+
+		metadata.State = AssetLoadState::Loading;
+		AssetHandle handle = metadata.Handle;
+		MeshRetention retention = Mesh::GetDefaultRetention();
+		s_WorkerPool->Enqueue([handle, path, retention]()
+			{
+				Ref<Mesh> mesh = Mesh::LoadGeometry(path, retention);
+				std::lock_guard<std::mutex> lock(s_CompletedMutex);
+				s_CompletedMeshLoads.push_back({ handle, path, mesh });
+			}, (uint32_t)priority);
+		return handle;
+	}
+
+	AssetHandle AssetManager::LoadTextureAsync(const std::string& path, bool srgb, TextureSpecification spec, AssetLoadPriority priority)
+	{
+		spec.Async = true;
+		spec.Priority = (uint32_t)priority;
+		Ref<Texture2D> texture = LoadTexture(path, srgb, spec);
+		if (!texture->IsLoaded())
+			return s_Registry.GetOrCreate(GetCanonicalPath(path), GetTextureSettingsKey(srgb, spec), AssetType::Texture).Handle;
+
+		AssetMetadata* metadata = s_Registry.Find(texture->Handle);
+		if (metadata && !texture->IsReady() && metadata->State != AssetLoadState::Loading)
+		{
+			metadata->State = AssetLoadState::Loading;
+			s_LoadingTextures.push_back(texture->Handle);
+		}
+		return texture->Handle;
+	}
+
+	AssetLoadState AssetManager::GetLoadState(AssetHandle handle)
+	{
+		if (IsMemoryAsset(handle))
+			return AssetLoadState::Loaded;
+		if (AssetMetadata* metadata = s_Registry.Find(handle))
+			return metadata->State;
+		return s_LoadedAssets.find(handle) != s_LoadedAssets.end() ? AssetLoadState::Loaded : AssetLoadState::Unloaded;
+	}
+
+	uint32_t AssetManager::GetPendingLoadCount()
+	{
+		uint32_t count = 0;
+		for (auto& [handle, metadata] : s_Registry.GetAssets())
+		{
+			if (metadata.State == AssetLoadState::Loading)
+				count++;
+		}
+
+		for (auto& [handle, asset] : s_LoadedAssets)
+		{
+			if (asset->GetAssetType() != AssetType::Texture || GetLoadState(handle) == AssetLoadState::Loading)
+				continue;
+			auto texture = std::dynamic_pointer_cast<Texture2D>(asset);
+			if (texture && !texture->IsReady() && texture->IsStreaming())
+				count++;
+		}
+		return count;
+	}
+
+	void AssetManager::OnLoaded(AssetHandle handle, const AssetLoadCallback& callback)
+	{
+		switch (GetLoadState(handle))
+		{
+		case AssetLoadState::Loaded:
+			callback(GetAsset<Asset>(handle));
+			return;
+		case AssetLoadState::Failed:
+			callback(nullptr);
+			return;
+		case AssetLoadState::Unloaded:
+		case AssetLoadState::Loading:
+			break;
+		}
+		s_LoadCallbacks[handle].push_back(callback);
+	}
+
+	Ref<Asset> AssetManager::GetPlaceholder(AssetType type)
+	{
+		auto it = s_Placeholders.find(type);
+		if (it != s_Placeholders.end())
+			return it->second;
+
+		Ref<Asset> placeholder;
+		switch (type)
+		{
+		case AssetType::Texture:
+		{
+			Ref<Texture2D> texture = Texture2D::Create(TextureFormat::RGBA, 1, 1);
+			texture->Lock();
+			uint8_t* pixels = (uint8_t*)texture->GetWritableBuffer().Data;
+			pixels[0] = pixels[1] = pixels[2] = 128;
+			pixels[3] = 255;
+			texture->Unlock();
+			placeholder = texture;
+			break;
+		}
+		case AssetType::Mesh:
+			placeholder = MeshFactory::CreateBox(glm::vec3(1.0f));
+			break;
+		default:
+			ENGINE_ERROR("Assets of type {0} have no placeholder", AssetTypeToString(type));
+			return nullptr;
+		}
+
+		s_Placeholders[type] = placeholder;
+		return placeholder;
+	}
+
+	void AssetManager::FinishAsyncLoads()
+	{
+		std::vector<AssetHandle> finished;
+
+		std::vector<CompletedMeshLoad> meshLoads;
+		{
+			std::lock_guard<std::mutex> lock(s_CompletedMutex);
+			meshLoads.swap(s_CompletedMeshLoads);
+		}
+		for (auto& load : meshLoads)
+		{
+			//Loaded synchronously meanwhile
+			if (!FindMesh(load.Path))
+			{
+				load.Mesh->FinishLoading();
+				AddMesh(load.Path, load.Mesh);
+			}
+			finished.push_back(load.Handle);
+		}
+
+		std::vector<TextureAlias> aliases;
+		{
+			std::lock_guard<std::mutex> lock(s_CompletedMutex);
+			aliases.swap(s_CompletedTextureAliases);
+		}
+		for (auto& alias : aliases)
+		{
+			//Either may have been evicted meanwhile
+			auto original = s_LoadedAssets.find(alias.Original);
+			auto duplicate = s_LoadedAssets.find(alias.Duplicate);
+			if (original == s_LoadedAssets.end() || duplicate == s_LoadedAssets.end())
+				continue;
+
+			auto texture = std::dynamic_pointer_cast<Texture2D>(original->second);
+			ENGINE_TRACE("Texture '{0}' has the same content as '{1}', sharing it", ((const Texture2D&)*duplicate->second).GetPath(), texture->GetPath());
+			s_TextureCacheStatistics.ContentHits++;
+			s_TextureCacheStatistics.SavedBytes += GetTextureSize(*texture);
+			for (auto& [key, handle] : s_TexturePaths)
+			{
+				if (handle == alias.Duplicate)
+					handle = alias.Original;
+			}
+			//Users that already hold the copy keep it, it is freed with the last of them
+			s_TextureAliases[alias.Duplicate] = alias.Original;
+			s_LoadedAssets.erase(duplicate);
+		}
+
+		for (size_t i = 0; i < s_LoadingTextures.size();)
+		{
+			AssetHandle handle = s_LoadingTextures[i];
+			auto alias = s_TextureAliases.find(handle);
+			auto asset = s_LoadedAssets.find(alias != s_TextureAliases.end() ? alias->second : handle);
+			auto texture = asset != s_LoadedAssets.end() ? std::dynamic_pointer_cast<Texture2D>(asset->second) : nullptr;
+			//Decoded and uploaded, or the decode failed
+			if (texture && !texture->IsReady() && texture->IsStreaming())
+			{
+				i++;
+				continue;
+			}
+
+			if (AssetMetadata* metadata = s_Registry.Find(handle))
+				metadata->State = texture && texture->IsReady() ? AssetLoadState::Loaded : AssetLoadState::Failed;
+			finished.push_back(handle);
+			s_LoadingTextures[i] = s_LoadingTextures.back();
+			s_LoadingTextures.pop_back();
+		}
+
+		for (AssetHandle handle : finished)
+		{
+			auto it = s_LoadCallbacks.find(handle);
+			if (it == s_LoadCallbacks.end())
+				continue;
+
+			//Callbacks may start other loads
+			std::vector<AssetLoadCallback> callbacks = std::move(it->second);
+			s_LoadCallbacks.erase(it);
+			Ref<Asset> asset = GetLoadState(handle) == AssetLoadState::Loaded ? GetAsset<Asset>(handle) : nullptr;
+			for (auto& callback : callbacks)
+				callback(asset);
+		}
+	}
+
+	void AssetManager::EvictAsset(AssetMetadata& metadata)
+	{
+		ENGINE_TRACE("Evict asset '{0}', last used in frame {1}", metadata.FilePath, metadata.LastUsedFrame);
+
+		auto eraseHandle = [&](std::unordered_map<std::string, AssetHandle>& index)
+		{
+			for (auto it = index.begin(); it != index.end();)
+				it = it->second == metadata.Handle ? index.erase(it) : std::next(it);
+		};
+		eraseHandle(s_TexturePaths);
+		eraseHandle(s_MeshPaths);
+		s_LoadedAssets.erase(metadata.Handle);
+		{
+			std::lock_guard<std::mutex> lock(s_TextureContentMutex);
+			for (auto it = s_TextureContents.begin(); it != s_TextureContents.end();)
+				it = it->second.Handle == metadata.Handle ? s_TextureContents.erase(it) : std::next(it);
+		}
+		//Copies that shared the texture load their own file again
+		for (auto it = s_TextureAliases.begin(); it != s_TextureAliases.end();)
+		{
+			if (it->second != metadata.Handle)
+			{
+				++it;
+				continue;
+			}
+			if (AssetMetadata* alias = s_Registry.Find(it->first))
+				alias->State = AssetLoadState::Unloaded;
+			it = s_TextureAliases.erase(it);
+		}
+
+		metadata.State = AssetLoadState::Unloaded;
+		metadata.MemorySize = 0;
+	}
+
+	Ref<Texture2D> AssetManager::LoadTexture(const std::string& path, bool srgb, TextureSpecification spec)
+	{
+		auto findTexture = [](const std::unordered_map<std::string, AssetHandle>& index, const std::string& key) -> Ref<Texture2D>
+		{
+			auto it = index.find(key);
+			if (it == index.end())
+				return nullptr;
+			auto asset = s_LoadedAssets.find(it->second);
+			return asset != s_LoadedAssets.end() ? std::dynamic_pointer_cast<Texture2D>(asset->second) : nullptr;
+		};
+
+		s_TextureCacheStatistics.Loads++;
+		std::string settings = GetTextureSettingsKey(srgb, spec);
+		std::string pathKey = GetCanonicalPath(path) + settings;
+		if (auto texture = findTexture(s_TexturePaths, pathKey))
+		{
+			s_TextureCacheStatistics.PathHits++;
+			s_TextureCacheStatistics.SavedBytes += GetTextureSize(*texture);
+			return texture;
+		}
+
+		AssetMetadata& metadata = s_Registry.GetOrCreate(GetCanonicalPath(path), settings, AssetType::Texture);
+		metadata.State = AssetLoadState::Loading;
+		Ref<Texture2D> texture = Texture2D::Create(path, srgb, spec);
+		if (!texture->IsLoaded())
+		{
+			metadata.State = AssetLoadState::Failed;
+			return texture;
+		}
+
+		texture->Handle = metadata.Handle;
+		s_LoadedAssets[texture->Handle] = texture;
+		metadata.State = AssetLoadState::Loaded;
+		metadata.LastUsedFrame = s_Frame;
+		s_TexturePaths[pathKey] = texture->Handle;
+
+		//Copies of a file under another name share the first texture. The file is hashed on the workers and equal
+		//hashes are confirmed byte by byte there, FinishAsyncLoads then drops the copy.
+		AssetHandle handle = texture->Handle;
+		std::string filepath = path;
+		s_WorkerPool->Enqueue([handle, filepath, settings]()
+			{
+				std::vector<uint8_t> bytes;
+				if (!ReadFileBytes(filepath, bytes))
+					return;
+
+				std::string contentKey = std::to_string(bytes.size()) + ":" + std::to_string(Hash::FNV(bytes.data(), bytes.size())) + settings;
+				TextureContent other;
+				{
+					std::lock_guard<std::mutex> lock(s_TextureContentMutex);
+					auto [it, inserted] = s_TextureContents.try_emplace(contentKey, TextureContent{ handle, filepath });
+					if (inserted)
+						return;
+					other = it->second;
+				}
+
+				std::vector<uint8_t> otherBytes;
+				if (other.Handle == handle || !ReadFileBytes(other.Path, otherBytes) || otherBytes != bytes)
+					return;
+				std::lock_guard<std::mutex> lock(s_CompletedMutex);
+				s_CompletedTextureAliases.push_back({ handle, other.Handle });
+			}, spec.Priority);
+		return texture;
+	}
+
+	uint64_t AssetManager::ReportDuplicateTextures()
+	{
+		std::unordered_map<std::string, std::vector<Texture2D*>> files;
+		for (auto& [handle, asset] : s_LoadedAssets)
+		{
+			if (asset->GetAssetType() != AssetType::Texture)
+				continue;
+			auto texture = std::dynamic_pointer_cast<Texture2D>(asset);
+			if (texture && texture->IsLoaded())
+				files[GetCanonicalPath(texture->GetPath())].push_back(texture.get());
+		}
+
+		uint64_t duplicateBytes = 0;
+		for (auto& [path, textures] : files)
+		{
+			if (textures.size() < 2)
+				continue;
+
+			uint64_t bytes = 0;
+			for (size_t i = 1; i < textures.size(); i++)
+				bytes += GetTextureSize(*textures[i]);
+			ENGINE_WARN("Texture '{0}' is loaded {1} times, {2} KB duplicated", path, textures.size(), bytes / 1024);
+			duplicateBytes += bytes;
+		}
+
+		auto& statistics = s_TextureCacheStatistics;
+		ENGINE_INFO("Texture cache: {0} loads, {1} path hits, {2} content hits, {3} KB not loaded again, {4} KB duplicated",
+			statistics.Loads, statistics.PathHits, statistics.ContentHits, statistics.SavedBytes / 1024, duplicateBytes / 1024);
+		return duplicateBytes;
+	}
+
+	Ref<Mesh> AssetManager::LoadMesh(const std::string& path)
+	{
+		return LoadMesh(path, Mesh::GetDefaultRetention());
+	}
+
+	Ref<Mesh> AssetManager::LoadMesh(const std::string& path, MeshRetention retention)
+	{
+		if (auto mesh = FindMesh(path))
+		{
+			ENGINE_TRACE("Mesh '{0}' is loaded already, sharing it", path);
+			//The geometry is gone, loading it again would not be shared
+			if (mesh->GetRetention() < retention)
+				ENGINE_WARN("Mesh '{0}' is loaded with retention {1}, {2} was requested", path, MeshRetentionToString(mesh->GetRetention()), MeshRetentionToString(retention));
+			return mesh;
+		}
+
+		s_Registry.GetOrCreate(GetCanonicalPath(path), "", AssetType::Mesh).State = AssetLoadState::Loading;
+		Ref<Mesh> mesh = Mesh::Create(path, retention);
+		AddMesh(path, mesh);
+		return mesh;
+	}
+
+	Ref<Mesh> AssetManager::FindMesh(const std::string& path)
+	{
+		auto it = s_MeshPaths.find(GetCanonicalPath(path));
+		if (it == s_MeshPaths.end())
+			return nullptr;
+		auto asset = s_LoadedAssets.find(it->second);
+		return asset != s_LoadedAssets.end() ? std::dynamic_pointer_cast<Mesh>(asset->second) : nullptr;
+	}
+
+	void AssetManager::AddMesh(const std::string& path, const Ref<Mesh>& mesh)
+	{
+		std::string canonicalPath = GetCanonicalPath(path);
+		AssetMetadata& metadata = s_Registry.GetOrCreate(canonicalPath, "", AssetType::Mesh);
+		//Failed loads are not kept, so they are retried
+		if (mesh->GetSubmeshes().empty())
+		{
+			metadata.State = AssetLoadState::Failed;
+			return;
+		}
+
+		mesh->Handle = metadata.Handle;
+		s_LoadedAssets[mesh->Handle] = mesh;
+		s_MeshPaths[canonicalPath] = mesh->Handle;
+		metadata.State = AssetLoadState::Loaded;
+		metadata.LastUsedFrame = s_Frame;
+	}
+
+	uint64_t AssetManager::ReportMeshMemory()
+	{
+		struct MeshEntry
+		{
+			std::string Path;
+			Ref<Engine::Mesh> Mesh;
+			MeshMemoryStatistics Statistics;
+		};
+		std::vector<MeshEntry> meshes;
+		for (auto& [path, handle] : s_MeshPaths)
+		{
+			auto asset = s_LoadedAssets.find(handle);
+			if (asset == s_LoadedAssets.end())
+				continue;
+			auto mesh = std::dynamic_pointer_cast<Mesh>(asset->second);
+			meshes.push_back({ path, mesh, mesh->GetMemoryStatistics() });
+		}
+		std::sort(meshes.begin(), meshes.end(), [](const MeshEntry& a, const MeshEntry& b)
+			{
+				return a.Statistics.GetCPUTotal() > b.Statistics.GetCPUTotal();
+			});
+
+		MeshMemoryStatistics total;
+		for (auto& [path, mesh, statistics] : meshes)
+		{
+			ENGINE_INFO("Mesh '{0}' ({1}): {2} KB geometry, {3} KB BVH on the CPU, {4} KB on the GPU", path, MeshRetentionToString(mesh->GetRetention()),
+				statistics.CPUGeometry / 1024, statistics.CPUQueries / 1024, statistics.GPU / 1024);
+			total.CPUGeometry += statistics.CPUGeometry;
+			total.CPUQueries += statistics.CPUQueries;
+			total.GPU += statistics.GPU;
+		}
+
+		ENGINE_INFO("Mesh memory: {0} meshes, {1} KB geometry, {2} KB BVH on the CPU, {3} KB on the GPU",
+			meshes.size(), total.CPUGeometry / 1024, total.CPUQueries / 1024, total.GPU / 1024);
+		return total.GetCPUTotal();
 	}
 
 	void AssetManager::ClearUnusedMemoryAsset()
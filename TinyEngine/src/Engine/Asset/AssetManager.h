@@ -1,20 +1,76 @@
 #pragma once
 
 #include "Engine/Core/Ref.h"
+#include "Engine/Core/ThreadPool.h"
 #include "Engine/Asset/Asset.h"
+#include "Engine/Asset/AssetRegistry.h"
+#include "Engine/Renderer/Texture.h"
 #include <unordered_map>
+#include <functional>
 
 namespace Engine
 {
+	class Mesh;
+	enum class MeshRetention;
+
+	struct TextureCacheStatistics
+	{
+		uint32_t Loads = 0;
+		uint32_t PathHits = 0;
+		uint32_t ContentHits = 0;
+		//Bytes the hits would have decoded and uploaded again
+		uint64_t SavedBytes = 0;
+	};
+
+	/// <summary>
+	/// Order of the queued asynchronous loads on the asset workers.
+	/// </summary>
+	enum class AssetLoadPriority
+	{
+		Low = 0,
+		Normal,
+		High
+	};
+
+	/// <summary>
+	/// Called on the main thread when an asynchronous load is done. Failed loads pass null.
+	/// </summary>
+	using AssetLoadCallback = std::function<void(const Ref<Asset>&)>;
+
 	class AssetManager
 	{
 	public:
 		static void Init();
 		static void Shutdown();
+		/// <summary>
+		/// Call once per frame after rendering. Marks the assets that are referenced as used, evicts unreferenced
+		/// assets in least recently used order while their type is over budget, and clears unused memory assets.
+		/// </summary>
+		static void Update();
 
 		static const std::unordered_map<AssetHandle, Ref<Asset>>& GetLoadedAssets() { return s_LoadedAssets; }
 		static const std::unordered_map<AssetHandle, Ref<Asset>>& GetMemoryAssets() { return s_MemoryAssets; }
 
+		/// <summary>
+		/// Worker threads for decoding and importing asset files. Valid between Init and Shutdown.
+		/// </summary>
+		static ThreadPool& GetWorkerPool() { return *s_WorkerPool; }
+
+		/// <summary>
+		/// Stable handles of the asset files, saved in assets/Assets.registry.
+		/// </summary>
+		static AssetRegistry& GetRegistry() { return s_Registry; }
+
+		/// <summary>
+		/// Bytes the loaded assets of type may use before unreferenced ones are evicted. 0 never evicts.
+		/// </summary>
+		static void SetMemoryBudget(AssetType type, uint64_t bytes) { s_MemoryBudgets[type] = bytes; }
+		static uint64_t GetMemoryBudget(AssetType type);
+		/// <summary>
+		/// Bytes of the loaded assets of type in the registry, as of the last eviction check.
+		/// </summary>
+		static uint64_t GetMemoryUsage(AssetType type);
+
 		/// <summary>
 		/// Create asset from file
 		/// </summary>
@@ -50,23 +106,148 @@ namespace Engine
 			return s_MemoryAssets.find(handle) != s_MemoryAssets.end();
 		}
 
+		/// <summary>
+		/// Registered assets that are not loaded, e.g. evicted ones, are loaded again from their file.
+		/// </summary>
 		template<typename T>
 		static Ref<T> GetAsset(AssetHandle handle)
 		{
 			if (IsMemoryAsset(handle))
 				return std::dynamic_pointer_cast<T>(s_MemoryAssets[handle]);
+
+			auto it = s_LoadedAssets.find(handle);
+			if (it != s_LoadedAssets.end())
+				return std::dynamic_pointer_cast<T>(it->second);
+			return std::dynamic_pointer_cast<T>(LoadAsset(handle));
+		}
+
+		/// <summary>
+		/// Start loading a file on the asset workers and return its stable handle right away. Until the asset is loaded,
+		/// GetAssetOrPlaceholder returns the default asset of T. Works for Mesh and Texture2D, onLoaded runs on the main thread.
+		/// </summary>
+		template<typename T>
+		static AssetHandle LoadAsync(const std::string& path, AssetLoadPriority priority = AssetLoadPriority::Normal, std::function<void(const Ref<T>&)> onLoaded = nullptr)
+		{
+			static_assert(std::is_same<T, Mesh>::value || std::is_same<T, Texture2D>::value, "LoadAsync only works for meshes and 2D textures");
+
+			AssetHandle handle = 0;
+			if constexpr (std::is_same<T, Texture2D>::value)
+				handle = LoadTextureAsync(path, false, {}, priority);
 			else
-				return std::dynamic_pointer_cast<T>(s_LoadedAssets[handle]);
+				handle = LoadMeshAsync(path, priority);
+
+			if (onLoaded)
+				OnLoaded(handle, [onLoaded](const Ref<Asset>& asset) { onLoaded(std::dynamic_pointer_cast<T>(asset)); });
+			return handle;
 		}
+		static AssetHandle LoadMeshAsync(const std::string& path, AssetLoadPriority priority = AssetLoadPriority::Normal);
+		/// <summary>
+		/// The pixels decode on the asset workers, the file header is read right away.
+		/// </summary>
+		static AssetHandle LoadTextureAsync(const std::string& path, bool srgb = false, TextureSpecification spec = {}, AssetLoadPriority priority = AssetLoadPriority::Normal);
+
+		static AssetLoadState GetLoadState(AssetHandle handle);
+		/// <summary>
+		/// Asynchronous loads in flight, including textures from LoadTexture that are still decoding.
+		/// </summary>
+		static uint32_t GetPendingLoadCount();
+		/// <summary>
+		/// Call callback on the main thread when the asset is loaded, right away if it is loaded or failed already.
+		/// </summary>
+		static void OnLoaded(AssetHandle handle, const AssetLoadCallback& callback);
+
+		/// <summary>
+		/// Engine default asset that stands in for assets still loading: a flat grey texture, a unit box mesh.
+		/// </summary>
+		static Ref<Asset> GetPlaceholder(AssetType type);
+		template<typename T>
+		static Ref<T> GetPlaceholder()
+		{
+			return std::dynamic_pointer_cast<T>(GetPlaceholder(T::GetStaticType()));
+		}
+
+		/// <summary>
+		/// The asset if it is loaded, the placeholder of T otherwise. Never loads on the calling thread.
+		/// </summary>
+		template<typename T>
+		static Ref<T> GetAssetOrPlaceholder(AssetHandle handle)
+		{
+			if (GetLoadState(handle) == AssetLoadState::Loaded)
+			{
+				if (Ref<T> asset = GetAsset<T>(handle))
+					return asset;
+			}
+			return GetPlaceholder<T>();
+		}
+
+		/// <summary>
+		/// Load a texture file once. Requests for the same file with the same settings return the loaded texture.
+		/// Files with identical content share it too, once the asset workers have compared them. Failed loads are not kept, so they are retried.
+		/// </summary>
+		static Ref<Texture2D> LoadTexture(const std::string& path, bool srgb = false, TextureSpecification spec = {});
+		static const TextureCacheStatistics& GetTextureCacheStatistics() { return s_TextureCacheStatistics; }
+		/// <summary>
+		/// Log texture files that are loaded more than once, e.g. created with CreateNewAsset instead of LoadTexture,
+		/// and the bytes the copies take. Returns the duplicate bytes.
+		/// </summary>
+		static uint64_t ReportDuplicateTextures();
+
+		/// <summary>
+		/// Load a mesh file once. Entities that reference the same file share the returned mesh,
+		/// per entity materials belong in MeshComponent.
+		/// </summary>
+		static Ref<Mesh> LoadMesh(const std::string& path);
+		/// <summary>
+		/// Load a mesh file that keeps at least retention of its CPU geometry, e.g. positions for physics cooking.
+		/// </summary>
+		static Ref<Mesh> LoadMesh(const std::string& path, MeshRetention retention);
+		/// <summary>
+		/// The mesh loaded from path, null if the file has not been loaded.
+		/// </summary>
+		static Ref<Mesh> FindMesh(const std::string& path);
+		/// <summary>
+		/// Register a mesh loaded elsewhere, e.g. on the worker pool, so LoadMesh returns it for path.
+		/// </summary>
+		static void AddMesh(const std::string& path, const Ref<Mesh>& mesh);
+		/// <summary>
+		/// Log the resident CPU and GPU memory of every loaded mesh, largest CPU use first. Returns the CPU bytes.
+		/// </summary>
+		static uint64_t ReportMeshMemory();
 
 		/// <summary>
 		/// Clear unused (refence count == 1) memory asset at the end of every frame
 		/// </summary>
 		static void ClearUnusedMemoryAsset();
 
+	private:
+		/// <summary>
+		/// Load a registered asset from its file.
+		/// </summary>
+		static Ref<Asset> LoadAsset(AssetHandle handle);
+		/// <summary>
+		/// Unload an asset nothing references. It stays registered and loads again on the next request.
+		/// </summary>
+		static void EvictAsset(AssetMetadata& metadata);
+		/// <summary>
+		/// Finish the asynchronous loads that are done and run their callbacks.
+		/// </summary>
+		static void FinishAsyncLoads();
+
 	private:
 		static std::unordered_map<AssetHandle, Ref<Asset>> s_LoadedAssets; 
 		static std::unordered_map<AssetHandle, Ref<Asset>> s_MemoryAssets;
+		static Scope<ThreadPool> s_WorkerPool;
+
+		//Texture key (path and settings) -> handle
+		static std::unordered_map<std::string, AssetHandle> s_TexturePaths;
+		static TextureCacheStatistics s_TextureCacheStatistics;
+		//Canonical path -> mesh handle
+		static std::unordered_map<std::string, AssetHandle> s_MeshPaths;
+
+		static AssetRegistry s_Registry;
+		static std::unordered_map<AssetType, uint64_t> s_MemoryBudgets;
+		static std::unordered_map<AssetType, uint64_t> s_MemoryUsage;
+		static uint64_t s_Frame;
 
 	};
 }
@@ -0,0 +1,120 @@
+#include "pch.h"
+#include "AssetRegistry.h"
+#include "Engine/Core/Log.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "yaml-cpp/yaml.h"
+
+namespace Engine
+{
+	//Separated, so a path that ends like a variant does not collide with another path and variant
+	static std::string MakePathKey(const std::string& path, const std::string& variant)
+	{
+		return path + '|' + variant;
+	}
+
+	AssetMetadata& AssetRegistry::GetOrCreate(const std::string& path, const std::string& variant, AssetType type)
+	{
+		if (AssetMetadata* metadata = Find(path, variant))
+			return *metadata;
+
+		AssetMetadata metadata;
+		metadata.Handle = AssetHandle();
+		metadata.Type = type;
+		metadata.FilePath = path;
+		metadata.Variant = variant;
+		Add(metadata);
+		m_Dirty = true;
+		return m_Assets[metadata.Handle];
+	}
+
+	AssetMetadata* AssetRegistry::Find(AssetHandle handle)
+	{
+		auto it = m_Assets.find(handle);
+		return it != m_Assets.end() ? &it->second : nullptr;
+	}
+
+	AssetMetadata* AssetRegistry::Find(const std::string& path, const std::string& variant)
+	{
+		auto it = m_Paths.find(MakePathKey(path, variant));
+		return it != m_Paths.end() ? Find(it->second) : nullptr;
+	}
+
+	bool AssetRegistry::Add(const AssetMetadata& metadata)
+	{
+		std::string key = MakePathKey(metadata.FilePath, metadata.Variant);
+		if (m_Assets.find(metadata.Handle) != m_Assets.end() || m_Paths.find(key) != m_Paths.end())
+		{
+			ENGINE_WARN("Asset '{0}' ({1}) is registered twice, the second entry is ignored", metadata.FilePath, (uint64_t)metadata.Handle);
+			return false;
+		}
+
+		m_Assets[metadata.Handle] = metadata;
+		m_Paths[key] = metadata.Handle;
+		return true;
+	}
+
+	bool AssetRegistry::Load(const std::string& filepath)
+	{
+		std::ifstream stream(filepath);
+		if (!stream)
+			return false;
+		std::stringstream strStream;
+		strStream << stream.rdbuf();
+
+		YAML::Node data = YAML::Load(strStream.str());
+		auto assets = data["Assets"];
+		if (!assets)
+			return false;
+
+		for (auto asset : assets)
+		{
+			AssetMetadata metadata;
+			metadata.Handle = asset["Handle"].as<uint64_t>();
+			metadata.Type = AssetTypeFormString(asset["Type"].as<std::string>());
+			metadata.FilePath = asset["FilePath"].as<std::string>();
+			if (asset["Variant"])
+				metadata.Variant = asset["Variant"].as<std::string>();
+			Add(metadata);
+		}
+
+		ENGINE_INFO("Loaded {0} assets from registry '{1}'", m_Assets.size(), filepath);
+		m_Dirty = false;
+		return true;
+	}
+
+	void AssetRegistry::Save(const std::string& filepath)
+	{
+		//Sorted, so the file diffs well under version control
+		std::vector<const AssetMetadata*> assets;
+		for (auto& [handle, metadata] : m_Assets)
+			assets.push_back(&metadata);
+		std::sort(assets.begin(), assets.end(), [](const AssetMetadata* a, const AssetMetadata* b)
+			{
+				return a->FilePath != b->FilePath ? a->FilePath < b->FilePath : a->Variant < b->Variant;
+			});
+
+		YAML::Emitter out;
+		out << YAML::BeginMap;
+		out << YAML::Key << "Assets";
+		out << YAML::Value << YAML::BeginSeq;	//Assets seq
+		for (const AssetMetadata* metadata : assets)
+		{
+			out << YAML::BeginMap;
+			out << YAML::Key << "Handle" << YAML::Value << (uint64_t)metadata->Handle;
+			out << YAML::Key << "Type" << YAML::Value << AssetTypeToString(metadata->Type);
+			out << YAML::Key << "FilePath" << YAML::Value << metadata->FilePath;
+			if (!metadata->Variant.empty())
+				out << YAML::Key << "Variant" << YAML::Value << metadata->Variant;
+			out << YAML::EndMap;
+		}
+		out << YAML::EndSeq;	//Assets seq
+		out << YAML::EndMap;
+
+		std::ofstream fout(filepath);
+		fout << out.c_str();
+		m_Dirty = false;
+	}
+}
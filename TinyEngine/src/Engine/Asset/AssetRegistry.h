@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Engine/Asset/Asset.h"
+
+#include <string>
+#include <unordered_map>
+
+namespace Engine
+{
+	enum class AssetLoadState
+	{
+		Unloaded = 0,
+		Loading,
+		Loaded,
+		Failed
+	};
+
+	/// <summary>
+	/// What the registry knows about an asset file. Kept while the asset itself is not loaded, so it can be loaded again.
+	/// </summary>
+	struct AssetMetadata
+	{
+		AssetHandle Handle = 0;
+		AssetType Type = AssetType::None;
+		//Canonical, relative to the working directory
+		std::string FilePath;
+		//Load settings that make a different asset of the same file, e.g. the texture settings
+		std::string Variant;
+
+		//Runtime state, not saved
+		AssetLoadState State = AssetLoadState::Unloaded;
+		uint64_t LastUsedFrame = 0;
+		uint64_t MemorySize = 0;
+	};
+
+	/// <summary>
+	/// Maps asset files to handles that stay the same across runs. The registry is saved next to the assets,
+	/// so handles kept in files stay valid after a restart.
+	/// </summary>
+	class AssetRegistry
+	{
+	public:
+		/// <summary>
+		/// The metadata of path with variant. Files that are not registered yet get a new handle.
+		/// </summary>
+		AssetMetadata& GetOrCreate(const std::string& path, const std::string& variant, AssetType type);
+		/// <summary>
+		/// Null if the handle is not registered.
+		/// </summary>
+		AssetMetadata* Find(AssetHandle handle);
+		AssetMetadata* Find(const std::string& path, const std::string& variant);
+
+		const std::unordered_map<AssetHandle, AssetMetadata>& GetAssets() const { return m_Assets; }
+		uint32_t GetCount() const { return (uint32_t)m_Assets.size(); }
+
+		/// <summary>
+		/// Add the entries of a registry file. Returns false if the file could not be read.
+		/// </summary>
+		bool Load(const std::string& filepath);
+		void Save(const std::string& filepath);
+		/// <summary>
+		/// True if assets were registered since the last Load or Save.
+		/// </summary>
+		bool IsDirty() const { return m_Dirty; }
+
+	private:
+		bool Add(const AssetMetadata& metadata);
+
+	private:
+		std::unordered_map<AssetHandle, AssetMetadata> m_Assets;
+		//Path and variant -> handle
+		std::unordered_map<std::string, AssetHandle> m_Paths;
+		bool m_Dirty = false;
+	};
+}
@@ -25,8 +25,8 @@ namespace Engine
 		if (assetType == "None")		return AssetType::None;
 		if (assetType == "Scene")		return AssetType::Scene;
 		if (assetType == "Mesh")		return AssetType::Mesh;
-		if (assetType == "Texture")		return AssetType::Mesh;
-		if (assetType == "Material")	return AssetType::Mesh;
+		if (assetType == "Texture")		return AssetType::Texture;
+		if (assetType == "Material")	return AssetType::Material;
 
 		ENGINE_ASSERT(false, "Unknown Asset Type");
 		return AssetType::None;
@@ -6,11 +6,13 @@
 #include "Engine/Physics/Physics.h"
 #include "Engine/Script/ScriptEngine.h"
 
-#include <commdlg.h>
-
-#define GLFW_EXPOSE_NATIVE_WIN32
 #include <GLFW/glfw3.h>
-#include <GLFW/glfw3native.h>
+#ifdef ENGINE_PLATFORM_WINDOWS
+	#include <commdlg.h>
+
+	#define GLFW_EXPOSE_NATIVE_WIN32
+	#include <GLFW/glfw3native.h>
+#endif // ENGINE_PLATFORM_WINDOWS
 
 namespace Engine 
 {
@@ -35,12 +37,12 @@ namespace Engine
 		//Init systems
 		ScriptEngine::Init("assets/scripts/SandBox.dll");
 		Physics::Init();
+		//Renderer decodes textures on the asset workers
+		AssetManager::Init();
 
 		//Init renderer
 		Renderer::Init();
 		Renderer::WaitAndRender();
-
-		AssetManager::Init();
 	}
 
 	Application::~Application()
@@ -78,8 +80,8 @@ namespace Engine
 
 				//Excute render commands
 				Renderer::WaitAndRender();
-				//Clear memory asset
-				AssetManager::ClearUnusedMemoryAsset();
+				//Track asset use, evict unused assets over budget
+				AssetManager::Update();
 			}
 			m_Window->OnUpdate();
 		}
@@ -137,6 +139,7 @@ namespace Engine
 
 	std::string Application::OpenFile(const char* filter) const
 	{
+#ifdef ENGINE_PLATFORM_WINDOWS
 		OPENFILENAMEA ofn;       // common dialog box structure
 		CHAR szFile[260] = { 0 };       // if using TCHAR macros
 
@@ -154,11 +157,15 @@ namespace Engine
 		{
 			return ofn.lpstrFile;
 		}
+#else
+		ENGINE_WARN("File dialogs are only supported on Windows");
+#endif // ENGINE_PLATFORM_WINDOWS
 		return std::string();
 	}
 
 	std::string Application::SaveFile(const char* filter) const
 	{
+#ifdef ENGINE_PLATFORM_WINDOWS
 		OPENFILENAMEA ofn;       // common dialog box structure
 		CHAR szFile[260] = { 0 };       // if using TCHAR macros
 
@@ -176,6 +183,9 @@ namespace Engine
 		{
 			return ofn.lpstrFile;
 		}
+#else
+		ENGINE_WARN("File dialogs are only supported on Windows");
+#endif // ENGINE_PLATFORM_WINDOWS
 		return std::string();
 	}
 
@@ -4,6 +4,11 @@
 	#define ENGINE_ENABLE_ASSERTS
 #endif
 
+#ifdef ENGINE_PLATFORM_LINUX
+	#include <signal.h>
+	#define __debugbreak() raise(SIGTRAP)
+#endif
+
 #ifdef ENGINE_ENABLE_ASSERTS
 	#define ENGINE_ASSERT(condition, ...) { if(!(condition)) { ENGINE_ERROR("Assertion Failed: {0}", __VA_ARGS__);__debugbreak(); } }
 	#define APP_ASSERT(condition, ...) { if(!(condition)) { APP_ERROR("Assertion Failed: {0}", __VA_ARGS__);__debugbreak(); } }
@@ -40,6 +40,13 @@ namespace Engine
 			Size = size;
 		}
 
+		void Release()
+		{
+			delete[] Data;
+			Data = nullptr;
+			Size = 0;
+		}
+
 		void ZeroInitialize()
 		{
 			if (Data)
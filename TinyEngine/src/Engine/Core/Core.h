@@ -14,8 +14,11 @@
 	#else
 		#define ENGINE_API
 	#endif
+#elif defined(ENGINE_PLATFORM_LINUX)
+	//Linux is only supported by the headless renderer
+	#define ENGINE_API
 #else 
-	#error Engine Only supports Windows!
+	#error Engine Only supports Windows and headless Linux!
 #endif 
 
 #define BIT(x) (1 << x)
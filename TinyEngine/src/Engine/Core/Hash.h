@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Engine
+{
+	class Hash
+	{
+	public:
+		/// <summary>
+		/// 32-bit FNV-1a. constexpr so string literals can be hashed at compile time.
+		/// </summary>
+		static constexpr uint32_t FNV(const char* str)
+		{
+			uint32_t hash = 2166136261u;
+			while (*str)
+			{
+				hash ^= (uint8_t)*str++;
+				hash *= 16777619u;
+			}
+			return hash;
+		}
+
+		/// <summary>
+		/// 32-bit FNV-1a over a byte range. Pass the previous result as hash to chain ranges.
+		/// </summary>
+		static uint32_t FNV(const void* data, size_t size, uint32_t hash = 2166136261u)
+		{
+			const uint8_t* bytes = (const uint8_t*)data;
+			for (size_t i = 0; i < size; i++)
+			{
+				hash ^= bytes[i];
+				hash *= 16777619u;
+			}
+			return hash;
+		}
+	};
+}
@@ -0,0 +1,70 @@
+#include "pch.h"
+#include "MappedFile.h"
+
+#ifndef ENGINE_PLATFORM_WINDOWS
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+namespace Engine
+{
+#ifdef ENGINE_PLATFORM_WINDOWS
+	MappedFile::MappedFile(const std::string& path)
+	{
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return;
+		m_File = file;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+			return;
+
+		m_Mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!m_Mapping)
+			return;
+
+		m_Data = (const uint8_t*)MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0);
+		if (m_Data)
+			m_Size = (uint64_t)size.QuadPart;
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (m_Data)
+			UnmapViewOfFile(m_Data);
+		if (m_Mapping)
+			CloseHandle(m_Mapping);
+		if (m_File)
+			CloseHandle(m_File);
+	}
+#else
+	MappedFile::MappedFile(const std::string& path)
+	{
+		int file = open(path.c_str(), O_RDONLY);
+		if (file < 0)
+			return;
+
+		struct stat status;
+		if (fstat(file, &status) == 0 && status.st_size > 0)
+		{
+			void* data = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+			if (data != MAP_FAILED)
+			{
+				m_Data = (const uint8_t*)data;
+				m_Size = (uint64_t)status.st_size;
+			}
+		}
+		//The mapping keeps the file referenced
+		close(file);
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (m_Data)
+			munmap((void*)m_Data, (size_t)m_Size);
+	}
+#endif
+}
@@ -0,0 +1,66 @@
+#include "pch.h"
+#include "ThreadPool.h"
+
+namespace Engine
+{
+	ThreadPool::ThreadPool(uint32_t threadCount)
+	{
+		if (threadCount == 0)
+			threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+		m_Threads.reserve(threadCount);
+		for (uint32_t i = 0; i < threadCount; i++)
+			m_Threads.emplace_back(&ThreadPool::WorkerLoop, this);
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Stopping = true;
+			m_Jobs.clear();
+		}
+		m_Condition.notify_all();
+
+		for (auto& thread : m_Threads)
+			thread.join();
+	}
+
+	void ThreadPool::Enqueue(Job job, uint32_t priority)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			//After the jobs of the same priority
+			auto it = std::upper_bound(m_Jobs.begin(), m_Jobs.end(), priority, [](uint32_t priority, const QueuedJob& queued)
+				{
+					return priority > queued.Priority;
+				});
+			m_Jobs.insert(it, { std::move(job), priority });
+		}
+		m_Condition.notify_one();
+	}
+
+	uint32_t ThreadPool::GetPendingJobCount()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return (uint32_t)m_Jobs.size();
+	}
+
+	void ThreadPool::WorkerLoop()
+	{
+		while (true)
+		{
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_Condition.wait(lock, [this]() { return m_Stopping || !m_Jobs.empty(); });
+				if (m_Stopping)
+					return;
+
+				job = std::move(m_Jobs.front().Function);
+				m_Jobs.pop_front();
+			}
+			job();
+		}
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <vector>
+
+namespace Engine
+{
+	/// <summary>
+	/// Fixed set of worker threads running jobs by priority, then in submission order. Jobs must not touch the renderer,
+	/// hand results back to the main thread instead.
+	/// </summary>
+	class ThreadPool
+	{
+	public:
+		using Job = std::function<void()>;
+
+		/// <summary>
+		/// threadCount 0 uses one thread per core, leaving one core for the main thread.
+		/// </summary>
+		ThreadPool(uint32_t threadCount = 0);
+		/// <summary>
+		/// Waits for running jobs. Jobs that have not started are dropped.
+		/// </summary>
+		~ThreadPool();
+
+		/// <summary>
+		/// Jobs of higher priority run before the queued jobs of lower priority.
+		/// </summary>
+		void Enqueue(Job job, uint32_t priority = 0);
+
+		uint32_t GetThreadCount() const { return (uint32_t)m_Threads.size(); }
+		uint32_t GetPendingJobCount();
+
+	private:
+		struct QueuedJob
+		{
+			Job Function;
+			uint32_t Priority;
+		};
+
+		void WorkerLoop();
+
+	private:
+		std::vector<std::thread> m_Threads;
+		//Highest priority first
+		std::deque<QueuedJob> m_Jobs;
+		std::mutex m_Mutex;
+		std::condition_variable m_Condition;
+		bool m_Stopping = false;
+	};
+}
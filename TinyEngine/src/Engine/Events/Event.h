@@ -53,7 +53,7 @@ namespace Engine
 	};
 
 	//Event궨庯
-#define EVENT_CLASS_TYPE(type)	static EventType GetStaticType() { return EventType::##type; }\
+#define EVENT_CLASS_TYPE(type)	static EventType GetStaticType() { return EventType::type; }\
 								virtual EventType GetEventType() const override { return GetStaticType(); }\
 								virtual const char* GetName() const override { return #type; }
 
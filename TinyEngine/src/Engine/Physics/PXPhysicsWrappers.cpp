@@ -24,6 +24,10 @@ namespace Engine
 
 	static ContactListener s_ContactListener;
 
+	//Debug geometry of cooked meshes by collision mesh file, shared by the colliders of the same asset
+	static std::unordered_map<std::string, std::vector<Ref<Mesh>>> s_ConvexDebugMeshes;
+	static std::unordered_map<std::string, std::vector<Ref<Mesh>>> s_TriangleDebugMeshes;
+
 	void PhysicsErrorCallback::reportError(physx::PxErrorCode::Enum code, const char* message, const char* file, int line)
 	{
 		const char* errorMessage = NULL;
@@ -294,19 +298,26 @@ namespace Engine
 		s_CookingFactory->setParams(newParams);
 
 		if (invalidateOld)
+		{
 			PhysicsMeshSerializer::DeleteIfSerialized(collider.CollisionMesh->GetFilePath());
+			s_ConvexDebugMeshes.erase(collider.CollisionMesh->GetFilePath());
+		}
 
-		if (!PhysicsMeshSerializer::IsSerialized(collider.CollisionMesh->GetFilePath()))
+		if (!PhysicsMeshSerializer::IsSerialized(collider.CollisionMesh->GetFilePath()) && collider.CollisionMesh->GetPositions().empty())
+		{
+			ENGINE_ERROR("Mesh '{0}' keeps no positions to cook, load it with MeshRetention::KeepPositionsForQueries", collider.CollisionMesh->GetFilePath());
+		}
+		else if (!PhysicsMeshSerializer::IsSerialized(collider.CollisionMesh->GetFilePath()))
 		{
-			const std::vector<Vertex>& vertices = collider.CollisionMesh->GetStaticVertices();
+			const std::vector<glm::vec3>& positions = collider.CollisionMesh->GetPositions();
 			const std::vector<Index>& indices = collider.CollisionMesh->GetIndices();
 
 			for (const auto& submesh : collider.CollisionMesh->GetSubmeshes())
 			{
 				physx::PxConvexMeshDesc convexDesc;
 				convexDesc.points.count = submesh.VertexCount;
-				convexDesc.points.stride = sizeof(Vertex);
-				convexDesc.points.data = &vertices[submesh.BaseVertex];
+				convexDesc.points.stride = sizeof(glm::vec3);
+				convexDesc.points.data = &positions[submesh.BaseVertex];
 				convexDesc.indices.count = submesh.IndexCount / 3;
 				convexDesc.indices.data = &indices[submesh.BaseIndex / 3];
 				convexDesc.indices.stride = sizeof(Index);
@@ -346,7 +357,12 @@ namespace Engine
 			}
 		}
 
-		if (collider.ProcessedMeshes.size() <= 0)
+		auto cachedMeshes = s_ConvexDebugMeshes.find(collider.CollisionMesh->GetFilePath());
+		if (cachedMeshes != s_ConvexDebugMeshes.end())
+		{
+			collider.ProcessedMeshes = cachedMeshes->second;
+		}
+		else
 		{
 			for (auto shape : shapes)
 			{
@@ -393,10 +409,11 @@ namespace Engine
 						collisionIndices.push_back(index);
 						indexCounter++;
 					}
-
-					collider.ProcessedMeshes.push_back(CreateRef<Mesh>(collisionVertices, collisionIndices, FromPhysXTransform(shape->getLocalPose())));
 				}
+
+				collider.ProcessedMeshes.push_back(CreateRef<Mesh>(collisionVertices, collisionIndices, FromPhysXTransform(shape->getLocalPose())));
 			}
+			s_ConvexDebugMeshes[collider.CollisionMesh->GetFilePath()] = collider.ProcessedMeshes;
 		}
 
 		s_CookingFactory->setParams(currentParams);
@@ -410,19 +427,26 @@ namespace Engine
 		collider.ProcessedMeshes.clear();
 
 		if (invalidateOld)
+		{
 			PhysicsMeshSerializer::DeleteIfSerialized(collider.CollisionMesh->GetFilePath());
+			s_TriangleDebugMeshes.erase(collider.CollisionMesh->GetFilePath());
+		}
 
-		if (!PhysicsMeshSerializer::IsSerialized(collider.CollisionMesh->GetFilePath()))
+		if (!PhysicsMeshSerializer::IsSerialized(collider.CollisionMesh->GetFilePath()) && collider.CollisionMesh->GetPositions().empty())
+		{
+			ENGINE_ERROR("Mesh '{0}' keeps no positions to cook, load it with MeshRetention::KeepPositionsForQueries", collider.CollisionMesh->GetFilePath());
+		}
+		else if (!PhysicsMeshSerializer::IsSerialized(collider.CollisionMesh->GetFilePath()))
 		{
-			const std::vector<Vertex>& vertices = collider.CollisionMesh->GetStaticVertices();
+			const std::vector<glm::vec3>& positions = collider.CollisionMesh->GetPositions();
 			const std::vector<Index>& indices = collider.CollisionMesh->GetIndices();
 
 			for (const auto& submesh : collider.CollisionMesh->GetSubmeshes())
 			{
 				physx::PxTriangleMeshDesc triangleDesc;
 				triangleDesc.points.count = submesh.VertexCount;
-				triangleDesc.points.stride = sizeof(Vertex);
-				triangleDesc.points.data = &vertices[submesh.BaseVertex];
+				triangleDesc.points.stride = sizeof(glm::vec3);
+				triangleDesc.points.data = &positions[submesh.BaseVertex];
 				triangleDesc.triangles.count = submesh.IndexCount / 3;
 				triangleDesc.triangles.data = &indices[submesh.BaseIndex / 3];
 				triangleDesc.triangles.stride = sizeof(Index);
@@ -460,7 +484,12 @@ namespace Engine
 			}
 		}
 
-		if (collider.ProcessedMeshes.size() <= 0)
+		auto cachedMeshes = s_TriangleDebugMeshes.find(collider.CollisionMesh->GetFilePath());
+		if (cachedMeshes != s_TriangleDebugMeshes.end())
+		{
+			collider.ProcessedMeshes = cachedMeshes->second;
+		}
+		else
 		{
 			for (auto shape : shapes)
 			{
@@ -494,6 +523,7 @@ namespace Engine
 
 				collider.ProcessedMeshes.push_back(CreateRef<Mesh>(vertices, indices, FromPhysXTransform(shape->getLocalPose())));
 			}
+			s_TriangleDebugMeshes[collider.CollisionMesh->GetFilePath()] = collider.ProcessedMeshes;
 		}
 
 		return shapes;
@@ -612,6 +642,8 @@ namespace Engine
 
 	void PXPhysicsWrappers::Shutdown()
 	{
+		s_ConvexDebugMeshes.clear();
+		s_TriangleDebugMeshes.clear();
 		s_CookingFactory->release();
 		s_Physics->release();
 		s_Foundation->release();
@@ -6,7 +6,7 @@ namespace Engine
 	template<typename T, typename ConditionFunction>
 	static bool RemoveIfExists(std::vector<T>& vector, ConditionFunction condition)
 	{
-		for (std::vector<T>::iterator it = vector.begin(); it != vector.end(); ++it)
+		for (typename std::vector<T>::iterator it = vector.begin(); it != vector.end(); ++it)
 		{
 			if (condition(*it))
 			{
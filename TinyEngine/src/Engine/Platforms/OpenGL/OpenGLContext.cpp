@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "OpenGLContext.h"
+#include "OpenGLExtensions.h"
 #include "Engine/Core/Core.h"
 
 #include <GLFW/glfw3.h>
@@ -26,6 +27,7 @@ namespace Engine
         ENGINE_INFO("  Vendor: {0}", (char*)glGetString(GL_VENDOR));
         ENGINE_INFO("  Renderer: {0}", (char*)glGetString(GL_RENDERER));
         ENGINE_INFO("  Version: {0}", (char*)glGetString(GL_VERSION));
+        OpenGLExtensions::Load((GLADloadproc)glfwGetProcAddress);
         ENGINE_INFO("-------------------------------------------------------------------");
     }
 
@@ -0,0 +1,67 @@
+#include "pch.h"
+#include "OpenGLExtensions.h"
+
+#include <thread>
+#include <algorithm>
+
+namespace Engine
+{
+	bool OpenGLExtensions::BindlessTexture = false;
+	PFN_GetTextureHandleARB OpenGLExtensions::GetTextureHandleARB = nullptr;
+	PFN_MakeTextureHandleResidentARB OpenGLExtensions::MakeTextureHandleResidentARB = nullptr;
+	PFN_MakeTextureHandleNonResidentARB OpenGLExtensions::MakeTextureHandleNonResidentARB = nullptr;
+	PFN_ProgramUniformHandleui64ARB OpenGLExtensions::ProgramUniformHandleui64ARB = nullptr;
+	bool OpenGLExtensions::ParallelShaderCompile = false;
+	PFN_MaxShaderCompilerThreadsKHR OpenGLExtensions::MaxShaderCompilerThreadsKHR = nullptr;
+	bool OpenGLExtensions::TextureCompressionS3TC = false;
+	bool OpenGLExtensions::IndirectParameters = false;
+	PFN_MultiDrawElementsIndirectCountARB OpenGLExtensions::MultiDrawElementsIndirectCountARB = nullptr;
+
+	void OpenGLExtensions::Load(GLADloadproc loader)
+	{
+		if (IsSupported("GL_ARB_bindless_texture"))
+		{
+			GetTextureHandleARB = (PFN_GetTextureHandleARB)loader("glGetTextureHandleARB");
+			MakeTextureHandleResidentARB = (PFN_MakeTextureHandleResidentARB)loader("glMakeTextureHandleResidentARB");
+			MakeTextureHandleNonResidentARB = (PFN_MakeTextureHandleNonResidentARB)loader("glMakeTextureHandleNonResidentARB");
+			ProgramUniformHandleui64ARB = (PFN_ProgramUniformHandleui64ARB)loader("glProgramUniformHandleui64ARB");
+			BindlessTexture = GetTextureHandleARB && MakeTextureHandleResidentARB && MakeTextureHandleNonResidentARB && ProgramUniformHandleui64ARB;
+		}
+
+		if (IsSupported("GL_KHR_parallel_shader_compile"))
+			MaxShaderCompilerThreadsKHR = (PFN_MaxShaderCompilerThreadsKHR)loader("glMaxShaderCompilerThreadsKHR");
+		else if (IsSupported("GL_ARB_parallel_shader_compile"))
+			MaxShaderCompilerThreadsKHR = (PFN_MaxShaderCompilerThreadsKHR)loader("glMaxShaderCompilerThreadsARB");
+		ParallelShaderCompile = MaxShaderCompilerThreadsKHR != nullptr;
+		if (ParallelShaderCompile)
+		{
+			//Leave one core for the main thread
+			uint32_t threads = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+			MaxShaderCompilerThreadsKHR(threads);
+		}
+
+		TextureCompressionS3TC = IsSupported("GL_EXT_texture_compression_s3tc");
+
+		if (IsSupported("GL_ARB_indirect_parameters"))
+			MultiDrawElementsIndirectCountARB = (PFN_MultiDrawElementsIndirectCountARB)loader("glMultiDrawElementsIndirectCountARB");
+		IndirectParameters = MultiDrawElementsIndirectCountARB != nullptr;
+
+		ENGINE_INFO("OpenGL Extensions:");
+		ENGINE_INFO("  GL_ARB_bindless_texture: {0}", BindlessTexture);
+		ENGINE_INFO("  GL_KHR_parallel_shader_compile: {0}", ParallelShaderCompile);
+		ENGINE_INFO("  GL_EXT_texture_compression_s3tc: {0}", TextureCompressionS3TC);
+		ENGINE_INFO("  GL_ARB_indirect_parameters: {0}", IndirectParameters);
+	}
+
+	bool OpenGLExtensions::IsSupported(const char* name)
+	{
+		GLint count = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+		for (GLint i = 0; i < count; i++)
+		{
+			if (!strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), name))
+				return true;
+		}
+		return false;
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <glad/glad.h>
+
+namespace Engine
+{
+	typedef GLuint64(APIENTRYP PFN_GetTextureHandleARB)(GLuint texture);
+	typedef void (APIENTRYP PFN_MakeTextureHandleResidentARB)(GLuint64 handle);
+	typedef void (APIENTRYP PFN_MakeTextureHandleNonResidentARB)(GLuint64 handle);
+	typedef void (APIENTRYP PFN_ProgramUniformHandleui64ARB)(GLuint program, GLint location, GLuint64 value);
+	typedef void (APIENTRYP PFN_MaxShaderCompilerThreadsKHR)(GLuint count);
+	typedef void (APIENTRYP PFN_MultiDrawElementsIndirectCountARB)(GLenum mode, GLenum type, const void* indirect, GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride);
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+#ifndef GL_PARAMETER_BUFFER_ARB
+#define GL_PARAMETER_BUFFER_ARB 0x80EE
+#endif
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+	/// <summary>
+	/// Extensions used by the OpenGL backend that are not part of the core profile loaded by Glad.
+	/// Loaded once by the renderer context after Glad.
+	/// </summary>
+	class OpenGLExtensions
+	{
+	public:
+		static void Load(GLADloadproc loader);
+		static bool IsSupported(const char* name);
+
+	public:
+		//GL_ARB_bindless_texture
+		static bool BindlessTexture;
+		static PFN_GetTextureHandleARB GetTextureHandleARB;
+		static PFN_MakeTextureHandleResidentARB MakeTextureHandleResidentARB;
+		static PFN_MakeTextureHandleNonResidentARB MakeTextureHandleNonResidentARB;
+		static PFN_ProgramUniformHandleui64ARB ProgramUniformHandleui64ARB;
+
+		//GL_KHR_parallel_shader_compile (or the ARB variant)
+		static bool ParallelShaderCompile;
+		static PFN_MaxShaderCompilerThreadsKHR MaxShaderCompilerThreadsKHR;
+
+		//GL_EXT_texture_compression_s3tc, BC1/BC3. BC4/BC5/BC7 are core.
+		static bool TextureCompressionS3TC;
+
+		//GL_ARB_indirect_parameters, draw counts read from a buffer
+		static bool IndirectParameters;
+		static PFN_MultiDrawElementsIndirectCountARB MultiDrawElementsIndirectCountARB;
+	};
+}
@@ -159,6 +159,39 @@ namespace Engine
         });
     }
 
+    void OpenGLFrameBuffer::ReadColorAttachment(Buffer& outBuffer, uint32_t attachmentIndex) const
+    {
+        uint32_t size = m_Specification.Width * m_Specification.Height * 4 * sizeof(float);
+        outBuffer.Allocate(size);
+
+        Buffer* buffer = &outBuffer;
+        Renderer::Submit([this, attachmentIndex, buffer, size]() {
+            RENDERCOMMAND_TRACE("RenderCommand: Read frameBuffer({0}) - ColorAttachment({1})", m_RendererID, attachmentIndex);
+            glGetTextureImage(m_ColorAttachments[attachmentIndex], 0, GL_RGBA, GL_FLOAT, size, buffer->Data);
+        });
+    }
+
+    void OpenGLFrameBuffer::Discard(bool color, bool depth)
+    {
+        Renderer::Submit([this, color, depth]() {
+            GLenum attachments[MaxColorAttachmentCount + 1];
+            uint32_t count = 0;
+            if (color)
+            {
+                for (uint32_t i = 0; i < m_ColorAttachments.size(); i++)
+                    attachments[count++] = GL_COLOR_ATTACHMENT0 + i;
+            }
+            if (depth && m_DepthAttachmentFormat != FrameBufferTextureFormat::None)
+                attachments[count++] = m_DepthAttachmentFormat == FrameBufferTextureFormat::DEPTH24STENCIL8 ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+
+            if (count)
+            {
+                RENDERCOMMAND_TRACE("RenderCommand: Discard frameBuffer({0})", m_RendererID);
+                glInvalidateNamedFramebufferData(m_RendererID, count, attachments);
+            }
+        });
+    }
+
     void OpenGLFrameBuffer::Create()
     {
         Renderer::Submit([this]()
@@ -25,6 +25,8 @@ namespace Engine
 
 		virtual void Resize(uint32_t width, uint32_t height) override;
 		virtual void BindTexture(uint32_t attachmentIndex = 0, uint32_t slot = 0) const override;
+		virtual void ReadColorAttachment(Buffer& outBuffer, uint32_t attachmentIndex = 0) const override;
+		virtual void Discard(bool color = true, bool depth = true) override;
 
 	private:
 		void Create();
@@ -0,0 +1,115 @@
+#include "pch.h"
+#include "OpenGLHeadlessContext.h"
+#include "OpenGLExtensions.h"
+#include "Engine/Core/Core.h"
+
+#include <glad/glad.h>
+
+#ifdef ENGINE_PLATFORM_LINUX
+	#include <EGL/egl.h>
+	#include <EGL/eglext.h>
+#endif
+
+namespace Engine
+{
+#ifdef ENGINE_PLATFORM_LINUX
+    static EGLDisplay GetHeadlessDisplay()
+    {
+        //Prefer the surfaceless platform, it needs neither X11 nor a DRM device
+        auto eglGetPlatformDisplayEXT = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (eglGetPlatformDisplayEXT)
+        {
+            EGLDisplay display = eglGetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            if (display != EGL_NO_DISPLAY)
+                return display;
+        }
+        return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+#endif
+
+    OpenGLHeadlessContext::OpenGLHeadlessContext()
+    {
+    }
+
+    OpenGLHeadlessContext::~OpenGLHeadlessContext()
+    {
+#ifdef ENGINE_PLATFORM_LINUX
+        if (m_Display)
+        {
+            eglMakeCurrent((EGLDisplay)m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            if (m_Context)
+                eglDestroyContext((EGLDisplay)m_Display, (EGLContext)m_Context);
+            eglTerminate((EGLDisplay)m_Display);
+        }
+#endif
+    }
+
+    void OpenGLHeadlessContext::Init()
+    {
+#ifdef ENGINE_PLATFORM_LINUX
+        EGLDisplay display = GetHeadlessDisplay();
+        ENGINE_ASSERT(display != EGL_NO_DISPLAY, "Could not get EGL display!");
+
+        EGLint major, minor;
+        if (!eglInitialize(display, &major, &minor))
+        {
+            ENGINE_FATAL("Initialize EGL failed!");
+            return;
+        }
+        m_Display = display;
+
+        const EGLint configAttributes[] = {
+            EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+            EGL_RED_SIZE, 8,
+            EGL_GREEN_SIZE, 8,
+            EGL_BLUE_SIZE, 8,
+            EGL_ALPHA_SIZE, 8,
+            EGL_DEPTH_SIZE, 24,
+            EGL_NONE
+        };
+        EGLConfig config = nullptr;
+        EGLint configCount = 0;
+        //Surfaceless displays may not expose pbuffer configs, a context without config is enough for FBO rendering
+        if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0)
+            config = nullptr;
+
+        eglBindAPI(EGL_OPENGL_API);
+        //The renderer relies on DSA and compute shaders
+        const EGLint contextAttributes[] = {
+            EGL_CONTEXT_MAJOR_VERSION, 4,
+            EGL_CONTEXT_MINOR_VERSION, 5,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+        };
+        EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+        if (context == EGL_NO_CONTEXT)
+        {
+            ENGINE_FATAL("Create EGL context failed! Error: {0}", eglGetError());
+            return;
+        }
+        m_Context = context;
+
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
+
+        //Initialize Glad
+        int status = gladLoadGLLoader((GLADloadproc)eglGetProcAddress);
+        ENGINE_ASSERT(status, "Initialize Glad failed!");
+
+        ENGINE_INFO("-------------------------------------------------------------------");
+        ENGINE_INFO("OpenGL Info (headless, EGL {0}.{1}):", major, minor);
+        ENGINE_INFO("  Vendor: {0}", (char*)glGetString(GL_VENDOR));
+        ENGINE_INFO("  Renderer: {0}", (char*)glGetString(GL_RENDERER));
+        ENGINE_INFO("  Version: {0}", (char*)glGetString(GL_VERSION));
+        OpenGLExtensions::Load((GLADloadproc)eglGetProcAddress);
+        ENGINE_INFO("-------------------------------------------------------------------");
+#else
+        ENGINE_ASSERT(false, "Headless context is only supported on Linux!");
+#endif
+    }
+
+    void OpenGLHeadlessContext::SwapBuffers()
+    {
+        glFlush();
+    }
+}
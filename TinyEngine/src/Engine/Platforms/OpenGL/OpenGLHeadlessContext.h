@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Engine/Renderer/RendererContext.h"
+
+namespace Engine
+{
+	/// <summary>
+	/// Windowless OpenGL context. On Linux it is created through EGL (surfaceless platform first,
+	/// then the default display), so it also works with Mesa llvmpipe on machines without GPU.
+	/// All rendering goes to FrameBuffers, SwapBuffers only flushes the command stream.
+	/// </summary>
+	class OpenGLHeadlessContext : public RendererContext
+	{
+	public:
+		OpenGLHeadlessContext();
+		virtual ~OpenGLHeadlessContext();
+
+		virtual void Init() override;
+		virtual void SwapBuffers() override;
+
+	private:
+		void* m_Display = nullptr;
+		void* m_Context = nullptr;
+	};
+}
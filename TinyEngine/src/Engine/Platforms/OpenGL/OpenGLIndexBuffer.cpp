@@ -23,13 +23,15 @@ namespace Engine
 	OpenGLIndexBuffer::OpenGLIndexBuffer(void* data, uint32_t size) :
 		m_Size(size)
 	{
-		m_LocalData = Buffer::Copy(data, size);
+		//Freed once uploaded, the GPU keeps the only copy
+		Buffer buffer = Buffer::Copy(data, size);
 
-		Renderer::Submit([this]()
+		Renderer::Submit([this, buffer]() mutable
 			{
 				glCreateBuffers(1, &m_RendererID);
 				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
-				glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_Size, m_LocalData.Data, GL_STATIC_DRAW);
+				glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_Size, buffer.Data, GL_STATIC_DRAW);
+				buffer.Release();
 
 				RENDERCOMMAND_TRACE("RenderCommand: Construct indexBuffer({0})", m_RendererID);
 			}
@@ -70,12 +72,13 @@ namespace Engine
 
 	void OpenGLIndexBuffer::SetData(void* data, uint32_t size, uint32_t offset)
 	{
-		m_LocalData = Buffer::Copy(data, size);
+		Buffer buffer = Buffer::Copy(data, size);
 		m_Size = size;
-		Renderer::Submit([this, offset]()
+		Renderer::Submit([this, buffer, offset]() mutable
 			{
 				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
-				glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, m_Size, offset, m_LocalData.Data);
+				glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, offset, buffer.Size, buffer.Data);
+				buffer.Release();
 			}
 		);
 	}
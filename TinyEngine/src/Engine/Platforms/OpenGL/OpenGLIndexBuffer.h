@@ -22,7 +22,5 @@ namespace Engine
 	private:
 		uint32_t m_RendererID = 0;
 		uint32_t m_Size;
-
-		Buffer m_LocalData;
 	};
 }
\ No newline at end of file
@@ -21,6 +21,9 @@ namespace Engine
 		case ShaderDataType::Int3:     return GL_INT;
 		case ShaderDataType::Int4:     return GL_INT;
 		case ShaderDataType::Bool:     return GL_BOOL;
+		case ShaderDataType::Short2:   return GL_SHORT;
+		case ShaderDataType::Half2:    return GL_HALF_FLOAT;
+		case ShaderDataType::Int1010102: return GL_INT_2_10_10_10_REV;
 		}
 		ENGINE_ASSERT(false, "Unknown ShaderDataType!");
 		return 0;
@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "OpenGLRendererAPI.h"
+#include "Engine/Platforms/OpenGL/OpenGLExtensions.h"
 
 #include <glad/glad.h>
 
@@ -76,4 +77,55 @@ namespace Engine{
 		if (!depthTest)
 			glEnable(GL_DEPTH_TEST);
 	}
+
+	void OpenGLRendererAPI::DrawElementsIndirect(uint32_t indexSize, uint32_t commandBuffer, uint32_t commandOffset, uint32_t maxCommands, uint32_t countBuffer, uint32_t countOffset)
+	{
+		GLenum type = indexSize == sizeof(uint16_t) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+		const void* commands = (const void*)(uintptr_t)commandOffset;
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+		if (OpenGLExtensions::IndirectParameters)
+		{
+			glBindBuffer(GL_PARAMETER_BUFFER_ARB, countBuffer);
+			OpenGLExtensions::MultiDrawElementsIndirectCountARB(GL_TRIANGLES, type, commands, countOffset, maxCommands, 0);
+			glBindBuffer(GL_PARAMETER_BUFFER_ARB, 0);
+		}
+		else
+		{
+			//Commands past the visible ones must have been cleared, they draw nothing
+			glMultiDrawElementsIndirect(GL_TRIANGLES, type, commands, maxCommands, 0);
+		}
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+
+	void OpenGLRendererAPI::BindStorageBuffer(uint32_t binding, uint32_t buffer)
+	{
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, buffer);
+	}
+
+	void OpenGLRendererAPI::SetBufferData(uint32_t buffer, const void* data, uint32_t size, uint32_t offset)
+	{
+		glNamedBufferSubData(buffer, offset, size, data);
+	}
+
+	void OpenGLRendererAPI::ClearBuffer(uint32_t buffer, uint32_t offset, uint32_t size)
+	{
+		uint32_t zero = 0;
+		glClearNamedBufferSubData(buffer, GL_R32UI, offset, size, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+	}
+
+	void OpenGLRendererAPI::DispatchCompute(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ)
+	{
+		glDispatchCompute(groupsX, groupsY, groupsZ);
+	}
+
+	void OpenGLRendererAPI::Barrier(uint32_t barriers)
+	{
+		GLbitfield bits = 0;
+		if (barriers & (uint32_t)RendererBarrier::VertexAttributes)
+			bits |= GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT;
+		if (barriers & (uint32_t)RendererBarrier::IndirectCommands)
+			bits |= GL_COMMAND_BARRIER_BIT;
+		if (bits)
+			glMemoryBarrier(bits);
+	}
 }
\ No newline at end of file
@@ -12,5 +12,12 @@ namespace Engine
 		virtual void Clear() override;
 		virtual void SetViewport(uint32_t x, uint32_t y, uint32_t width, uint32_t height) override;
 		virtual void DrawElements(uint32_t count, PrimitiveType type, bool depthTest = true) override;
+		virtual void DrawElementsIndirect(uint32_t indexSize, uint32_t commandBuffer, uint32_t commandOffset, uint32_t maxCommands, uint32_t countBuffer, uint32_t countOffset) override;
+
+		virtual void BindStorageBuffer(uint32_t binding, uint32_t buffer) override;
+		virtual void SetBufferData(uint32_t buffer, const void* data, uint32_t size, uint32_t offset = 0) override;
+		virtual void ClearBuffer(uint32_t buffer, uint32_t offset, uint32_t size) override;
+		virtual void DispatchCompute(uint32_t groupsX, uint32_t groupsY = 1, uint32_t groupsZ = 1) override;
+		virtual void Barrier(uint32_t barriers) override;
 	};
 }
\ No newline at end of file
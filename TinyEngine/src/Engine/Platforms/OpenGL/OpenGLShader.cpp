@@ -1,11 +1,21 @@
 #include "pch.h"
 #include "OpenGLShader.h"
+#include "OpenGLExtensions.h"
 #include "Engine/Renderer/Renderer.h"
+#include "Engine/Renderer/Texture.h"
+#include "Engine/Renderer/RendererConfig.h"
 #include "Engine/Core/Math/Matrix.h"
+#include "Engine/Core/Hash.h"
 #include <glad/glad.h>
 
+#include <filesystem>
+
 namespace Engine 
 {
+	const char* OpenGLShader::ProgramCacheDirectory = "assets/cache/shaders/";
+	//Bump to invalidate every cached program binary
+	const char* OpenGLShader::ProgramCacheVersion = "1";
+
 	static GLenum ShaderTypeFromString(const std::string& type)
 	{
 		if (type == "vertex") 
@@ -19,8 +29,8 @@ namespace Engine
 		return 0;
 	}
 
-	OpenGLShader::OpenGLShader(const std::string& filepath)
-		:m_Path(filepath)
+	OpenGLShader::OpenGLShader(const std::string& filepath, bool async, uint32_t keywords)
+		:m_Path(filepath), m_AsyncCompile(async), m_VariantKeywords(keywords)
 	{
 		auto lashSlash = filepath.find_last_of("/\\");
 		lashSlash = lashSlash == std::string::npos ? 0 : lashSlash + 1;
@@ -42,21 +52,96 @@ namespace Engine
 				glDeleteProgram(rendererID);
 			}
 		);
+
+		delete[] m_VSUploadedUniforms.Data;
+		delete[] m_PSUploadedUniforms.Data;
+
+		//The layout belongs to the base shader
+		if (!m_Base)
+		{
+			for (ShaderResource* resource : m_Resources)
+				delete resource;
+		}
 	}
 
 	void OpenGLShader::Reload()
 	{
+		//Variants first, reload callbacks of the base shader may already draw with them
+		for (auto& kv : m_Variants)
+			kv.second->Reload();
+
 		std::string source = ReadFile(m_Path);
 		Load(source);
 	}
 
+	Shader* OpenGLShader::GetVariant(uint32_t keywords)
+	{
+		//Unknown keyword bits don't change the program
+		if (m_KeywordNames.size() < 32)
+			keywords &= (1u << m_KeywordNames.size()) - 1;
+		if (keywords == 0 || m_VariantKeywords)
+			return this;
+
+		auto it = m_Variants.find(keywords);
+		if (it != m_Variants.end())
+			return it->second.get();
+
+		//Compiled in the background, drawn with the placeholder program until ready
+		SHADER_TRACE("Shader '{0}' create variant {1:#x}", m_Name, keywords);
+		auto variant = CreateRef<OpenGLShader>(m_Path, true, keywords);
+		variant->m_Base = this;
+		m_Variants[keywords] = variant;
+		return variant.get();
+	}
+
+	uint32_t OpenGLShader::GetKeywordMask(const std::string& keyword) const
+	{
+		for (uint32_t i = 0; i < m_KeywordNames.size(); i++)
+		{
+			if (m_KeywordNames[i] == keyword)
+				return 1u << i;
+		}
+		return 0;
+	}
+
+	void OpenGLShader::ParseKeywords(const std::string& source)
+	{
+		m_KeywordNames.clear();
+
+		const char* pragmaToken = "#pragma variant";
+		size_t pos = source.find(pragmaToken);
+		while (pos != std::string::npos)
+		{
+			size_t begin = pos + strlen(pragmaToken);
+			size_t eol = source.find_first_of("\r\n", begin);
+			std::istringstream keywords(source.substr(begin, eol == std::string::npos ? std::string::npos : eol - begin));
+			std::string keyword;
+			while (keywords >> keyword)
+				m_KeywordNames.push_back(keyword);
+
+			pos = source.find(pragmaToken, begin);
+		}
+
+		ENGINE_ASSERT(m_KeywordNames.size() <= 32, "Shader declares too many variant keywords!");
+	}
+
 	void OpenGLShader::Bind() const
 	{
 		Renderer::Submit([this]()
 			{
 				RENDERCOMMAND_TRACE("RenderCommand: Bind shader({0}). Name: '{1}'", m_RendererID, m_Name);
 
-				glUseProgram(m_RendererID);
+				if (m_RendererID)
+				{
+					glUseProgram(m_RendererID);
+					return;
+				}
+
+				//Draws nothing until the material sets the placeholder transforms
+				GLuint program = GetPlaceholderProgram();
+				glm::mat4 zero(0.0f);
+				glUseProgram(program);
+				glProgramUniformMatrix4fv(program, 1, 1, GL_FALSE, glm::value_ptr(zero));
 			}
 		);
 	}
@@ -154,11 +239,16 @@ namespace Engine
 	/// </summary>
 	void OpenGLShader::SetVSMaterialUniformBuffer(Buffer buffer)
 	{
-		Renderer::Submit([this, buffer]()
+		//The material may be rewritten before the command executes, upload the values it holds now
+		Buffer snapshot = Renderer::CopyFrameData(buffer);
+		Renderer::Submit([this, snapshot]()
 			{
 				SHADER_TRACE("Shader '{0}' upload vertex shader uniform buffer", m_Name);
+				if (!m_RendererID)
+					return;
 				glUseProgram(m_RendererID);
-				ResolveAndSetUniforms(m_VSMaterialUniformBuffer, buffer);
+				UpdateUniformLocations();
+				ResolveAndSetUniforms(GetLayout()->m_VSMaterialUniformBuffer, m_VSUniformLocations, snapshot, m_VSUploadedUniforms);
 			}
 		);
 	}
@@ -168,11 +258,89 @@ namespace Engine
 	/// </summary>
 	void OpenGLShader::SetPSMaterialUniformBuffer(Buffer buffer)
 	{
-		Renderer::Submit([this, buffer]()
+		Buffer snapshot = Renderer::CopyFrameData(buffer);
+		Renderer::Submit([this, snapshot]()
 			{
 				SHADER_TRACE("Shader '{0}' upload fragment shader uniform buffer", m_Name);
+				if (!m_RendererID)
+					return;
 				glUseProgram(m_RendererID);
-				ResolveAndSetUniforms(m_PSMaterialUniformBuffer, buffer);
+				UpdateUniformLocations();
+				ResolveAndSetUniforms(GetLayout()->m_PSMaterialUniformBuffer, m_PSUniformLocations, snapshot, m_PSUploadedUniforms);
+			}
+		);
+	}
+
+	void OpenGLShader::BindTextures(const std::vector<Ref<Texture>>& textures)
+	{
+		static const uint32_t MaxTextureSlots = 32;
+		ENGINE_ASSERT(textures.size() <= MaxTextureSlots, "Too many texture slots!");
+
+		//Textures are kept alive by the material until the command is executed
+		struct TextureSlots
+		{
+			uint32_t Count = 0;
+			const Texture* Textures[MaxTextureSlots];
+		} slots;
+		slots.Count = (uint32_t)textures.size();
+		for (uint32_t i = 0; i < slots.Count; i++)
+			slots.Textures[i] = textures[i].get();
+
+		Renderer::Submit([this, slots]()
+			{
+				RENDERCOMMAND_TRACE("RenderCommand: Bind {0} texture slots of shader '{1}'", slots.Count, m_Name);
+				if (m_RendererID)
+					UpdateUniformLocations();
+
+				//Textures the handles do not cover stay on texture units: sampler arrays, samplers this program
+				//does not use and textures without a resident handle
+				const Texture* unitTextures[MaxTextureSlots];
+				for (uint32_t i = 0; i < slots.Count; i++)
+				{
+					const Texture* texture = slots.Textures[i];
+					unitTextures[i] = texture;
+					if (!OpenGLExtensions::BindlessTexture || !texture || i >= m_SamplerLocations.size() || m_SamplerLocations[i] == -1)
+						continue;
+
+					//Sampler uniforms hold resident handles, only changed handles are uploaded
+					uint64_t handle = texture->GetBindlessHandle();
+					if (!handle)
+					{
+						if (m_SamplerHandles[i])
+						{
+							glProgramUniform1i(m_RendererID, m_SamplerLocations[i], i);
+							m_SamplerHandles[i] = 0;
+						}
+						continue;
+					}
+					if (handle != m_SamplerHandles[i])
+					{
+						OpenGLExtensions::ProgramUniformHandleui64ARB(m_RendererID, m_SamplerLocations[i], handle);
+						m_SamplerHandles[i] = handle;
+					}
+					unitTextures[i] = nullptr;
+				}
+
+				//Bind contiguous runs of textures with one call each
+				GLuint ids[MaxTextureSlots];
+				uint32_t first = 0;
+				while (first < slots.Count)
+				{
+					if (!unitTextures[first])
+					{
+						first++;
+						continue;
+					}
+
+					uint32_t count = 0;
+					while (first + count < slots.Count && unitTextures[first + count])
+					{
+						ids[count] = unitTextures[first + count]->GetRendererID();
+						count++;
+					}
+					glBindTextures(first, count, ids);
+					first += count;
+				}
 			}
 		);
 	}
@@ -277,17 +445,6 @@ namespace Engine
 		glUniformMatrix4fv(location, count, GL_FALSE, glm::value_ptr(matrix));
 	}
 
-	void OpenGLShader::UploadUniformStruct(OpenGLShaderUniform* uniform, uint8_t* buffer, uint32_t offset)
-	{
-		const auto& fields = uniform->GetShaderUniformStruct().GetFields();
-		for (size_t k = 0; k < fields.size(); k++)
-		{
-			OpenGLShaderUniform* field = (OpenGLShaderUniform*)fields[k];
-			ResolveAndSetUniformField(*field, buffer, offset);
-			offset += field->m_Size;
-		}
-	}
-
 	void OpenGLShader::Set(const std::string& name, int value)
 	{
 		Renderer::Submit([=]() {
@@ -344,15 +501,30 @@ namespace Engine
 			});
 	}
 
-	void OpenGLShader::AddShaderReloadedCallback(const ShaderReloadedCallback& callback)
+	void OpenGLShader::UploadUniform(const std::string& name, uint32_t value)
+	{
+		glUniform1ui(GetUniformLocation(name), value);
+	}
+
+	uint32_t OpenGLShader::AddShaderReloadedCallback(const ShaderReloadedCallback& callback)
+	{
+		uint32_t id = m_NextCallbackID++;
+		m_ShaderReloadedCallbacks.emplace_back(id, callback);
+		return id;
+	}
+
+	void OpenGLShader::RemoveShaderReloadedCallback(uint32_t id)
 	{
-		m_ShaderReloadedCallbacks.push_back(callback);
+		auto it = std::find_if(m_ShaderReloadedCallbacks.begin(), m_ShaderReloadedCallbacks.end(),
+			[id](const auto& entry) { return entry.first == id; });
+		if (it != m_ShaderReloadedCallbacks.end())
+			m_ShaderReloadedCallbacks.erase(it);
 	}
 
 	std::string OpenGLShader::ReadFile(const std::string& filepath)
 	{
 		std::string result;
-		std::ifstream in(filepath, std::ios::in, std::ios::binary);
+		std::ifstream in(filepath, std::ios::in | std::ios::binary);
 		if (in)
 		{
 			in.seekg(0, std::ios::end);
@@ -371,29 +543,29 @@ namespace Engine
 
 	void OpenGLShader::Load(const std::string& source)
 	{
+		ParseKeywords(source);
 		m_ShaderSource = PreProcess(source);
-		if(!m_IsCompute)
-			Parse();
+		//Compute shaders are dispatched right after loading and have no placeholder. Reloads keep drawing with the old program, wait for them too.
+		bool async = m_AsyncCompile && !m_IsCompute && !m_Loaded;
+		m_Compiling = async;
 
 		Renderer::Submit([=]()
 			{
-				if (m_RendererID)
-					glDeleteProgram(m_RendererID);
-
-				Compile();
-				if(!m_IsCompute)
-					ResolveUniforms();
-
-				//Reload callback
-				if (m_Loaded)
-				{
-					for (auto& callback : m_ShaderReloadedCallbacks)
-						callback();
-				}
+				RENDERCOMMAND_TRACE("RenderCommand: Construct shader. Name: '{0}'", m_Name);
 
-				m_Loaded = true;
+				BeginCompile();
+				if (!async)
+					FinishCompile();
+			}
+		);
+	}
 
-				RENDERCOMMAND_TRACE("RenderCommand: Construct shader. Name: '{0}', ID: ({1})", m_Name, m_RendererID);
+	void OpenGLShader::PollCompile()
+	{
+		Renderer::Submit([this]()
+			{
+				if (m_PendingProgram && IsCompileComplete())
+					FinishCompile();
 			}
 		);
 	}
@@ -430,625 +602,671 @@ namespace Engine
 		return shaderSources;
 	}
 
-	//--------------------------------------------------------------------------------
-	//Parsing helper function
-	//--------------------------------------------------------------------------------
-	const char* FindToken(const char* str, const std::string& token)
+	static OpenGLShaderUniform::Type UniformTypeFromGLType(GLenum type)
 	{
-		const char* t = str;
-		while (t = strstr(t, token.c_str()))
+		switch (type)
 		{
-			bool left = str == t || isspace(t[-1]);
-			bool right = !t[token.size()] || isspace(t[token.size()]);
-			if (left && right)
-				return t;
-
-			t += token.size();
+			case GL_INT:			return OpenGLShaderUniform::Type::Int;
+			case GL_BOOL:			return OpenGLShaderUniform::Type::Bool;
+			case GL_FLOAT:			return OpenGLShaderUniform::Type::Float;
+			case GL_FLOAT_VEC2:		return OpenGLShaderUniform::Type::Vec2;
+			case GL_FLOAT_VEC3:		return OpenGLShaderUniform::Type::Vec3;
+			case GL_FLOAT_VEC4:		return OpenGLShaderUniform::Type::Vec4;
+			case GL_FLOAT_MAT3:		return OpenGLShaderUniform::Type::Mat3;
+			case GL_FLOAT_MAT4:		return OpenGLShaderUniform::Type::Mat4;
 		}
-		return nullptr;
-	}
-
-	const char* FindToken(const std::string& string, const std::string& token)
-	{
-		return FindToken(string.c_str(), token);
+		return OpenGLShaderUniform::Type::None;
 	}
 
-	/// <summary>
-	/// ڷŶַָ
-	/// </summary>
-	/// <param name="string">Դַ</param>
-	/// <param name="delimiters">ָ</param>
-	/// <returns>ַָ</returns>
-	std::vector<std::string> SplitString(const std::string& string, const std::string& delimiters)
+	static OpenGLShaderResource::Type ResourceTypeFromGLType(GLenum type)
 	{
-		size_t start = 0;
-		size_t end = string.find_first_of(delimiters);
-
-		std::vector<std::string> result;
-
-		while (end <= std::string::npos)
+		switch (type)
 		{
-			std::string token = string.substr(start, end - start);
-			if (!token.empty())
-				result.push_back(token);
-
-			if (end == std::string::npos)
-				break;
-
-			start = end + 1;
-			end = string.find_first_of(delimiters, start);
+			case GL_SAMPLER_2D:
+			case GL_SAMPLER_2D_SHADOW:		return OpenGLShaderResource::Type::Texture2D;
+			case GL_SAMPLER_CUBE:
+			case GL_SAMPLER_CUBE_SHADOW:	return OpenGLShaderResource::Type::TextureCube;
 		}
-
-		return result;
-	}
-
-	std::vector<std::string> SplitString(const std::string& string, const char delimiter)
-	{
-		return SplitString(string, std::string(1, delimiter));
-	}
-
-	/// <summary>
-	/// ַиΪ
-	/// </summary>
-	std::vector<std::string> Tokenize(const std::string& string)
-	{
-		return SplitString(string, " \t\n\r");
-	}
-
-	std::vector<std::string> GetLines(const std::string& string)
-	{
-		return SplitString(string, "\n");
+		return OpenGLShaderResource::Type::None;
 	}
 
-	/// <summary>
-	/// '}'ַ
-	/// </summary>
-	/// <param name="str">Դַ</param>
-	/// <param name="outPosition">кָλ</param>
-	/// <returns>'}'ǰַ</returns>
-	std::string GetBlock(const char* str, const char** outPosition)
-	{
-		const char* end = strstr(str, "}");
-		if (!end)
-			return str;
-
-		if (outPosition)
-			*outPosition = end;
-		uint32_t length = end - str + 1;
-		return std::string(str, length);
-	}
-
-	/// <summary>
-	/// ';'ַ
-	/// </summary>
-	/// <param name="str">Դַ</param>
-	/// <param name="outPosition">кָλ</param>
-	/// <returns>'}'ǰַ</returns>
-	std::string GetStatement(const char* str, const char** outPosition)
+	int32_t OpenGLShader::GetUniformLocation(const std::string& name) const
 	{
-		const char* end = strstr(str, ";");
-		if (!end)
-			return str;
+		for (const ReflectedUniform& uniform : m_ReflectedUniforms)
+		{
+			if (uniform.Name == name)
+				return uniform.Location;
+		}
 
-		if (outPosition)
-			*outPosition = end;
-		uint32_t length = end - str + 1;
-		return std::string(str, length);
+		SHADER_WARN("Shader '{0}': Uniform '{1}' connot be found or unused", m_Name, name);
+		return -1;
 	}
 
-	/// <summary>
-	/// ַǷضǰ׺ʼ
-	/// </summary>
-	bool StartsWith(const std::string& string, const std::string& start)
+	void OpenGLShader::Reflect()
 	{
-		return string.find(start) == 0;
-	}
-	//--------------------------------------------------------------------------------
-	//--------------------------------------------------------------------------------
-
-	void OpenGLShader::Parse()
-	{
-		const char* token;
-		const char* vstr;
-		const char* fstr;
-
-		m_Resources.clear();
-		m_Structs.clear();
-		m_VSMaterialUniformBuffer.reset();
-		m_PSMaterialUniformBuffer.reset();
-
-		auto& vertexSource = m_ShaderSource[GL_VERTEX_SHADER];
-		auto& fragmentSource = m_ShaderSource[GL_FRAGMENT_SHADER];
-
-		//Vertex Shader
-		vstr = vertexSource.c_str();
-		while (token = FindToken(vstr, "struct"))
-			ParseUniformStruct(GetBlock(token, &vstr), ShaderDomain::Vertex);
-
-		vstr = vertexSource.c_str();
-		while (token = FindToken(vstr, "uniform"))
-			ParseUniform(GetStatement(token, &vstr), ShaderDomain::Vertex);
-		
-		// Fragment Shader
-		fstr = fragmentSource.c_str();
-		while (token = FindToken(fstr, "struct"))
-			ParseUniformStruct(GetBlock(token, &fstr), ShaderDomain::Pixel);
+		m_ReflectedUniforms.clear();
+
+		GLint count = 0;
+		GLint maxNameLength = 0;
+		glGetProgramInterfaceiv(m_RendererID, GL_UNIFORM, GL_ACTIVE_RESOURCES, &count);
+		glGetProgramInterfaceiv(m_RendererID, GL_UNIFORM, GL_MAX_NAME_LENGTH, &maxNameLength);
+		std::vector<GLchar> name((size_t)maxNameLength + 1);
+
+		const GLenum properties[] = { GL_TYPE, GL_ARRAY_SIZE, GL_LOCATION, GL_BLOCK_INDEX, GL_REFERENCED_BY_VERTEX_SHADER };
+		constexpr GLsizei propertyCount = sizeof(properties) / sizeof(properties[0]);
+		GLint values[propertyCount];
+		for (GLint i = 0; i < count; i++)
+		{
+			glGetProgramResourceiv(m_RendererID, GL_UNIFORM, i, propertyCount, properties, propertyCount, nullptr, values);
+			//Built-ins and members of uniform blocks are not set with locations
+			if (values[2] == -1 || values[3] != -1)
+				continue;
+
+			GLsizei length = 0;
+			glGetProgramResourceName(m_RendererID, GL_UNIFORM, i, (GLsizei)name.size(), &length, name.data());
+
+			ReflectedUniform uniform;
+			uniform.Name.assign(name.data(), length);
+			//Arrays are reported by their first element
+			if (length > 3 && uniform.Name.compare(length - 3, 3, "[0]") == 0)
+				uniform.Name.resize(length - 3);
+			uniform.Type = (GLenum)values[0];
+			uniform.Count = (uint32_t)values[1];
+			uniform.Location = values[2];
+			uniform.Domain = values[4] ? ShaderDomain::Vertex : ShaderDomain::Pixel;
+			m_ReflectedUniforms.push_back(uniform);
+		}
 
-		fstr = fragmentSource.c_str();
-		while (token = FindToken(fstr, "uniform"))
-			ParseUniform(GetStatement(token, &fstr), ShaderDomain::Pixel);
+		SHADER_TRACE("Shader '{0}' has {1} active uniforms", m_Name, m_ReflectedUniforms.size());
 	}
 
-	static bool IsTypeStringResource(const std::string& type)
+	bool OpenGLShader::MergeLayout(const std::vector<ReflectedUniform>& uniforms)
 	{
-		if (type == "sampler2D")		return true;
-		if (type == "samplerCube")		return true;
-		return false;
-	}
-
-	/// <summary>
-	/// Shaderеuniform
-	/// </summary>
-	/// <param name="statement">uniform</param>
-	/// <param name="domain">Shader</param>
-	void OpenGLShader::ParseUniform(const std::string& statement, ShaderDomain domain)
-	{
-		std::vector<std::string> tokens = Tokenize(statement);
-		uint32_t index = 0;
-
-		index++;
-		std::string typeString = tokens[index++];
-		std::string name = tokens[index++];
-		//ȥnameе';'
-		if (const char* s = strstr(name.c_str(), ";"))
-			name = std::string(name.c_str(), s - name.c_str());
-		//鳤
-		std::string n(name);
-		int32_t count = 1;
-		const char* nameStr = n.c_str();
-		if (const char* s = strstr(nameStr, "["))
-		{
-			name = std::string(nameStr, s - nameStr);
-
-			const char* end = strstr(nameStr, "]");
-			std::string c(s + 1, end - s);
-			count = atoi(c.c_str());
-		}
-		//ڱͽн
-		if (IsTypeStringResource(typeString))
+		bool changed = false;
+		for (const ReflectedUniform& reflected : uniforms)
 		{
 			//sampler
-			ShaderResource* shaderResource = new OpenGLShaderResource(OpenGLShaderResource::StringToType(typeString), name, count);
-			m_Resources.push_back(shaderResource);
-		}
-		else
-		{
-			//other types
-			OpenGLShaderUniform::Type t = OpenGLShaderUniform::StringToType(typeString);
-			OpenGLShaderUniform* uniform = nullptr;
-
-			if (t == OpenGLShaderUniform::Type::None)
+			OpenGLShaderResource::Type resourceType = ResourceTypeFromGLType(reflected.Type);
+			if (resourceType != OpenGLShaderResource::Type::None)
 			{
-				//struct
-				ShaderStruct* s = FindStruct(typeString);
-				ENGINE_ASSERT(s, "Fail to find shader struct!");
-				uniform = new OpenGLShaderUniform(domain, s, name, count);
+				uint32_t sampler = 0;
+				bool found = false;
+				for (ShaderResource* resource : m_Resources)
+				{
+					found |= resource->GetName() == reflected.Name;
+					sampler = std::max(sampler, resource->GetRegister() + resource->GetCount());
+				}
+				if (found)
+					continue;
+
+				//Registers of the resources already in the layout stay the same
+				OpenGLShaderResource* resource = new OpenGLShaderResource(resourceType, reflected.Name, reflected.Count);
+				resource->m_Register = sampler;
+				m_Resources.push_back(resource);
+				changed = true;
+				continue;
 			}
-			else
+
+			//other types
+			OpenGLShaderUniform::Type type = UniformTypeFromGLType(reflected.Type);
+			if (type == OpenGLShaderUniform::Type::None)
 			{
-				//basic type
-				uniform = new OpenGLShaderUniform(domain, t, name, count);
+				SHADER_WARN("Shader '{0}': Uniform '{1}' has an unsupported type", m_Name, reflected.Name);
+				continue;
 			}
 
-			if (StartsWith(name, "r_"))
+			//A uniform some variant uses in another stage stays in the buffer it was first added to
+			if ((m_VSMaterialUniformBuffer && m_VSMaterialUniformBuffer->FindUniform(reflected.Name)) ||
+				(m_PSMaterialUniformBuffer && m_PSMaterialUniformBuffer->FindUniform(reflected.Name)))
+				continue;
+
+			OpenGLShaderUniform* uniform = new OpenGLShaderUniform(reflected.Domain, type, reflected.Name, reflected.Count);
+			if (reflected.Domain == ShaderDomain::Vertex)
 			{
-				if (domain == ShaderDomain::Vertex)
-					((OpenGLShaderUniformBuffer*)m_VSRendererUniformBuffers.front())->PushUniform(uniform);
-				else if (domain == ShaderDomain::Pixel)
-					((OpenGLShaderUniformBuffer*)m_PSRendererUniformBuffers.front())->PushUniform(uniform);
+				if (!m_VSMaterialUniformBuffer)
+					m_VSMaterialUniformBuffer = CreateRef<OpenGLShaderUniformBuffer>("VertexMaterialUniformBuffer", ShaderDomain::Vertex);
+				m_VSMaterialUniformBuffer->PushUniform(uniform);
 			}
 			else
 			{
-				if (domain == ShaderDomain::Vertex)
-				{
-					if (!m_VSMaterialUniformBuffer)
-						m_VSMaterialUniformBuffer = CreateRef<OpenGLShaderUniformBuffer>("VertexMaterialUniformBuffer", domain);
-					m_VSMaterialUniformBuffer->PushUniform(uniform);
-				}
-				else if (domain == ShaderDomain::Pixel)
-				{
-					if (!m_PSMaterialUniformBuffer)
-						m_PSMaterialUniformBuffer = CreateRef<OpenGLShaderUniformBuffer>("FragmentMaterialUniformBuffer", domain);
-					m_PSMaterialUniformBuffer->PushUniform(uniform);
-				}
+				if (!m_PSMaterialUniformBuffer)
+					m_PSMaterialUniformBuffer = CreateRef<OpenGLShaderUniformBuffer>("FragmentMaterialUniformBuffer", ShaderDomain::Pixel);
+				m_PSMaterialUniformBuffer->PushUniform(uniform);
 			}
+			changed = true;
 		}
+		return changed;
 	}
 
-	/// <summary>
-	/// ShaderеStruct
-	/// </summary>
-	/// <param name="block">Struct</param>
-	/// <param name="domain">Shader</param>
-	void OpenGLShader::ParseUniformStruct(const std::string& block, ShaderDomain domain)
-	{
-		std::vector<std::string> tokens = Tokenize(block);
-		uint32_t index = 0;
-
-		index++;
-		std::string name = tokens[index++];
-		ShaderStruct* uniformStruct = new ShaderStruct(name);
-		index++;
-		//ṹڲ
-		while (index < tokens.size())
-		{
-			if (tokens[index] == "}")
-				break;
-
-			std::string type = tokens[index++];
-			std::string name = tokens[index++];
-			//ȥnameе';'
-			if (const char* s = strstr(name.c_str(), ";"))
-				name = std::string(name.c_str(), s - name.c_str());
-			//鳤
-			std::string n(name);
-			uint32_t count = 1;
-			const char* namestr = n.c_str();
-			if (const char* s = strstr(namestr, "["))
-			{
-				name = std::string(namestr, s - namestr);
+	void OpenGLShader::RebuildLayout()
+	{
+		//Materials read the previous layout while moving their values, release it afterwards
+		Ref<OpenGLShaderUniformBuffer> vsUniformBuffer = m_VSMaterialUniformBuffer;
+		Ref<OpenGLShaderUniformBuffer> psUniformBuffer = m_PSMaterialUniformBuffer;
+		ShaderResourceList resources = std::move(m_Resources);
+		m_VSMaterialUniformBuffer.reset();
+		m_PSMaterialUniformBuffer.reset();
+		m_Resources.clear();
 
-				const char* end = strstr(namestr, "]");
-				std::string c(s + 1, end - s);
-				count = atoi(c.c_str());
-			}
-			ShaderUniform* field = new OpenGLShaderUniform(domain, OpenGLShaderUniform::StringToType(type), name, count);
-			uniformStruct->AddField(field);
-		}
-		m_Structs.push_back(uniformStruct);
-	}
+		MergeLayout(m_ReflectedUniforms);
+		for (auto& kv : m_Variants)
+			MergeLayout(kv.second->m_ReflectedUniforms);
+		OnLayoutChanged();
 
-	ShaderStruct* OpenGLShader::FindStruct(const std::string& name)
-	{
-		for (ShaderStruct* s : m_Structs)
-		{
-			if (s->GetName() == name)
-				return s;
-		}
-		return nullptr;
+		for (ShaderResource* resource : resources)
+			delete resource;
 	}
 
-	int32_t OpenGLShader::GetUniformLocation(const std::string& name) const
+	void OpenGLShader::OnLayoutChanged()
 	{
-		int32_t result = glGetUniformLocation(m_RendererID, name.c_str());
-		if (result == -1)
-			SHADER_WARN("Shader '{0}': Uniform '{1}' connot be found or unused", m_Name, name);
-		return result;
+		m_LayoutVersion++;
+		for (auto& entry : m_ShaderReloadedCallbacks)
+			entry.second();
 	}
 
 	void OpenGLShader::ResolveUniforms()
 	{
-		glUseProgram(m_RendererID);
+		OpenGLShader* layout = GetLayout();
 
-		//Vertex Shader
-		for (uint32_t i = 0; i < m_VSRendererUniformBuffers.size(); i++)
+		std::unordered_map<std::string, int32_t> locations;
+		for (const ReflectedUniform& uniform : m_ReflectedUniforms)
+			locations[uniform.Name] = uniform.Location;
+		auto findLocation = [&locations](const std::string& name)
 		{
-			const ShaderUniformList& uniforms = ((OpenGLShaderUniformBuffer*)m_VSRendererUniformBuffers[i])->GetUniforms();
-			for (uint32_t j = 0; j < uniforms.size(); j++)
-			{
-				OpenGLShaderUniform* uniform = (OpenGLShaderUniform*)uniforms[j];
-				if (uniform->GetType() == OpenGLShaderUniform::Type::Struct)
-				{
-					const ShaderStruct& s = uniform->GetShaderUniformStruct();
-					const auto& fields = s.GetFields();
-					for (size_t k = 0; k < fields.size(); k++)
-					{
-						OpenGLShaderUniform* field = (OpenGLShaderUniform*)fields[k];
-						field->m_Location = GetUniformLocation(uniform->m_Name + "." + field->m_Name);
-					}
-				}
-				else
-				{
-					uniform->m_Location = GetUniformLocation(uniform->m_Name);
-				}
-			}
-		}
+			auto it = locations.find(name);
+			return it != locations.end() ? it->second : -1;
+		};
 
-		//Fragment Shader
-		for (uint32_t i = 0; i < m_PSRendererUniformBuffers.size(); i++)
+		auto resolveUniformBuffer = [&](const Ref<OpenGLShaderUniformBuffer>& uniformBuffer, std::vector<int32_t>& uniformLocations)
 		{
-			const ShaderUniformList& uniforms = ((OpenGLShaderUniformBuffer*)m_PSRendererUniformBuffers[i])->GetUniforms();
-			for (uint32_t j = 0; j < uniforms.size(); j++)
-			{
-				OpenGLShaderUniform* uniform = (OpenGLShaderUniform*)uniforms[j];
-				if (uniform->GetType() == OpenGLShaderUniform::Type::Struct)
-				{
-					const ShaderStruct& s = uniform->GetShaderUniformStruct();
-					const auto& fields = s.GetFields();
-					for (size_t k = 0; k < fields.size(); k++)
-					{
-						OpenGLShaderUniform* field = (OpenGLShaderUniform*)fields[k];
-						field->m_Location = GetUniformLocation(uniform->m_Name + "." + field->m_Name);
-					}
-				}
-				else
-				{
-					uniform->m_Location = GetUniformLocation(uniform->m_Name);
-				}
-			}
-		}
+			uniformLocations.clear();
+			if (!uniformBuffer)
+				return;
 
-		//Vertex Shader MaterialUniformBuffer
-		{
-			const auto& uniformBuffer = m_VSMaterialUniformBuffer;
-			if (uniformBuffer)
+			for (ShaderUniform* uniform : uniformBuffer->GetUniforms())
 			{
-				const ShaderUniformList& uniforms = uniformBuffer->GetUniforms();
-				for (uint32_t j = 0; j < uniforms.size(); j++)
-				{
-					OpenGLShaderUniform* uniform = (OpenGLShaderUniform*)uniforms[j];
-					if (uniform->GetType() == OpenGLShaderUniform::Type::Struct)
-					{
-						const ShaderStruct& s = uniform->GetShaderUniformStruct();
-						const auto& fields = s.GetFields();
-						for (size_t k = 0; k < fields.size(); k++)
-						{
-							OpenGLShaderUniform* field = (OpenGLShaderUniform*)fields[k];
-							field->m_Location = GetUniformLocation(uniform->m_Name + "." + field->m_Name);
-						}
-					}
-					else
-					{
-						uniform->m_Location = GetUniformLocation(uniform->m_Name);
-					}
-				}
+				int32_t location = findLocation(uniform->GetName());
+				uniformLocations.push_back(location);
+				if (layout == this)
+					((OpenGLShaderUniform*)uniform)->m_Location = location;
 			}
-		}
+		};
+		resolveUniformBuffer(layout->m_VSMaterialUniformBuffer, m_VSUniformLocations);
+		resolveUniformBuffer(layout->m_PSMaterialUniformBuffer, m_PSUniformLocations);
 
-		//Fragment Shader MaterialUniformBuffer
+		//עShader sampler. Registers come from the layout so every variant reads material textures from the same units.
+		m_SamplerLocations.clear();
+		for (ShaderResource* resource : layout->m_Resources)
 		{
-			const auto& uniformBuffer = m_PSMaterialUniformBuffer;
-			if (uniformBuffer)
-			{
-				const ShaderUniformList& uniforms = uniformBuffer->GetUniforms();
-				for (uint32_t j = 0; j < uniforms.size(); j++)
-				{
-					OpenGLShaderUniform* uniform = (OpenGLShaderUniform*)uniforms[j];
-					if (uniform->GetType() == OpenGLShaderUniform::Type::Struct)
-					{
-						const ShaderStruct& s = uniform->GetShaderUniformStruct();
-						const auto& fields = s.GetFields();
-						for (size_t k = 0; k < fields.size(); k++)
-						{
-							OpenGLShaderUniform* field = (OpenGLShaderUniform*)fields[k];
-							field->m_Location = GetUniformLocation(uniform->m_Name + "." + field->m_Name);
-						}
-					}
-					else
-					{
-						uniform->m_Location = GetUniformLocation(uniform->m_Name);
-					}
-				}
-			}
-		}
+			uint32_t sampler = resource->GetRegister();
+			uint32_t count = resource->GetCount();
+			if (m_SamplerLocations.size() < sampler + count)
+				m_SamplerLocations.resize(sampler + count, -1);
 
-		//עShader sampler 
-		uint32_t sampler = 0;
-		for (uint32_t i = 0; i < m_Resources.size(); i++)
-		{
-			OpenGLShaderResource* resource = (OpenGLShaderResource*)m_Resources[i];
+			int32_t location = findLocation(resource->GetName());
+			if (location == -1)
+				continue;
 
-			if (resource->GetCount() == 1)
+			if (count == 1)
 			{
-				resource->m_Register = sampler;
-				UploadUniformInt(resource->m_Name, sampler);
-				sampler++;
+				glProgramUniform1i(m_RendererID, location, sampler);
+				m_SamplerLocations[sampler] = location;
 			}
-			else if (resource->GetCount() > 1)
+			else
 			{
-				resource->m_Register = sampler;
-				uint32_t count = resource->GetCount();
-				int* samplers = new int[count];
+				//Arrays stay on texture units
+				std::vector<int> samplers(count);
 				for (uint32_t s = 0; s < count; s++)
-					samplers[s] = sampler++;
-				UploadUniformIntArray(resource->GetName(), samplers, count);
-				delete[] samplers;
+					samplers[s] = sampler + s;
+				glProgramUniform1iv(m_RendererID, location, count, samplers.data());
 			}
 		}
+		m_SamplerHandles.assign(m_SamplerLocations.size(), 0);
+
+		//Offsets or locations changed, the next upload sends every value
+		delete[] m_VSUploadedUniforms.Data;
+		delete[] m_PSUploadedUniforms.Data;
+		m_VSUploadedUniforms = Buffer();
+		m_PSUploadedUniforms = Buffer();
+
+		m_ResolvedLayoutVersion = layout->m_LayoutVersion;
 	}
 
-	void OpenGLShader::ResolveAndSetUniforms(const Ref<OpenGLShaderUniformBuffer>& uniformBuffer, Buffer buffer)
+	void OpenGLShader::UpdateUniformLocations()
 	{
+		//Another program of the shader added uniforms to the layout
+		if (m_ResolvedLayoutVersion != GetLayout()->m_LayoutVersion)
+			ResolveUniforms();
+	}
+
+	void OpenGLShader::ResolveAndSetUniforms(const Ref<OpenGLShaderUniformBuffer>& uniformBuffer, const std::vector<int32_t>& locations, Buffer buffer, Buffer& uploaded)
+	{
+		if (!uniformBuffer)
+			return;
+
+		bool compare = uploaded.Data && uploaded.Size == buffer.Size;
 		const ShaderUniformList& uniforms = uniformBuffer->GetUniforms();
-		for (uint32_t i = 0; i < uniforms.size(); i++)
+		for (uint32_t i = 0; i < uniforms.size() && i < locations.size(); i++)
 		{
 			OpenGLShaderUniform* uniform = (OpenGLShaderUniform*)uniforms[i];
-			SHADER_TRACE("Shader '{0}' resolve uniform '{1}'({2})", m_Name, uniform->GetName(), uniform->GetLocation());
+
+			//Inactive in this program, or added to the layout after the buffer was copied
+			int32_t location = locations[i];
+			uint32_t offset = uniform->GetOffset();
+			uint32_t size = uniform->GetSize();
+			if (location == -1 || offset + size > buffer.Size)
+				continue;
+
+			//Skip values the program already holds
+			if (compare && memcmp(uploaded.Data + offset, buffer.Data + offset, size) == 0)
+				continue;
+
+			SHADER_TRACE("Shader '{0}' resolve uniform '{1}'({2})", m_Name, uniform->GetName(), location);
 
 			if (uniform->IsArray())
-				ResolveAndSetUniformArray(uniform, buffer);
+				ResolveAndSetUniformArray(uniform, location, buffer);
 			else
-				ResolveAndSetUniform(uniform, buffer);
+				ResolveAndSetUniform(uniform, location, buffer);
 		}
+
+		if (!compare)
+			uploaded.Allocate(buffer.Size);
+		memcpy(uploaded.Data, buffer.Data, buffer.Size);
 	}
 
-	void OpenGLShader::ResolveAndSetUniform(OpenGLShaderUniform* uniform, Buffer buffer)
+	void OpenGLShader::ResolveAndSetUniform(OpenGLShaderUniform* uniform, int32_t location, Buffer buffer)
 	{
-		if (uniform->GetLocation() == -1 && uniform->m_Struct == nullptr)
-			return;
-
 		uint32_t offset = uniform->GetOffset();
 		switch (uniform->GetType())
 		{
 		case OpenGLShaderUniform::Type::Bool:
-			UploadUniformFloat(uniform->GetLocation(), *(bool*)&buffer.Data[offset]);
+			UploadUniformInt(location, *(bool*)&buffer.Data[offset]);
 			break;
 		case OpenGLShaderUniform::Type::Float:
-			UploadUniformFloat(uniform->GetLocation(), *(float*)&buffer.Data[offset]);
+			UploadUniformFloat(location, *(float*)&buffer.Data[offset]);
 			break;
 		case OpenGLShaderUniform::Type::Int:
-			UploadUniformInt(uniform->GetLocation(), *(int*)&buffer.Data[offset]);
+			UploadUniformInt(location, *(int*)&buffer.Data[offset]);
 			break;
 		case OpenGLShaderUniform::Type::Vec2:
-			UploadUniformFloat2(uniform->GetLocation(), *(glm::vec2*)&buffer.Data[offset]);
+			UploadUniformFloat2(location, *(glm::vec2*)&buffer.Data[offset]);
 			break;
 		case OpenGLShaderUniform::Type::Vec3:
-			UploadUniformFloat3(uniform->GetLocation(), *(glm::vec3*)&buffer.Data[offset]);
+			UploadUniformFloat3(location, *(glm::vec3*)&buffer.Data[offset]);
 			break;
 		case OpenGLShaderUniform::Type::Vec4:
-			UploadUniformFloat4(uniform->GetLocation(), *(glm::vec4*)&buffer.Data[offset]);
+			UploadUniformFloat4(location, *(glm::vec4*)&buffer.Data[offset]);
 			break;
 		case OpenGLShaderUniform::Type::Mat3:
-			UploadUniformMat3(uniform->GetLocation(), *(glm::mat3*)&buffer.Data[offset]);
+			UploadUniformMat3(location, *(glm::mat3*)&buffer.Data[offset]);
 			break;
 		case OpenGLShaderUniform::Type::Mat4:
-			UploadUniformMat4(uniform->GetLocation(), *(glm::mat4*)&buffer.Data[offset]);
-			break;
-		case OpenGLShaderUniform::Type::Struct:
-			UploadUniformStruct(uniform, buffer.Data, offset);
+			UploadUniformMat4(location, *(glm::mat4*)&buffer.Data[offset]);
 			break;
 		default:
 			ENGINE_ASSERT(false, "Unknown uniform type!");
 		}
 	}
 
-	void OpenGLShader::ResolveAndSetUniformArray(OpenGLShaderUniform* uniform, Buffer buffer)
+	void OpenGLShader::ResolveAndSetUniformArray(OpenGLShaderUniform* uniform, int32_t location, Buffer buffer)
 	{
 		uint32_t offset = uniform->GetOffset();
+		uint32_t count = uniform->GetCount();
+		const float* data = (const float*)&buffer.Data[offset];
 		switch (uniform->GetType())
 		{
 		case OpenGLShaderUniform::Type::Bool:
-			UploadUniformFloat(uniform->GetLocation(), *(bool*)&buffer.Data[offset]);
+			//Array elements have consecutive locations, bools are one byte each in the buffer
+			for (uint32_t i = 0; i < count; i++)
+				UploadUniformInt(location + i, buffer.Data[offset + i]);
 			break;
 		case OpenGLShaderUniform::Type::Float:
-			UploadUniformFloat(uniform->GetLocation(), *(float*)&buffer.Data[offset]);
+			glUniform1fv(location, count, data);
 			break;
-		case OpenGLShaderUniform::Type::Int: 
-			UploadUniformInt(uniform->GetLocation(), *(int*)&buffer.Data[offset]);
-			//Maybe UploadUniformIntArray
+		case OpenGLShaderUniform::Type::Int:
+			UploadUniformIntArray(location, (int*)&buffer.Data[offset], count);
 			break;
 		case OpenGLShaderUniform::Type::Vec2:
-			UploadUniformFloat2(uniform->GetLocation(), *(glm::vec2*)&buffer.Data[offset]);
+			glUniform2fv(location, count, data);
 			break;
 		case OpenGLShaderUniform::Type::Vec3:
-			UploadUniformFloat3(uniform->GetLocation(), *(glm::vec3*)&buffer.Data[offset]);
+			glUniform3fv(location, count, data);
 			break;
 		case OpenGLShaderUniform::Type::Vec4:
-			UploadUniformFloat4(uniform->GetLocation(), *(glm::vec4*)&buffer.Data[offset]);
+			glUniform4fv(location, count, data);
 			break;
 		case OpenGLShaderUniform::Type::Mat3:
-			UploadUniformMat3(uniform->GetLocation(), *(glm::mat3*)&buffer.Data[offset]);
+			glUniformMatrix3fv(location, count, GL_FALSE, data);
 			break;
 		case OpenGLShaderUniform::Type::Mat4:
-			UploadUniformMat4Array(uniform->GetLocation(), *(glm::mat4*)&buffer.Data[offset], uniform->GetCount());
-			break;
-		case OpenGLShaderUniform::Type::Struct:
-			UploadUniformStruct(uniform, buffer.Data, offset);
+			UploadUniformMat4Array(location, *(glm::mat4*)&buffer.Data[offset], count);
 			break;
 		default:
 			ENGINE_ASSERT(false, "Unknown uniform type!");
 		}
 	}
 
-	void OpenGLShader::ResolveAndSetUniformField(const OpenGLShaderUniform& field, uint8_t* data, int32_t offset)
+	void OpenGLShader::BeginCompile()
 	{
-		switch (field.GetType())
+		//Final stage sources in a stable order, the cache key depends on it
+		std::string header;
+		//Bindless textures need the extension enabled in every stage that declares samplers
+		if (OpenGLExtensions::BindlessTexture && !m_IsCompute)
+			header += "#extension GL_ARB_bindless_texture : require\n";
+		for (uint32_t i = 0; i < m_KeywordNames.size(); i++)
 		{
-		case OpenGLShaderUniform::Type::Bool:
-			UploadUniformFloat(field.GetLocation(), *(bool*)&data[offset]);
-			break;
-		case OpenGLShaderUniform::Type::Float:
-			UploadUniformFloat(field.GetLocation(), *(float*)&data[offset]);
-			break;
-		case OpenGLShaderUniform::Type::Int:
-			UploadUniformInt(field.GetLocation(), *(int*)&data[offset]);
-			break;
-		case OpenGLShaderUniform::Type::Vec2:
-			UploadUniformFloat2(field.GetLocation(), *(glm::vec2*)&data[offset]);
-			break;
-		case OpenGLShaderUniform::Type::Vec3:
-			UploadUniformFloat3(field.GetLocation(), *(glm::vec3*)&data[offset]);
-			break;
-		case OpenGLShaderUniform::Type::Vec4:
-			UploadUniformFloat4(field.GetLocation(), *(glm::vec4*)&data[offset]);
-			break;
-		case OpenGLShaderUniform::Type::Mat3:
-			UploadUniformMat3(field.GetLocation(), *(glm::mat3*)&data[offset]);
-			break;
-		case OpenGLShaderUniform::Type::Mat4:
-			UploadUniformMat4(field.GetLocation(), *(glm::mat4*)&data[offset]);
-			break;
-		default:
-			ENGINE_ASSERT(false, "Unknown uniform type!");
+			if (m_VariantKeywords & (1u << i))
+				header += "#define " + m_KeywordNames[i] + " 1\n";
 		}
-	}
 
-	void OpenGLShader::Compile()
-	{
-		std::vector<GLuint> shaderRendererIDs;
-
-		//Create shader program
-		GLuint program = glCreateProgram();
+		std::map<GLenum, std::string> sources;
 		for (auto& kv : m_ShaderSource)
 		{
-			GLenum type = kv.first;
 			const std::string& source = kv.second;
+			std::string stageHeader = header;
+#if MESH_PACKED_VERTICES
+			//Mesh vertex inputs are decoded in the vertex stage, see PackedVertex. Compute shaders that read mesh vertex
+			//buffers, like skinning, need the layout as well. Stages that do not test the flag keep their cache keys.
+			bool readsVertices = kv.first == GL_VERTEX_SHADER || kv.first == GL_COMPUTE_SHADER;
+			if (readsVertices && source.find("PACKED_VERTICES") != std::string::npos)
+				stageHeader += "#define PACKED_VERTICES 1\n";
+#endif
+			size_t versionEnd = source.find('\n', source.find("#version"));
+			if (!stageHeader.empty() && versionEnd != std::string::npos)
+				sources[kv.first] = source.substr(0, versionEnd + 1) + stageHeader + source.substr(versionEnd + 1);
+			else
+				sources[kv.first] = source;
+		}
+
+		//A previous compile that never finished is superseded
+		if (m_PendingProgram)
+		{
+			glDeleteProgram(m_PendingProgram);
+			for (auto id : m_PendingShaderIDs)
+				glDeleteShader(id);
+			m_PendingShaderIDs.clear();
+		}
 
+		m_PendingCacheKey = GetProgramCacheKey(sources);
+		m_PendingProgram = LoadProgramBinary(m_PendingCacheKey);
+		if (m_PendingProgram)
+		{
+			s_CacheStatistics.Hits++;
+			SHADER_TRACE("Shader '{0}' loaded from program cache", m_Name);
+			return;
+		}
+		s_CacheStatistics.Misses++;
+
+		//Create shader program. Status is not queried here so the driver can compile in the background.
+		GLuint program = glCreateProgram();
+		for (auto& kv : sources)
+		{
 			//Create shader handle
-			GLuint shaderID = glCreateShader(type);
+			GLuint shaderID = glCreateShader(kv.first);
 			//Send shader source to GL
-			const GLchar* sourceCStr = (const GLchar*)source.c_str();
+			const GLchar* sourceCStr = (const GLchar*)kv.second.c_str();
 			glShaderSource(shaderID, 1, &sourceCStr, 0);
 			//Compile shader
 			glCompileShader(shaderID);
-			//If shader is not compiled, print log and delete shader
-			GLint isCompiled = 0;
-			glGetShaderiv(shaderID, GL_COMPILE_STATUS, &isCompiled);
-			if (isCompiled == GL_FALSE)
-			{
-				GLint maxLength = 0;
-				glGetShaderiv(shaderID, GL_INFO_LOG_LENGTH, &maxLength);
-
-				std::vector<GLchar> infoLog(maxLength);
-				glGetShaderInfoLog(shaderID, maxLength, &maxLength, &infoLog[0]);
-
-				glDeleteShader(shaderID);
-
-				ENGINE_ERROR("Shader '{0}' compilation failure:\n'{1}'", m_Path, &infoLog[0]);
-				return;
-			}
 
-			shaderRendererIDs.push_back(shaderID);
+			m_PendingShaderIDs.push_back(shaderID);
 			glAttachShader(program, shaderID);
 		}
 
 		//Link program
+		glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 		glLinkProgram(program);
+		m_PendingProgram = program;
+	}
+
+	bool OpenGLShader::IsCompileComplete() const
+	{
+		if (!OpenGLExtensions::ParallelShaderCompile)
+			return true;
+
+		GLint completed = GL_FALSE;
+		glGetProgramiv(m_PendingProgram, GL_COMPLETION_STATUS_KHR, &completed);
+		return completed == GL_TRUE;
+	}
+
+	void OpenGLShader::FinishCompile()
+	{
+		GLuint program = m_PendingProgram;
+		std::vector<GLuint> shaderRendererIDs = std::move(m_PendingShaderIDs);
+		m_PendingProgram = 0;
+		m_PendingShaderIDs.clear();
+		m_Compiling = false;
 
-		//If link failed, print log and delete shader
+		//If link failed, print log of the failed stage or the program and delete shader
 		GLint isLinked = 0;
 		glGetProgramiv(program, GL_LINK_STATUS, &isLinked);
 		if (isLinked == GL_FALSE)
 		{
-			GLint maxLength = 1024;
-			//glGetProgramiv(program, GL_INFO_LOG_LENGTH, &maxLength);
+			bool stageFailed = false;
+			for (auto id : shaderRendererIDs)
+			{
+				GLint isCompiled = 0;
+				glGetShaderiv(id, GL_COMPILE_STATUS, &isCompiled);
+				if (isCompiled == GL_FALSE)
+				{
+					GLint maxLength = 0;
+					glGetShaderiv(id, GL_INFO_LOG_LENGTH, &maxLength);
+
+					std::vector<GLchar> infoLog(maxLength + 1);
+					glGetShaderInfoLog(id, maxLength, &maxLength, &infoLog[0]);
+
+					ENGINE_ERROR("Shader '{0}' compilation failure:\n'{1}'", m_Path, &infoLog[0]);
+					stageFailed = true;
+				}
+			}
+			if (!stageFailed)
+			{
+				GLint maxLength = 1024;
+				//glGetProgramiv(program, GL_INFO_LOG_LENGTH, &maxLength);
+
+				std::vector<GLchar> infoLog(maxLength);
+				glGetProgramInfoLog(program, maxLength, &maxLength, &infoLog[0]);
 
-			std::vector<GLchar> infoLog(maxLength);
-			glGetProgramInfoLog(program, maxLength, &maxLength, &infoLog[0]);
+				ENGINE_ERROR("Shader '{0}' link failure:\n'{1}'", m_Path, &infoLog[0]);
+			}
 
+			//Keep the previous program on a failed reload
 			glDeleteProgram(program);
 			for (auto id : shaderRendererIDs)
 				glDeleteShader(id);
-
-			ENGINE_ERROR("Shader '{0}' link failure:\n'{1}'", m_Path, &infoLog[0]);
 			return;
 		}
 
 		//detach shader after a successful link
 		for (auto id : shaderRendererIDs)
+		{
 			glDetachShader(program, id);
+			glDeleteShader(id);
+		}
+
+		//Cache hits were not compiled from source and are already on disk
+		if (!shaderRendererIDs.empty())
+			SaveProgramBinary(program, m_PendingCacheKey);
 
+		if (m_RendererID)
+			glDeleteProgram(m_RendererID);
 		m_RendererID = program;
+
+		Reflect();
+		if (!m_IsCompute)
+		{
+			//A reload may remove uniforms, build the layout again. Otherwise add what this program uses to the shared layout.
+			OpenGLShader* layout = GetLayout();
+			if (m_Loaded && !m_Base)
+				RebuildLayout();
+			else if (layout->MergeLayout(m_ReflectedUniforms))
+				layout->OnLayoutChanged();
+			ResolveUniforms();
+		}
+
+		m_Loaded = true;
+
+		SHADER_TRACE("Shader '{0}' ready ({1})", m_Name, m_RendererID);
+	}
+
+	static const char* s_PlaceholderVertexSource = R"(
+		#version 450 core
+		layout(location = 0) in vec3 a_Position;
+		layout(location = 0) uniform mat4 u_ViewProjectionMatrix;
+		layout(location = 1) uniform mat4 u_Transform;
+		void main()
+		{
+			gl_Position = u_ViewProjectionMatrix * u_Transform * vec4(a_Position, 1.0);
+		}
+	)";
+	static const char* s_PlaceholderFragmentSource = R"(
+		#version 450 core
+		layout(location = 0) out vec4 o_Color;
+		void main()
+		{
+			o_Color = vec4(1.0, 0.0, 1.0, 1.0);
+		}
+	)";
+
+	uint32_t OpenGLShader::GetPlaceholderProgram()
+	{
+		static GLuint program = 0;
+		if (program)
+			return program;
+
+		//Tiny enough to compile synchronously the first time a material needs it
+		GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+		glShaderSource(vertexShader, 1, &s_PlaceholderVertexSource, 0);
+		glCompileShader(vertexShader);
+		GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+		glShaderSource(fragmentShader, 1, &s_PlaceholderFragmentSource, 0);
+		glCompileShader(fragmentShader);
+
+		program = glCreateProgram();
+		glAttachShader(program, vertexShader);
+		glAttachShader(program, fragmentShader);
+		glLinkProgram(program);
+		glDetachShader(program, vertexShader);
+		glDetachShader(program, fragmentShader);
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+
+		return program;
+	}
+
+	void OpenGLShader::SetPlaceholderTransforms(const glm::mat4& viewProjection, const glm::mat4& transform)
+	{
+		Renderer::Submit([this, viewProjection, transform]()
+			{
+				if (m_RendererID)
+					return;
+				GLuint program = GetPlaceholderProgram();
+				glProgramUniformMatrix4fv(program, 0, 1, GL_FALSE, glm::value_ptr(viewProjection));
+				glProgramUniformMatrix4fv(program, 1, 1, GL_FALSE, glm::value_ptr(transform));
+			}
+		);
+	}
+
+	uint32_t OpenGLShader::GetProgramCacheKey(const std::map<GLenum, std::string>& sources) const
+	{
+		//Binaries are only valid for the driver that produced them
+		uint32_t hash = Hash::FNV(OpenGLShader::ProgramCacheVersion);
+		const char* driver[] = {
+			(const char*)glGetString(GL_VENDOR),
+			(const char*)glGetString(GL_RENDERER),
+			(const char*)glGetString(GL_VERSION)
+		};
+		for (const char* str : driver)
+		{
+			if (str)
+				hash = Hash::FNV(str, strlen(str), hash);
+		}
+		for (auto& kv : sources)
+		{
+			hash = Hash::FNV(&kv.first, sizeof(GLenum), hash);
+			hash = Hash::FNV(kv.second.data(), kv.second.size(), hash);
+		}
+		return hash;
+	}
+
+	std::string OpenGLShader::GetProgramCachePath() const
+	{
+		if (m_VariantKeywords)
+			return std::string(ProgramCacheDirectory) + m_Name + "_" + std::to_string(m_VariantKeywords) + ".glbin";
+		return std::string(ProgramCacheDirectory) + m_Name + ".glbin";
+	}
+
+	/// <summary>
+	/// ļʽ: ProgramBinaryHeader + binary
+	/// </summary>
+	struct ProgramBinaryHeader
+	{
+		uint32_t Magic;
+		uint32_t Key;
+		uint32_t Format;
+		uint32_t Length;
+	};
+	static const uint32_t ProgramBinaryMagic = 0x42505354; //'TSPB'
+
+	uint32_t OpenGLShader::LoadProgramBinary(uint32_t key)
+	{
+		GLint formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		if (formats == 0)
+			return 0;
+
+		std::ifstream in(GetProgramCachePath(), std::ios::in | std::ios::binary);
+		if (!in)
+			return 0;
+
+		ProgramBinaryHeader header;
+		in.read((char*)&header, sizeof(header));
+		if (!in || header.Magic != ProgramBinaryMagic || header.Key != key || header.Length == 0)
+			return 0;
+
+		std::vector<uint8_t> binary(header.Length);
+		in.read((char*)binary.data(), binary.size());
+		if (!in)
+			return 0;
+
+		GLuint program = glCreateProgram();
+		glProgramBinary(program, header.Format, binary.data(), (GLsizei)binary.size());
+
+		//The driver may reject binaries it produced before an update, fall back to compiling
+		GLint isLinked = 0;
+		glGetProgramiv(program, GL_LINK_STATUS, &isLinked);
+		if (isLinked == GL_FALSE)
+		{
+			glDeleteProgram(program);
+			return 0;
+		}
+
+		return program;
+	}
+
+	void OpenGLShader::SaveProgramBinary(uint32_t program, uint32_t key)
+	{
+		GLint length = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length == 0)
+			return;
+
+		std::vector<uint8_t> binary(length);
+		GLenum format = 0;
+		glGetProgramBinary(program, length, &length, &format, binary.data());
+
+		std::error_code error;
+		std::filesystem::create_directories(ProgramCacheDirectory, error);
+		std::ofstream out(GetProgramCachePath(), std::ios::out | std::ios::binary);
+		if (!out)
+		{
+			SHADER_WARN("Could not write program cache for shader '{0}'", m_Name);
+			return;
+		}
+
+		ProgramBinaryHeader header = { ProgramBinaryMagic, key, format, (uint32_t)length };
+		out.write((const char*)&header, sizeof(header));
+		out.write((const char*)binary.data(), length);
 	}
 
 
@@ -4,21 +4,45 @@
 #include "Engine/Platforms/OpenGL/OpenGLShaderUniform.h"
 #include <glm/glm.hpp>
 #include <unordered_map>
+#include <map>
 
 //TODO: Remove
 typedef unsigned int GLenum;
 
 namespace Engine
 {
+	/// <summary>
+	/// Active uniform of a linked program
+	/// </summary>
+	struct ReflectedUniform
+	{
+		std::string Name;			//Arrays without the '[0]' suffix, struct members as 'name.field'
+		GLenum Type;
+		uint32_t Count;
+		int32_t Location;
+		ShaderDomain Domain;
+	};
+
 	class OpenGLShader : public Shader
 	{
 	public:
-		OpenGLShader(const std::string& filepath);
+		static const char* ProgramCacheDirectory;
+		static const char* ProgramCacheVersion;
+
+	public:
+		OpenGLShader(const std::string& filepath, bool async = false, uint32_t keywords = 0);
 		virtual ~OpenGLShader();
 
 		virtual void Reload() override;
 
 		virtual uint32_t GetRendererID() const override { return m_RendererID; }
+		virtual bool IsReady() const override { return m_RendererID != 0; }
+		virtual bool IsCompiling() const override { return m_Compiling; }
+		virtual void PollCompile() override;
+
+		virtual const std::vector<std::string>& GetKeywords() const override { return m_KeywordNames; }
+		virtual uint32_t GetKeywordMask(const std::string& keyword) const override;
+		virtual Shader* GetVariant(uint32_t keywords) override;
 		virtual void Bind() const override;
 		virtual void Unbind() const override;
 
@@ -28,6 +52,7 @@ namespace Engine
 
 		virtual void SetVSMaterialUniformBuffer(Buffer buffer) override;
 		virtual void SetPSMaterialUniformBuffer(Buffer buffer) override;
+		virtual void SetPlaceholderTransforms(const glm::mat4& viewProjection, const glm::mat4& transform) override;
 		virtual bool HasVSMaterialUniformBuffer() const override { return (bool)m_VSMaterialUniformBuffer; }
 		virtual bool HasPSMaterialUniformBuffer() const override { return (bool)m_PSMaterialUniformBuffer; }
 		virtual const ShaderUniformBuffer& GetVSMaterialUniformBuffer() const override { return *m_VSMaterialUniformBuffer; }
@@ -43,28 +68,72 @@ namespace Engine
 		virtual void Set(const std::string& name, const glm::vec4& value) override;
 		virtual void Set(const std::string& name, const glm::mat3& matrix) override;
 		virtual void Set(const std::string& name, const glm::mat4& matrix) override;
+		virtual void UploadUniform(const std::string& name, uint32_t value) override;
 
 		virtual const ShaderResourceList& GetResources() const override { return m_Resources; }
+		virtual void BindTextures(const std::vector<Ref<Texture>>& textures) override;
 
-		virtual void AddShaderReloadedCallback(const ShaderReloadedCallback& callback) override;
+		virtual uint32_t AddShaderReloadedCallback(const ShaderReloadedCallback& callback) override;
+		virtual void RemoveShaderReloadedCallback(uint32_t id) override;
 
 	private:
 		std::string ReadFile(const std::string& filepath);
 		void Load(const std::string& source);
+		void ParseKeywords(const std::string& source);
 		std::unordered_map<GLenum, std::string> PreProcess(const std::string& source);
-		void Parse();
-		void ParseUniform(const std::string& statement, ShaderDomain domain);
-		void ParseUniformStruct(const std::string& block, ShaderDomain domain);
-		ShaderStruct* FindStruct(const std::string& name);		
 		int32_t GetUniformLocation(const std::string& name) const;
+
+		/// <summary>
+		/// Query the active uniforms of the linked program.
+		/// </summary>
+		void Reflect();
+		/// <summary>
+		/// Shader whose uniform buffers and resources describe the material layout. Variants use the layout of their base shader.
+		/// </summary>
+		OpenGLShader* GetLayout() { return m_Base ? m_Base : this; }
+		/// <summary>
+		/// Append uniforms and resources the layout does not have yet. Existing offsets and registers are kept.
+		/// </summary>
+		bool MergeLayout(const std::vector<ReflectedUniform>& uniforms);
+		/// <summary>
+		/// Build the layout again from this program and its variants, used after a reload.
+		/// </summary>
+		void RebuildLayout();
+		/// <summary>
+		/// Materials of the shader move their values to the new layout.
+		/// </summary>
+		void OnLayoutChanged();
+		/// <summary>
+		/// Map the layout to locations of this program and assign sampler registers.
+		/// </summary>
 		void ResolveUniforms();
+		void UpdateUniformLocations();
+
+		/// <summary>
+		/// ϴbufferuploadedͬıuploaded
+		/// </summary>
+		void ResolveAndSetUniforms(const Ref<OpenGLShaderUniformBuffer>& uniformBuffer, const std::vector<int32_t>& locations, Buffer buffer, Buffer& uploaded);
+		void ResolveAndSetUniform(OpenGLShaderUniform* uniform, int32_t location, Buffer buffer);
+		void ResolveAndSetUniformArray(OpenGLShaderUniform* uniform, int32_t location, Buffer buffer);
+
+		/// <summary>
+		/// Issue compile and link without querying status, the driver may finish them on its own threads.
+		/// </summary>
+		void BeginCompile();
+		bool IsCompileComplete() const;
+		/// <summary>
+		/// Check status of the pending program and make it current. Blocks if the driver has not finished.
+		/// </summary>
+		void FinishCompile();
 
-		void ResolveAndSetUniforms(const Ref<OpenGLShaderUniformBuffer>& uniformBuffer, Buffer buffer);
-		void ResolveAndSetUniform(OpenGLShaderUniform* uniform, Buffer buffer);
-		void ResolveAndSetUniformArray(OpenGLShaderUniform* uniform, Buffer buffer);
-		void ResolveAndSetUniformField(const OpenGLShaderUniform& field, uint8_t* data, int32_t offset);
+		//Drawn with while the program is compiling
+		static uint32_t GetPlaceholderProgram();
 
-		void Compile();
+		//Program binary cache
+		uint32_t GetProgramCacheKey(const std::map<GLenum, std::string>& sources) const;
+		std::string GetProgramCachePath() const;
+		uint32_t LoadProgramBinary(uint32_t key);
+		void SaveProgramBinary(uint32_t program, uint32_t key);
 
 		//Upload with name
 		void UploadUniformInt(const std::string& name, int value);
@@ -86,11 +155,6 @@ namespace Engine
 		void UploadUniformMat3(uint32_t location, const glm::mat3& matrix);
 		void UploadUniformMat4(uint32_t location, const glm::mat4& matrix);
 		void UploadUniformMat4Array(uint32_t location, const glm::mat4& matrix, uint32_t count);
-		
-		/// <summary>
-		/// ϴstructShaderstructʱӦ֤structڲУұضstructӦshaderڲstruct˳һ
-		/// </summary>
-		void UploadUniformStruct(OpenGLShaderUniform* uniform, uint8_t* buffer, uint32_t offset);
 
 	private:
 		uint32_t m_RendererID = 0;
@@ -98,19 +162,48 @@ namespace Engine
 		std::string m_Path;
 		bool m_Loaded = false;
 		bool m_IsCompute = false;
+		bool m_AsyncCompile = false;
+		bool m_Compiling = false;
+
+		//Program compiled or linked by the driver but not checked yet
+		uint32_t m_PendingProgram = 0;
+		std::vector<uint32_t> m_PendingShaderIDs;
+		uint32_t m_PendingCacheKey = 0;
 
 		ShaderUniformList m_VSRendererUniformBuffers;
 		ShaderUniformList m_PSRendererUniformBuffers;
 		Ref<OpenGLShaderUniformBuffer> m_VSMaterialUniformBuffer;
 		Ref<OpenGLShaderUniformBuffer> m_PSMaterialUniformBuffer;
+		//Material uniform values last uploaded to the program
+		Buffer m_VSUploadedUniforms;
+		Buffer m_PSUploadedUniforms;
 		
 		//ShaderڲTexture resource
 		ShaderResourceList m_Resources;
-		//ShaderڲStruct
-		ShaderStructList m_Structs;
+		//Bumped whenever uniforms or resources of the layout change
+		uint32_t m_LayoutVersion = 0;
+
+		//Active uniforms of the program, queried after linking
+		std::vector<ReflectedUniform> m_ReflectedUniforms;
+		//Locations of the layout uniforms in this program, -1 if inactive
+		std::vector<int32_t> m_VSUniformLocations;
+		std::vector<int32_t> m_PSUniformLocations;
+		uint32_t m_ResolvedLayoutVersion = 0;
 		
+		//Sampler uniform location and bindless handle currently set, indexed by register
+		std::vector<int32_t> m_SamplerLocations;
+		std::vector<uint64_t> m_SamplerHandles;
+
+		//'#pragma variant' keywords, bit i of a variant mask defines m_KeywordNames[i]
+		std::vector<std::string> m_KeywordNames;
+		uint32_t m_VariantKeywords = 0;
+		std::unordered_map<uint32_t, Ref<OpenGLShader>> m_Variants;
+		//Shader the variant was created from, nullptr for the base shader
+		OpenGLShader* m_Base = nullptr;
+
 		std::unordered_map<GLenum, std::string> m_ShaderSource;
-		std::vector<ShaderReloadedCallback> m_ShaderReloadedCallbacks;
+		std::vector<std::pair<uint32_t, ShaderReloadedCallback>> m_ShaderReloadedCallbacks;
+		uint32_t m_NextCallbackID = 0;
 
 	};
 }
\ No newline at end of file
@@ -74,6 +74,12 @@ namespace Engine
 	{
 	}
 
+	OpenGLShaderUniformBuffer::~OpenGLShaderUniformBuffer()
+	{
+		for (ShaderUniform* uniform : m_Uniforms)
+			delete (OpenGLShaderUniform*)uniform;
+	}
+
 	void OpenGLShaderUniformBuffer::PushUniform(OpenGLShaderUniform* uniform)
 	{
 		uint32_t offset = 0;
@@ -67,6 +67,7 @@ namespace Engine
 
 	public:
 		OpenGLShaderUniformBuffer(const std::string& name, ShaderDomain domain);
+		~OpenGLShaderUniformBuffer();
 
 		virtual const std::string& GetName() const override { return m_Name; }
 		virtual uint32_t GetRegister() const override { return m_Register; }
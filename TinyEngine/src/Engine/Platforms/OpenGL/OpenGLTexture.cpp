@@ -1,10 +1,15 @@
 #include "pch.h"
 #include "OpenGLTexture.h"
+#include "OpenGLExtensions.h"
 #include "Engine/Renderer/Renderer.h"
 #include "Engine/Asset/AssetManager.h"
+#include "Engine/Renderer/TextureCompressor.h"
+#include "Engine/Renderer/TextureStreamer.h"
 
 #include "stb_image.h"
 #include <glad/glad.h>
+#include <mutex>
+#include <deque>
 
 namespace Engine
 {
@@ -17,109 +22,251 @@ namespace Engine
         case Engine::TextureFormat::RGB:        return GL_RGB;
         case Engine::TextureFormat::RGBA:       return GL_RGBA;
         case Engine::TextureFormat::RGBA16F:    return GL_RGBA16F;
+        default:
+            ENGINE_ASSERT(false, "Unknown texture format!");
+            return 0;
+        }
+    }
+
+    static GLenum TextureFormatToOpenGLCompressedFormat(TextureFormat format, bool srgb)
+    {
+        switch (format)
+        {
+        case Engine::TextureFormat::BC1:    return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case Engine::TextureFormat::BC3:    return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case Engine::TextureFormat::BC4:    return GL_COMPRESSED_RED_RGTC1;
+        case Engine::TextureFormat::BC5:    return GL_COMPRESSED_RG_RGTC2;
+        case Engine::TextureFormat::BC7:    return srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+        default:
+            ENGINE_ASSERT(false, "Unknown compressed texture format!");
+            return 0;
         }
-        ENGINE_ASSERT(false, "Unknown texture format!");
-        return 0;
     }
 
     //-----------------------------------------------------------------------------------
-    //OpenGLTexture2D
+    //Texture uploads
     //-----------------------------------------------------------------------------------
-    OpenGLTexture2D::OpenGLTexture2D(const std::string& path, bool srgb, TextureSpecification spec)
-        :m_Path(path), m_Specification(spec)
+    struct OpenGLTextureUpload
     {
-        if(m_Specification.Flip == TextureFlip::None)
-            stbi_set_flip_vertically_on_load(false);
-        if (m_Specification.Flip == TextureFlip::Vertical)
-            stbi_set_flip_vertically_on_load(true);
+        //Main thread only, cleared if the texture is destroyed before the upload
+        OpenGLTexture2D* Texture = nullptr;
+        std::string Path;
+        bool HDR = false;
+        bool SRGB = false;
+        bool Flip = false;
+        //KTX2 file to load instead of decoding Path, the import cache if Path is not KTX2 itself
+        std::string CompressedPath;
+        TextureUsage Usage = TextureUsage::Default;
+        //Levels to read from CompressedPath. Streamed textures start with their small mips.
+        uint32_t FirstLevel = 0;
+        uint32_t LastLevel = UINT32_MAX;
+
+        //Written by the decoding thread
+        uint8_t* Data = nullptr;
+        CompressedImage Compressed;
+        uint32_t Size = 0;
+    };
+
+    static std::mutex s_UploadMutex;
+    static std::deque<Ref<OpenGLTextureUpload>> s_DecodedUploads;
+    static uint32_t s_UploadPixelBuffer = 0;
+
+    //1x1 textures bound while the image decodes. Mid grey for sRGB (albedo) maps,
+    //flat normal for linear maps, which also reads as 0.5 roughness/metalness.
+    static uint32_t s_PlaceholderIDs[2] = { 0, 0 };
+    static uint64_t s_PlaceholderHandles[2] = { 0, 0 };
+    static bool s_PlaceholdersCreated = false;
+
+    static void CreatePlaceholders()
+    {
+        if (s_PlaceholdersCreated)
+            return;
+        s_PlaceholdersCreated = true;
+
+        Renderer::Submit([]()
+            {
+                const uint8_t pixels[2][4] = { { 128, 128, 255, 255 }, { 188, 188, 188, 255 } };
+                for (uint32_t i = 0; i < 2; i++)
+                {
+                    glCreateTextures(GL_TEXTURE_2D, 1, &s_PlaceholderIDs[i]);
+                    glTextureStorage2D(s_PlaceholderIDs[i], 1, i ? GL_SRGB8_ALPHA8 : GL_RGBA8, 1, 1);
+                    glTextureSubImage2D(s_PlaceholderIDs[i], 0, 0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels[i]);
+                }
+            });
+    }
+
+    static void DecodeImage(OpenGLTextureUpload& upload)
+    {
+        if (!upload.CompressedPath.empty())
+        {
+            //Compress the source on a cache miss, fall back to the uncompressed image if that fails
+            bool isSource = upload.CompressedPath == upload.Path;
+            if (isSource || TextureCompressor::IsCacheValid(upload.Path, upload.CompressedPath) ||
+                TextureCompressor::CompressFile(upload.Path, upload.CompressedPath, upload.Usage, upload.SRGB, upload.Flip))
+            {
+                if (TextureCompressor::ReadKTX2(upload.CompressedPath, upload.Compressed, upload.FirstLevel, upload.LastLevel))
+                {
+                    upload.Size = upload.Compressed.GetSize();
+                    return;
+                }
+            }
+            if (isSource)
+                return;
+        }
+
+        stbi_set_flip_vertically_on_load_thread(upload.Flip);
 
         int width, height, channels;
-        if (stbi_is_hdr(path.c_str()))
+        if (upload.HDR)
         {
-            m_Data.Data = (uint8_t*)stbi_loadf(path.c_str(), &width, &height, &channels, 0);
-            m_IsHDR = true;
-            m_Format = TextureFormat::RGBA16F;
+            upload.Data = (uint8_t*)stbi_loadf(upload.Path.c_str(), &width, &height, &channels, STBI_rgb);
+            upload.Size = width * height * 3 * sizeof(float);
         }
         else
         {
-            m_Data.Data = stbi_load(path.c_str(), &width, &height, &channels, srgb ? STBI_rgb : STBI_rgb_alpha);
-            m_IsHDR = false;
-            m_Format = TextureFormat::RGBA;
+            int components = upload.SRGB ? STBI_rgb : STBI_rgb_alpha;
+            upload.Data = stbi_load(upload.Path.c_str(), &width, &height, &channels, components);
+            upload.Size = width * height * components;
         }
-        if (!m_Data.Data)
+    }
+
+    //-----------------------------------------------------------------------------------
+    //OpenGLTexture2D
+    //-----------------------------------------------------------------------------------
+    void OpenGLTexture2D::ProcessPendingUploads(uint32_t byteBudget)
+    {
+        //Always upload at least one image, so images larger than the budget still finish
+        uint32_t uploadedBytes = 0;
+        while (uploadedBytes < byteBudget)
         {
-            ENGINE_ERROR("Could not read image '{0}'", path);
-            stbi_image_free(m_Data.Data);
-            return;
+            Ref<OpenGLTextureUpload> upload;
+            {
+                std::lock_guard<std::mutex> lock(s_UploadMutex);
+                if (s_DecodedUploads.empty())
+                    break;
+                upload = s_DecodedUploads.front();
+                s_DecodedUploads.pop_front();
+            }
+
+            if (upload->Texture && upload->Size)
+            {
+                upload->Texture->Upload(*upload);
+                upload->Texture->m_Upload = nullptr;
+                uploadedBytes += upload->Size;
+                RENDERCOMMAND_TRACE("Upload texture2D. Path: '{0}', ID: ({1}), {2} bytes", upload->Path, upload->Texture->m_RendererID, upload->Size);
+            }
+            else if (upload->Texture)
+            {
+                ENGINE_ERROR("Could not decode image '{0}'", upload->Path);
+                upload->Texture->m_Upload = nullptr;
+                //Don't request mips of a file that can't be read again
+                if (upload->Texture->m_Streamed)
+                {
+                    upload->Texture->m_Streamed = false;
+                    TextureStreamer::Unregister(upload->Texture);
+                }
+            }
+            stbi_image_free(upload->Data);
         }
+    }
 
+    OpenGLTexture2D::OpenGLTexture2D(const std::string& path, bool srgb, TextureSpecification spec)
+        :m_Path(path), m_Specification(spec), m_SRGB(srgb)
+    {
+        auto upload = CreateRef<OpenGLTextureUpload>();
+        upload->Texture = this;
+        upload->Path = path;
+        upload->SRGB = srgb;
+        upload->Flip = m_Specification.Flip == TextureFlip::Vertical;
+        upload->Usage = m_Specification.Usage;
+
+        //Only the header is read here, pixels are decoded below or on the asset workers
+        if (TextureCompressor::IsKTX2(path))
+        {
+            CompressedImage header;
+            if (!TextureCompressor::ReadKTX2(path, header, 0, 0))
+            {
+                ENGINE_ERROR("Could not read image '{0}'", path);
+                return;
+            }
+
+            m_Format = header.Format;
+            m_SRGB = upload->SRGB = header.SRGB;
+            m_Width = header.Width;
+            m_Height = header.Height;
+            m_Channels = 4;
+            m_MipLevels = (uint32_t)header.Levels.size();
+            upload->CompressedPath = path;
+        }
+        else
+        {
+            int width, height, channels;
+            if (!stbi_info(path.c_str(), &width, &height, &channels))
+            {
+                ENGINE_ERROR("Could not read image '{0}'", path);
+                return;
+            }
+
+            m_IsHDR = stbi_is_hdr(path.c_str());
+            m_Format = m_IsHDR ? TextureFormat::RGBA16F : TextureFormat::RGBA;
+            m_Width = width;
+            m_Height = height;
+            m_Channels = channels;
+            m_MipLevels = Texture::CalculateMipMapCount(m_Width, m_Height);
+
+            //HDR images stay uncompressed. BC1 needs S3TC, which every desktop driver has in practice.
+            bool compress = m_Specification.Usage != TextureUsage::Default && !m_IsHDR;
+            if (m_Specification.Usage == TextureUsage::Albedo && !OpenGLExtensions::TextureCompressionS3TC)
+                compress = false;
+            if (compress)
+                upload->CompressedPath = TextureCompressor::GetCachePath(path, m_Specification.Usage, srgb, upload->Flip);
+        }
         m_Loaded = true;
-        m_Width = width;
-        m_Height = height;
-        m_Channels = channels;
+        upload->HDR = m_IsHDR;
 
-        //TODO: More details
-        Renderer::Submit([this, srgb]() 
-            {
-                if (srgb)
-                {
-                    glCreateTextures(GL_TEXTURE_2D, 1, &m_RendererID);
-                    int levels = Texture::CalculateMipMapCount(m_Width, m_Height);
-                    glTextureStorage2D(m_RendererID, levels, GL_SRGB8, m_Width, m_Height);
-                    glTextureParameteri(m_RendererID, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
-                    glTextureParameteri(m_RendererID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-                    glTextureSubImage2D(
-                        m_RendererID, 
-                        0, 
-                        0, 
-                        0, 
-                        m_Width, 
-                        m_Height, 
-                        GL_RGB, 
-                        GL_UNSIGNED_BYTE, 
-                        m_Data.Data
-                    );
-                    glGenerateTextureMipmap(m_RendererID);
-                }
-                else
+        //KTX2 files hold every mip, load the small ones now and stream the rest
+        if (!upload->CompressedPath.empty())
+        {
+            m_Streamed = true;
+            m_CompressedPath = upload->CompressedPath;
+            upload->FirstLevel = TextureStreamer::CalculateInitialMip(m_Width, m_Height, m_MipLevels);
+            TextureStreamer::Register(this);
+        }
+
+        if (m_Specification.Async)
+        {
+            CreatePlaceholders();
+            m_Upload = upload;
+            AssetManager::GetWorkerPool().Enqueue([upload]()
                 {
-                    glGenTextures(1, &m_RendererID);
-                    glBindTexture(GL_TEXTURE_2D, m_RendererID);
-
-                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-                    GLenum internalFormat = TextureFormatToOpenGLTextureFormat(m_Format);
-                    GLenum format = srgb ? GL_SRGB8 : (m_IsHDR ? GL_RGB : TextureFormatToOpenGLTextureFormat(m_Format)); // HDR = GL_RGB for now
-                    GLenum type = internalFormat == GL_RGBA16F ? GL_FLOAT : GL_UNSIGNED_BYTE;
-                    glTexImage2D(
-                        GL_TEXTURE_2D,
-                        0, 
-                        internalFormat, 
-                        m_Width, 
-                        m_Height, 
-                        0, 
-                        format, 
-                        type, 
-                        m_Data.Data
-                    );
-                    glGenerateMipmap(GL_TEXTURE_2D);
-
-                    glBindTexture(GL_TEXTURE_2D, 0);
-                }
-                stbi_image_free(m_Data.Data);
+                    DecodeImage(*upload);
+                    std::lock_guard<std::mutex> lock(s_UploadMutex);
+                    s_DecodedUploads.push_back(upload);
+                }, m_Specification.Priority);
+            return;
+        }
+
+        DecodeImage(*upload);
+        if (!upload->Size)
+        {
+            ENGINE_ERROR("Could not read image '{0}'", path);
+            m_Loaded = false;
+            return;
+        }
+
+        Renderer::Submit([this, upload]() 
+            {
+                Upload(*upload);
+                stbi_image_free(upload->Data);
 
                 RENDERCOMMAND_TRACE("RenderCommand: Construct texture2D. Path: '{0}', ID: ({1})", m_Path, m_RendererID);
             });
     }
 
     OpenGLTexture2D::OpenGLTexture2D(TextureFormat format, uint32_t width, uint32_t height, TextureSpecification spec)
-        :m_Format(format), m_Width(width), m_Height(height), m_Specification(spec)
+        :m_Format(format), m_Width(width), m_Height(height), m_Specification(spec), m_Ready(true)
     {
+        m_MipLevels = Texture::CalculateMipMapCount(m_Width, m_Height);
         Renderer::Submit([this]()
             {
                 glCreateTextures(GL_TEXTURE_2D, 1, &m_RendererID);
@@ -153,28 +300,210 @@ namespace Engine
 
     OpenGLTexture2D::~OpenGLTexture2D()
     {
+        if (m_Upload)
+            m_Upload->Texture = nullptr;
+        if (m_Streamed)
+            TextureStreamer::Unregister(this);
+
         uint32_t rendererID = m_RendererID;
-        Renderer::Submit([rendererID]()
+        uint64_t bindlessHandle = m_BindlessHandle;
+        Renderer::Submit([rendererID, bindlessHandle]()
             {
                 RENDERCOMMAND_TRACE("RenderCommand: Destroy texture({0})", rendererID);
+                if (bindlessHandle)
+                    OpenGLExtensions::MakeTextureHandleNonResidentARB(bindlessHandle);
                 glDeleteTextures(1, &rendererID);
             });
     }
 
     uint32_t OpenGLTexture2D::GetMipLevelCount() const
     {
-        return Texture::CalculateMipMapCount(m_Width, m_Height);
+        return m_MipLevels;
+    }
+
+    uint32_t OpenGLTexture2D::GetRendererID() const
+    {
+        return m_Ready ? m_RendererID : s_PlaceholderIDs[m_SRGB];
     }
 
     void OpenGLTexture2D::Bind(uint32_t slot) const
     {
         Renderer::Submit([this, slot]()
             {
-                RENDERCOMMAND_TRACE("RenderCommand: Bind texture({0})", m_RendererID);
-                glBindTextureUnit(slot, m_RendererID);
+                RENDERCOMMAND_TRACE("RenderCommand: Bind texture({0})", GetRendererID());
+                glBindTextureUnit(slot, GetRendererID());
             });
     }
+
+    uint64_t OpenGLTexture2D::GetBindlessHandle() const
+    {
+        if (!m_Ready)
+        {
+            uint64_t& handle = s_PlaceholderHandles[m_SRGB];
+            if (!handle && s_PlaceholderIDs[m_SRGB] && OpenGLExtensions::BindlessTexture)
+            {
+                handle = OpenGLExtensions::GetTextureHandleARB(s_PlaceholderIDs[m_SRGB]);
+                OpenGLExtensions::MakeTextureHandleResidentARB(handle);
+            }
+            return handle;
+        }
+
+        if (!m_BindlessHandle && m_RendererID && OpenGLExtensions::BindlessTexture)
+        {
+            m_BindlessHandle = OpenGLExtensions::GetTextureHandleARB(m_RendererID);
+            OpenGLExtensions::MakeTextureHandleResidentARB(m_BindlessHandle);
+        }
+        return m_BindlessHandle;
+    }
     
+    void OpenGLTexture2D::Upload(const OpenGLTextureUpload& upload)
+    {
+        const CompressedImage& compressed = upload.Compressed;
+        bool isCompressed = !compressed.Levels.empty();
+        if (isCompressed)
+        {
+            m_Format = compressed.Format;
+            m_MipLevels = (uint32_t)compressed.Levels.size();
+        }
+        else if (m_Streamed)
+        {
+            //Compressing the source failed, the uncompressed image has no mips on disk
+            m_Streamed = false;
+            TextureStreamer::Unregister(this);
+        }
+
+        GLenum internalFormat = m_IsHDR ? GL_RGBA16F : (m_SRGB ? GL_SRGB8 : GL_RGBA8);
+        if (isCompressed)
+            internalFormat = TextureFormatToOpenGLCompressedFormat(m_Format, m_SRGB);
+        GLenum format = m_IsHDR || m_SRGB ? GL_RGB : GL_RGBA;
+        GLenum type = m_IsHDR ? GL_FLOAT : GL_UNSIGNED_BYTE;
+        uint32_t levels = m_MipLevels;
+
+        //Levels in the upload. Mip loads of streamed textures stop at the resident mip, Reallocate keeps the rest.
+        uint32_t firstLevel = isCompressed ? std::min(upload.FirstLevel, levels - 1) : 0;
+        uint32_t lastLevel = isCompressed ? std::min(upload.LastLevel, levels) : levels;
+        Reallocate(firstLevel);
+
+        //Orphan the previous contents so the copy doesn't wait for the last upload to be consumed
+        if (!s_UploadPixelBuffer)
+            glCreateBuffers(1, &s_UploadPixelBuffer);
+        glNamedBufferData(s_UploadPixelBuffer, upload.Size, nullptr, GL_STREAM_DRAW);
+        uint8_t* staging = (uint8_t*)glMapNamedBufferRange(s_UploadPixelBuffer, 0, upload.Size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (isCompressed)
+        {
+            for (auto& level : compressed.Levels)
+            {
+                memcpy(staging, level.data(), level.size());
+                staging += level.size();
+            }
+        }
+        else
+        {
+            memcpy(staging, upload.Data, upload.Size);
+        }
+        glUnmapNamedBuffer(s_UploadPixelBuffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s_UploadPixelBuffer);
+
+        if (isCompressed)
+        {
+            //Mips come with the image, upload them as they are
+            size_t offset = 0;
+            for (uint32_t i = firstLevel; i < lastLevel; i++)
+            {
+                uint32_t size = (uint32_t)compressed.Levels[i].size();
+                uint32_t width = std::max(m_Width >> i, 1u);
+                uint32_t height = std::max(m_Height >> i, 1u);
+                glCompressedTextureSubImage2D(m_RendererID, i - firstLevel, 0, 0, width, height, internalFormat, size, (const void*)offset);
+                offset += size;
+            }
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+        else
+        {
+            //RGB rows are not 4 byte aligned
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTextureSubImage2D(m_RendererID, 0, 0, 0, m_Width, m_Height, format, type, nullptr);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+            if (levels > 1)
+                glGenerateTextureMipmap(m_RendererID);
+        }
+        m_Ready = true;
+    }
+
+    void OpenGLTexture2D::Reallocate(uint32_t mip)
+    {
+        GLenum internalFormat = m_IsHDR ? GL_RGBA16F : (m_SRGB ? GL_SRGB8 : GL_RGBA8);
+        if (Texture::IsCompressed(m_Format))
+            internalFormat = TextureFormatToOpenGLCompressedFormat(m_Format, m_SRGB);
+        uint32_t levels = m_MipLevels - mip;
+
+        uint32_t rendererID;
+        glCreateTextures(GL_TEXTURE_2D, 1, &rendererID);
+        glTextureStorage2D(rendererID, levels, internalFormat, std::max(m_Width >> mip, 1u), std::max(m_Height >> mip, 1u));
+        glTextureParameteri(rendererID, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTextureParameteri(rendererID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        //sRGB maps keep the default repeat wrap
+        if (!m_SRGB)
+        {
+            GLenum wrap = m_Specification.Wrap == TextureWrap::Clamp ? GL_CLAMP_TO_EDGE : GL_REPEAT;
+            glTextureParameteri(rendererID, GL_TEXTURE_WRAP_S, wrap);
+            glTextureParameteri(rendererID, GL_TEXTURE_WRAP_T, wrap);
+            glTextureParameteri(rendererID, GL_TEXTURE_WRAP_R, wrap);
+        }
+
+        //Immutable storage can't drop levels, copy the mips both storages hold into the new one
+        if (m_RendererID)
+        {
+            for (uint32_t i = std::max(mip, m_ResidentMip); i < m_MipLevels; i++)
+            {
+                uint32_t width = std::max(m_Width >> i, 1u);
+                uint32_t height = std::max(m_Height >> i, 1u);
+                glCopyImageSubData(m_RendererID, GL_TEXTURE_2D, i - m_ResidentMip, 0, 0, 0, rendererID, GL_TEXTURE_2D, i - mip, 0, 0, 0, width, height, 1);
+            }
+
+            if (m_BindlessHandle)
+                OpenGLExtensions::MakeTextureHandleNonResidentARB(m_BindlessHandle);
+            glDeleteTextures(1, &m_RendererID);
+        }
+
+        m_RendererID = rendererID;
+        m_BindlessHandle = 0;
+        m_ResidentMip = mip;
+    }
+
+    void OpenGLTexture2D::SetResidentMip(uint32_t mip)
+    {
+        mip = std::min(mip, m_MipLevels - 1);
+        if (!m_Streamed || !m_Ready || m_Upload || mip == m_ResidentMip)
+            return;
+
+        if (mip > m_ResidentMip)
+        {
+            Reallocate(mip);
+            RENDERCOMMAND_TRACE("Evict texture2D mips. Path: '{0}', resident mip: {1}", m_Path, mip);
+            return;
+        }
+
+        //Read the missing mips on the workers, they are uploaded with the decoded images
+        auto upload = CreateRef<OpenGLTextureUpload>();
+        upload->Texture = this;
+        upload->Path = m_Path;
+        upload->SRGB = m_SRGB;
+        upload->CompressedPath = m_CompressedPath;
+        upload->FirstLevel = mip;
+        upload->LastLevel = m_ResidentMip;
+        m_Upload = upload;
+        AssetManager::GetWorkerPool().Enqueue([upload]()
+            {
+                if (TextureCompressor::ReadKTX2(upload->CompressedPath, upload->Compressed, upload->FirstLevel, upload->LastLevel))
+                    upload->Size = upload->Compressed.GetSize();
+                std::lock_guard<std::mutex> lock(s_UploadMutex);
+                s_DecodedUploads.push_back(upload);
+            });
+    }
+
     void OpenGLTexture2D::Lock()
     {
         m_Locked = true;
@@ -210,7 +539,20 @@ namespace Engine
     {
         TextureSpecification equirectTextureSpec;
         equirectTextureSpec.Flip = TextureFlip::None;
+        //The conversion below is queued right away and needs the pixels
+        equirectTextureSpec.Async = false;
         Ref<Texture2D> equirectTexture = AssetManager::CreateNewAsset<Texture2D>(path, false, equirectTextureSpec);
+        ConvertEquirect(equirectTexture);
+    }
+
+    OpenGLTextureCube::OpenGLTextureCube(const Ref<Texture2D>& equirectTexture)
+        :m_Path(equirectTexture->GetPath())
+    {
+        ConvertEquirect(equirectTexture);
+    }
+
+    void OpenGLTextureCube::ConvertEquirect(const Ref<Texture2D>& equirectTexture)
+    {
         ENGINE_ASSERT(equirectTexture->GetFormat() == TextureFormat::RGBA16F, "Texture is not HDR");
 
         m_Width = 2048;
@@ -222,7 +564,8 @@ namespace Engine
         auto equirectangularConversionShader = Renderer::GetShaderLibrary().Get("EquirectangularToCubeMap");
         equirectangularConversionShader->Bind();
         equirectTexture->Bind();
-        Renderer::Submit([this]()
+        //The bind above holds no reference, keep the image until the conversion ran
+        Renderer::Submit([this, equirectTexture]()
             {
                 glBindImageTexture(0, m_RendererID, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA16F);
                 glDispatchCompute(m_Width / 32, m_Height / 32, 6);
@@ -242,8 +585,11 @@ namespace Engine
     OpenGLTextureCube::~OpenGLTextureCube()
     {
         uint32_t rendererID = m_RendererID;
-        Renderer::Submit([rendererID]() 
+        uint64_t bindlessHandle = m_BindlessHandle;
+        Renderer::Submit([rendererID, bindlessHandle]() 
             {
+                if (bindlessHandle)
+                    OpenGLExtensions::MakeTextureHandleNonResidentARB(bindlessHandle);
                 glDeleteTextures(1, &rendererID);
             });
     }
@@ -266,12 +612,25 @@ namespace Engine
             });
     }
 
+    uint64_t OpenGLTextureCube::GetBindlessHandle() const
+    {
+        if (!m_BindlessHandle && m_RendererID && OpenGLExtensions::BindlessTexture)
+        {
+            m_BindlessHandle = OpenGLExtensions::GetTextureHandleARB(m_RendererID);
+            OpenGLExtensions::MakeTextureHandleResidentARB(m_BindlessHandle);
+        }
+        return m_BindlessHandle;
+    }
+
     void OpenGLTextureCube::Allocate()
     {
         Renderer::Submit([this]()
             {
                 if (m_RendererID)
                 {
+                    if (m_BindlessHandle)
+                        OpenGLExtensions::MakeTextureHandleNonResidentARB(m_BindlessHandle);
+                    m_BindlessHandle = 0;
                     glDeleteTextures(1, &m_RendererID);
                     m_RendererID = 0;
                 }
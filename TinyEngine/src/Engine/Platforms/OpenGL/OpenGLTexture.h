@@ -5,8 +5,13 @@
 
 namespace Engine
 {
+	struct OpenGLTextureUpload;
+
 	class OpenGLTexture2D : public Texture2D
 	{
+	public:
+		static void ProcessPendingUploads(uint32_t byteBudget);
+
 	public:
 		OpenGLTexture2D(const std::string& path, bool srgb, TextureSpecification spec);
 		OpenGLTexture2D(TextureFormat format, uint32_t width, uint32_t height, TextureSpecification spec);
@@ -20,9 +25,16 @@ namespace Engine
 		virtual const std::string& GetPath() const override { return m_Path; }
 
 		virtual bool IsLoaded() const override { return m_Loaded; }
+		virtual bool IsReady() const override { return m_Ready; }
 
-		virtual uint32_t GetRendererID() const { return m_RendererID; };
+		virtual bool IsStreamed() const override { return m_Streamed; }
+		virtual uint32_t GetResidentMip() const override { return m_ResidentMip; }
+		virtual void SetResidentMip(uint32_t mip) override;
+		virtual bool IsStreaming() const override { return m_Upload != nullptr; }
+
+		virtual uint32_t GetRendererID() const override;
 		virtual void Bind(uint32_t slot = 0) const override;
+		virtual uint64_t GetBindlessHandle() const override;
 
 		virtual void Lock() override;
 		virtual void Unlock() override;
@@ -31,25 +43,47 @@ namespace Engine
 		virtual Buffer& GetWritableBuffer() override;
 
 		virtual bool operator==(const Texture& other) override 
-		{ return m_RendererID == ((OpenGLTexture2D&)other).m_RendererID; };
+		{ return this == &other; };
+	private:
+		/// <summary>
+		/// Create the texture storage and upload the decoded image through a pixel buffer. Render thread only.
+		/// </summary>
+		void Upload(const OpenGLTextureUpload& upload);
+		/// <summary>
+		/// Replace the storage with one holding the mips from mip down, copying the mips both have. Render thread only.
+		/// </summary>
+		void Reallocate(uint32_t mip);
+
 	private:
 		uint32_t m_RendererID = 0;
+		mutable uint64_t m_BindlessHandle = 0;
 		std::string m_Path;
 
 		TextureFormat m_Format = TextureFormat::RGB;
 		uint32_t m_Width, m_Height, m_Channels;
+		uint32_t m_MipLevels = 1;
+		//Level 0 of the storage
+		uint32_t m_ResidentMip = 0;
 		TextureSpecification m_Specification;
 
 		Buffer m_Data;
 		bool m_IsHDR = false;
+		bool m_SRGB = false;
 		bool m_Locked = false;
 		bool m_Loaded = false;
+		bool m_Ready = false;
+		bool m_Streamed = false;
+		//KTX2 file the mips stream from
+		std::string m_CompressedPath;
+		//Decode or mip load in flight, shared with the worker
+		Ref<OpenGLTextureUpload> m_Upload;
 	};
 
 	class OpenGLTextureCube : public TextureCube
 	{
 	public:
 		OpenGLTextureCube(const std::string& path, TextureSpecification spec);
+		OpenGLTextureCube(const Ref<Texture2D>& equirectTexture);
 		OpenGLTextureCube(TextureFormat format, uint32_t width, uint32_t height);	
 		virtual ~OpenGLTextureCube();
 
@@ -64,15 +98,21 @@ namespace Engine
 
 		virtual uint32_t GetRendererID() const override { return m_RendererID; }
 		virtual void Bind(uint32_t slot) const override;
+		virtual uint64_t GetBindlessHandle() const override;
 
 		virtual bool operator==(const Texture& other) override
 		{ return m_RendererID == ((OpenGLTextureCube&)other).m_RendererID; };
 
 	private:
 		void Allocate();
+		/// <summary>
+		/// Fill the cube from an uploaded equirectangular HDR image.
+		/// </summary>
+		void ConvertEquirect(const Ref<Texture2D>& equirectTexture);
 
 	private:
 		uint32_t m_RendererID = 0;
+		mutable uint64_t m_BindlessHandle = 0;
 		std::string m_Path;
 
 		TextureFormat m_Format = TextureFormat::RGBA16F;
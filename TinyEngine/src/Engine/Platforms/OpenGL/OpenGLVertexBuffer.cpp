@@ -37,13 +37,15 @@ namespace Engine
 	OpenGLVertexBuffer::OpenGLVertexBuffer(void* data, uint32_t size, VertexBufferUsage usage)
 		:m_Size(size), m_Usage(usage)
 	{
-		m_LocalData = Buffer::Copy(data, size);
+		//Freed once uploaded, the GPU keeps the only copy
+		Buffer buffer = Buffer::Copy(data, size);
 
-		Renderer::Submit([this]()
+		Renderer::Submit([this, buffer]() mutable
 			{
 				glCreateBuffers(1, &m_RendererID);
 				glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
-				glBufferData(GL_ARRAY_BUFFER, m_Size, m_LocalData.Data, OpenGLVertexBufferUsage(m_Usage));
+				glBufferData(GL_ARRAY_BUFFER, m_Size, buffer.Data, OpenGLVertexBufferUsage(m_Usage));
+				buffer.Release();
 
 				RENDERCOMMAND_TRACE("RenderCommand: Construct vertexBuffer({0})", m_RendererID);
 			}
@@ -84,12 +86,13 @@ namespace Engine
 
 	void OpenGLVertexBuffer::SetData(void* data, uint32_t size, uint32_t offset)
 	{
-		m_LocalData = Buffer::Copy(data, size);
+		Buffer buffer = Buffer::Copy(data, size);
 		m_Size = size;
-		Renderer::Submit([this, offset]()
+		Renderer::Submit([this, buffer, offset]() mutable
 			{
 				glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
-				glBufferSubData(GL_ARRAY_BUFFER, offset, m_Size, m_LocalData.Data);
+				glBufferSubData(GL_ARRAY_BUFFER, offset, buffer.Size, buffer.Data);
+				buffer.Release();
 			}
 		);
 	}
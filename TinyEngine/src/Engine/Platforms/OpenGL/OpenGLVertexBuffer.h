@@ -27,7 +27,5 @@ namespace Engine
 		uint32_t m_RendererID = 0;
 		uint32_t m_Size;
 		VertexBufferUsage m_Usage;
-
-		Buffer m_LocalData;
 	};
 }
\ No newline at end of file
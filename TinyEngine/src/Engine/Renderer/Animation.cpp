@@ -0,0 +1,236 @@
+#include "pch.h"
+#include "Animation.h"
+
+#include <glm/gtc/quaternion.hpp>
+
+#if defined(__AVX__)
+	#define ANIMATION_SIMD_WIDTH 8
+	#include <immintrin.h>
+#elif defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+	#define ANIMATION_SIMD_WIDTH 4
+	#include <xmmintrin.h>
+#else
+	#define ANIMATION_SIMD_WIDTH 1
+#endif
+
+namespace Engine
+{
+	//One register of lanes. The blend kernel is written once against these.
+#if ANIMATION_SIMD_WIDTH == 8
+	using FloatN = __m256;
+	static inline FloatN LoadN(const float* p) { return _mm256_loadu_ps(p); }
+	static inline void StoreN(float* p, FloatN v) { _mm256_storeu_ps(p, v); }
+	static inline FloatN SetN(float v) { return _mm256_set1_ps(v); }
+	static inline FloatN AddN(FloatN a, FloatN b) { return _mm256_add_ps(a, b); }
+	static inline FloatN SubN(FloatN a, FloatN b) { return _mm256_sub_ps(a, b); }
+	static inline FloatN MulN(FloatN a, FloatN b) { return _mm256_mul_ps(a, b); }
+	static inline FloatN InverseSqrtN(FloatN v) { return _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(v)); }
+	//v with its sign flipped in the lanes where s is negative
+	static inline FloatN FlipSignN(FloatN v, FloatN s) { return _mm256_xor_ps(v, _mm256_and_ps(s, _mm256_set1_ps(-0.0f))); }
+#elif ANIMATION_SIMD_WIDTH == 4
+	using FloatN = __m128;
+	static inline FloatN LoadN(const float* p) { return _mm_loadu_ps(p); }
+	static inline void StoreN(float* p, FloatN v) { _mm_storeu_ps(p, v); }
+	static inline FloatN SetN(float v) { return _mm_set1_ps(v); }
+	static inline FloatN AddN(FloatN a, FloatN b) { return _mm_add_ps(a, b); }
+	static inline FloatN SubN(FloatN a, FloatN b) { return _mm_sub_ps(a, b); }
+	static inline FloatN MulN(FloatN a, FloatN b) { return _mm_mul_ps(a, b); }
+	static inline FloatN InverseSqrtN(FloatN v) { return _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(v)); }
+	static inline FloatN FlipSignN(FloatN v, FloatN s) { return _mm_xor_ps(v, _mm_and_ps(s, _mm_set1_ps(-0.0f))); }
+#else
+	using FloatN = float;
+	static inline FloatN LoadN(const float* p) { return *p; }
+	static inline void StoreN(float* p, FloatN v) { *p = v; }
+	static inline FloatN SetN(float v) { return v; }
+	static inline FloatN AddN(FloatN a, FloatN b) { return a + b; }
+	static inline FloatN SubN(FloatN a, FloatN b) { return a - b; }
+	static inline FloatN MulN(FloatN a, FloatN b) { return a * b; }
+	static inline FloatN InverseSqrtN(FloatN v) { return 1.0f / std::sqrt(v); }
+	static inline FloatN FlipSignN(FloatN v, FloatN s) { return s < 0.0f ? -v : v; }
+#endif
+	static_assert(Pose::MaxLanes % ANIMATION_SIMD_WIDTH == 0, "Pose streams must be padded to whole registers");
+
+	/// <summary>
+	/// Blend two poses laid out like Pose::Data. result may alias a or b.
+	/// </summary>
+	static void BlendStreams(const float* a, const float* b, float weight, float* result, uint32_t stride)
+	{
+		const FloatN w = SetN(weight);
+
+		//Translation and scale
+		for (uint32_t stream = 0; stream < Pose::StreamCount; stream++)
+		{
+			if (stream >= Pose::RotationX && stream <= Pose::RotationW)
+				continue;
+
+			size_t offset = (size_t)stream * stride;
+			for (uint32_t i = 0; i < stride; i += ANIMATION_SIMD_WIDTH)
+			{
+				FloatN va = LoadN(a + offset + i);
+				FloatN vb = LoadN(b + offset + i);
+				StoreN(result + offset + i, AddN(va, MulN(SubN(vb, va), w)));
+			}
+		}
+
+		//Rotation
+		const size_t x = (size_t)Pose::RotationX * stride;
+		const size_t y = (size_t)Pose::RotationY * stride;
+		const size_t z = (size_t)Pose::RotationZ * stride;
+		const size_t qw = (size_t)Pose::RotationW * stride;
+		for (uint32_t i = 0; i < stride; i += ANIMATION_SIMD_WIDTH)
+		{
+			FloatN ax = LoadN(a + x + i), ay = LoadN(a + y + i), az = LoadN(a + z + i), aw = LoadN(a + qw + i);
+			FloatN bx = LoadN(b + x + i), by = LoadN(b + y + i), bz = LoadN(b + z + i), bw = LoadN(b + qw + i);
+
+			//q and -q are the same rotation, take the one on the shorter arc
+			FloatN dot = AddN(AddN(MulN(ax, bx), MulN(ay, by)), AddN(MulN(az, bz), MulN(aw, bw)));
+			bx = FlipSignN(bx, dot);
+			by = FlipSignN(by, dot);
+			bz = FlipSignN(bz, dot);
+			bw = FlipSignN(bw, dot);
+
+			FloatN rx = AddN(ax, MulN(SubN(bx, ax), w));
+			FloatN ry = AddN(ay, MulN(SubN(by, ay), w));
+			FloatN rz = AddN(az, MulN(SubN(bz, az), w));
+			FloatN rw = AddN(aw, MulN(SubN(bw, aw), w));
+
+			FloatN length = AddN(AddN(MulN(rx, rx), MulN(ry, ry)), AddN(MulN(rz, rz), MulN(rw, rw)));
+			FloatN scale = InverseSqrtN(length);
+			StoreN(result + x + i, MulN(rx, scale));
+			StoreN(result + y + i, MulN(ry, scale));
+			StoreN(result + z + i, MulN(rz, scale));
+			StoreN(result + qw + i, MulN(rw, scale));
+		}
+	}
+
+	static void ResetStreams(float* data, uint32_t stride)
+	{
+		std::fill(data, data + (size_t)Pose::StreamCount * stride, 0.0f);
+		std::fill(data + (size_t)Pose::RotationW * stride, data + (size_t)(Pose::RotationW + 1) * stride, 1.0f);
+		std::fill(data + (size_t)Pose::ScaleX * stride, data + (size_t)Pose::StreamCount * stride, 1.0f);
+	}
+
+	static void SetStreamJoint(float* data, uint32_t stride, uint32_t joint, const glm::vec3& translation, const glm::vec4& rotation, const glm::vec3& scale)
+	{
+		const float values[Pose::StreamCount] = {
+			translation.x, translation.y, translation.z,
+			rotation.x, rotation.y, rotation.z, rotation.w,
+			scale.x, scale.y, scale.z
+		};
+		for (uint32_t stream = 0; stream < Pose::StreamCount; stream++)
+			data[(size_t)stream * stride + joint] = values[stream];
+	}
+
+	//-----------------------------------------------------------------------------------
+	//Pose
+	//-----------------------------------------------------------------------------------
+	void Pose::Reset(uint32_t jointCount)
+	{
+		JointCount = jointCount;
+		Stride = CalculateStride(jointCount);
+		Data.resize((size_t)StreamCount * Stride);
+		ResetStreams(Data.data(), Stride);
+	}
+
+	void Pose::SetJoint(uint32_t joint, const glm::vec3& translation, const glm::vec4& rotation, const glm::vec3& scale)
+	{
+		SetStreamJoint(Data.data(), Stride, joint, translation, rotation, scale);
+	}
+
+	glm::mat4 Pose::GetJointMatrix(uint32_t joint) const
+	{
+		auto value = [&](Stream stream) { return Data[(size_t)stream * Stride + joint]; };
+		glm::quat rotation(value(RotationW), value(RotationX), value(RotationY), value(RotationZ));
+		glm::mat4 matrix = glm::mat4_cast(rotation);
+		matrix[0] *= value(ScaleX);
+		matrix[1] *= value(ScaleY);
+		matrix[2] *= value(ScaleZ);
+		matrix[3] = glm::vec4(value(TranslationX), value(TranslationY), value(TranslationZ), 1.0f);
+		return matrix;
+	}
+
+	//-----------------------------------------------------------------------------------
+	//Skeleton
+	//-----------------------------------------------------------------------------------
+	int32_t Skeleton::FindJoint(const std::string& name) const
+	{
+		auto it = std::find(JointNames.begin(), JointNames.end(), name);
+		return it != JointNames.end() ? (int32_t)(it - JointNames.begin()) : -1;
+	}
+
+	//-----------------------------------------------------------------------------------
+	//AnimationClip
+	//-----------------------------------------------------------------------------------
+	AnimationClip::AnimationClip(const std::string& name, float duration, float sampleRate, uint32_t jointCount)
+		:m_Name(name), m_Duration(duration), m_JointCount(jointCount), m_Stride(Pose::CalculateStride(jointCount))
+	{
+		//The first and last frame fall on the start and end of the clip, the rate is adjusted to fit
+		m_FrameCount = std::max((uint32_t)std::ceil(duration * sampleRate), 1u) + 1;
+		m_SampleRate = duration > 0.0f ? (m_FrameCount - 1) / duration : sampleRate;
+
+		m_Frames.resize((size_t)m_FrameCount * Pose::StreamCount * m_Stride);
+		for (uint32_t frame = 0; frame < m_FrameCount; frame++)
+			ResetStreams(GetFrame(frame), m_Stride);
+	}
+
+	void AnimationClip::SetJoint(uint32_t frame, uint32_t joint, const glm::vec3& translation, const glm::vec4& rotation, const glm::vec3& scale)
+	{
+		SetStreamJoint(GetFrame(frame), m_Stride, joint, translation, rotation, scale);
+	}
+
+	//-----------------------------------------------------------------------------------
+	//AnimationSampler
+	//-----------------------------------------------------------------------------------
+	void AnimationSampler::Sample(const AnimationClip& clip, float time, bool loop, Pose& result)
+	{
+		if (result.JointCount != clip.GetJointCount())
+			result.Reset(clip.GetJointCount());
+
+		float lastFrame = (float)(clip.GetFrameCount() - 1);
+		float position = time * clip.GetSampleRate();
+		if (loop)
+		{
+			position = std::fmod(position, lastFrame);
+			if (position < 0.0f)
+				position += lastFrame;
+		}
+		else
+		{
+			position = glm::clamp(position, 0.0f, lastFrame);
+		}
+
+		uint32_t frame = std::min((uint32_t)position, clip.GetFrameCount() - 1);
+		uint32_t next = std::min(frame + 1, clip.GetFrameCount() - 1);
+		BlendStreams(clip.GetFrame(frame), clip.GetFrame(next), position - (float)frame, result.Data.data(), result.Stride);
+	}
+
+	void AnimationSampler::Blend(const Pose& a, const Pose& b, float weight, Pose& result)
+	{
+		ENGINE_ASSERT(a.JointCount == b.JointCount, "Poses of different skeletons!");
+		if (&result != &a && &result != &b && result.JointCount != a.JointCount)
+			result.Reset(a.JointCount);
+		BlendStreams(a.Data.data(), b.Data.data(), weight, result.Data.data(), a.Stride);
+	}
+
+	void AnimationSampler::CalculateSkinningMatrices(const Skeleton& skeleton, const Pose& pose, std::vector<glm::mat4>& result)
+	{
+		uint32_t jointCount = skeleton.GetJointCount();
+		result.resize(jointCount);
+
+		//Parents come first, so their model transform is ready
+		for (uint32_t i = 0; i < jointCount; i++)
+		{
+			glm::mat4 local = pose.GetJointMatrix(i);
+			int32_t parent = skeleton.ParentIndices[i];
+			result[i] = parent >= 0 ? result[parent] * local : local;
+		}
+
+		for (uint32_t i = 0; i < jointCount; i++)
+			result[i] = result[i] * skeleton.InverseBindPoses[i];
+	}
+
+	uint32_t AnimationSampler::GetLaneCount()
+	{
+		return ANIMATION_SIMD_WIDTH;
+	}
+}
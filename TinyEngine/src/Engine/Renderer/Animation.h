@@ -0,0 +1,124 @@
+#pragma once
+
+#include "Engine/Core/Core.h"
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace Engine
+{
+	/// <summary>
+	/// Local joint transforms as SoA streams, one float per joint in each stream. Streams are padded to a multiple of
+	/// MaxLanes joints with the identity transform, so the SIMD kernels never handle partial lanes.
+	/// </summary>
+	struct Pose
+	{
+		enum Stream : uint32_t
+		{
+			TranslationX, TranslationY, TranslationZ,
+			RotationX, RotationY, RotationZ, RotationW,
+			ScaleX, ScaleY, ScaleZ,
+			StreamCount
+		};
+		static constexpr uint32_t MaxLanes = 8;
+
+		uint32_t JointCount = 0;
+		//Floats per stream
+		uint32_t Stride = 0;
+		std::vector<float> Data;
+
+		static uint32_t CalculateStride(uint32_t jointCount) { return (jointCount + MaxLanes - 1) / MaxLanes * MaxLanes; }
+
+		/// <summary>
+		/// Resize to jointCount joints, all set to the identity transform.
+		/// </summary>
+		void Reset(uint32_t jointCount);
+
+		float* GetStream(Stream stream) { return Data.data() + (size_t)stream * Stride; }
+		const float* GetStream(Stream stream) const { return Data.data() + (size_t)stream * Stride; }
+
+		void SetJoint(uint32_t joint, const glm::vec3& translation, const glm::vec4& rotation, const glm::vec3& scale);
+		glm::mat4 GetJointMatrix(uint32_t joint) const;
+	};
+
+	/// <summary>
+	/// Joints in parent first order, so one pass over the array turns local transforms into model transforms.
+	/// </summary>
+	struct Skeleton
+	{
+		std::vector<std::string> JointNames;
+		//-1 for roots
+		std::vector<int32_t> ParentIndices;
+		//Model space to joint space in the bind pose, identity for joints no vertex references
+		std::vector<glm::mat4> InverseBindPoses;
+		//Local transforms of the bind pose
+		Pose BindPose;
+
+		uint32_t GetJointCount() const { return (uint32_t)JointNames.size(); }
+		int32_t FindJoint(const std::string& name) const;
+	};
+
+	/// <summary>
+	/// Animation resampled at a fixed rate. Every frame is a full pose laid out like Pose::Data, so sampling is a blend
+	/// of two neighbouring frames and needs no key search.
+	/// </summary>
+	class AnimationClip
+	{
+	public:
+		static constexpr float DefaultSampleRate = 30.0f;
+
+	public:
+		AnimationClip(const std::string& name, float duration, float sampleRate, uint32_t jointCount);
+
+		const std::string& GetName() const { return m_Name; }
+		float GetDuration() const { return m_Duration; }
+		float GetSampleRate() const { return m_SampleRate; }
+		uint32_t GetFrameCount() const { return m_FrameCount; }
+		uint32_t GetJointCount() const { return m_JointCount; }
+
+		float* GetFrame(uint32_t frame) { return m_Frames.data() + (size_t)frame * Pose::StreamCount * m_Stride; }
+		const float* GetFrame(uint32_t frame) const { return m_Frames.data() + (size_t)frame * Pose::StreamCount * m_Stride; }
+		/// <summary>
+		/// Set one joint of one frame, rotation is a quaternion in xyzw order.
+		/// </summary>
+		void SetJoint(uint32_t frame, uint32_t joint, const glm::vec3& translation, const glm::vec4& rotation, const glm::vec3& scale);
+
+		uint64_t GetMemorySize() const { return m_Frames.size() * sizeof(float); }
+
+	private:
+		std::string m_Name;
+		float m_Duration;
+		float m_SampleRate;
+		uint32_t m_FrameCount;
+		uint32_t m_JointCount;
+		uint32_t m_Stride;
+		std::vector<float> m_Frames;
+	};
+
+	/// <summary>
+	/// Pose evaluation. Translation and scale are interpolated linearly, rotations with normalized lerp along
+	/// the shorter arc. The kernels use AVX when the build enables it, SSE otherwise.
+	/// </summary>
+	class AnimationSampler
+	{
+	public:
+		/// <summary>
+		/// Sample the clip at time seconds. Looping clips wrap around, others hold the last frame.
+		/// </summary>
+		static void Sample(const AnimationClip& clip, float time, bool loop, Pose& result);
+		/// <summary>
+		/// result = a * (1 - weight) + b * weight. result may be a or b.
+		/// </summary>
+		static void Blend(const Pose& a, const Pose& b, float weight, Pose& result);
+		/// <summary>
+		/// Model transform of every joint times its inverse bind pose, the matrices the vertices are skinned with.
+		/// </summary>
+		static void CalculateSkinningMatrices(const Skeleton& skeleton, const Pose& pose, std::vector<glm::mat4>& result);
+
+		/// <summary>
+		/// Floats processed per instruction by the kernels of this build.
+		/// </summary>
+		static uint32_t GetLaneCount();
+	};
+}
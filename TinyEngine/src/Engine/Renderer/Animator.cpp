@@ -0,0 +1,107 @@
+#include "pch.h"
+#include "Animator.h"
+#include "Engine/Renderer/Renderer.h"
+
+namespace Engine
+{
+	Ref<Animator> Animator::Create(const Ref<Mesh>& mesh)
+	{
+		return CreateRef<Animator>(mesh);
+	}
+
+	Animator::Animator(const Ref<Mesh>& mesh)
+		:m_Mesh(mesh)
+	{
+		ENGINE_ASSERT(mesh->IsAnimated(), "Mesh has no skeleton!");
+
+		const Skeleton& skeleton = mesh->GetSkeleton();
+		m_Pose = skeleton.BindPose;
+		AnimationSampler::CalculateSkinningMatrices(skeleton, m_Pose, m_SkinningMatrices);
+
+		//Both are written on the GPU every frame
+		m_BoneBuffer = VertexBuffer::Create((uint32_t)(m_SkinningMatrices.size() * sizeof(glm::mat4)), VertexBufferUsage::Dynamic);
+		m_SkinnedVertexBuffer = VertexBuffer::Create(mesh->GetVertexBuffer()->GetSize(), VertexBufferUsage::Dynamic);
+	}
+
+	void Animator::Play(const Ref<AnimationClip>& clip, float fadeTime)
+	{
+		if (clip == m_Clip)
+			return;
+
+		if (m_Clip && fadeTime > 0.0f)
+		{
+			m_PreviousClip = m_Clip;
+			m_PreviousTime = m_Time;
+			m_FadeTime = fadeTime;
+			m_FadeElapsed = 0.0f;
+		}
+		else
+		{
+			m_PreviousClip = nullptr;
+		}
+
+		m_Clip = clip;
+		m_Time = 0.0f;
+	}
+
+	void Animator::Stop()
+	{
+		m_Clip = nullptr;
+		m_PreviousClip = nullptr;
+		m_Time = 0.0f;
+	}
+
+	void Animator::Update(Timestep ts, bool loop)
+	{
+		const Skeleton& skeleton = m_Mesh->GetSkeleton();
+		if (!m_Clip)
+		{
+			m_Pose = skeleton.BindPose;
+		}
+		else
+		{
+			m_Time += ts;
+			AnimationSampler::Sample(*m_Clip, m_Time, loop, m_Pose);
+		}
+
+		if (m_PreviousClip)
+		{
+			m_FadeElapsed += ts;
+			if (m_FadeElapsed >= m_FadeTime)
+			{
+				m_PreviousClip = nullptr;
+			}
+			else
+			{
+				m_PreviousTime += ts;
+				AnimationSampler::Sample(*m_PreviousClip, m_PreviousTime, loop, m_PreviousPose);
+				AnimationSampler::Blend(m_PreviousPose, m_Pose, m_FadeElapsed / m_FadeTime, m_Pose);
+			}
+		}
+
+		AnimationSampler::CalculateSkinningMatrices(skeleton, m_Pose, m_SkinningMatrices);
+	}
+
+	void Animator::Skin(const Ref<Shader>& shader)
+	{
+		//The animator may update again before the render thread runs, the matrices are copied into the frame
+		Buffer matrices = Renderer::CopyFrameData(Buffer((uint8_t*)m_SkinningMatrices.data(), (uint32_t)(m_SkinningMatrices.size() * sizeof(glm::mat4))));
+		Ref<VertexBuffer> vertices = m_Mesh->GetVertexBuffer();
+		Ref<VertexBuffer> influences = m_Mesh->GetInfluenceBuffer();
+		Ref<VertexBuffer> bones = m_BoneBuffer;
+		Ref<VertexBuffer> skinned = m_SkinnedVertexBuffer;
+		uint32_t vertexCount = m_Mesh->GetVertexCount();
+		Renderer::Submit([shader, matrices, vertices, influences, bones, skinned, vertexCount]()
+			{
+				RendererAPI& api = Renderer::GetAPI();
+				api.SetBufferData(bones->GetRendererID(), matrices.Data, matrices.Size);
+
+				api.BindStorageBuffer(0, vertices->GetRendererID());
+				api.BindStorageBuffer(1, influences->GetRendererID());
+				api.BindStorageBuffer(2, bones->GetRendererID());
+				api.BindStorageBuffer(3, skinned->GetRendererID());
+				shader->UploadUniform("u_VertexCount", vertexCount);
+				api.DispatchCompute((vertexCount + SkinningGroupSize - 1) / SkinningGroupSize);
+			});
+	}
+}
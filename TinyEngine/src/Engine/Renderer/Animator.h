@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Engine/Core/Core.h"
+#include "Engine/Core/TimeStep.h"
+#include "Engine/Renderer/Animation.h"
+#include "Engine/Renderer/Mesh.h"
+#include "Engine/Renderer/Shader.h"
+#include "Engine/Renderer/VertexBuffer.h"
+
+namespace Engine
+{
+	/// <summary>
+	/// Plays the clips of an animated mesh for one entity. The mesh stays shared, the vertices are skinned by a compute
+	/// shader into a vertex buffer owned by the animator, which is drawn in place of the mesh vertex buffer.
+	/// </summary>
+	class Animator
+	{
+	public:
+		//Threads per group of the skinning shader
+		static constexpr uint32_t SkinningGroupSize = 64;
+
+	public:
+		static Ref<Animator> Create(const Ref<Mesh>& mesh);
+
+		Animator(const Ref<Mesh>& mesh);
+
+		const Ref<Mesh>& GetMesh() const { return m_Mesh; }
+		const Ref<AnimationClip>& GetClip() const { return m_Clip; }
+		float GetTime() const { return m_Time; }
+		const Pose& GetPose() const { return m_Pose; }
+
+		/// <summary>
+		/// Start clip from the beginning, cross-fading from the current pose over fadeTime seconds.
+		/// </summary>
+		void Play(const Ref<AnimationClip>& clip, float fadeTime = 0.2f);
+		/// <summary>
+		/// Return to the bind pose.
+		/// </summary>
+		void Stop();
+		/// <summary>
+		/// Advance the clip and compute the skinning matrices.
+		/// </summary>
+		void Update(Timestep ts, bool loop);
+
+		/// <summary>
+		/// Queue the dispatch that skins the mesh with the last updated pose. The skinning shader must be bound.
+		/// </summary>
+		void Skin(const Ref<Shader>& shader);
+		const Ref<VertexBuffer>& GetSkinnedVertexBuffer() const { return m_SkinnedVertexBuffer; }
+
+	private:
+		Ref<Mesh> m_Mesh;
+
+		Ref<AnimationClip> m_Clip;
+		float m_Time = 0.0f;
+		Pose m_Pose;
+
+		//Clip faded out while m_Clip fades in
+		Ref<AnimationClip> m_PreviousClip;
+		float m_PreviousTime = 0.0f;
+		Pose m_PreviousPose;
+		float m_FadeTime = 0.0f;
+		float m_FadeElapsed = 0.0f;
+
+		std::vector<glm::mat4> m_SkinningMatrices;
+		Ref<VertexBuffer> m_BoneBuffer;
+		Ref<VertexBuffer> m_SkinnedVertexBuffer;
+	};
+}
@@ -3,6 +3,7 @@
 #include <glm/glm.hpp>
 #include "Engine/Core/Core.h"
 #include "Engine/Core/Ref.h"
+#include "Engine/Core/Buffer.h"
 
 namespace Engine
 {
@@ -59,6 +60,14 @@ namespace Engine
 
 		virtual void Resize(uint32_t width, uint32_t height) = 0;
 		virtual void BindTexture(uint32_t attachmentIndex = 0, uint32_t slot = 0) const = 0;
+		/// <summary>
+		/// Read back color attachment as RGBA32F. Data is valid after the render command queue is executed.
+		/// </summary>
+		virtual void ReadColorAttachment(Buffer& outBuffer, uint32_t attachmentIndex = 0) const = 0;
+		/// <summary>
+		/// Tell the driver the contents of the attachments are no longer needed, so they don't have to be stored or preserved.
+		/// </summary>
+		virtual void Discard(bool color = true, bool depth = true) = 0;
 
 		static Ref<FrameBuffer> Create(const FrameBufferSpecification& spec);	
 	};
@@ -0,0 +1,210 @@
+#include "pch.h"
+#include "ImageWriter.h"
+
+#include <glm/gtc/packing.hpp>
+
+namespace Engine
+{
+	//--------------------------------------------------------------------------------
+	//PNG helper function
+	//--------------------------------------------------------------------------------
+	static uint32_t CRC32(const uint8_t* data, size_t size, uint32_t crc = 0)
+	{
+		static uint32_t s_Table[256] = {};
+		if (!s_Table[1])
+		{
+			for (uint32_t i = 0; i < 256; i++)
+			{
+				uint32_t c = i;
+				for (int k = 0; k < 8; k++)
+					c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+				s_Table[i] = c;
+			}
+		}
+
+		crc = ~crc;
+		for (size_t i = 0; i < size; i++)
+			crc = s_Table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		return ~crc;
+	}
+
+	static void WriteBigEndian(std::vector<uint8_t>& out, uint32_t value)
+	{
+		out.push_back((value >> 24) & 0xFF);
+		out.push_back((value >> 16) & 0xFF);
+		out.push_back((value >> 8) & 0xFF);
+		out.push_back(value & 0xFF);
+	}
+
+	static void WriteChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data)
+	{
+		WriteBigEndian(out, (uint32_t)data.size());
+		size_t begin = out.size();
+		out.insert(out.end(), type, type + 4);
+		out.insert(out.end(), data.begin(), data.end());
+		WriteBigEndian(out, CRC32(out.data() + begin, out.size() - begin));
+	}
+
+	/// <summary>
+	/// zlib stream with stored (uncompressed) deflate blocks, good enough for regression images
+	/// </summary>
+	static std::vector<uint8_t> ZlibStore(const std::vector<uint8_t>& data)
+	{
+		std::vector<uint8_t> out = { 0x78, 0x01 };
+		size_t pos = 0;
+		do
+		{
+			uint16_t blockSize = (uint16_t)std::min<size_t>(data.size() - pos, 65535);
+			bool last = pos + blockSize == data.size();
+			out.push_back(last ? 1 : 0);
+			out.push_back(blockSize & 0xFF);
+			out.push_back(blockSize >> 8);
+			out.push_back(~blockSize & 0xFF);
+			out.push_back((uint16_t)~blockSize >> 8);
+			out.insert(out.end(), data.begin() + pos, data.begin() + pos + blockSize);
+			pos += blockSize;
+		} while (pos < data.size());
+
+		uint32_t a = 1, b = 0;
+		for (uint8_t byte : data)
+		{
+			a = (a + byte) % 65521;
+			b = (b + a) % 65521;
+		}
+		WriteBigEndian(out, (b << 16) | a);
+		return out;
+	}
+
+	bool ImageWriter::WritePNG(const std::string& filepath, const float* pixels, uint32_t width, uint32_t height)
+	{
+		//Each scanline starts with filter type 0
+		std::vector<uint8_t> raw;
+		raw.reserve((size_t)(width * 4 + 1) * height);
+		for (uint32_t y = 0; y < height; y++)
+		{
+			const float* row = pixels + (size_t)(height - 1 - y) * width * 4;
+			raw.push_back(0);
+			for (uint32_t x = 0; x < width * 4; x++)
+				raw.push_back((uint8_t)(glm::clamp(row[x], 0.0f, 1.0f) * 255.0f + 0.5f));
+		}
+
+		std::vector<uint8_t> header;
+		WriteBigEndian(header, width);
+		WriteBigEndian(header, height);
+		header.push_back(8);	//Bit depth
+		header.push_back(6);	//Color type: RGBA
+		header.push_back(0);
+		header.push_back(0);
+		header.push_back(0);
+
+		std::vector<uint8_t> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+		WriteChunk(png, "IHDR", header);
+		WriteChunk(png, "IDAT", ZlibStore(raw));
+		WriteChunk(png, "IEND", {});
+
+		std::ofstream out(filepath, std::ios::out | std::ios::binary);
+		if (!out)
+		{
+			ENGINE_ERROR("Could not write image '{0}'", filepath);
+			return false;
+		}
+		out.write((const char*)png.data(), png.size());
+		return true;
+	}
+
+	//--------------------------------------------------------------------------------
+	//EXR helper function
+	//--------------------------------------------------------------------------------
+	template<typename T>
+	static void WriteLittleEndian(std::vector<uint8_t>& out, T value)
+	{
+		uint8_t* bytes = (uint8_t*)&value;
+		out.insert(out.end(), bytes, bytes + sizeof(T));
+	}
+
+	static void WriteAttribute(std::vector<uint8_t>& out, const char* name, const char* type, const std::vector<uint8_t>& data)
+	{
+		out.insert(out.end(), name, name + strlen(name) + 1);
+		out.insert(out.end(), type, type + strlen(type) + 1);
+		WriteLittleEndian<int32_t>(out, (int32_t)data.size());
+		out.insert(out.end(), data.begin(), data.end());
+	}
+
+	bool ImageWriter::WriteEXR(const std::string& filepath, const float* pixels, uint32_t width, uint32_t height)
+	{
+		std::vector<uint8_t> exr;
+		WriteLittleEndian<uint32_t>(exr, 20000630);	//Magic number
+		WriteLittleEndian<uint32_t>(exr, 2);		//Version 2, scanline
+
+		//Channels are stored in alphabetical order
+		const char* channelNames[] = { "A", "B", "G", "R" };
+		const uint32_t channelIndices[] = { 3, 2, 1, 0 };
+		{
+			std::vector<uint8_t> channels;
+			for (const char* name : channelNames)
+			{
+				channels.insert(channels.end(), name, name + 2);
+				WriteLittleEndian<int32_t>(channels, 1);	//HALF
+				WriteLittleEndian<uint32_t>(channels, 0);	//pLinear + reserved
+				WriteLittleEndian<int32_t>(channels, 1);
+				WriteLittleEndian<int32_t>(channels, 1);
+			}
+			channels.push_back(0);
+			WriteAttribute(exr, "channels", "chlist", channels);
+		}
+		WriteAttribute(exr, "compression", "compression", { 0 });
+		{
+			std::vector<uint8_t> window;
+			WriteLittleEndian<int32_t>(window, 0);
+			WriteLittleEndian<int32_t>(window, 0);
+			WriteLittleEndian<int32_t>(window, (int32_t)width - 1);
+			WriteLittleEndian<int32_t>(window, (int32_t)height - 1);
+			WriteAttribute(exr, "dataWindow", "box2i", window);
+			WriteAttribute(exr, "displayWindow", "box2i", window);
+		}
+		WriteAttribute(exr, "lineOrder", "lineOrder", { 0 });
+		{
+			std::vector<uint8_t> value;
+			WriteLittleEndian<float>(value, 1.0f);
+			WriteAttribute(exr, "pixelAspectRatio", "float", value);
+			WriteAttribute(exr, "screenWindowWidth", "float", value);
+		}
+		{
+			std::vector<uint8_t> value;
+			WriteLittleEndian<float>(value, 0.0f);
+			WriteLittleEndian<float>(value, 0.0f);
+			WriteAttribute(exr, "screenWindowCenter", "v2f", value);
+		}
+		exr.push_back(0);
+
+		//Offset table, one uncompressed scanline per block
+		const uint32_t lineSize = width * 4 * sizeof(uint16_t);
+		uint64_t offset = exr.size() + (uint64_t)height * sizeof(uint64_t);
+		for (uint32_t y = 0; y < height; y++)
+		{
+			WriteLittleEndian<uint64_t>(exr, offset);
+			offset += 2 * sizeof(int32_t) + lineSize;
+		}
+
+		for (uint32_t y = 0; y < height; y++)
+		{
+			const float* row = pixels + (size_t)(height - 1 - y) * width * 4;
+			WriteLittleEndian<int32_t>(exr, (int32_t)y);
+			WriteLittleEndian<int32_t>(exr, (int32_t)lineSize);
+			for (uint32_t channel : channelIndices)
+			{
+				for (uint32_t x = 0; x < width; x++)
+					WriteLittleEndian<uint16_t>(exr, glm::packHalf1x16(row[x * 4 + channel]));
+			}
+		}
+
+		std::ofstream out(filepath, std::ios::out | std::ios::binary);
+		if (!out)
+		{
+			ENGINE_ERROR("Could not write image '{0}'", filepath);
+			return false;
+		}
+		out.write((const char*)exr.data(), exr.size());
+		return true;
+	}
+}
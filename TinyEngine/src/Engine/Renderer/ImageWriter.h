@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+#include "Engine/Core/Core.h"
+
+namespace Engine
+{
+	/// <summary>
+	/// Write RGBA32F pixels (as read back from FrameBuffer) to image files.
+	/// Rows are expected bottom-up like OpenGL textures.
+	/// </summary>
+	class ImageWriter
+	{
+	public:
+		/// <summary>
+		/// 8-bit RGBA PNG, values are clamped to [0, 1]
+		/// </summary>
+		static bool WritePNG(const std::string& filepath, const float* pixels, uint32_t width, uint32_t height);
+		/// <summary>
+		/// Uncompressed half float RGBA OpenEXR, keeps HDR values
+		/// </summary>
+		static bool WriteEXR(const std::string& filepath, const float* pixels, uint32_t width, uint32_t height);
+	};
+}
@@ -21,7 +21,7 @@ namespace Engine
 		/// IndexBuffer
 		/// </summary>
 		/// <param name="size">ܳ</param>
-		static Ref<IndexBuffer> IndexBuffer::Create(uint32_t size);
+		static Ref<IndexBuffer> Create(uint32_t size);
 		/// <summary>
 		/// IndexBuffer
 		/// </summary>
@@ -3,6 +3,80 @@
 
 namespace Engine
 {
+    static constexpr ShaderPropertyID s_ViewProjectionProperty("u_ViewProjectionMatrix");
+    static constexpr ShaderPropertyID s_TransformProperty("u_Transform");
+
+    //--------------------------------------------------------------------------------
+    //Layout change helper function
+    //--------------------------------------------------------------------------------
+    /// <summary>
+    /// Call fn(from, to) for uniforms of the previous layout that the current layout has with the same size
+    /// </summary>
+    template<typename Fn>
+    static void ForEachKeptUniform(const std::unordered_map<uint32_t, MaterialUniform>& previous, const std::unordered_map<uint32_t, MaterialUniform>& current, Fn fn)
+    {
+        for (auto& [id, from] : previous)
+        {
+            auto it = current.find(id);
+            if (it != current.end() && it->second.Size == from.Size)
+                fn(from, it->second);
+        }
+    }
+
+    /// <summary>
+    /// Textures indexed by the registers of the current layout
+    /// </summary>
+    static std::vector<Ref<Texture>> MoveTextures(const std::unordered_map<uint32_t, ShaderResource*>& previous, const std::vector<Ref<Texture>>& textures,
+        const std::unordered_map<uint32_t, ShaderResource*>& current)
+    {
+        std::vector<Ref<Texture>> result;
+        for (auto& [id, resource] : previous)
+        {
+            uint32_t slot = resource->GetRegister();
+            auto it = current.find(id);
+            if (slot >= textures.size() || !textures[slot] || it == current.end())
+                continue;
+
+            uint32_t newSlot = it->second->GetRegister();
+            if (result.size() <= newSlot)
+                result.resize((size_t)newSlot + 1);
+            result[newSlot] = textures[slot];
+        }
+        return result;
+    }
+
+    /// <summary>
+    /// Hand the pending values and textures the layout has now to setValue/setTexture and forget them
+    /// </summary>
+    template<typename SetValue, typename SetTexture>
+    static void ApplyPendingProperties(MaterialPendingProperties& pending, const std::unordered_map<uint32_t, MaterialUniform>& uniformLookup,
+        const std::unordered_map<uint32_t, ShaderResource*>& resourceLookup, SetValue setValue, SetTexture setTexture)
+    {
+        for (auto it = pending.Values.begin(); it != pending.Values.end();)
+        {
+            auto uniform = uniformLookup.find(it->first);
+            if (uniform == uniformLookup.end() || it->second.size() < uniform->second.Size)
+            {
+                ++it;
+                continue;
+            }
+            setValue(uniform->second, it->second.data());
+            it = pending.Values.erase(it);
+        }
+
+        for (auto it = pending.Textures.begin(); it != pending.Textures.end();)
+        {
+            auto resource = resourceLookup.find(it->first);
+            if (resource == resourceLookup.end())
+            {
+                ++it;
+                continue;
+            }
+            setTexture(resource->second->GetRegister(), it->second);
+            it = pending.Textures.erase(it);
+        }
+    }
+
     //--------------------------------------------------------------------------------
     //Material
     //--------------------------------------------------------------------------------
@@ -16,24 +90,64 @@ namespace Engine
     {
         m_MaterialFlags |= (uint32_t)MaterialFlag::DepthTest;
 
-        m_Shader->AddShaderReloadedCallback(std::bind(&Material::OnShaderReloaded, this));
+        m_ShaderReloadedCallbackID = m_Shader->AddShaderReloadedCallback(std::bind(&Material::OnShaderReloaded, this));
         AllocateStorage();
     }
 
     Material::~Material()
     {
+        m_Shader->RemoveShaderReloadedCallback(m_ShaderReloadedCallbackID);
     }
 
     void Material::Bind() 
     {
-        m_Shader->Bind();
+        Shader* shader = GetVariant(m_Keywords);
+        shader->Bind();
+        if (!shader->IsReady())
+        {
+            glm::mat4 viewProjection(1.0f), transform(1.0f);
+            TryGet(s_ViewProjectionProperty, viewProjection);
+            TryGet(s_TransformProperty, transform);
+            shader->SetPlaceholderTransforms(viewProjection, transform);
+        }
 
         if (m_VSUniformStorageBuffer)
-            m_Shader->SetVSMaterialUniformBuffer(m_VSUniformStorageBuffer);
+            shader->SetVSMaterialUniformBuffer(m_VSUniformStorageBuffer);
         if (m_PSUniformStorageBuffer)
-            m_Shader->SetPSMaterialUniformBuffer(m_PSUniformStorageBuffer);
+            shader->SetPSMaterialUniformBuffer(m_PSUniformStorageBuffer);
 
-        BindTextures();
+        if (!m_Textures.empty())
+            shader->BindTextures(m_Textures);
+    }
+
+    void Material::SetKeyword(const std::string& keyword, bool enabled)
+    {
+        uint32_t mask = m_Shader->GetKeywordMask(keyword);
+        if (!mask)
+        {
+            MATERIAL_WARN("Shader '{0}' does not declare keyword '{1}'", m_Shader->GetName(), keyword);
+            return;
+        }
+
+        if (enabled)
+            m_Keywords |= mask;
+        else
+            m_Keywords &= ~mask;
+        //Start compiling before the first draw needs it
+        GetVariant(m_Keywords);
+    }
+
+    bool Material::IsKeywordEnabled(const std::string& keyword) const
+    {
+        return m_Keywords & m_Shader->GetKeywordMask(keyword);
+    }
+
+    Shader* Material::GetVariant(uint32_t keywords)
+    {
+        Shader* shader = m_Shader->GetVariant(keywords);
+        if (!shader->IsReady())
+            shader->PollCompile();
+        return shader;
     }
 
     void Material::AllocateStorage()
@@ -50,66 +164,98 @@ namespace Engine
             m_PSUniformStorageBuffer.Allocate(psBuffer.GetSize());
             m_PSUniformStorageBuffer.ZeroInitialize();
         }
+
+        BuildPropertyLookup();
+    }
+
+    void Material::BuildPropertyLookup()
+    {
+        m_UniformLookup.clear();
+        m_ResourceLookup.clear();
+
+        auto addUniforms = [this](const ShaderUniformBuffer& uniformBuffer, ShaderDomain domain)
+        {
+            for (ShaderUniform* uniform : uniformBuffer.GetUniforms())
+            {
+                ShaderPropertyID id(uniform->GetName());
+                ENGINE_ASSERT(m_UniformLookup.find(id.Value) == m_UniformLookup.end(), "Uniform name hash collision!");
+                MaterialUniform& materialUniform = m_UniformLookup[id.Value];
+                materialUniform.Uniform = uniform;
+                materialUniform.Domain = domain;
+                materialUniform.Offset = uniform->GetOffset();
+                materialUniform.Size = uniform->GetSize();
+                materialUniform.Index = (uint32_t)m_UniformLookup.size() - 1;
+            }
+        };
+        if (m_Shader->HasVSMaterialUniformBuffer())
+            addUniforms(m_Shader->GetVSMaterialUniformBuffer(), ShaderDomain::Vertex);
+        if (m_Shader->HasPSMaterialUniformBuffer())
+            addUniforms(m_Shader->GetPSMaterialUniformBuffer(), ShaderDomain::Pixel);
+
+        for (ShaderResource* resource : m_Shader->GetResources())
+        {
+            ShaderPropertyID id(resource->GetName());
+            ENGINE_ASSERT(m_ResourceLookup.find(id.Value) == m_ResourceLookup.end(), "Resource name hash collision!");
+            m_ResourceLookup[id.Value] = resource;
+        }
     }
 
     void Material::OnShaderReloaded()
     {
-        //BUG: ShaderغMaterialInstanceԱգҪǰб沢غָ
-        //Ŀǰֱӷز½зԱ֤Բ䣬ShaderɾԶܲ
-        return;
+        //Properties the new layout does not have are dropped
+        auto uniformLookup = std::move(m_UniformLookup);
+        auto resourceLookup = std::move(m_ResourceLookup);
+        Buffer previousStorage[] = { m_VSUniformStorageBuffer, m_PSUniformStorageBuffer };
+        m_VSUniformStorageBuffer = Buffer();
+        m_PSUniformStorageBuffer = Buffer();
 
         AllocateStorage();
+        ForEachKeptUniform(uniformLookup, m_UniformLookup, [&](const MaterialUniform& from, const MaterialUniform& to)
+            {
+                GetUniformBufferTarget(to.Domain).Write(previousStorage[(int)from.Domain].Data + from.Offset, to.Size, to.Offset);
+            });
+        m_Textures = MoveTextures(resourceLookup, m_Textures, m_ResourceLookup);
+        ApplyPendingProperties(m_PendingProperties, m_UniformLookup, m_ResourceLookup,
+            [this](const MaterialUniform& uniform, uint8_t* value)
+            {
+                GetUniformBufferTarget(uniform.Domain).Write(value, uniform.Size, uniform.Offset);
+            },
+            [this](uint32_t slot, const Ref<Texture>& texture)
+            {
+                if (m_Textures.size() <= slot)
+                    m_Textures.resize((size_t)slot + 1);
+                m_Textures[slot] = texture;
+            });
+
         for (auto mi : m_MaterialInstances)
-            mi->OnShaderReloaded();
+            mi->OnShaderReloaded(uniformLookup, resourceLookup);
+
+        delete[] previousStorage[0].Data;
+        delete[] previousStorage[1].Data;
     }
 
-    void Material::BindTextures()
+    void Material::OnTextureUpdated()
     {
-        for (uint32_t i = 0; i < m_Textures.size(); i++)
-        {
-            auto& texture = m_Textures[i];
-            if (texture)
-                texture->Bind(i);
-        }
+        for (auto mi : m_MaterialInstances)
+            mi->m_TextureTableDirty = true;
     }
 
-    ShaderUniform* Material::FindShaderUniform(const std::string& name)
+
+    ShaderUniform* Material::FindShaderUniform(ShaderPropertyID id)
     {
-        if (m_VSUniformStorageBuffer)
-        {
-            auto& uniforms = m_Shader->GetVSMaterialUniformBuffer().GetUniforms();
-            for (ShaderUniform* uniform : uniforms)
-            {
-                if (uniform->GetName() == name)
-                    return uniform;
-            }
-        }
-        if (m_PSUniformStorageBuffer)
-        {
-            auto& uniforms = m_Shader->GetPSMaterialUniformBuffer().GetUniforms();
-            for (ShaderUniform* uniform : uniforms)
-            {
-                if (uniform->GetName() == name)
-                    return uniform;
-            }
-        }
-        return nullptr;
+        auto uniform = FindMaterialUniform(id);
+        return uniform ? uniform->Uniform : nullptr;
     }
 
-    ShaderResource* Material::FindShaderResource(const std::string& name)
+    ShaderResource* Material::FindShaderResource(ShaderPropertyID id)
     {
-        auto& resources = m_Shader->GetResources();
-        for (ShaderResource* resource : resources)
-        {
-            if (resource->GetName() == name)
-                return resource;
-        }
-        return nullptr;
+        auto it = m_ResourceLookup.find(id.Value);
+        return it != m_ResourceLookup.end() ? it->second : nullptr;
     }
 
-    Buffer& Material::GetUniformBufferTarget(ShaderUniform* uniform)
+    Buffer& Material::GetUniformBufferTarget(ShaderDomain domain)
     {
-        switch (uniform->GetDomain())
+        switch (domain)
         {
         case ShaderDomain::Vertex:    return m_VSUniformStorageBuffer;
         case ShaderDomain::Pixel:     return m_PSUniformStorageBuffer;
@@ -126,6 +272,22 @@ namespace Engine
         return CreateRef<MaterialInstance>(material, name);
     }
 
+    Ref<MaterialInstance> MaterialInstance::Copy(const Ref<MaterialInstance>& other, const std::string& name)
+    {
+        auto instance = CreateRef<MaterialInstance>(other->m_Material, name);
+        //Both follow the layout of the same material, so the storage has the same size
+        if (other->m_VSUniformStorageBuffer)
+            memcpy(instance->m_VSUniformStorageBuffer.Data, other->m_VSUniformStorageBuffer.Data, other->m_VSUniformStorageBuffer.Size);
+        if (other->m_PSUniformStorageBuffer)
+            memcpy(instance->m_PSUniformStorageBuffer.Data, other->m_PSUniformStorageBuffer.Data, other->m_PSUniformStorageBuffer.Size);
+        instance->m_Textures = other->m_Textures;
+        instance->m_OverriddenValues = other->m_OverriddenValues;
+        instance->m_PendingProperties = other->m_PendingProperties;
+        instance->m_Keywords = other->m_Keywords;
+        instance->m_KeywordOverrides = other->m_KeywordOverrides;
+        return instance;
+    }
+
     MaterialInstance::MaterialInstance(const Ref<Material>& material, const std::string& name)
         :m_Name(name), m_Material(material)
     {
@@ -140,20 +302,59 @@ namespace Engine
 
     void MaterialInstance::Bind()
     {
-        m_Material->GetShader()->Bind();
+        Shader* shader = m_Material->GetVariant(GetKeywords());
+        shader->Bind();
+        if (!shader->IsReady())
+        {
+            glm::mat4 viewProjection(1.0f), transform(1.0f);
+            TryGet(s_ViewProjectionProperty, viewProjection);
+            TryGet(s_TransformProperty, transform);
+            shader->SetPlaceholderTransforms(viewProjection, transform);
+        }
 
         if (m_VSUniformStorageBuffer)
-            m_Material->m_Shader->SetVSMaterialUniformBuffer(m_VSUniformStorageBuffer);
+            shader->SetVSMaterialUniformBuffer(m_VSUniformStorageBuffer);
         if (m_PSUniformStorageBuffer)
-            m_Material->m_Shader->SetPSMaterialUniformBuffer(m_PSUniformStorageBuffer);
+            shader->SetPSMaterialUniformBuffer(m_PSUniformStorageBuffer);
+
+        if (m_TextureTableDirty)
+            UpdateTextureTable();
+        if (!m_TextureTable.empty())
+            shader->BindTextures(m_TextureTable);
+    }
 
-        m_Material->BindTextures();
-        for (uint32_t i = 0; i < m_Textures.size(); i++)
+    void MaterialInstance::SetKeyword(const std::string& keyword, bool enabled)
+    {
+        uint32_t mask = m_Material->m_Shader->GetKeywordMask(keyword);
+        if (!mask)
         {
-            auto& texture = m_Textures[i];
-            if (texture)
-                texture->Bind(i);
+            MATERIAL_WARN("Material: Shader '{0}' does not declare keyword '{1}'", m_Material->GetShader()->GetName(), keyword);
+            return;
         }
+
+        m_KeywordOverrides |= mask;
+        if (enabled)
+            m_Keywords |= mask;
+        else
+            m_Keywords &= ~mask;
+        m_Material->GetVariant(GetKeywords());
+    }
+
+    bool MaterialInstance::IsKeywordEnabled(const std::string& keyword) const
+    {
+        return GetKeywords() & m_Material->m_Shader->GetKeywordMask(keyword);
+    }
+
+    uint32_t MaterialInstance::GetKeywords() const
+    {
+        return (m_Material->m_Keywords & ~m_KeywordOverrides) | (m_Keywords & m_KeywordOverrides);
+    }
+
+    const std::vector<Ref<Texture>>& MaterialInstance::GetTextureTable()
+    {
+        if (m_TextureTableDirty)
+            UpdateTextureTable();
+        return m_TextureTable;
     }
 
     void MaterialInstance::SetFlag(MaterialFlag flag, bool value)
@@ -182,27 +383,99 @@ namespace Engine
             m_PSUniformStorageBuffer.Allocate(psBuffer.GetSize());
             memcpy(m_PSUniformStorageBuffer.Data, m_Material->m_PSUniformStorageBuffer.Data, psBuffer.GetSize());
         }
+
+        m_OverriddenValues.assign((m_Material->GetUniformCount() + 63) / 64, 0);
     }
 
-    void MaterialInstance::OnShaderReloaded()
+    void MaterialInstance::OnShaderReloaded(const std::unordered_map<uint32_t, MaterialUniform>& uniformLookup, const std::unordered_map<uint32_t, ShaderResource*>& resourceLookup)
     {
+        //Values the instance does not override are copied from the material again
+        Buffer previousStorage[] = { m_VSUniformStorageBuffer, m_PSUniformStorageBuffer };
+        auto overriddenValues = std::move(m_OverriddenValues);
+        m_VSUniformStorageBuffer = Buffer();
+        m_PSUniformStorageBuffer = Buffer();
+
         AllocateStorage();
-        m_OverriddenValues.clear();
+        ForEachKeptUniform(uniformLookup, m_Material->m_UniformLookup, [&](const MaterialUniform& from, const MaterialUniform& to)
+            {
+                if (!(overriddenValues[from.Index / 64] & (1ull << (from.Index % 64))))
+                    return;
+                GetUniformBufferTarget(to.Domain).Write(previousStorage[(int)from.Domain].Data + from.Offset, to.Size, to.Offset);
+                m_OverriddenValues[to.Index / 64] |= 1ull << (to.Index % 64);
+            });
+        m_Textures = MoveTextures(resourceLookup, m_Textures, m_Material->m_ResourceLookup);
+        ApplyPendingProperties(m_PendingProperties, m_Material->m_UniformLookup, m_Material->m_ResourceLookup,
+            [this](const MaterialUniform& uniform, uint8_t* value)
+            {
+                GetUniformBufferTarget(uniform.Domain).Write(value, uniform.Size, uniform.Offset);
+                m_OverriddenValues[uniform.Index / 64] |= 1ull << (uniform.Index % 64);
+            },
+            [this](uint32_t slot, const Ref<Texture>& texture)
+            {
+                if (m_Textures.size() <= slot)
+                    m_Textures.resize((size_t)slot + 1);
+                m_Textures[slot] = texture;
+            });
+        m_TextureTableDirty = true;
+
+        delete[] previousStorage[0].Data;
+        delete[] previousStorage[1].Data;
+    }
+
+    void MaterialInstance::SetData(ShaderPropertyID id, const uint8_t* data, uint32_t size)
+    {
+        auto uniform = m_Material->FindMaterialUniform(id);
+        if (!uniform)
+        {
+            m_PendingProperties.Values[id.Value].assign(data, data + size);
+            return;
+        }
+        if (size != uniform->Size)
+        {
+            MATERIAL_WARN("Material: Value of '{0}' has {1} bytes, the uniform has {2}", uniform->Uniform->GetName(), size, uniform->Size);
+            return;
+        }
+        GetUniformBufferTarget(uniform->Domain).Write((uint8_t*)data, size, uniform->Offset);
+        m_OverriddenValues[uniform->Index / 64] |= 1ull << (uniform->Index % 64);
+    }
+
+    void MaterialInstance::ForEachOverriddenValue(const std::function<void(const std::string& name, const uint8_t* data, uint32_t size)>& func)
+    {
+        for (const auto& [id, uniform] : m_Material->m_UniformLookup)
+        {
+            if (!(m_OverriddenValues[uniform.Index / 64] & (1ull << (uniform.Index % 64))))
+                continue;
+            func(uniform.Uniform->GetName(), GetUniformBufferTarget(uniform.Domain).Data + uniform.Offset, uniform.Size);
+        }
+    }
+
+    void MaterialInstance::OnMaterialValueUpdated(const MaterialUniform& uniform)
+    {
+        if (!(m_OverriddenValues[uniform.Index / 64] & (1ull << (uniform.Index % 64))))
+        {
+            auto& buffer = GetUniformBufferTarget(uniform.Domain);
+            auto& materialBuffer = m_Material->GetUniformBufferTarget(uniform.Domain);
+            buffer.Write(materialBuffer.Data + uniform.Offset, uniform.Size, uniform.Offset);
+        }
     }
 
-    void MaterialInstance::OnMaterialValueUpdated(ShaderUniform* uniform)
+    void MaterialInstance::UpdateTextureTable()
     {
-        if (m_OverriddenValues.find(uniform->GetName()) == m_OverriddenValues.end())
+        const auto& materialTextures = m_Material->m_Textures;
+        m_TextureTable.assign(std::max(materialTextures.size(), m_Textures.size()), nullptr);
+        for (uint32_t i = 0; i < m_TextureTable.size(); i++)
         {
-            auto& buffer = GetUniformBufferTarget(uniform);
-            auto& materialBuffer = m_Material->GetUniformBufferTarget(uniform);
-            buffer.Write(materialBuffer.Data + uniform->GetOffset(), uniform->GetSize(), uniform->GetOffset());
+            if (i < m_Textures.size() && m_Textures[i])
+                m_TextureTable[i] = m_Textures[i];
+            else if (i < materialTextures.size())
+                m_TextureTable[i] = materialTextures[i];
         }
+        m_TextureTableDirty = false;
     }
 
-    Buffer& MaterialInstance::GetUniformBufferTarget(ShaderUniform* uniform)
+    Buffer& MaterialInstance::GetUniformBufferTarget(ShaderDomain domain)
     {
-        switch (uniform->GetDomain())
+        switch (domain)
         {
         case ShaderDomain::Vertex:    return m_VSUniformStorageBuffer;
         case ShaderDomain::Pixel:     return m_PSUniformStorageBuffer;
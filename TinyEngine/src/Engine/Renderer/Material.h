@@ -6,6 +6,7 @@
 #include "Engine/Renderer/Texture.h"
 #include "Engine/Asset/Asset.h"
 #include <unordered_set>
+#include <unordered_map>
 
 namespace Engine
 {
@@ -24,6 +25,51 @@ namespace Engine
 		TwoSided	= BIT(3)
 	};
 
+	/// <summary>
+	/// Uniform layout resolved once per shader. Index addresses the per-uniform override bits of MaterialInstance.
+	/// </summary>
+	struct MaterialUniform
+	{
+		ShaderUniform* Uniform;
+		ShaderDomain Domain;
+		uint32_t Offset;
+		uint32_t Size;
+		uint32_t Index;
+	};
+
+	/// <summary>
+	/// Values set before the shader layout has the property, e.g. while the shader or the variant using it is still compiling.
+	/// Moved into storage when the layout changes.
+	/// </summary>
+	struct MaterialPendingProperties
+	{
+		std::unordered_map<uint32_t, std::vector<uint8_t>> Values;
+		std::unordered_map<uint32_t, Ref<Texture>> Textures;
+
+		template<typename T>
+		T& Get(ShaderPropertyID id)
+		{
+			auto& value = Values[id.Value];
+			if (value.size() < sizeof(T))
+				value.resize(sizeof(T));
+			return *(T*)value.data();
+		}
+		template<typename T>
+		const T* Find(ShaderPropertyID id) const
+		{
+			auto it = Values.find(id.Value);
+			return it != Values.end() && it->second.size() >= sizeof(T) ? (const T*)it->second.data() : nullptr;
+		}
+		template<typename T>
+		Ref<T> GetTexture(ShaderPropertyID id) const
+		{
+			auto it = Textures.find(id.Value);
+			return it != Textures.end() ? std::dynamic_pointer_cast<T>(it->second) : nullptr;
+		}
+	};
+
+	class MaterialInstance;
+
 	/// <summary>
 	/// Material
 	/// </summary>
@@ -43,79 +89,124 @@ namespace Engine
 		uint32_t GetFlags() const { return m_MaterialFlags; }
 		void SetFlags(MaterialFlag flag) { m_MaterialFlags |= (uint32_t)flag; }
 
+		/// <summary>
+		/// Enable a '#pragma variant' keyword of the shader. Bind uses the shader variant compiled for the enabled keywords.
+		/// </summary>
+		void SetKeyword(const std::string& keyword, bool enabled = true);
+		bool IsKeywordEnabled(const std::string& keyword) const;
+		uint32_t GetKeywords() const { return m_Keywords; }
+
 		Ref<Shader> GetShader() { return m_Shader; }
 
 		//Set material values
 		template<typename T>
-		void Set(const std::string& name, const T& value)
+		void Set(ShaderPropertyID id, const T& value)
 		{
-			auto uniform = FindShaderUniform(name);
+			auto uniform = FindMaterialUniform(id);
 			if(!uniform)
 			{
-				MATERIAL_WARN("Conld not find uniform '{0}' in shader '{1}'!", name, m_Name);
+				MATERIAL_WARN("Could not find uniform '{0}' in shader '{1}'!", id.ToString(), m_Name);
+				m_PendingProperties.Get<T>(id) = value;
 				return;
 			}
-			auto& buffer = GetUniformBufferTarget(uniform);
-			buffer.Write((uint8_t*)&value, uniform->GetSize(), uniform->GetOffset());
+			auto& buffer = GetUniformBufferTarget(uniform->Domain);
+			buffer.Write((uint8_t*)&value, uniform->Size, uniform->Offset);
 
 			for (auto mi : m_MaterialInstances)
-				mi->OnMaterialValueUpdated(uniform);
+				mi->OnMaterialValueUpdated(*uniform);
 		}
-		void Set(const std::string& name, const Ref<Texture>& texture)
+		void Set(ShaderPropertyID id, const Ref<Texture>& texture)
 		{
-			auto resource = FindShaderResource(name);
+			auto resource = FindShaderResource(id);
 			if (!resource)
 			{
-				MATERIAL_WARN("Conld not find uniform '{0}' in shader '{1}'!", name, m_Name);
+				MATERIAL_WARN("Could not find uniform '{0}' in shader '{1}'!", id.ToString(), m_Name);
+				m_PendingProperties.Textures[id.Value] = texture;
 				return;
 			}
 			uint32_t slot = resource->GetRegister();
 			if (m_Textures.size() <= slot)
 				m_Textures.resize((size_t)slot + 1);
+			if (m_Textures[slot] == texture)
+				return;
 			m_Textures[slot] = texture;
+			OnTextureUpdated();
 		}
-		void Set(const std::string& name, const Ref<Texture2D>& texture)
+		void Set(ShaderPropertyID id, const Ref<Texture2D>& texture)
 		{
-			Set(name, (const Ref<Texture>&)texture);
+			Set(id, (const Ref<Texture>&)texture);
 		}
-		void Set(const std::string& name, const Ref<TextureCube>& texture)
+		void Set(ShaderPropertyID id, const Ref<TextureCube>& texture)
 		{
-			Set(name, (const Ref<Texture>&)texture);
+			Set(id, (const Ref<Texture>&)texture);
 		}
 
 		//Get material values
 		template<typename T>
-		T& Get(const std::string& name)
+		T& Get(ShaderPropertyID id)
+		{
+			auto uniform = FindMaterialUniform(id);
+			if (!uniform)
+				return m_PendingProperties.Get<T>(id);
+			auto& buffer = GetUniformBufferTarget(uniform->Domain);
+			return buffer.Read<T>(uniform->Offset);
+		}
+		/// <summary>
+		/// Copy the value if it was set, without adding a pending entry for it.
+		/// </summary>
+		template<typename T>
+		bool TryGet(ShaderPropertyID id, T& value)
 		{
-			auto uniform = FindShaderUniform(name);
-			ENGINE_ASSERT(uniform, "Conld not find uniform in shader!");
-			auto& buffer = GetUniformBufferTarget(uniform);
-			return buffer.Read<T>(uniform->GetOffset());
+			if (auto uniform = FindMaterialUniform(id))
+			{
+				value = GetUniformBufferTarget(uniform->Domain).Read<T>(uniform->Offset);
+				return true;
+			}
+			if (const T* pending = m_PendingProperties.Find<T>(id))
+			{
+				value = *pending;
+				return true;
+			}
+			return false;
 		}
 		template<typename T>
-		Ref<T> GetResource(const std::string& name)
+		Ref<T> GetResource(ShaderPropertyID id)
 		{
-			auto resource = FindShaderResource(name);
-			ENGINE_ASSERT(resource, "Conld not find uniform in shader!");
+			auto resource = FindShaderResource(id);
+			if (!resource)
+				return m_PendingProperties.GetTexture<T>(id);
 			uint32_t slot = resource->GetRegister();
 			ENGINE_ASSERT(slot < m_Textures.size(), "Texture slot is invalid!");
 			return std::dynamic_pointer_cast<T>(m_Textures[slot]);
 		}
 
-		ShaderUniform* FindShaderUniform(const std::string& name);
-		ShaderResource* FindShaderResource(const std::string& name);
+		ShaderUniform* FindShaderUniform(ShaderPropertyID id);
+		ShaderResource* FindShaderResource(ShaderPropertyID id);
+		const MaterialUniform* FindMaterialUniform(ShaderPropertyID id) const
+		{
+			auto it = m_UniformLookup.find(id.Value);
+			return it != m_UniformLookup.end() ? &it->second : nullptr;
+		}
+		uint32_t GetUniformCount() const { return (uint32_t)m_UniformLookup.size(); }
 
 	private:
 		void AllocateStorage();
+		void BuildPropertyLookup();
+		/// <summary>
+		/// Move values and textures to the new shader layout
+		/// </summary>
 		void OnShaderReloaded();
-		void BindTextures();
+		void OnTextureUpdated();
+		Shader* GetVariant(uint32_t keywords);
 
-		Buffer& GetUniformBufferTarget(ShaderUniform* uniform);
+		Buffer& GetUniformBufferTarget(ShaderDomain domain);
 
 	private:
 		std::string m_Name;
 		Ref<Shader> m_Shader;
+		uint32_t m_ShaderReloadedCallbackID = 0;
 		uint32_t m_MaterialFlags;
+		uint32_t m_Keywords = 0;
 
 		//MaterialӵеMaterialInstance
 		std::unordered_set<MaterialInstance*> m_MaterialInstances;
@@ -124,6 +215,11 @@ namespace Engine
 		Buffer m_VSUniformStorageBuffer;
 		Buffer m_PSUniformStorageBuffer;
 		std::vector<Ref<Texture>> m_Textures;
+
+		//Property handle -> uniform layout / resource
+		std::unordered_map<uint32_t, MaterialUniform> m_UniformLookup;
+		std::unordered_map<uint32_t, ShaderResource*> m_ResourceLookup;
+		MaterialPendingProperties m_PendingProperties;
 	};
 
 	/// <summary>
@@ -135,6 +231,10 @@ namespace Engine
 
 	public:
 		static Ref<MaterialInstance> Create(const Ref<Material>& material, const std::string& name = "MaterialInstance");
+		/// <summary>
+		/// New instance of the same material with the values, textures and keywords of other.
+		/// </summary>
+		static Ref<MaterialInstance> Copy(const Ref<MaterialInstance>& other, const std::string& name);
 
 		MaterialInstance(const Ref<Material>& material, const std::string& name = "MaterialInstance");
 		virtual ~MaterialInstance();
@@ -147,80 +247,128 @@ namespace Engine
 		bool GetFlag(MaterialFlag flag) const { return (uint32_t)flag & m_Material->GetFlags(); }
 		void SetFlag(MaterialFlag flag, bool value = true);
 
+		/// <summary>
+		/// Override a keyword of the material for this instance only.
+		/// </summary>
+		void SetKeyword(const std::string& keyword, bool enabled = true);
+		bool IsKeywordEnabled(const std::string& keyword) const;
+		uint32_t GetKeywords() const;
+
 		//Set material instance values
 		template <typename T>
-		void Set(const std::string& name, const T& value)
+		void Set(ShaderPropertyID id, const T& value)
 		{
-			auto uniform = m_Material->FindShaderUniform(name);
-			//ENGINE_ASSERT(uniform, "Conld not find uniform in shader!");
+			auto uniform = m_Material->FindMaterialUniform(id);
+			//ENGINE_ASSERT(uniform, "Could not find uniform in shader!");
 			if (!uniform) 
 			{
-				MATERIAL_WARN("Material: Shader '{0}' does not have uniform '{1}'", m_Material->GetShader()->GetName(), name);
+				MATERIAL_WARN("Material: Shader '{0}' does not have uniform '{1}'", m_Material->GetShader()->GetName(), id.ToString());
+				m_PendingProperties.Get<T>(id) = value;
 				return;
 			}
-			auto& buffer = GetUniformBufferTarget(uniform);
-			buffer.Write((uint8_t*)&value, uniform->GetSize(), uniform->GetOffset());
+			auto& buffer = GetUniformBufferTarget(uniform->Domain);
+			buffer.Write((uint8_t*)&value, uniform->Size, uniform->Offset);
 
-			m_OverriddenValues.insert(name);
+			m_OverriddenValues[uniform->Index / 64] |= 1ull << (uniform->Index % 64);
 		}
-		void Set(const std::string& name, const Ref<Texture>& texture)
+		void Set(ShaderPropertyID id, const Ref<Texture>& texture)
 		{
-			auto resource = m_Material->FindShaderResource(name);
-			//ENGINE_ASSERT(resource, "Conld not find uniform in shader!");
+			auto resource = m_Material->FindShaderResource(id);
+			//ENGINE_ASSERT(resource, "Could not find uniform in shader!");
 			if (!resource)
 			{
-				MATERIAL_WARN("Material: Shader '{0}' does not have resource '{1}'", m_Material->GetShader()->GetName(), name);
+				MATERIAL_WARN("Material: Shader '{0}' does not have resource '{1}'", m_Material->GetShader()->GetName(), id.ToString());
+				m_PendingProperties.Textures[id.Value] = texture;
 				return;
 			}
 			uint32_t slot = resource->GetRegister();
 			if (m_Textures.size() <= slot)
 				m_Textures.resize((size_t)slot + 1);
 			m_Textures[slot] = texture;
+			m_TextureTableDirty = true;
 		}
-		void Set(const std::string& name, const Ref<Texture2D>& texture)
+		void Set(ShaderPropertyID id, const Ref<Texture2D>& texture)
 		{
-			Set(name, (const Ref<Texture>&)texture);
+			Set(id, (const Ref<Texture>&)texture);
 		}
-		void Set(const std::string& name, const Ref<TextureCube>& texture)
+		void Set(ShaderPropertyID id, const Ref<TextureCube>& texture)
 		{
-			Set(name, (const Ref<Texture>&)texture);
+			Set(id, (const Ref<Texture>&)texture);
 		}
 
 		//Get material instance values
 		template<typename T>
-		T& Get(const std::string& name)
+		T& Get(ShaderPropertyID id)
+		{
+			auto uniform = m_Material->FindMaterialUniform(id);
+			if (!uniform)
+				return m_PendingProperties.Get<T>(id);
+			auto& buffer = GetUniformBufferTarget(uniform->Domain);
+			return buffer.Read<T>(uniform->Offset);
+		}
+		/// <summary>
+		/// Copy the value if the instance or its material set it, without adding a pending entry for it.
+		/// </summary>
+		template<typename T>
+		bool TryGet(ShaderPropertyID id, T& value)
 		{
-			auto uniform = m_Material->FindShaderUniform(name);
-			ENGINE_ASSERT(uniform, "Conld not find uniform in shader!");
-			auto& buffer = GetUniformBufferTarget(uniform);
-			return buffer.Read<T>(uniform->GetOffset());
+			if (auto uniform = m_Material->FindMaterialUniform(id))
+			{
+				value = GetUniformBufferTarget(uniform->Domain).Read<T>(uniform->Offset);
+				return true;
+			}
+			if (const T* pending = m_PendingProperties.Find<T>(id))
+			{
+				value = *pending;
+				return true;
+			}
+			return m_Material->TryGet(id, value);
 		}
 		template<typename T>
-		Ref<T> GetResource(const std::string& name)
+		Ref<T> GetResource(ShaderPropertyID id)
 		{
-			auto resource = m_Material->FindShaderResource(name);
-			ENGINE_ASSERT(resource, "Conld not find uniform in shader!");
+			auto resource = m_Material->FindShaderResource(id);
+			if (!resource)
+				return m_PendingProperties.GetTexture<T>(id);
 			uint32_t slot = resource->GetRegister();
 			ENGINE_ASSERT(slot < m_Textures.size(), "Texture slot is invalid!");
 			return std::dynamic_pointer_cast<T>(m_Textures[slot]);
 		}
 		template<typename T>
-		Ref<T> TryGetResource(const std::string& name)
+		Ref<T> TryGetResource(ShaderPropertyID id)
 		{
-			auto resource = m_Material->FindShaderResource(name);
+			auto resource = m_Material->FindShaderResource(id);
 			if (!resource)
-				return nullptr;
+				return m_PendingProperties.GetTexture<T>(id);
 			uint32_t slot = resource->GetRegister();
 			if (slot >= m_Textures.size())
 				return nullptr;
 			return std::dynamic_pointer_cast<T>(m_Textures[slot]);
 		}
 
+		/// <summary>
+		/// Set a value from raw bytes, for callers that do not know the uniform type, e.g. the scene serializer.
+		/// </summary>
+		void SetData(ShaderPropertyID id, const uint8_t* data, uint32_t size);
+		/// <summary>
+		/// Call func with the name and raw bytes of every value the instance overrides.
+		/// </summary>
+		void ForEachOverriddenValue(const std::function<void(const std::string& name, const uint8_t* data, uint32_t size)>& func);
+
+		/// <summary>
+		/// Textures bound by slot, instance textures override the material's.
+		/// </summary>
+		const std::vector<Ref<Texture>>& GetTextureTable();
+
 	private:
 		void AllocateStorage();
-		void OnShaderReloaded();
-		void OnMaterialValueUpdated(ShaderUniform* uniform);
-		Buffer& GetUniformBufferTarget(ShaderUniform* uniform);
+		/// <summary>
+		/// Move overridden values and textures from the previous layout of the material
+		/// </summary>
+		void OnShaderReloaded(const std::unordered_map<uint32_t, MaterialUniform>& uniformLookup, const std::unordered_map<uint32_t, ShaderResource*>& resourceLookup);
+		void OnMaterialValueUpdated(const MaterialUniform& uniform);
+		void UpdateTextureTable();
+		Buffer& GetUniformBufferTarget(ShaderDomain domain);
 
 	private:
 		std::string m_Name;
@@ -231,8 +379,16 @@ namespace Engine
 		Buffer m_VSUniformStorageBuffer;
 		Buffer m_PSUniformStorageBuffer;
 		std::vector<Ref<Texture>> m_Textures;
+		//Material textures overridden by instance textures, rebuilt when either changes
+		std::vector<Ref<Texture>> m_TextureTable;
+		bool m_TextureTableDirty = true;
+
+		//One bit per MaterialUniform::Index, set when the instance overrides the material value
+		std::vector<uint64_t> m_OverriddenValues;
+		MaterialPendingProperties m_PendingProperties;
 
-		// TODO: This is temporary; come up with a proper system to track overrides
-		std::unordered_set<std::string> m_OverriddenValues;
+		//Keywords in m_KeywordOverrides are taken from m_Keywords instead of the material
+		uint32_t m_Keywords = 0;
+		uint32_t m_KeywordOverrides = 0;
 	};
 }
\ No newline at end of file
@@ -4,10 +4,17 @@
 #include "Engine/Renderer/IndexBuffer.h"
 #include "Engine/Renderer/Renderer.h"
 #include "Engine/Asset/AssetManager.h"
+#include "Engine/Renderer/MeshCache.h"
+#include "Engine/Renderer/MeshOptimizer.h"
+#include "Engine/Renderer/Meshlet.h"
 
 #include <filesystem>
 #include <locale>
 #include <codecvt>
+#include <mutex>
+#include <unordered_set>
+
+#include <glm/gtc/packing.hpp>
 
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
@@ -28,17 +35,107 @@ namespace Engine
         return result;
     }
 
+    static float CalculateUVDensity(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, uint32_t baseVertex, uint32_t firstTriangle, uint32_t triangleCount)
+    {
+        //Both areas are doubled, which cancels out
+        float surfaceArea = 0.0f;
+        float uvArea = 0.0f;
+        for (uint32_t i = firstTriangle; i < firstTriangle + triangleCount; i++)
+        {
+            const Vertex& v0 = vertices[baseVertex + indices[i].V1];
+            const Vertex& v1 = vertices[baseVertex + indices[i].V2];
+            const Vertex& v2 = vertices[baseVertex + indices[i].V3];
+            surfaceArea += glm::length(glm::cross(v1.Position - v0.Position, v2.Position - v0.Position));
+
+            glm::vec2 e1 = v1.Texcoord - v0.Texcoord;
+            glm::vec2 e2 = v2.Texcoord - v0.Texcoord;
+            uvArea += glm::abs(e1.x * e2.y - e1.y * e2.x);
+        }
+        return surfaceArea > 0.0f && uvArea > 0.0f ? glm::sqrt(uvArea / surfaceArea) : 0.0f;
+    }
+
+    static glm::vec2 OctahedralEncode(const glm::vec3& normal)
+    {
+        float sum = glm::abs(normal.x) + glm::abs(normal.y) + glm::abs(normal.z);
+        if (sum == 0.0f)
+            return glm::vec2(0.0f);
+
+        //Project on the octahedron and fold the lower half over the diagonals
+        glm::vec2 result = glm::vec2(normal.x, normal.y) / sum;
+        if (normal.z < 0.0f)
+        {
+            glm::vec2 sign = { result.x >= 0.0f ? 1.0f : -1.0f, result.y >= 0.0f ? 1.0f : -1.0f };
+            result = (1.0f - glm::abs(glm::vec2(result.y, result.x))) * sign;
+        }
+        return result;
+    }
+
+    static PackedVertex PackVertex(const Vertex& vertex)
+    {
+        PackedVertex packed;
+        packed.Position = vertex.Position;
+        packed.Normal = glm::packSnorm2x16(OctahedralEncode(vertex.Normal));
+        float sign = glm::dot(glm::cross(vertex.Normal, vertex.Tangent), vertex.Binormal) < 0.0f ? -1.0f : 1.0f;
+        packed.Tangent = glm::packSnorm3x10_1x2(glm::vec4(vertex.Tangent, sign));
+        packed.Texcoord = glm::packHalf2x16(vertex.Texcoord);
+        return packed;
+    }
+
+    /// <summary>
+    /// Advance cursor to the last key at or before time. Frames are sampled in order, so the search resumes from there.
+    /// </summary>
+    template<typename Key>
+    static uint32_t FindKey(const Key* keys, uint32_t count, double time, uint32_t cursor)
+    {
+        while (cursor + 1 < count && keys[cursor + 1].mTime <= time)
+            cursor++;
+        return cursor;
+    }
+
+    static glm::vec3 SampleVectorKeys(const aiVectorKey* keys, uint32_t count, double time, uint32_t& cursor, const glm::vec3& defaultValue)
+    {
+        if (count == 0)
+            return defaultValue;
+
+        cursor = FindKey(keys, count, time, cursor);
+        const aiVectorKey& a = keys[cursor];
+        const aiVectorKey& b = keys[glm::min(cursor + 1, count - 1)];
+        float t = b.mTime > a.mTime ? (float)glm::clamp((time - a.mTime) / (b.mTime - a.mTime), 0.0, 1.0) : 0.0f;
+        aiVector3D value = a.mValue + (b.mValue - a.mValue) * t;
+        return { value.x, value.y, value.z };
+    }
+
+    static glm::vec4 SampleQuatKeys(const aiQuatKey* keys, uint32_t count, double time, uint32_t& cursor, const glm::vec4& defaultValue)
+    {
+        if (count == 0)
+            return defaultValue;
+
+        cursor = FindKey(keys, count, time, cursor);
+        const aiQuatKey& a = keys[cursor];
+        const aiQuatKey& b = keys[glm::min(cursor + 1, count - 1)];
+        float t = b.mTime > a.mTime ? (float)glm::clamp((time - a.mTime) / (b.mTime - a.mTime), 0.0, 1.0) : 0.0f;
+        aiQuaternion value;
+        aiQuaternion::Interpolate(value, a.mValue, b.mValue, t);
+        value.Normalize();
+        return { value.x, value.y, value.z, value.w };
+    }
+
     const std::string Mesh::m_InitShaderName = "PBR";
 
     struct LogStream : public Assimp::LogStream
     {
         static void Initialize()
         {
-            if (Assimp::DefaultLogger::isNullLogger())
-            {
-                Assimp::DefaultLogger::create("", Assimp::Logger::VERBOSE);
-                Assimp::DefaultLogger::get()->attachStream(new LogStream, Assimp::Logger::Err | Assimp::Logger::Warn);
-            }
+            //Meshes may be imported on several worker threads at once
+            static std::once_flag once;
+            std::call_once(once, []()
+                {
+                    if (Assimp::DefaultLogger::isNullLogger())
+                    {
+                        Assimp::DefaultLogger::create("", Assimp::Logger::VERBOSE);
+                        Assimp::DefaultLogger::get()->attachStream(new LogStream, Assimp::Logger::Err | Assimp::Logger::Warn);
+                    }
+                });
         }
 
         virtual void write(const char* message) override
@@ -47,58 +144,207 @@ namespace Engine
         }
     };
 
+    const char* MeshRetentionToString(MeshRetention retention)
+    {
+        switch (retention)
+        {
+        case MeshRetention::GPUOnly:                    return "GPUOnly";
+        case MeshRetention::KeepPositionsForQueries:    return "KeepPositionsForQueries";
+        case MeshRetention::KeepAll:                    return "KeepAll";
+        }
+        return "Unknown";
+    }
+
     //-----------------------------------------------------------------------------------
     //Mesh
     //-----------------------------------------------------------------------------------
-    Ref<Mesh> Mesh::Create(const std::string& filename)
+    static MeshRetention s_DefaultRetention = MeshRetention::GPUOnly;
+
+    Ref<Mesh> Mesh::Create(const std::string& filename, MeshRetention retention)
+    {
+        return CreateRef<Mesh>(filename, retention);
+    }
+
+    Ref<Mesh> Mesh::Create(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, const glm::mat4& transform, MeshRetention retention)
     {
-        return CreateRef<Mesh>(filename);
+        return CreateRef<Mesh>(vertices, indices, transform, retention);
     }
 
-    Ref<Mesh> Mesh::Create(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, const glm::mat4& transform)
+    Ref<Mesh> Mesh::LoadGeometry(const std::string& filename, MeshRetention retention)
     {
-        return CreateRef<Mesh>(vertices, indices, transform);
+        //The default constructor is private, so no CreateRef
+        Ref<Mesh> mesh(new Mesh());
+        mesh->m_FilePath = filename;
+        mesh->m_Retention = retention;
+        mesh->LoadFile();
+        return mesh;
     }
 
-    Mesh::Mesh(const std::string& filename)
-        :m_FilePath(filename)
+    void Mesh::SetDefaultRetention(MeshRetention retention)
+    {
+        s_DefaultRetention = retention;
+    }
+
+    MeshRetention Mesh::GetDefaultRetention()
+    {
+        return s_DefaultRetention;
+    }
+
+    Mesh::Mesh(const std::string& filename, MeshRetention retention)
+        :m_FilePath(filename), m_Retention(retention)
     {
         //BUG: ַȡ
 
-        MESH_INFO("Mesh: Loading mesh '{0}'", filename);
+        LoadFile();
+        FinishLoading();
+    }
+
+    bool Mesh::LoadFile()
+    {
+        MESH_INFO("Mesh: Loading mesh '{0}'", m_FilePath);
+
+        //Imports are cached as .tmesh, Assimp only runs when the source is newer than the cache
+        std::string cachePath = MeshCache::GetCachePath(m_FilePath);
+        if (!MeshCache::IsCacheValid(m_FilePath, cachePath) || !LoadCache(cachePath, m_PendingMaterials))
+        {
+            if (!Import(m_PendingMaterials))
+                return false;
+
+            PackGeometry(m_PendingVertexStream, m_PendingIndexStream);
+            ExtractPositions();
+            //Cached with the geometry, a cache hit does not rebuild them
+            BuildMeshlets();
+            //The cache has no skeleton or clips, animated meshes are imported every time
+            if (!IsAnimated())
+                MeshCache::Write(cachePath, m_StaticVertices, m_Indices, m_PendingVertexStream, m_PendingIndexStream, m_Meshlets, m_Submeshes, m_PendingMaterials);
+
+            //Everything after this reads only the positions
+            if (m_Retention != MeshRetention::KeepAll)
+                std::vector<Vertex>().swap(m_StaticVertices);
+        }
+
+        BuildBVHs();
+        return true;
+    }
+
+    void Mesh::FinishLoading()
+    {
+        //Failed to load, or finished already
+        if (m_Submeshes.empty() || m_VertexArray)
+            return;
+
+        //The buffers copy the streams until the render thread uploads them
+        m_VertexBuffer = VertexBuffer::Create(m_PendingVertexStream.data(), (uint32_t)m_PendingVertexStream.size());
+        m_IndexBuffer = IndexBuffer::Create(m_PendingIndexStream.data(), (uint32_t)m_PendingIndexStream.size());
+        std::vector<uint8_t>().swap(m_PendingVertexStream);
+        std::vector<uint8_t>().swap(m_PendingIndexStream);
+        if (!m_Influences.empty())
+            m_InfluenceBuffer = VertexBuffer::Create(m_Influences.data(), (uint32_t)(m_Influences.size() * sizeof(VertexInfluence)));
+        if (!m_Meshlets.empty())
+            m_MeshletBuffer = VertexBuffer::Create(m_Meshlets.data(), (uint32_t)(m_Meshlets.size() * sizeof(Meshlet)));
+
+        m_MeshShader = Renderer::GetShaderLibrary().Get(m_InitShaderName);
+        m_BaseMaterial = Material::Create(m_MeshShader);
+        m_BaseMaterial->SetFlags(MaterialFlag::DepthTest);
+        CreateMaterials(m_PendingMaterials);
+        std::vector<MeshMaterialDescription>().swap(m_PendingMaterials);
+
+        m_VertexArray = VertexArray::Create();
+        m_BaseVertexLayout = GetVertexLayout();
+
+        ReleaseGeometry();
+    }
+
+    const VertexBufferLayout& Mesh::GetVertexLayout()
+    {
+#if MESH_PACKED_VERTICES
+        static const VertexBufferLayout layout = {
+            { ShaderDataType::Float3, "a_Position" },
+            { ShaderDataType::Short2, "a_Normal", true },
+            { ShaderDataType::Int1010102, "a_Tangent", true },
+            { ShaderDataType::Half2, "a_TexCoord" },
+        };
+#else
+        static const VertexBufferLayout layout = {
+            { ShaderDataType::Float3, "a_Position" },
+            { ShaderDataType::Float3, "a_Normal" },
+            { ShaderDataType::Float3, "a_Tangent" },
+            { ShaderDataType::Float3, "a_Binormal" },
+            { ShaderDataType::Float2, "a_TexCoord" },
+        };
+#endif
+        return layout;
+    }
+
+    void Mesh::PackGeometry(std::vector<uint8_t>& vertexStream, std::vector<uint8_t>& indexStream)
+    {
+#if MESH_PACKED_VERTICES
+        vertexStream.resize(m_StaticVertices.size() * sizeof(PackedVertex));
+        PackedVertex* packed = (PackedVertex*)vertexStream.data();
+        for (size_t i = 0; i < m_StaticVertices.size(); i++)
+            packed[i] = PackVertex(m_StaticVertices[i]);
+#else
+        vertexStream.resize(m_StaticVertices.size() * sizeof(Vertex));
+        memcpy(vertexStream.data(), m_StaticVertices.data(), vertexStream.size());
+#endif
+
+        //Indices are relative to the submesh base vertex, so small submeshes fit in 16 bits
+        indexStream.clear();
+        for (Submesh& submesh : m_Submeshes)
+        {
+            submesh.IndexSize = submesh.VertexCount <= 65536 ? sizeof(uint16_t) : sizeof(uint32_t);
+            //Index offsets must be aligned to the index size
+            submesh.IndexOffset = (uint32_t)((indexStream.size() + 3) & ~(size_t)3);
+            indexStream.resize(submesh.IndexOffset + (size_t)submesh.IndexCount * submesh.IndexSize);
+
+            const uint32_t* source = (const uint32_t*)(m_Indices.data()) + submesh.BaseIndex;
+            if (submesh.IndexSize == sizeof(uint16_t))
+            {
+                uint16_t* target = (uint16_t*)(indexStream.data() + submesh.IndexOffset);
+                for (uint32_t i = 0; i < submesh.IndexCount; i++)
+                    target[i] = (uint16_t)source[i];
+            }
+            else
+            {
+                memcpy(indexStream.data() + submesh.IndexOffset, source, (size_t)submesh.IndexCount * sizeof(uint32_t));
+            }
+        }
+
+        MESH_INFO("Mesh: GPU geometry {0} bytes, unpacked {1} bytes", vertexStream.size() + indexStream.size(),
+            m_StaticVertices.size() * sizeof(Vertex) + m_Indices.size() * sizeof(Index));
+    }
 
+    bool Mesh::Import(std::vector<MeshMaterialDescription>& materials)
+    {
         LogStream::Initialize();
-        
-        m_Importer = std::make_unique<Assimp::Importer>();
+
+        //The importer owns the scene, both are released when this returns
+        Assimp::Importer importer;
         const uint32_t meshImportFlags =
             aiProcess_CalcTangentSpace |        // Create binormals/tangents just in case
             aiProcess_Triangulate |             // Make sure we're triangles
             aiProcess_SortByPType |             // Split meshes by primitive type
             aiProcess_GenNormals |              // Make sure we have legit normals
             aiProcess_GenUVCoords |             // Convert UVs if required 
+            aiProcess_JoinIdenticalVertices |   // Weld identical vertices
+            aiProcess_LimitBoneWeights |        // At most four bones per vertex
             aiProcess_OptimizeMeshes |          // Batch draws where possible
             aiProcess_ValidateDataStructure;    // Validation
-        const aiScene* scene = m_Importer->ReadFile(filename, meshImportFlags);
+        const aiScene* scene = importer.ReadFile(m_FilePath, meshImportFlags);
         if (!scene || !scene->HasMeshes())
         {
-            ENGINE_ERROR("Failed to load mesh file: '{0}'", filename);
-            return;
+            ENGINE_ERROR("Failed to load mesh file: '{0}'", m_FilePath);
+            return false;
         }
-        m_Scene = scene;
-
-        m_MeshShader = Renderer::GetShaderLibrary().Get(m_InitShaderName);
-        m_BaseMaterial = Material::Create(m_MeshShader);
-        m_BaseMaterial->SetFlags(MaterialFlag::DepthTest);
 
         uint32_t vertexCount = 0;
         uint32_t indexCount = 0;
 
-        //TODO: Load animated mesh 
         //Load meshes
-        m_Submeshes.reserve(m_Scene->mNumMeshes);
-        for (uint32_t i = 0; i < m_Scene->mNumMeshes; i++)
+        m_Submeshes.reserve(scene->mNumMeshes);
+        for (uint32_t i = 0; i < scene->mNumMeshes; i++)
         {
-            aiMesh* mesh = m_Scene->mMeshes[i];
+            aiMesh* mesh = scene->mMeshes[i];
 
             Submesh& submesh = m_Submeshes.emplace_back();
             submesh.BaseVertex = vertexCount;
@@ -147,219 +393,210 @@ namespace Engine
                 ENGINE_ASSERT(mesh->mFaces[j].mNumIndices == 3, "Face must have 3 indices!");
                 Index index = { mesh->mFaces[j].mIndices[0], mesh->mFaces[j].mIndices[1] ,mesh->mFaces[j].mIndices[2] };
                 m_Indices.push_back(index);
-
-                m_TriangleCache[i].emplace_back(
-                    m_StaticVertices[index.V1 + submesh.BaseVertex],
-                    m_StaticVertices[index.V2 + submesh.BaseVertex],
-                    m_StaticVertices[index.V3 + submesh.BaseVertex]
-                );
             }
+            submesh.UVDensity = CalculateUVDensity(m_StaticVertices, m_Indices, submesh.BaseVertex, submesh.BaseIndex / 3, mesh->mNumFaces);
         }
 
-        TraverseNodes(m_Scene->mRootNode);
+        //Influences are gathered before the optimizer reorders the vertices, then follow the new order
+        ImportSkeleton(scene);
+        std::vector<uint32_t> vertexRemap;
+        bool measureOverdraw = MeshOptimizer::IsOverdrawStatisticsEnabled();
+        MeshOptimizerStatistics before = MeshOptimizer::Analyze(m_StaticVertices, m_Indices, m_Submeshes, measureOverdraw);
+        MeshOptimizer::Optimize(m_StaticVertices, m_Indices, m_Submeshes, IsAnimated() ? &vertexRemap : nullptr);
+        if (IsAnimated())
+        {
+            std::vector<VertexInfluence> influences(m_Influences.size());
+            for (size_t i = 0; i < m_Influences.size(); i++)
+                influences[vertexRemap[i]] = m_Influences[i];
+            m_Influences.swap(influences);
+        }
+        MeshOptimizerStatistics after = MeshOptimizer::Analyze(m_StaticVertices, m_Indices, m_Submeshes, measureOverdraw);
+        ENGINE_INFO("Mesh: Optimized '{0}', {1} vertices, {2} triangles", m_FilePath, vertexCount, indexCount / 3);
+        ENGINE_INFO("     ACMR {0:.3f} -> {1:.3f}, ATVR {2:.3f} -> {3:.3f}", before.ACMR, after.ACMR, before.ATVR, after.ATVR);
+        if (measureOverdraw)
+            ENGINE_INFO("     overdraw {0:.3f} -> {1:.3f}", before.Overdraw, after.Overdraw);
+
+        TraverseNodes(scene->mRootNode);
+        if (IsAnimated())
+        {
+            //Skinning already places these in the space of the root node
+            for (uint32_t i = 0; i < scene->mNumMeshes; i++)
+            {
+                if (scene->mMeshes[i]->HasBones())
+                    m_Submeshes[i].Transform = glm::mat4(1.0f);
+            }
+            ImportAnimations(scene);
+        }
         
         //Load materials
-        if (m_Scene->HasMaterials())
+        MESH_INFO("Mesh: ({0}) materials", m_FilePath);
+        materials.resize(scene->mNumMaterials);
+        for (uint32_t i = 0; i < scene->mNumMaterials; i++)
         {
-            MESH_INFO("Mesh: ({0}) materials", filename);
-
-            m_Textures.resize(scene->mNumMaterials);
-            m_NormalMaps.resize(scene->mNumMaterials);
-            m_RoughnessMaps.resize(scene->mNumMaterials);
-            m_MetalnessMaps.resize(scene->mNumMaterials);
-            m_Materials.resize(scene->mNumMaterials);
-            
-            for (uint32_t i = 0; i < scene->mNumMaterials; i++)
+            auto aiMaterial = scene->mMaterials[i];
+            MeshMaterialDescription& material = materials[i];
+            material.Name = aiMaterial->GetName().C_Str();
+
+            aiColor3D aiColor;
+            aiMaterial->Get(AI_MATKEY_COLOR_DIFFUSE, aiColor);
+            material.AlbedoColor = { aiColor.r, aiColor.g, aiColor.b };
+
+            float shininess, metalness;
+            if (aiMaterial->Get(AI_MATKEY_SHININESS, shininess) != aiReturn_SUCCESS)
+                shininess = 80.0f;
+            if (aiMaterial->Get(AI_MATKEY_REFLECTIVITY, metalness) != aiReturn_SUCCESS)
+                metalness = 0.0f;
+            material.Metalness = metalness;
+            material.Roughness = 1.0f - glm::sqrt(shininess / 100.0f);
+
+            aiString aiTexPath;
+            if (aiMaterial->GetTexture(aiTextureType_DIFFUSE, 0, &aiTexPath) == aiReturn_SUCCESS)
+                material.AlbedoMap = aiTexPath.C_Str();
+            if (aiMaterial->GetTexture(aiTextureType_NORMALS, 0, &aiTexPath) == aiReturn_SUCCESS)
+                material.NormalMap = aiTexPath.C_Str();
+            if (aiMaterial->GetTexture(aiTextureType_SHININESS, 0, &aiTexPath) == aiReturn_SUCCESS)
+                material.RoughnessMap = aiTexPath.C_Str();
+            //The metalness map is only found in the raw FBX properties
+            for (uint32_t j = 0; j < aiMaterial->mNumProperties; j++)
             {
-                auto aiMaterial = m_Scene->mMaterials[i];
-                auto aiMaterialName = aiMaterial->GetName();
+                auto prop = aiMaterial->mProperties[j];
+                if (prop->mType == aiPTI_String && std::string(prop->mKey.data) == "$raw.ReflectionFactor|file")
+                {
+                    uint32_t strLength = *(uint32_t*)prop->mData;
+                    material.MetalnessMap = std::string(prop->mData + 4, strLength);
+                    break;
+                }
+            }
 
-                auto mi = MaterialInstance::Create(m_BaseMaterial, aiMaterialName.data);
-                m_Materials[i] = mi;
+            MESH_INFO("Mesh: Import material {0}, index = {1}", material.Name, i);
+            MESH_INFO("     TextureCount = {0}", aiMaterial->GetTextureCount(aiTextureType_DIFFUSE));
+            MESH_INFO("     Color = {0}, {1}, {2}", aiColor.r, aiColor.g, aiColor.b);
+            MESH_INFO("     Shininess = {0}", shininess);
+            MESH_INFO("     Metalness = {0}", metalness);
+            MESH_INFO("     Roughness = {0}", material.Roughness);
+        }
+        return true;
+    }
 
-                uint32_t textureCount = aiMaterial->GetTextureCount(aiTextureType_DIFFUSE);
+    bool Mesh::LoadCache(const std::string& cachePath, std::vector<MeshMaterialDescription>& materials)
+    {
+        MeshCacheView view;
+        if (!MeshCache::Read(cachePath, view))
+            return false;
+
+        //The mapping is closed when this returns, keep the streams for FinishLoading
+        m_PendingVertexStream.assign(view.VertexStream, view.VertexStream + view.VertexStreamSize);
+        m_PendingIndexStream.assign(view.IndexStream, view.IndexStream + view.IndexStreamSize);
+
+        //Straight to positions, the full vertices are only copied when they are kept
+        m_VertexCount = view.VertexCount;
+        m_Positions.resize(view.VertexCount);
+        for (uint32_t i = 0; i < view.VertexCount; i++)
+            m_Positions[i] = view.Vertices[i].Position;
+        if (m_Retention == MeshRetention::KeepAll)
+            m_StaticVertices.assign(view.Vertices, view.Vertices + view.VertexCount);
+        m_Indices.assign(view.Indices, view.Indices + view.TriangleCount);
+        m_Meshlets.assign(view.Meshlets, view.Meshlets + view.MeshletCount);
+        m_Submeshes = std::move(view.Submeshes);
+        materials = std::move(view.Materials);
+
+        MESH_INFO("Mesh: Loaded '{0}' from cache '{1}'", m_FilePath, cachePath);
+        return true;
+    }
 
-                aiColor3D aiColor;
-                aiMaterial->Get(AI_MATKEY_COLOR_DIFFUSE, aiColor);
+    void Mesh::CreateMaterials(const std::vector<MeshMaterialDescription>& materials)
+    {
+        //Map paths are relative to the mesh file
+        std::filesystem::path parentPath = std::filesystem::path(m_FilePath).parent_path();
+        auto loadMap = [&parentPath](const std::string& map, bool srgb, TextureUsage usage) -> Ref<Texture2D>
+        {
+            std::string texturePath = (parentPath / map).string();
+            MESH_INFO("     Map path = {0}", texturePath);
 
-                float shininess, metalness;
-                if (aiMaterial->Get(AI_MATKEY_SHININESS, shininess) != aiReturn_SUCCESS)
-                    shininess = 80.0f;
-                if (aiMaterial->Get(AI_MATKEY_REFLECTIVITY, metalness) != aiReturn_SUCCESS)
-                    metalness = 0.0f;
-                float roughness = 1.0f - glm::sqrt(shininess / 100.0f);
+            TextureSpecification spec;
+            spec.Usage = usage;
+            auto texture = AssetManager::LoadTexture(texturePath, srgb, spec);
+            if (texture->IsLoaded())
+                return texture;
 
-                MESH_INFO("Mesh: Load material {0}, index = {1}", mi->GetName(), i);
-                MESH_INFO("     TextureCount = {0}", textureCount);
-                MESH_INFO("     Color = {0}, {1}, {2}", aiColor.r, aiColor.g, aiColor.b);
-                MESH_INFO("     Shininess = {0}", shininess);
-                MESH_INFO("     Metalness = {0}", metalness);
-                MESH_INFO("     Roughness = {0}", roughness);
+            ENGINE_ERROR("Could not load texture {0}", texturePath);
+            return nullptr;
+        };
 
-                aiString aiTexPath;
-                
-                //Albedo map
-                mi->Set("u_AlbedoTexToggle", 0.0f);
-                bool hasAlbedoMap = aiMaterial->GetTexture(aiTextureType_DIFFUSE, 0, &aiTexPath) == aiReturn_SUCCESS;
-                if (hasAlbedoMap)
-                {
-                    std::filesystem::path path = filename;
-                    auto parentPath = path.parent_path();
-                    parentPath /= std::string(aiTexPath.data);
-                    std::string texturePath = parentPath.string();
-                    MESH_INFO("     Albedo map path = {0}", texturePath);
-                    
-                    auto texture = AssetManager::CreateNewAsset<Texture2D>(texturePath, true);
-                    if (texture->IsLoaded())
-                    {
-                        m_Textures[i] = texture;
-                        mi->Set("u_AlbedoTexture", m_Textures[i]);
-                        mi->Set("u_AlbedoTexToggle", 1.0f);
-                    }
-                    else
-                    {
-                        ENGINE_ERROR("Could not load texture {0}", texturePath);
-                        mi->Set("u_AlbedoColor", glm::vec3(aiColor.r, aiColor.g, aiColor.b));
-                    }
-                    
-                }
-                else
-                {
-                    mi->Set("u_AlbedoColor", glm::vec3{ aiColor.r, aiColor.g, aiColor.b });
-                    MESH_INFO("     No albedo map. Set albedo: {0}, {1}, {2}", aiColor.r, aiColor.g, aiColor.b);
-                }
+        m_Textures.resize(materials.size());
+        m_NormalMaps.resize(materials.size());
+        m_RoughnessMaps.resize(materials.size());
+        m_MetalnessMaps.resize(materials.size());
+        m_Materials.resize(materials.size());
 
-                //Normal map
-                mi->Set("u_NormalTexToggle", 0.0f);
-                bool hasNormalMap = aiMaterial->GetTexture(aiTextureType_NORMALS, 0, &aiTexPath) == aiReturn_SUCCESS;
-                if (hasNormalMap)
-                {
-                    std::filesystem::path path = filename;
-                    auto parentPath = path.parent_path();
-                    parentPath /= std::string(aiTexPath.data);
-                    std::string texturePath = parentPath.string();
-                    MESH_INFO("     Normal map path = {0}", texturePath);
-                    
-                    auto texture = AssetManager::CreateNewAsset<Texture2D>(texturePath);
-                    if (texture->IsLoaded())
-                    {
-                        m_NormalMaps[i] = texture;
-                        mi->Set("u_NormalTexture", texture);
-                        mi->Set("u_NormalTexToggle", 1.0f);
-                    }
-                    else
-                    {
-                        ENGINE_ERROR("Could not load texture {0}", texturePath);
-                    }
-                    
-                }
-                else
-                {
-                    MESH_INFO("     No normal map");
-                }
-                
-                //Roughness map
-                mi->Set("u_RoughnessTexToggle", 0.0f);
-                bool hasRoughnessMap = aiMaterial->GetTexture(aiTextureType_SHININESS, 0, &aiTexPath) == aiReturn_SUCCESS;
-                if (hasRoughnessMap)
-                {
-                    std::filesystem::path path = filename;
-                    auto parentPath = path.parent_path();
-                    parentPath /= std::string(aiTexPath.data);
-                    std::string texturePath = parentPath.string();
-                    MESH_INFO("     Roughness map path = {0}", texturePath);
-                    
-                    auto texture = AssetManager::CreateNewAsset<Texture2D>(texturePath);
-                    if (texture->IsLoaded())
-                    {
-                        m_RoughnessMaps[i] = texture;
-                        mi->Set("u_RoughnessTexture", texture);
-                        mi->Set("u_RoughnessTexToggle", 1.0f);
-                    }
-                    else
-                    {
-                        ENGINE_ERROR("Could not load texture {0}", texturePath);
-                    }
-                    
-                }
-                else
-                {
-                    mi->Set("u_Roughness", roughness);
-                    MESH_INFO("     No roughness map. Set roughness: {0}", roughness);
-                }
-                
-                //Metalness map
-                mi->Set("u_MetalnessTexToggle", 0.0f);
-                bool hasMetalnessMap = false;
-                for (uint32_t j = 0; j < aiMaterial->mNumProperties; j++)
-                {
-                    auto prop = aiMaterial->mProperties[j];
-                    if (prop->mType == aiPTI_String)
-                    {
-                        uint32_t strLength = *(uint32_t*)prop->mData;
-                        std::string str(prop->mData + 4, strLength);
-
-                        std::string key = prop->mKey.data;
-                        if (key == "$raw.ReflectionFactor|file")
-                        {
-                            hasMetalnessMap = true;
-
-                            std::filesystem::path path = filename;
-                            auto parentPath = path.parent_path();
-                            parentPath /= str;
-                            std::string texturePath = parentPath.string();
-                            MESH_INFO("    Metalness map path = {0}", texturePath);
-
-                            auto texture = AssetManager::CreateNewAsset<Texture2D>(texturePath);
-                            if (texture->IsLoaded())
-                            {
-                                m_MetalnessMaps[i] = texture;
-                                mi->Set("u_MetalnessTexture", texture);
-                                mi->Set("u_MetalnessTexToggle", 1.0f);
-                            }
-                            else
-                            {
-                                MESH_INFO("    Could not load texture: {0}", texturePath);
-                                mi->Set("u_Metalness", metalness);
-                                mi->Set("u_MetalnessTexToggle", 0.0f);
-                            }
-                            break;
-                        }
-                    }
-                }
+        for (uint32_t i = 0; i < (uint32_t)materials.size(); i++)
+        {
+            const MeshMaterialDescription& material = materials[i];
+            auto mi = MaterialInstance::Create(m_BaseMaterial, material.Name);
+            m_Materials[i] = mi;
+            MESH_INFO("Mesh: Load material {0}, index = {1}", mi->GetName(), i);
+
+            //Albedo map
+            mi->SetKeyword("ALBEDO_MAP", false);
+            if (!material.AlbedoMap.empty())
+                m_Textures[i] = loadMap(material.AlbedoMap, true, TextureUsage::Albedo);
+            if (m_Textures[i])
+            {
+                mi->Set("u_AlbedoTexture", m_Textures[i]);
+                mi->SetKeyword("ALBEDO_MAP", true);
+            }
+            else
+            {
+                mi->Set("u_AlbedoColor", material.AlbedoColor);
+            }
 
-                if (!hasMetalnessMap)
-                {
-                    mi->Set("u_Metalness", metalness);
-                    mi->Set("u_MetalnessTexToggle", 0.0f);
-                    MESH_INFO("    No metalness map. Set metalness: {0}", metalness);
-                }
+            //Normal map
+            mi->SetKeyword("NORMAL_MAP", false);
+            if (!material.NormalMap.empty())
+                m_NormalMaps[i] = loadMap(material.NormalMap, false, TextureUsage::Normal);
+            if (m_NormalMaps[i])
+            {
+                mi->Set("u_NormalTexture", m_NormalMaps[i]);
+                mi->SetKeyword("NORMAL_MAP", true);
+            }
 
-                //TODO: Other textures
+            //Roughness map
+            mi->SetKeyword("ROUGHNESS_MAP", false);
+            if (!material.RoughnessMap.empty())
+                m_RoughnessMaps[i] = loadMap(material.RoughnessMap, false, TextureUsage::Mask);
+            if (m_RoughnessMaps[i])
+            {
+                mi->Set("u_RoughnessTexture", m_RoughnessMaps[i]);
+                mi->SetKeyword("ROUGHNESS_MAP", true);
+            }
+            else
+            {
+                mi->Set("u_Roughness", material.Roughness);
             }
-        }
-        
-        m_VertexBuffer = VertexBuffer::Create(m_StaticVertices.data(), m_StaticVertices.size() * sizeof(Vertex));
-        m_IndexBuffer = IndexBuffer::Create(m_Indices.data(), m_Indices.size() * sizeof(Index));
-        m_VertexArray = VertexArray::Create();
 
-        m_BaseVertexLayout = {
-            { ShaderDataType::Float3, "a_Position" },
-            { ShaderDataType::Float3, "a_Normal" },
-            { ShaderDataType::Float3, "a_Tangent" },
-            { ShaderDataType::Float3, "a_Binormal" },
-            { ShaderDataType::Float2, "a_TexCoord" },
-        };
+            //Metalness map
+            mi->SetKeyword("METALNESS_MAP", false);
+            if (!material.MetalnessMap.empty())
+                m_MetalnessMaps[i] = loadMap(material.MetalnessMap, false, TextureUsage::Mask);
+            if (m_MetalnessMaps[i])
+            {
+                mi->Set("u_MetalnessTexture", m_MetalnessMaps[i]);
+                mi->SetKeyword("METALNESS_MAP", true);
+            }
+            else
+            {
+                mi->Set("u_Metalness", material.Metalness);
+            }
+
+            //TODO: Other textures
+        }
     }
 
-    Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, const glm::mat4& transform)
-        : m_StaticVertices(vertices), m_Indices(indices)
+    Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, const glm::mat4& transform, MeshRetention retention)
+        : m_Retention(retention), m_StaticVertices(vertices), m_Indices(indices)
     {
         MESH_INFO("Mesh: Construct basic mesh");
 
-        m_Importer = nullptr;
-        m_Scene = nullptr;
-
         Submesh& submesh = m_Submeshes.emplace_back();
         submesh.MeshName = "Basic mesh";
         submesh.BaseVertex = 0;
@@ -382,14 +619,14 @@ namespace Engine
             aabb.Max.z = glm::max(vertex.Position.z, aabb.Max.z);
         }
 
-        for (auto& index : m_Indices)
-        {
-            m_TriangleCache[0].emplace_back(
-                m_StaticVertices[index.V1 + submesh.BaseVertex],
-                m_StaticVertices[index.V2 + submesh.BaseVertex],
-                m_StaticVertices[index.V3 + submesh.BaseVertex]
-            );
-        }
+        submesh.UVDensity = CalculateUVDensity(m_StaticVertices, m_Indices, 0, 0, (uint32_t)m_Indices.size());
+
+        std::vector<uint8_t> vertexStream, indexStream;
+        PackGeometry(vertexStream, indexStream);
+        ExtractPositions();
+        if (m_Retention != MeshRetention::KeepAll)
+            std::vector<Vertex>().swap(m_StaticVertices);
+        BuildBVHs();
 
         //TEMP
         m_MeshShader = Renderer::GetShaderLibrary().Get(m_InitShaderName);
@@ -401,23 +638,302 @@ namespace Engine
         mi->Set("u_AlbedoColor", glm::vec3(0.6f, 0.6f, 0.6f));
         m_Materials.push_back(mi);
 
-        m_VertexBuffer = VertexBuffer::Create(m_StaticVertices.data(), m_StaticVertices.size() * sizeof(Vertex));
-        m_IndexBuffer = IndexBuffer::Create(m_Indices.data(), m_Indices.size() * sizeof(Index));
+        m_VertexBuffer = VertexBuffer::Create(vertexStream.data(), (uint32_t)vertexStream.size());
+        m_IndexBuffer = IndexBuffer::Create(indexStream.data(), (uint32_t)indexStream.size());
         m_VertexArray = VertexArray::Create();
+        m_BaseVertexLayout = GetVertexLayout();
 
-        m_BaseVertexLayout = {
-            { ShaderDataType::Float3, "a_Position" },
-            { ShaderDataType::Float3, "a_Normal" },
-            { ShaderDataType::Float3, "a_Tangent" },
-            { ShaderDataType::Float3, "a_Binormal" },
-            { ShaderDataType::Float2, "a_TexCoord" },
-        };
+        ReleaseGeometry();
     }
 
     Mesh::~Mesh()
     {
     }
 
+    bool Mesh::Raycast(const Ray& ray, const glm::mat4& transform, MeshRaycastHit& hit) const
+    {
+        bool result = false;
+        for (uint32_t i = 0; i < (uint32_t)m_Submeshes.size(); i++)
+        {
+            glm::mat4 submeshTransform = transform * m_Submeshes[i].Transform;
+            glm::mat4 inverse = glm::inverse(submeshTransform);
+            Ray localRay(inverse * glm::vec4(ray.Origin, 1.0f), glm::mat3(inverse) * ray.Direction);
+
+            BVHRaycastHit localHit;
+            if (!RaycastSubmesh(i, localRay, localHit))
+                continue;
+
+            //Submesh transforms may scale, compare the hits in world space
+            glm::vec3 position = submeshTransform * glm::vec4(localRay.Origin + localRay.Direction * localHit.Distance, 1.0f);
+            float distance = glm::distance(ray.Origin, position);
+            if (distance < hit.Distance)
+            {
+                hit.Submesh = i;
+                hit.Triangle = localHit.Triangle;
+                hit.Distance = distance;
+                hit.Position = position;
+                result = true;
+            }
+        }
+        return result;
+    }
+
+    bool Mesh::RaycastSubmesh(uint32_t submeshIndex, const Ray& ray, BVHRaycastHit& hit) const
+    {
+        //Released with the positions
+        if (m_BVHs.empty())
+            return false;
+
+        const Submesh& submesh = m_Submeshes[submeshIndex];
+        float t;
+        if (!ray.IntersectsAABB(submesh.BoundingBox, t))
+            return false;
+
+        return m_BVHs[submeshIndex].Raycast(ray, m_Positions.data() + submesh.BaseVertex, m_Indices.data() + submesh.BaseIndex / 3, hit);
+    }
+
+    MeshMemoryStatistics Mesh::GetMemoryStatistics() const
+    {
+        MeshMemoryStatistics statistics;
+        statistics.CPUGeometry = m_StaticVertices.capacity() * sizeof(Vertex) + m_Positions.capacity() * sizeof(glm::vec3)
+            + m_Indices.capacity() * sizeof(Index) + m_Influences.capacity() * sizeof(VertexInfluence) + m_Meshlets.capacity() * sizeof(Meshlet);
+        for (const MeshBVH& bvh : m_BVHs)
+            statistics.CPUQueries += bvh.GetMemorySize();
+
+        if (m_VertexBuffer)
+            statistics.GPU += m_VertexBuffer->GetSize();
+        if (m_IndexBuffer)
+            statistics.GPU += m_IndexBuffer->GetSize();
+        if (m_InfluenceBuffer)
+            statistics.GPU += m_InfluenceBuffer->GetSize();
+        if (m_MeshletBuffer)
+            statistics.GPU += m_MeshletBuffer->GetSize();
+        return statistics;
+    }
+
+    void Mesh::ExtractPositions()
+    {
+        m_VertexCount = (uint32_t)m_StaticVertices.size();
+        m_Positions.resize(m_StaticVertices.size());
+        for (size_t i = 0; i < m_StaticVertices.size(); i++)
+            m_Positions[i] = m_StaticVertices[i].Position;
+    }
+
+    void Mesh::BuildBVHs()
+    {
+        //Only queries read them, GPUOnly would release them with the positions
+        if (m_Retention < MeshRetention::KeepPositionsForQueries)
+            return;
+
+        m_BVHs.resize(m_Submeshes.size());
+        uint64_t memorySize = 0;
+        for (size_t i = 0; i < m_Submeshes.size(); i++)
+        {
+            const Submesh& submesh = m_Submeshes[i];
+            m_BVHs[i].Build(m_Positions.data() + submesh.BaseVertex, m_Indices.data() + submesh.BaseIndex / 3, submesh.IndexCount / 3);
+            memorySize += m_BVHs[i].GetMemorySize();
+        }
+        MESH_INFO("Mesh: BVH {0} bytes", memorySize);
+    }
+
+    void Mesh::BuildMeshlets()
+    {
+        m_Meshlets.clear();
+        for (Submesh& submesh : m_Submeshes)
+        {
+            submesh.MeshletOffset = (uint32_t)m_Meshlets.size();
+            MeshletBuilder::Build(m_Positions.data() + submesh.BaseVertex, submesh.VertexCount,
+                m_Indices.data() + submesh.BaseIndex / 3, submesh.IndexCount / 3, m_Meshlets);
+            submesh.MeshletCount = (uint32_t)m_Meshlets.size() - submesh.MeshletOffset;
+        }
+        MESH_INFO("Mesh: {0} meshlets, {1} bytes", m_Meshlets.size(), m_Meshlets.size() * sizeof(Meshlet));
+    }
+
+    void Mesh::ReleaseGeometry()
+    {
+        if (m_Retention == MeshRetention::KeepAll)
+            return;
+
+        //Uploaded, only the GPU reads them
+        std::vector<VertexInfluence>().swap(m_Influences);
+        std::vector<Meshlet>().swap(m_Meshlets);
+        if (m_Retention == MeshRetention::KeepPositionsForQueries)
+            return;
+
+        std::vector<glm::vec3>().swap(m_Positions);
+        std::vector<Index>().swap(m_Indices);
+        std::vector<MeshBVH>().swap(m_BVHs);
+    }
+
+    Ref<AnimationClip> Mesh::FindAnimation(const std::string& name) const
+    {
+        for (auto& clip : m_Animations)
+        {
+            if (clip->GetName() == name)
+                return clip;
+        }
+        return nullptr;
+    }
+
+    void Mesh::ImportSkeleton(const aiScene* scene)
+    {
+        //Offset matrices of the bones, a bone may be shared by several meshes
+        std::unordered_map<std::string, glm::mat4> bones;
+        for (uint32_t i = 0; i < scene->mNumMeshes; i++)
+        {
+            const aiMesh* mesh = scene->mMeshes[i];
+            for (uint32_t j = 0; j < mesh->mNumBones; j++)
+                bones[mesh->mBones[j]->mName.C_Str()] = AssimpMat4ToMat4(mesh->mBones[j]->mOffsetMatrix);
+        }
+        if (bones.empty())
+            return;
+
+        //Joints are the bone nodes and all their ancestors
+        std::unordered_set<const aiNode*> used;
+        for (auto& [name, offset] : bones)
+        {
+            const aiNode* node = scene->mRootNode->FindNode(name.c_str());
+            if (!node)
+                ENGINE_WARN("Mesh: Bone '{0}' has no node in '{1}'", name, m_FilePath);
+            for (; node; node = node->mParent)
+                used.insert(node);
+        }
+
+        //Depth first, so parents come before their children
+        std::vector<const aiNode*> nodes;
+        std::vector<std::pair<const aiNode*, int32_t>> stack = { { scene->mRootNode, -1 } };
+        while (!stack.empty())
+        {
+            auto [node, parent] = stack.back();
+            stack.pop_back();
+            if (!used.count(node))
+                continue;
+
+            int32_t joint = (int32_t)nodes.size();
+            nodes.push_back(node);
+            m_Skeleton.JointNames.push_back(node->mName.C_Str());
+            m_Skeleton.ParentIndices.push_back(parent);
+            auto it = bones.find(node->mName.C_Str());
+            m_Skeleton.InverseBindPoses.push_back(it != bones.end() ? it->second : glm::mat4(1.0f));
+
+            for (uint32_t i = node->mNumChildren; i-- > 0;)
+                stack.push_back({ node->mChildren[i], joint });
+        }
+
+        uint32_t jointCount = m_Skeleton.GetJointCount();
+        ENGINE_ASSERT(jointCount <= UINT16_MAX, "Too many joints!");
+        m_Skeleton.BindPose.Reset(jointCount);
+        for (uint32_t i = 0; i < jointCount; i++)
+        {
+            aiVector3D scale, position;
+            aiQuaternion rotation;
+            nodes[i]->mTransformation.Decompose(scale, rotation, position);
+            m_Skeleton.BindPose.SetJoint(i, { position.x, position.y, position.z }, { rotation.x, rotation.y, rotation.z, rotation.w }, { scale.x, scale.y, scale.z });
+        }
+
+        //Keep the four largest weights of every vertex
+        m_Influences.resize(m_StaticVertices.size());
+        std::vector<glm::vec4> weights(m_StaticVertices.size(), glm::vec4(0.0f));
+        for (uint32_t i = 0; i < scene->mNumMeshes; i++)
+        {
+            const aiMesh* mesh = scene->mMeshes[i];
+            for (uint32_t j = 0; j < mesh->mNumBones; j++)
+            {
+                const aiBone* bone = mesh->mBones[j];
+                int32_t joint = m_Skeleton.FindJoint(bone->mName.C_Str());
+                //Its weights are left out, the others of the vertex are normalized below
+                if (joint < 0)
+                {
+                    ENGINE_WARN("Mesh: Bone '{0}' of '{1}' is not in the skeleton, its weights are ignored", bone->mName.C_Str(), m_FilePath);
+                    continue;
+                }
+                for (uint32_t k = 0; k < bone->mNumWeights; k++)
+                {
+                    uint32_t vertex = m_Submeshes[i].BaseVertex + bone->mWeights[k].mVertexId;
+                    glm::vec4& weight = weights[vertex];
+                    uint32_t slot = 0;
+                    for (uint32_t s = 1; s < 4; s++)
+                    {
+                        if (weight[s] < weight[slot])
+                            slot = s;
+                    }
+                    if (bone->mWeights[k].mWeight > weight[slot])
+                    {
+                        weight[slot] = bone->mWeights[k].mWeight;
+                        m_Influences[vertex].Joints[slot] = (uint16_t)joint;
+                    }
+                }
+            }
+        }
+
+        //Vertices without weights keep their position, the skinning shader skips them
+        for (size_t i = 0; i < m_Influences.size(); i++)
+        {
+            const glm::vec4& weight = weights[i];
+            float sum = weight.x + weight.y + weight.z + weight.w;
+            if (sum <= 0.0f)
+                continue;
+
+            VertexInfluence& influence = m_Influences[i];
+            int32_t total = 0;
+            uint32_t largest = 0;
+            for (uint32_t s = 0; s < 4; s++)
+            {
+                influence.Weights[s] = (uint8_t)glm::round(weight[s] / sum * 255.0f);
+                total += influence.Weights[s];
+                if (weight[s] > weight[largest])
+                    largest = s;
+            }
+            //Rounding error goes to the largest weight, so the weights sum to exactly one
+            influence.Weights[largest] = (uint8_t)(influence.Weights[largest] + 255 - total);
+        }
+
+        MESH_INFO("Mesh: Skeleton of '{0}', {1} joints, {2} bones", m_FilePath, jointCount, bones.size());
+    }
+
+    void Mesh::ImportAnimations(const aiScene* scene)
+    {
+        const Pose& bindPose = m_Skeleton.BindPose;
+        for (uint32_t i = 0; i < scene->mNumAnimations; i++)
+        {
+            const aiAnimation* animation = scene->mAnimations[i];
+            double ticksPerSecond = animation->mTicksPerSecond > 0.0 ? animation->mTicksPerSecond : 25.0;
+            float duration = (float)(animation->mDuration / ticksPerSecond);
+            std::string name = animation->mName.length > 0 ? animation->mName.C_Str() : "Animation " + std::to_string(i);
+            auto clip = CreateRef<AnimationClip>(name, duration, AnimationClip::DefaultSampleRate, m_Skeleton.GetJointCount());
+
+            //Joints without a channel hold the bind pose
+            for (uint32_t frame = 0; frame < clip->GetFrameCount(); frame++)
+                memcpy(clip->GetFrame(frame), bindPose.Data.data(), bindPose.Data.size() * sizeof(float));
+
+            for (uint32_t j = 0; j < animation->mNumChannels; j++)
+            {
+                const aiNodeAnim* channel = animation->mChannels[j];
+                int32_t joint = m_Skeleton.FindJoint(channel->mNodeName.C_Str());
+                if (joint < 0)
+                    continue;
+
+                auto bind = [&](Pose::Stream stream) { return bindPose.GetStream(stream)[joint]; };
+                glm::vec3 bindPosition = { bind(Pose::TranslationX), bind(Pose::TranslationY), bind(Pose::TranslationZ) };
+                glm::vec4 bindRotation = { bind(Pose::RotationX), bind(Pose::RotationY), bind(Pose::RotationZ), bind(Pose::RotationW) };
+                glm::vec3 bindScale = { bind(Pose::ScaleX), bind(Pose::ScaleY), bind(Pose::ScaleZ) };
+
+                uint32_t positionKey = 0, rotationKey = 0, scaleKey = 0;
+                for (uint32_t frame = 0; frame < clip->GetFrameCount(); frame++)
+                {
+                    double time = glm::min(frame / clip->GetSampleRate() * ticksPerSecond, animation->mDuration);
+                    clip->SetJoint(frame, joint,
+                        SampleVectorKeys(channel->mPositionKeys, channel->mNumPositionKeys, time, positionKey, bindPosition),
+                        SampleQuatKeys(channel->mRotationKeys, channel->mNumRotationKeys, time, rotationKey, bindRotation),
+                        SampleVectorKeys(channel->mScalingKeys, channel->mNumScalingKeys, time, scaleKey, bindScale));
+                }
+            }
+
+            MESH_INFO("Mesh: Animation '{0}', {1} s, {2} frames, {3} bytes", name, duration, clip->GetFrameCount(), clip->GetMemorySize());
+            m_Animations.push_back(clip);
+        }
+    }
+
     void Mesh::TraverseNodes(aiNode* node, const glm::mat4& parentTransform, uint32_t level)
     {
         glm::mat4 transform = parentTransform * AssimpMat4ToMat4(node->mTransformation);
@@ -5,20 +5,19 @@
 #include <glm/glm.hpp>
 #include "Engine/Core/TimeStep.h"
 #include "Engine/Asset/Asset.h"
+#include "Engine/Renderer/RendererConfig.h"
 #include "Engine/Renderer/Pipeline.h"
 #include "Engine/Renderer/Material.h"
 #include "Engine/Renderer/Shader.h"
 #include "Engine/Renderer/VertexArray.h"
 #include "Engine/Renderer/VertexBuffer.h"
 #include "Engine/Renderer/IndexBuffer.h"
+#include "Engine/Renderer/MeshBVH.h"
+#include "Engine/Renderer/Animation.h"
 #include "Engine/Core/Math/AABB.h"
 
-struct aiScene;
 struct aiNode;
-
-namespace Assimp {
-	class Importer;
-}
+struct aiScene;
 
 namespace Engine
 {
@@ -39,20 +38,34 @@ namespace Engine
 		glm::vec2 Texcoord	= glm::vec2(0.0f);
 	};
 
-	struct Index
+	/// <summary>
+	/// Compact GPU vertex, 24 bytes instead of the 56 of Vertex. The normal is octahedral encoded in two snorm16,
+	/// the tangent is snorm10 with the binormal sign in w so the binormal is rebuilt in the shader,
+	/// texcoords are half floats.
+	/// </summary>
+	struct PackedVertex
 	{
-		uint32_t V1 = 0, V2 = 0, V3 = 0;
+		glm::vec3 Position	= glm::vec3(0.0f);
+		uint32_t Normal		= 0;
+		uint32_t Tangent	= 0;
+		uint32_t Texcoord	= 0;
 	};
 
-	struct Triangle
+	/// <summary>
+	/// Joints that move a vertex of an animated mesh, 12 bytes. Up to four joints, weights are unorm8 and sum to 255.
+	/// </summary>
+	struct VertexInfluence
 	{
-		Vertex V0, V1, V2;
+		uint16_t Joints[4] = { 0, 0, 0, 0 };
+		uint8_t Weights[4] = { 0, 0, 0, 0 };
+	};
 
-		Triangle(const Vertex& v0, const Vertex& v1, const Vertex& v2)
-			: V0(v0), V1(v1), V2(v2)
-		{}
+	struct Index
+	{
+		uint32_t V1 = 0, V2 = 0, V3 = 0;
 	};
 
+
 	struct Submesh
 	{
 		std::string NodeName;
@@ -63,9 +76,93 @@ namespace Engine
 		uint32_t MaterialIndex	= 0;
 		uint32_t IndexCount		= 0;
 		uint32_t VertexCount	= 0;
+		//Indices in the GPU index buffer, 16-bit when the submesh has at most 65536 vertices
+		uint32_t IndexSize		= sizeof(uint32_t);
+		uint32_t IndexOffset	= 0;
 
 		glm::mat4 Transform = glm::mat4(1.0f);
 		AABB BoundingBox;
+		//UV units per world unit averaged over the triangles, picks the texture mips to stream
+		float UVDensity = 0.0f;
+
+		//Range in the mesh meshlet list, built on import and stored in the mesh cache
+		uint32_t MeshletOffset	= 0;
+		uint32_t MeshletCount	= 0;
+	};
+
+	/// <summary>
+	/// Cluster of at most MeshletBuilder::MaxVertices vertices and MaxTriangles triangles, a contiguous triangle range
+	/// of its submesh. 48 bytes, read as is by the culling shader.
+	/// </summary>
+	struct Meshlet
+	{
+		//Bounding sphere in the space of the submesh
+		glm::vec3 Center	= glm::vec3(0.0f);
+		float Radius		= 0.0f;
+		//Backfacing from every point where dot(normalize(p - Center), ConeAxis) >= ConeCutoff, roughly. 1 never culls.
+		glm::vec3 ConeAxis	= glm::vec3(0.0f);
+		float ConeCutoff	= 1.0f;
+		//Relative to the first triangle of the submesh
+		uint32_t FirstTriangle	= 0;
+		uint32_t TriangleCount	= 0;
+		uint32_t VertexCount	= 0;
+		uint32_t Padding		= 0;
+	};
+
+	/// <summary>
+	/// Material of an imported mesh file. Map paths are relative to the mesh file, empty if the material has none.
+	/// </summary>
+	struct MeshMaterialDescription
+	{
+		std::string Name;
+		glm::vec3 AlbedoColor = glm::vec3(0.6f);
+		float Metalness = 0.0f;
+		float Roughness = 1.0f;
+
+		std::string AlbedoMap;
+		std::string NormalMap;
+		std::string RoughnessMap;
+		std::string MetalnessMap;
+	};
+
+	/// <summary>
+	/// CPU geometry a mesh keeps once its buffers are uploaded. Ordered from least to most memory.
+	/// </summary>
+	enum class MeshRetention
+	{
+		//Only the GPU buffers, raycasts miss and collision meshes cannot be cooked
+		GPUOnly = 0,
+		//Positions, indices and BVHs for ray queries and physics cooking
+		KeepPositionsForQueries,
+		//Every vertex attribute, influence and meshlet as imported
+		KeepAll
+	};
+
+	const char* MeshRetentionToString(MeshRetention retention);
+
+	/// <summary>
+	/// Resident memory of a mesh in bytes, textures and materials excluded.
+	/// </summary>
+	struct MeshMemoryStatistics
+	{
+		//Vertices, positions, indices, influences and meshlets
+		uint64_t CPUGeometry = 0;
+		//Ray query BVHs
+		uint64_t CPUQueries = 0;
+		//Vertex, index, influence and meshlet buffers
+		uint64_t GPU = 0;
+
+		uint64_t GetCPUTotal() const { return CPUGeometry + CPUQueries; }
+	};
+
+	struct MeshRaycastHit
+	{
+		uint32_t Submesh = 0;
+		//Relative to the first triangle of the submesh
+		uint32_t Triangle = 0;
+		//World space
+		float Distance = FLT_MAX;
+		glm::vec3 Position = glm::vec3(0.0f);
 	};
 
 	//------------------------------------------------------------------------------------
@@ -77,28 +174,76 @@ namespace Engine
 		friend class SceneHierarchyPanel;
 
 	public:
-		static Ref<Mesh> Create(const std::string& filename);
-		static Ref<Mesh> Create(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, const glm::mat4& transform = glm::mat4(1.0f));
+		static Ref<Mesh> Create(const std::string& filename, MeshRetention retention = GetDefaultRetention());
+		static Ref<Mesh> Create(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, const glm::mat4& transform = glm::mat4(1.0f), MeshRetention retention = GetDefaultRetention());
+		/// <summary>
+		/// Load the geometry of a mesh file without touching the renderer, so it can run on a worker thread.
+		/// The mesh is usable once FinishLoading has run on the main thread.
+		/// </summary>
+		static Ref<Mesh> LoadGeometry(const std::string& filename, MeshRetention retention = GetDefaultRetention());
+
+		/// <summary>
+		/// Retention of meshes created without one. GPUOnly unless changed, the editor keeps positions for picking.
+		/// </summary>
+		static void SetDefaultRetention(MeshRetention retention);
+		static MeshRetention GetDefaultRetention();
+
+		/// <summary>
+		/// Layout of the mesh vertex buffers, shared by every pipeline that draws meshes.
+		/// </summary>
+		static const VertexBufferLayout& GetVertexLayout();
 
 		static AssetType GetStaticType() { return AssetType::Mesh; }
 		virtual AssetType GetAssetType() const override { return GetStaticType(); }
 
 	public:
-		Mesh(const std::string& filename);
-		Mesh(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, const glm::mat4& transform = glm::mat4(1.0f));
+		Mesh(const std::string& filename, MeshRetention retention = GetDefaultRetention());
+		Mesh(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, const glm::mat4& transform = glm::mat4(1.0f), MeshRetention retention = GetDefaultRetention());
 		~Mesh();
 
+		/// <summary>
+		/// Create the GPU buffers and materials of a mesh from LoadGeometry. Main thread only.
+		/// </summary>
+		void FinishLoading();
+
 		const std::string& GetFilePath() const { return m_FilePath; }
 		std::vector<Submesh>& GetSubmeshes() { return m_Submeshes; }
 		const VertexBufferLayout& GetBaseVertexLayout() { return m_BaseVertexLayout; }
 		const std::vector<Submesh>& GetSubmeshes() const { return m_Submeshes; }
+		/// <summary>
+		/// Empty unless the retention is KeepAll.
+		/// </summary>
 		const std::vector<Vertex>& GetStaticVertices() const { return m_StaticVertices; }
+		/// <summary>
+		/// Empty if the retention is GPUOnly.
+		/// </summary>
+		const std::vector<glm::vec3>& GetPositions() const { return m_Positions; }
 		const std::vector<Index>& GetIndices() const { return m_Indices; }
 
+		MeshRetention GetRetention() const { return m_Retention; }
+		MeshMemoryStatistics GetMemoryStatistics() const;
+
 		/// <summary>
-		/// ȡĳSubmeshTriangle
+		/// Skinned meshes have a skeleton, their vertices are moved by the joints before drawing.
 		/// </summary>
-		const std::vector<Triangle> GetTriangleCache(uint32_t index) const { return m_TriangleCache.at(index); }
+		bool IsAnimated() const { return m_Skeleton.GetJointCount() > 0; }
+		const Skeleton& GetSkeleton() const { return m_Skeleton; }
+		const std::vector<Ref<AnimationClip>>& GetAnimations() const { return m_Animations; }
+		Ref<AnimationClip> FindAnimation(const std::string& name) const;
+		const Ref<VertexBuffer>& GetVertexBuffer() const { return m_VertexBuffer; }
+		const Ref<VertexBuffer>& GetInfluenceBuffer() const { return m_InfluenceBuffer; }
+		const std::vector<Meshlet>& GetMeshlets() const { return m_Meshlets; }
+		const Ref<VertexBuffer>& GetMeshletBuffer() const { return m_MeshletBuffer; }
+		uint32_t GetVertexCount() const { return m_VertexCount; }
+
+		/// <summary>
+		/// Closest hit of a world space ray with the mesh placed at transform. Only hits closer than hit.Distance are reported.
+		/// </summary>
+		bool Raycast(const Ray& ray, const glm::mat4& transform, MeshRaycastHit& hit) const;
+		/// <summary>
+		/// Closest hit of a ray in the space of the submesh.
+		/// </summary>
+		bool RaycastSubmesh(uint32_t submeshIndex, const Ray& ray, BVHRaycastHit& hit) const;
 
 		/// <summary>
 		/// ȡMaterial
@@ -107,9 +252,47 @@ namespace Engine
 		/// <summary>
 		/// ȡMaterial Instances
 		/// </summary>
-		std::vector<Ref<MaterialInstance>> GetMaterials() { return m_Materials; }
+		const std::vector<Ref<MaterialInstance>>& GetMaterials() const { return m_Materials; }
 
 	private:
+		Mesh() = default;
+
+		/// <summary>
+		/// Read the geometry from the cache or the source file, pack the GPU streams and build the BVHs if the retention keeps them.
+		/// </summary>
+		bool LoadFile();
+		/// <summary>
+		/// Import the file with Assimp and fill the geometry. The Assimp scene is released before returning.
+		/// </summary>
+		bool Import(std::vector<MeshMaterialDescription>& materials);
+		/// <summary>
+		/// Fill the geometry from the .tmesh cache of the file.
+		/// </summary>
+		bool LoadCache(const std::string& cachePath, std::vector<MeshMaterialDescription>& materials);
+		/// <summary>
+		/// Encode the geometry into the GPU vertex and index streams and set the index range of each submesh.
+		/// </summary>
+		void PackGeometry(std::vector<uint8_t>& vertexStream, std::vector<uint8_t>& indexStream);
+		void CreateMaterials(const std::vector<MeshMaterialDescription>& materials);
+		/// <summary>
+		/// Copy the positions out of the vertices. The BVHs and meshlets are built from them. The vertices are kept,
+		/// release them once the cache is written unless the retention is KeepAll.
+		/// </summary>
+		void ExtractPositions();
+		/// <summary>
+		/// Skipped for retentions that do not keep query geometry.
+		/// </summary>
+		void BuildBVHs();
+		void BuildMeshlets();
+		/// <summary>
+		/// Drop the CPU geometry the retention does not keep. Call once the buffers are created.
+		/// </summary>
+		void ReleaseGeometry();
+		/// <summary>
+		/// Skeleton, vertex influences and animation clips of a skinned scene.
+		/// </summary>
+		void ImportSkeleton(const aiScene* scene);
+		void ImportAnimations(const aiScene* scene);
 		void TraverseNodes(aiNode* node, const glm::mat4& parentTransform = glm::mat4(1.0f), uint32_t level = 0);
 
 	private:
@@ -124,10 +307,30 @@ namespace Engine
 
 		VertexBufferLayout m_BaseVertexLayout;
 
+		MeshRetention m_Retention = MeshRetention::GPUOnly;
+		uint32_t m_VertexCount = 0;
+
 		std::vector<Vertex> m_StaticVertices;
+		std::vector<glm::vec3> m_Positions;
 		std::vector<Index> m_Indices;
 
-		std::unordered_map<uint32_t, std::vector<Triangle>> m_TriangleCache;
+		//Ray queries, one per submesh
+		std::vector<MeshBVH> m_BVHs;
+
+		//Clusters for GPU culling, see MeshletCuller
+		std::vector<Meshlet> m_Meshlets;
+		Ref<VertexBuffer> m_MeshletBuffer;
+
+		//Animation
+		Skeleton m_Skeleton;
+		std::vector<Ref<AnimationClip>> m_Animations;
+		std::vector<VertexInfluence> m_Influences;
+		Ref<VertexBuffer> m_InfluenceBuffer;
+
+		//Held from LoadFile until FinishLoading
+		std::vector<MeshMaterialDescription> m_PendingMaterials;
+		std::vector<uint8_t> m_PendingVertexStream;
+		std::vector<uint8_t> m_PendingIndexStream;
 
 		//Material
 		Ref<Shader> m_MeshShader;
@@ -138,10 +341,6 @@ namespace Engine
 		std::vector<Ref<Texture2D>> m_RoughnessMaps;
 		std::vector<Ref<Texture2D>> m_MetalnessMaps;
 
-		//Assimp
-		std::unique_ptr<Assimp::Importer> m_Importer;
-		const aiScene* m_Scene;
-
 	private:
 		static const std::string m_InitShaderName;
 	};
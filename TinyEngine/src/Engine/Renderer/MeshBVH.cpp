@@ -0,0 +1,392 @@
+#include "pch.h"
+#include "MeshBVH.h"
+#include "Engine/Renderer/Mesh.h"
+
+#include <algorithm>
+#include <numeric>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+	#define MESH_BVH_SSE 1
+	#include <xmmintrin.h>
+#else
+	#define MESH_BVH_SSE 0
+#endif
+
+namespace Engine
+{
+	//Rejects triangles the ray is parallel to, the determinant is not normalized
+	static const float s_DeterminantEpsilon = 1e-12f;
+
+	struct RayData
+	{
+		glm::vec3 Origin;
+		glm::vec3 Direction;
+		glm::vec3 InverseDirection;
+#if MESH_BVH_SSE
+		__m128 Origin4;
+		__m128 InverseDirection4;
+#endif
+
+		RayData(const Ray& ray)
+			: Origin(ray.Origin), Direction(ray.Direction), InverseDirection(1.0f / ray.Direction)
+		{
+#if MESH_BVH_SSE
+			Origin4 = _mm_setr_ps(Origin.x, Origin.y, Origin.z, 0.0f);
+			InverseDirection4 = _mm_setr_ps(InverseDirection.x, InverseDirection.y, InverseDirection.z, 0.0f);
+#endif
+		}
+	};
+
+	static float SurfaceArea(const glm::vec3& min, const glm::vec3& max)
+	{
+		glm::vec3 extent = max - min;
+		return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+	}
+
+	static bool IntersectNode(const MeshBVH::Node& node, const RayData& ray, float tMax, float& tNear)
+	{
+#if MESH_BVH_SSE
+		//The fourth lane reads LeftFirst and Count and is ignored
+		__m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&node.Min.x), ray.Origin4), ray.InverseDirection4);
+		__m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&node.Max.x), ray.Origin4), ray.InverseDirection4);
+		alignas(16) float enter[4];
+		alignas(16) float exit[4];
+		_mm_store_ps(enter, _mm_min_ps(t1, t2));
+		_mm_store_ps(exit, _mm_max_ps(t1, t2));
+#else
+		float enter[3];
+		float exit[3];
+		for (uint32_t axis = 0; axis < 3; axis++)
+		{
+			float t1 = (node.Min[axis] - ray.Origin[axis]) * ray.InverseDirection[axis];
+			float t2 = (node.Max[axis] - ray.Origin[axis]) * ray.InverseDirection[axis];
+			enter[axis] = glm::min(t1, t2);
+			exit[axis] = glm::max(t1, t2);
+		}
+#endif
+		float tEnter = glm::max(glm::max(enter[0], enter[1]), glm::max(enter[2], 0.0f));
+		float tExit = glm::min(glm::min(exit[0], exit[1]), glm::min(exit[2], tMax));
+		tNear = tEnter;
+		return tEnter <= tExit;
+	}
+
+	/// <summary>
+	/// Moller-Trumbore against up to four triangles at once, both faces. Updates hit if a triangle is closer.
+	/// </summary>
+	static bool IntersectTriangles(const RayData& ray, const glm::vec3* positions, const Index* triangles, const uint32_t* triangleIndices, uint32_t count, BVHRaycastHit& hit)
+	{
+		//Structure of arrays, unused lanes stay degenerate and never hit
+		alignas(16) float a[3][4] = {};
+		alignas(16) float b[3][4] = {};
+		alignas(16) float c[3][4] = {};
+		for (uint32_t lane = 0; lane < count; lane++)
+		{
+			const Index& triangle = triangles[triangleIndices[lane]];
+			const glm::vec3& p0 = positions[triangle.V1];
+			const glm::vec3& p1 = positions[triangle.V2];
+			const glm::vec3& p2 = positions[triangle.V3];
+			for (uint32_t axis = 0; axis < 3; axis++)
+			{
+				a[axis][lane] = p0[axis];
+				b[axis][lane] = p1[axis];
+				c[axis][lane] = p2[axis];
+			}
+		}
+
+		alignas(16) float t[4];
+		alignas(16) float u[4];
+		alignas(16) float v[4];
+		int mask = 0;
+#if MESH_BVH_SSE
+		__m128 ax = _mm_load_ps(a[0]), ay = _mm_load_ps(a[1]), az = _mm_load_ps(a[2]);
+		__m128 e1x = _mm_sub_ps(_mm_load_ps(b[0]), ax), e1y = _mm_sub_ps(_mm_load_ps(b[1]), ay), e1z = _mm_sub_ps(_mm_load_ps(b[2]), az);
+		__m128 e2x = _mm_sub_ps(_mm_load_ps(c[0]), ax), e2y = _mm_sub_ps(_mm_load_ps(c[1]), ay), e2z = _mm_sub_ps(_mm_load_ps(c[2]), az);
+		__m128 dx = _mm_set1_ps(ray.Direction.x), dy = _mm_set1_ps(ray.Direction.y), dz = _mm_set1_ps(ray.Direction.z);
+
+		//p = d x e2, det = e1 . p
+		__m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+		__m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+		__m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+		__m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+		__m128 valid = _mm_cmpgt_ps(_mm_andnot_ps(_mm_set1_ps(-0.0f), det), _mm_set1_ps(s_DeterminantEpsilon));
+		__m128 inverseDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+		//s = o - a, u = (s . p) / det
+		__m128 sx = _mm_sub_ps(_mm_set1_ps(ray.Origin.x), ax);
+		__m128 sy = _mm_sub_ps(_mm_set1_ps(ray.Origin.y), ay);
+		__m128 sz = _mm_sub_ps(_mm_set1_ps(ray.Origin.z), az);
+		__m128 u4 = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inverseDet);
+
+		//q = s x e1, v = (d . q) / det, t = (e2 . q) / det
+		__m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+		__m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+		__m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+		__m128 v4 = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inverseDet);
+		__m128 t4 = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inverseDet);
+
+		__m128 zero = _mm_setzero_ps();
+		valid = _mm_and_ps(valid, _mm_cmpge_ps(u4, zero));
+		valid = _mm_and_ps(valid, _mm_cmpge_ps(v4, zero));
+		valid = _mm_and_ps(valid, _mm_cmple_ps(_mm_add_ps(u4, v4), _mm_set1_ps(1.0f)));
+		valid = _mm_and_ps(valid, _mm_cmpge_ps(t4, zero));
+		valid = _mm_and_ps(valid, _mm_cmplt_ps(t4, _mm_set1_ps(hit.Distance)));
+		mask = _mm_movemask_ps(valid);
+		_mm_store_ps(t, t4);
+		_mm_store_ps(u, u4);
+		_mm_store_ps(v, v4);
+#else
+		for (uint32_t lane = 0; lane < count; lane++)
+		{
+			glm::vec3 p0 = { a[0][lane], a[1][lane], a[2][lane] };
+			glm::vec3 e1 = glm::vec3(b[0][lane], b[1][lane], b[2][lane]) - p0;
+			glm::vec3 e2 = glm::vec3(c[0][lane], c[1][lane], c[2][lane]) - p0;
+			glm::vec3 p = glm::cross(ray.Direction, e2);
+			float det = glm::dot(e1, p);
+			if (glm::abs(det) <= s_DeterminantEpsilon)
+				continue;
+
+			float inverseDet = 1.0f / det;
+			glm::vec3 s = ray.Origin - p0;
+			glm::vec3 q = glm::cross(s, e1);
+			u[lane] = glm::dot(s, p) * inverseDet;
+			v[lane] = glm::dot(ray.Direction, q) * inverseDet;
+			t[lane] = glm::dot(e2, q) * inverseDet;
+			if (u[lane] >= 0.0f && v[lane] >= 0.0f && u[lane] + v[lane] <= 1.0f && t[lane] >= 0.0f && t[lane] < hit.Distance)
+				mask |= 1 << lane;
+		}
+#endif
+		if (mask == 0)
+			return false;
+
+		for (uint32_t lane = 0; lane < 4; lane++)
+		{
+			if ((mask & (1 << lane)) && t[lane] < hit.Distance)
+			{
+				hit.Distance = t[lane];
+				hit.Triangle = triangleIndices[lane];
+				hit.Barycentric = { u[lane], v[lane] };
+			}
+		}
+		return true;
+	}
+
+	void MeshBVH::Build(const glm::vec3* positions, const Index* triangles, uint32_t triangleCount)
+	{
+		m_Nodes.clear();
+		m_Triangles.resize(triangleCount);
+		if (triangleCount == 0)
+			return;
+
+		std::vector<glm::vec3> boundsMin(triangleCount);
+		std::vector<glm::vec3> boundsMax(triangleCount);
+		std::vector<glm::vec3> centroids(triangleCount);
+		for (uint32_t i = 0; i < triangleCount; i++)
+		{
+			const glm::vec3& p0 = positions[triangles[i].V1];
+			const glm::vec3& p1 = positions[triangles[i].V2];
+			const glm::vec3& p2 = positions[triangles[i].V3];
+			boundsMin[i] = glm::min(glm::min(p0, p1), p2);
+			boundsMax[i] = glm::max(glm::max(p0, p1), p2);
+			centroids[i] = (boundsMin[i] + boundsMax[i]) * 0.5f;
+		}
+		std::iota(m_Triangles.begin(), m_Triangles.end(), 0);
+
+		m_Nodes.reserve((size_t)triangleCount * 2);
+		Node root = {};
+		root.LeftFirst = 0;
+		root.Count = triangleCount;
+		m_Nodes.push_back(root);
+
+		struct BuildTask
+		{
+			uint32_t Node;
+			uint32_t Depth;
+		};
+		std::vector<BuildTask> tasks = { { 0, 0 } };
+		while (!tasks.empty())
+		{
+			BuildTask task = tasks.back();
+			tasks.pop_back();
+			uint32_t first = m_Nodes[task.Node].LeftFirst;
+			uint32_t count = m_Nodes[task.Node].Count;
+
+			glm::vec3 nodeMin = glm::vec3(FLT_MAX), nodeMax = glm::vec3(-FLT_MAX);
+			glm::vec3 centroidMin = glm::vec3(FLT_MAX), centroidMax = glm::vec3(-FLT_MAX);
+			for (uint32_t i = first; i < first + count; i++)
+			{
+				uint32_t triangle = m_Triangles[i];
+				nodeMin = glm::min(nodeMin, boundsMin[triangle]);
+				nodeMax = glm::max(nodeMax, boundsMax[triangle]);
+				centroidMin = glm::min(centroidMin, centroids[triangle]);
+				centroidMax = glm::max(centroidMax, centroids[triangle]);
+			}
+			m_Nodes[task.Node].Min = nodeMin;
+			m_Nodes[task.Node].Max = nodeMax;
+
+			if (count <= MaxLeafTriangles || task.Depth >= MaxDepth)
+				continue;
+
+			//Binned SAH over the centroids, the cost of a plane is the area weighted triangle count of both sides
+			glm::vec3 extent = centroidMax - centroidMin;
+			auto getBin = [&](uint32_t triangle, uint32_t axis)
+			{
+				float scale = BinCount / extent[axis];
+				return glm::min(BinCount - 1, (uint32_t)((centroids[triangle][axis] - centroidMin[axis]) * scale));
+			};
+
+			float bestCost = FLT_MAX;
+			uint32_t bestAxis = 0;
+			uint32_t bestSplit = 0;
+			for (uint32_t axis = 0; axis < 3; axis++)
+			{
+				if (extent[axis] <= 0.0f)
+					continue;
+
+				struct Bin
+				{
+					glm::vec3 Min = glm::vec3(FLT_MAX);
+					glm::vec3 Max = glm::vec3(-FLT_MAX);
+					uint32_t Count = 0;
+				};
+				Bin bins[BinCount];
+				for (uint32_t i = first; i < first + count; i++)
+				{
+					uint32_t triangle = m_Triangles[i];
+					Bin& bin = bins[getBin(triangle, axis)];
+					bin.Min = glm::min(bin.Min, boundsMin[triangle]);
+					bin.Max = glm::max(bin.Max, boundsMax[triangle]);
+					bin.Count++;
+				}
+
+				float leftCost[BinCount - 1];
+				Bin leftSide, rightSide;
+				for (uint32_t plane = 0; plane < BinCount - 1; plane++)
+				{
+					leftSide.Min = glm::min(leftSide.Min, bins[plane].Min);
+					leftSide.Max = glm::max(leftSide.Max, bins[plane].Max);
+					leftSide.Count += bins[plane].Count;
+					leftCost[plane] = leftSide.Count ? SurfaceArea(leftSide.Min, leftSide.Max) * leftSide.Count : 0.0f;
+				}
+				for (uint32_t plane = BinCount - 1; plane > 0; plane--)
+				{
+					rightSide.Min = glm::min(rightSide.Min, bins[plane].Min);
+					rightSide.Max = glm::max(rightSide.Max, bins[plane].Max);
+					rightSide.Count += bins[plane].Count;
+					//Both sides need triangles
+					if (rightSide.Count == 0 || rightSide.Count == count)
+						continue;
+
+					float cost = leftCost[plane - 1] + SurfaceArea(rightSide.Min, rightSide.Max) * rightSide.Count;
+					if (cost < bestCost)
+					{
+						bestCost = cost;
+						bestAxis = axis;
+						bestSplit = plane - 1;
+					}
+				}
+			}
+
+			uint32_t middle;
+			if (bestCost < FLT_MAX)
+			{
+				auto begin = m_Triangles.begin() + first;
+				auto split = std::partition(begin, begin + count, [&](uint32_t triangle) { return getBin(triangle, bestAxis) <= bestSplit; });
+				middle = (uint32_t)(split - m_Triangles.begin());
+			}
+			else
+			{
+				//All centroids coincide
+				middle = first + count / 2;
+			}
+
+			uint32_t left = (uint32_t)m_Nodes.size();
+			Node leftNode = {};
+			leftNode.LeftFirst = first;
+			leftNode.Count = middle - first;
+			Node rightNode = {};
+			rightNode.LeftFirst = middle;
+			rightNode.Count = first + count - middle;
+			m_Nodes.push_back(leftNode);
+			m_Nodes.push_back(rightNode);
+
+			m_Nodes[task.Node].LeftFirst = left;
+			m_Nodes[task.Node].Count = 0;
+			tasks.push_back({ left, task.Depth + 1 });
+			tasks.push_back({ left + 1, task.Depth + 1 });
+		}
+		m_Nodes.shrink_to_fit();
+	}
+
+	bool MeshBVH::Raycast(const Ray& ray, const glm::vec3* positions, const Index* triangles, BVHRaycastHit& hit) const
+	{
+		if (m_Nodes.empty())
+			return false;
+
+		RayData data(ray);
+		float tNear;
+		if (!IntersectNode(m_Nodes[0], data, hit.Distance, tNear))
+			return false;
+
+		struct StackEntry
+		{
+			uint32_t Node;
+			float Distance;
+		};
+		StackEntry stack[MaxDepth + 1];
+		uint32_t stackSize = 0;
+
+		bool result = false;
+		uint32_t node = 0;
+		while (true)
+		{
+			const Node& current = m_Nodes[node];
+			if (current.Count > 0)
+			{
+				for (uint32_t i = 0; i < current.Count; i += 4)
+				{
+					uint32_t count = glm::min(4u, current.Count - i);
+					result |= IntersectTriangles(data, positions, triangles, m_Triangles.data() + current.LeftFirst + i, count, hit);
+				}
+			}
+			else
+			{
+				uint32_t nearChild = current.LeftFirst;
+				uint32_t farChild = current.LeftFirst + 1;
+				float tNearChild, tFarChild;
+				bool hitNear = IntersectNode(m_Nodes[nearChild], data, hit.Distance, tNearChild);
+				bool hitFar = IntersectNode(m_Nodes[farChild], data, hit.Distance, tFarChild);
+				if (hitNear && hitFar)
+				{
+					//Visit the nearer child first, the other one is culled later if a closer hit has been found
+					if (tFarChild < tNearChild)
+					{
+						std::swap(nearChild, farChild);
+						std::swap(tNearChild, tFarChild);
+					}
+					stack[stackSize++] = { farChild, tFarChild };
+					node = nearChild;
+					continue;
+				}
+				if (hitNear || hitFar)
+				{
+					node = hitNear ? nearChild : farChild;
+					continue;
+				}
+			}
+
+			node = UINT32_MAX;
+			while (stackSize > 0)
+			{
+				const StackEntry& entry = stack[--stackSize];
+				if (entry.Distance < hit.Distance)
+				{
+					node = entry.Node;
+					break;
+				}
+			}
+			if (node == UINT32_MAX)
+				break;
+		}
+		return result;
+	}
+}
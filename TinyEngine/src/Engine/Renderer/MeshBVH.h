@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Engine/Core/Core.h"
+#include "Engine/Core/Math/Ray.h"
+
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace Engine
+{
+	struct Index;
+
+	struct BVHRaycastHit
+	{
+		//Ray parameter of the hit
+		float Distance = FLT_MAX;
+		//Relative to the first triangle the BVH was built from
+		uint32_t Triangle = 0;
+		glm::vec2 Barycentric = glm::vec2(0.0f);
+	};
+
+	/// <summary>
+	/// Bounding volume hierarchy over the triangles of one submesh, built with binned SAH. Leaves reference ranges of
+	/// a triangle index list, the geometry itself stays in the mesh position and index arrays.
+	/// </summary>
+	class MeshBVH
+	{
+	public:
+		static constexpr uint32_t MaxLeafTriangles = 4;
+		static constexpr uint32_t BinCount = 12;
+		//Deeper nodes become leaves, bounds the traversal stack
+		static constexpr uint32_t MaxDepth = 48;
+
+		/// <summary>
+		/// 32 bytes. Leaves have Count triangles from LeftFirst, inner nodes have Count 0 and children LeftFirst and LeftFirst + 1.
+		/// </summary>
+		struct Node
+		{
+			glm::vec3 Min;
+			uint32_t LeftFirst;
+			glm::vec3 Max;
+			uint32_t Count;
+		};
+
+	public:
+		void Build(const glm::vec3* positions, const Index* triangles, uint32_t triangleCount);
+		/// <summary>
+		/// Closest hit of a ray in the space of the geometry. Only hits closer than hit.Distance are reported.
+		/// </summary>
+		bool Raycast(const Ray& ray, const glm::vec3* positions, const Index* triangles, BVHRaycastHit& hit) const;
+
+		bool IsEmpty() const { return m_Nodes.empty(); }
+		uint64_t GetMemorySize() const { return m_Nodes.size() * sizeof(Node) + m_Triangles.size() * sizeof(uint32_t); }
+
+	private:
+		std::vector<Node> m_Nodes;
+		std::vector<uint32_t> m_Triangles;
+	};
+}
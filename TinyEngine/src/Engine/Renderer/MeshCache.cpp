@@ -0,0 +1,313 @@
+#include "pch.h"
+#include "MeshCache.h"
+#include "Engine/Core/Hash.h"
+
+#include <filesystem>
+#include <thread>
+
+namespace Engine
+{
+	const char* MeshCache::CacheDirectory = "assets/cache/meshes/";
+
+	static const char s_TMeshMagic[4] = { 'T', 'M', 'S', 'H' };
+	//Streams start on this boundary so the mapped data can be read in place
+	static const uint64_t s_StreamAlignment = 16;
+
+#pragma pack(push, 1)
+	struct TMeshHeader
+	{
+		char Magic[4];
+		uint32_t Version;
+		//Catch Vertex and GPU layout changes without a version bump
+		uint32_t VertexSize;
+		uint32_t StreamStride;
+		uint32_t MeshletSize;
+		uint32_t VertexCount;
+		uint32_t TriangleCount;
+		uint32_t SubmeshCount;
+		uint32_t MaterialCount;
+		uint32_t StringTableSize;
+		uint32_t VertexStreamSize;
+		uint32_t IndexStreamSize;
+		uint32_t MeshletCount;
+
+		uint64_t VertexOffset;
+		uint64_t IndexOffset;
+		uint64_t VertexStreamOffset;
+		uint64_t IndexStreamOffset;
+		uint64_t MeshletOffset;
+		uint64_t SubmeshOffset;
+		uint64_t MaterialOffset;
+		uint64_t StringTableOffset;
+	};
+
+	//Strings are offsets into the string table, 0 is the empty string
+	struct TMeshSubmesh
+	{
+		uint32_t NodeName;
+		uint32_t MeshName;
+		uint32_t BaseVertex;
+		uint32_t BaseIndex;
+		uint32_t MaterialIndex;
+		uint32_t IndexCount;
+		uint32_t VertexCount;
+		uint32_t IndexSize;
+		uint32_t IndexOffset;
+		uint32_t MeshletOffset;
+		uint32_t MeshletCount;
+		float Transform[16];
+		float BoundsMin[3];
+		float BoundsMax[3];
+		float UVDensity;
+	};
+
+	struct TMeshMaterial
+	{
+		uint32_t Name;
+		float AlbedoColor[3];
+		float Metalness;
+		float Roughness;
+		uint32_t AlbedoMap;
+		uint32_t NormalMap;
+		uint32_t RoughnessMap;
+		uint32_t MetalnessMap;
+	};
+#pragma pack(pop)
+
+	static uint64_t Align(uint64_t offset)
+	{
+		return (offset + s_StreamAlignment - 1) / s_StreamAlignment * s_StreamAlignment;
+	}
+
+	std::string MeshCache::GetCachePath(const std::string& source)
+	{
+		uint32_t hash = Hash::FNV(source.data(), source.size());
+		hash = Hash::FNV(&Version, sizeof(Version), hash);
+		return std::string(CacheDirectory) + std::filesystem::path(source).stem().string() + "_" + std::to_string(hash) + ".tmesh";
+	}
+
+	bool MeshCache::IsCacheValid(const std::string& source, const std::string& cachePath)
+	{
+		std::error_code error;
+		auto cacheTime = std::filesystem::last_write_time(cachePath, error);
+		if (error)
+			return false;
+		auto sourceTime = std::filesystem::last_write_time(source, error);
+		return !error && cacheTime >= sourceTime;
+	}
+
+	bool MeshCache::Read(const std::string& path, MeshCacheView& view)
+	{
+		view.File = CreateScope<MappedFile>(path);
+		if (!view.File->IsOpen() || view.File->GetSize() < sizeof(TMeshHeader))
+			return false;
+
+		const uint8_t* data = view.File->GetData();
+		uint64_t size = view.File->GetSize();
+		const TMeshHeader& header = *(const TMeshHeader*)data;
+		if (memcmp(header.Magic, s_TMeshMagic, sizeof(s_TMeshMagic)) != 0 || header.Version != Version ||
+			header.VertexSize != sizeof(Vertex) || header.StreamStride != Mesh::GetVertexLayout().GetStride() || header.MeshletSize != sizeof(Meshlet))
+		{
+			ENGINE_WARN("Mesh cache '{0}' is outdated", path);
+			return false;
+		}
+
+		auto inFile = [size](uint64_t offset, uint64_t length) { return offset <= size && length <= size - offset; };
+		if (!inFile(header.VertexOffset, (uint64_t)header.VertexCount * sizeof(Vertex)) ||
+			!inFile(header.IndexOffset, (uint64_t)header.TriangleCount * sizeof(Index)) ||
+			!inFile(header.VertexStreamOffset, header.VertexStreamSize) ||
+			!inFile(header.IndexStreamOffset, header.IndexStreamSize) ||
+			!inFile(header.MeshletOffset, (uint64_t)header.MeshletCount * sizeof(Meshlet)) ||
+			!inFile(header.SubmeshOffset, (uint64_t)header.SubmeshCount * sizeof(TMeshSubmesh)) ||
+			!inFile(header.MaterialOffset, (uint64_t)header.MaterialCount * sizeof(TMeshMaterial)) ||
+			!inFile(header.StringTableOffset, header.StringTableSize) || header.StringTableSize == 0 ||
+			data[header.StringTableOffset + header.StringTableSize - 1] != '\0')
+		{
+			ENGINE_ERROR("Mesh cache '{0}' is truncated", path);
+			return false;
+		}
+
+		const char* strings = (const char*)data + header.StringTableOffset;
+		auto getString = [&](uint32_t offset) { return std::string(offset < header.StringTableSize ? strings + offset : ""); };
+
+		view.Vertices = (const Vertex*)(data + header.VertexOffset);
+		view.VertexCount = header.VertexCount;
+		view.Indices = (const Index*)(data + header.IndexOffset);
+		view.TriangleCount = header.TriangleCount;
+		view.VertexStream = data + header.VertexStreamOffset;
+		view.VertexStreamSize = header.VertexStreamSize;
+		view.IndexStream = data + header.IndexStreamOffset;
+		view.IndexStreamSize = header.IndexStreamSize;
+		view.Meshlets = (const Meshlet*)(data + header.MeshletOffset);
+		view.MeshletCount = header.MeshletCount;
+
+		const TMeshSubmesh* submeshes = (const TMeshSubmesh*)(data + header.SubmeshOffset);
+		view.Submeshes.resize(header.SubmeshCount);
+		for (uint32_t i = 0; i < header.SubmeshCount; i++)
+		{
+			const TMeshSubmesh& source = submeshes[i];
+			Submesh& submesh = view.Submeshes[i];
+			submesh.NodeName = getString(source.NodeName);
+			submesh.MeshName = getString(source.MeshName);
+			submesh.BaseVertex = source.BaseVertex;
+			submesh.BaseIndex = source.BaseIndex;
+			submesh.MaterialIndex = source.MaterialIndex;
+			submesh.IndexCount = source.IndexCount;
+			submesh.VertexCount = source.VertexCount;
+			submesh.IndexSize = source.IndexSize;
+			submesh.IndexOffset = source.IndexOffset;
+			submesh.MeshletOffset = source.MeshletOffset;
+			submesh.MeshletCount = source.MeshletCount;
+			submesh.Transform = glm::make_mat4(source.Transform);
+			submesh.BoundingBox = AABB(glm::make_vec3(source.BoundsMin), glm::make_vec3(source.BoundsMax));
+			submesh.UVDensity = source.UVDensity;
+
+			if ((uint64_t)submesh.BaseVertex + submesh.VertexCount > header.VertexCount ||
+				(uint64_t)submesh.BaseIndex + submesh.IndexCount > (uint64_t)header.TriangleCount * 3 ||
+				(submesh.IndexSize != sizeof(uint16_t) && submesh.IndexSize != sizeof(uint32_t)) ||
+				(uint64_t)submesh.IndexOffset + (uint64_t)submesh.IndexCount * submesh.IndexSize > header.IndexStreamSize ||
+				(uint64_t)submesh.MeshletOffset + submesh.MeshletCount > header.MeshletCount)
+			{
+				ENGINE_ERROR("Mesh cache '{0}': submesh {1} is out of range", path, i);
+				return false;
+			}
+		}
+
+		const TMeshMaterial* materials = (const TMeshMaterial*)(data + header.MaterialOffset);
+		view.Materials.resize(header.MaterialCount);
+		for (uint32_t i = 0; i < header.MaterialCount; i++)
+		{
+			const TMeshMaterial& source = materials[i];
+			MeshMaterialDescription& material = view.Materials[i];
+			material.Name = getString(source.Name);
+			material.AlbedoColor = glm::make_vec3(source.AlbedoColor);
+			material.Metalness = source.Metalness;
+			material.Roughness = source.Roughness;
+			material.AlbedoMap = getString(source.AlbedoMap);
+			material.NormalMap = getString(source.NormalMap);
+			material.RoughnessMap = getString(source.RoughnessMap);
+			material.MetalnessMap = getString(source.MetalnessMap);
+		}
+		return true;
+	}
+
+	bool MeshCache::Write(const std::string& path, const std::vector<Vertex>& vertices, const std::vector<Index>& indices,
+		const std::vector<uint8_t>& vertexStream, const std::vector<uint8_t>& indexStream, const std::vector<Meshlet>& meshlets,
+		const std::vector<Submesh>& submeshes, const std::vector<MeshMaterialDescription>& materials)
+	{
+		std::string stringTable(1, '\0');
+		auto addString = [&stringTable](const std::string& value) -> uint32_t
+		{
+			if (value.empty())
+				return 0;
+			uint32_t offset = (uint32_t)stringTable.size();
+			stringTable.append(value.c_str(), value.size() + 1);
+			return offset;
+		};
+
+		std::vector<TMeshSubmesh> submeshTable(submeshes.size());
+		for (size_t i = 0; i < submeshes.size(); i++)
+		{
+			const Submesh& submesh = submeshes[i];
+			TMeshSubmesh& entry = submeshTable[i];
+			entry.NodeName = addString(submesh.NodeName);
+			entry.MeshName = addString(submesh.MeshName);
+			entry.BaseVertex = submesh.BaseVertex;
+			entry.BaseIndex = submesh.BaseIndex;
+			entry.MaterialIndex = submesh.MaterialIndex;
+			entry.IndexCount = submesh.IndexCount;
+			entry.VertexCount = submesh.VertexCount;
+			entry.IndexSize = submesh.IndexSize;
+			entry.IndexOffset = submesh.IndexOffset;
+			entry.MeshletOffset = submesh.MeshletOffset;
+			entry.MeshletCount = submesh.MeshletCount;
+			memcpy(entry.Transform, glm::value_ptr(submesh.Transform), sizeof(entry.Transform));
+			memcpy(entry.BoundsMin, glm::value_ptr(submesh.BoundingBox.Min), sizeof(entry.BoundsMin));
+			memcpy(entry.BoundsMax, glm::value_ptr(submesh.BoundingBox.Max), sizeof(entry.BoundsMax));
+			entry.UVDensity = submesh.UVDensity;
+		}
+
+		std::vector<TMeshMaterial> materialTable(materials.size());
+		for (size_t i = 0; i < materials.size(); i++)
+		{
+			const MeshMaterialDescription& material = materials[i];
+			TMeshMaterial& entry = materialTable[i];
+			entry.Name = addString(material.Name);
+			memcpy(entry.AlbedoColor, glm::value_ptr(material.AlbedoColor), sizeof(entry.AlbedoColor));
+			entry.Metalness = material.Metalness;
+			entry.Roughness = material.Roughness;
+			entry.AlbedoMap = addString(material.AlbedoMap);
+			entry.NormalMap = addString(material.NormalMap);
+			entry.RoughnessMap = addString(material.RoughnessMap);
+			entry.MetalnessMap = addString(material.MetalnessMap);
+		}
+
+		TMeshHeader header = {};
+		memcpy(header.Magic, s_TMeshMagic, sizeof(s_TMeshMagic));
+		header.Version = Version;
+		header.VertexSize = sizeof(Vertex);
+		header.StreamStride = Mesh::GetVertexLayout().GetStride();
+		header.MeshletSize = sizeof(Meshlet);
+		header.VertexCount = (uint32_t)vertices.size();
+		header.TriangleCount = (uint32_t)indices.size();
+		header.SubmeshCount = (uint32_t)submeshTable.size();
+		header.MaterialCount = (uint32_t)materialTable.size();
+		header.StringTableSize = (uint32_t)stringTable.size();
+		header.VertexStreamSize = (uint32_t)vertexStream.size();
+		header.IndexStreamSize = (uint32_t)indexStream.size();
+		header.MeshletCount = (uint32_t)meshlets.size();
+		header.VertexOffset = Align(sizeof(TMeshHeader));
+		header.IndexOffset = Align(header.VertexOffset + vertices.size() * sizeof(Vertex));
+		header.VertexStreamOffset = Align(header.IndexOffset + indices.size() * sizeof(Index));
+		header.IndexStreamOffset = Align(header.VertexStreamOffset + vertexStream.size());
+		header.MeshletOffset = Align(header.IndexStreamOffset + indexStream.size());
+		header.SubmeshOffset = Align(header.MeshletOffset + meshlets.size() * sizeof(Meshlet));
+		header.MaterialOffset = header.SubmeshOffset + submeshTable.size() * sizeof(TMeshSubmesh);
+		header.StringTableOffset = header.MaterialOffset + materialTable.size() * sizeof(TMeshMaterial);
+
+		//Workers may import the same mesh, write to a private file and move it in place
+		std::error_code error;
+		std::filesystem::path target(path);
+		if (target.has_parent_path())
+			std::filesystem::create_directories(target.parent_path(), error);
+		std::string temporary = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+		{
+			std::ofstream out(temporary, std::ios::out | std::ios::binary);
+			if (!out)
+			{
+				ENGINE_ERROR("Could not write mesh cache '{0}'", path);
+				return false;
+			}
+
+			const char padding[s_StreamAlignment] = {};
+			out.write((const char*)&header, sizeof(header));
+			out.write(padding, header.VertexOffset - sizeof(header));
+			out.write((const char*)vertices.data(), vertices.size() * sizeof(Vertex));
+			out.write(padding, header.IndexOffset - (header.VertexOffset + vertices.size() * sizeof(Vertex)));
+			out.write((const char*)indices.data(), indices.size() * sizeof(Index));
+			out.write(padding, header.VertexStreamOffset - (header.IndexOffset + indices.size() * sizeof(Index)));
+			out.write((const char*)vertexStream.data(), vertexStream.size());
+			out.write(padding, header.IndexStreamOffset - (header.VertexStreamOffset + vertexStream.size()));
+			out.write((const char*)indexStream.data(), indexStream.size());
+			out.write(padding, header.MeshletOffset - (header.IndexStreamOffset + indexStream.size()));
+			out.write((const char*)meshlets.data(), meshlets.size() * sizeof(Meshlet));
+			out.write(padding, header.SubmeshOffset - (header.MeshletOffset + meshlets.size() * sizeof(Meshlet)));
+			out.write((const char*)submeshTable.data(), submeshTable.size() * sizeof(TMeshSubmesh));
+			out.write((const char*)materialTable.data(), materialTable.size() * sizeof(TMeshMaterial));
+			out.write(stringTable.data(), stringTable.size());
+			if (!out)
+			{
+				ENGINE_ERROR("Could not write mesh cache '{0}'", path);
+				return false;
+			}
+		}
+
+		std::filesystem::rename(temporary, path, error);
+		if (error)
+		{
+			std::filesystem::remove(temporary, error);
+			return false;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Engine/Core/Core.h"
+#include "Engine/Core/Ref.h"
+#include "Engine/Core/MappedFile.h"
+#include "Engine/Renderer/Mesh.h"
+
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+	/// <summary>
+	/// Opened .tmesh file. The geometry and the GPU streams point into the mapped file and are valid while File is alive.
+	/// </summary>
+	struct MeshCacheView
+	{
+		Scope<MappedFile> File;
+
+		const Vertex* Vertices = nullptr;
+		uint32_t VertexCount = 0;
+		const Index* Indices = nullptr;
+		uint32_t TriangleCount = 0;
+
+		//Vertex and index buffer contents, see Mesh::PackGeometry
+		const uint8_t* VertexStream = nullptr;
+		uint32_t VertexStreamSize = 0;
+		const uint8_t* IndexStream = nullptr;
+		uint32_t IndexStreamSize = 0;
+
+		//Meshlets of all submeshes, see Submesh::MeshletOffset
+		const Meshlet* Meshlets = nullptr;
+		uint32_t MeshletCount = 0;
+
+		std::vector<Submesh> Submeshes;
+		std::vector<MeshMaterialDescription> Materials;
+	};
+
+	/// <summary>
+	/// Import cache of mesh files. A .tmesh file holds the geometry, the vertex and index streams as they are uploaded,
+	/// the meshlets, the submesh table and the material descriptions, so reloading a mesh needs no Assimp import
+	/// and no meshlet build.
+	/// </summary>
+	class MeshCache
+	{
+	public:
+		static const char* CacheDirectory;
+		//Bump when the file layout, the Vertex struct or the import processing changes
+		static constexpr uint32_t Version = 5;
+
+	public:
+		static std::string GetCachePath(const std::string& source);
+		/// <summary>
+		/// Cache file exists and is newer than the source.
+		/// </summary>
+		static bool IsCacheValid(const std::string& source, const std::string& cachePath);
+
+		static bool Read(const std::string& path, MeshCacheView& view);
+		static bool Write(const std::string& path, const std::vector<Vertex>& vertices, const std::vector<Index>& indices,
+			const std::vector<uint8_t>& vertexStream, const std::vector<uint8_t>& indexStream, const std::vector<Meshlet>& meshlets,
+			const std::vector<Submesh>& submeshes, const std::vector<MeshMaterialDescription>& materials);
+	};
+}
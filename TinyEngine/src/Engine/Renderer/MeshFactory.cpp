@@ -165,4 +165,78 @@ namespace Engine
 
 		return CreateRef<Mesh>(vertices, indices, glm::mat4(1.0f));
 	}
+
+	Ref<Mesh> MeshFactory::CreateHemisphere(float radius)
+	{
+		std::vector<Vertex> vertices;
+		std::vector<Index> indices;
+
+		constexpr float latitudeBands = 15;
+		constexpr float longitudeBands = 30;
+
+		for (float latitude = 0.0f; latitude <= latitudeBands; latitude++)
+		{
+			float theta = latitude * M_PI * 0.5f / latitudeBands;
+			float sinTheta = glm::sin(theta);
+			float cosTheta = glm::cos(theta);
+
+			for (float longitude = 0.0f; longitude <= longitudeBands; longitude++)
+			{
+				float phi = longitude * 2 * M_PI / longitudeBands;
+				float sinPhi = glm::sin(phi);
+				float cosPhi = glm::cos(phi);
+
+				Vertex vertex;
+				vertex.Normal = { cosPhi * sinTheta, cosTheta, sinPhi * sinTheta };
+				vertex.Position = { radius * vertex.Normal.x, radius * vertex.Normal.y, radius * vertex.Normal.z };
+				vertices.push_back(vertex);
+			}
+		}
+
+		for (uint32_t latitude = 0; latitude < latitudeBands; latitude++)
+		{
+			for (uint32_t longitude = 0; longitude < longitudeBands; longitude++)
+			{
+				uint32_t first = (latitude * (longitudeBands + 1)) + longitude;
+				uint32_t second = first + longitudeBands + 1;
+
+				indices.push_back({ first, second, first + 1 });
+				indices.push_back({ second, second + 1, first + 1 });
+			}
+		}
+
+		return CreateRef<Mesh>(vertices, indices, glm::mat4(1.0f));
+	}
+	Ref<Mesh> MeshFactory::CreateCylinder(float radius, float height)
+	{
+		std::vector<Vertex> vertices;
+		std::vector<Index> indices;
+
+		constexpr uint32_t segments = 30;
+
+		for (uint32_t ring = 0; ring < 2; ring++)
+		{
+			float y = ring == 0 ? height * 0.5f : -height * 0.5f;
+			for (uint32_t i = 0; i <= segments; i++)
+			{
+				float phi = i * 2 * M_PI / segments;
+
+				Vertex vertex;
+				vertex.Normal = { glm::cos(phi), 0.0f, glm::sin(phi) };
+				vertex.Position = { radius * vertex.Normal.x, y, radius * vertex.Normal.z };
+				vertices.push_back(vertex);
+			}
+		}
+
+		for (uint32_t i = 0; i < segments; i++)
+		{
+			uint32_t first = i;
+			uint32_t second = first + segments + 1;
+
+			indices.push_back({ first, second, first + 1 });
+			indices.push_back({ second, second + 1, first + 1 });
+		}
+
+		return CreateRef<Mesh>(vertices, indices, glm::mat4(1.0f));
+	}
 }
\ No newline at end of file
@@ -10,5 +10,13 @@ namespace Engine
 		static Ref<Mesh> CreateBox(const glm::vec3& size);
 		static Ref<Mesh> CreateSphere(float radius);
 		static Ref<Mesh> CreateCapsule(float radius, float height);
+		/// <summary>
+		/// Upper half of a sphere, the flat side lies on y = 0.
+		/// </summary>
+		static Ref<Mesh> CreateHemisphere(float radius);
+		/// <summary>
+		/// Open tube along y, centered on the origin.
+		/// </summary>
+		static Ref<Mesh> CreateCylinder(float radius, float height);
 	};
 }
\ No newline at end of file
@@ -0,0 +1,451 @@
+#include "pch.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+
+namespace Engine
+{
+	//Triangles using each vertex, the lists of all vertices share one array
+	struct TriangleAdjacency
+	{
+		std::vector<uint32_t> Offsets;
+		std::vector<uint32_t> Counts;
+		std::vector<uint32_t> Triangles;
+	};
+
+	static void BuildAdjacency(TriangleAdjacency& adjacency, const Index* triangles, uint32_t triangleCount, uint32_t vertexCount)
+	{
+		adjacency.Counts.assign(vertexCount, 0);
+		for (uint32_t i = 0; i < triangleCount; i++)
+		{
+			const uint32_t* corners = &triangles[i].V1;
+			for (uint32_t c = 0; c < 3; c++)
+				adjacency.Counts[corners[c]]++;
+		}
+
+		adjacency.Offsets.resize(vertexCount);
+		uint32_t offset = 0;
+		for (uint32_t i = 0; i < vertexCount; i++)
+		{
+			adjacency.Offsets[i] = offset;
+			offset += adjacency.Counts[i];
+		}
+
+		adjacency.Triangles.resize(offset);
+		std::vector<uint32_t> fill = adjacency.Offsets;
+		for (uint32_t i = 0; i < triangleCount; i++)
+		{
+			const uint32_t* corners = &triangles[i].V1;
+			for (uint32_t c = 0; c < 3; c++)
+				adjacency.Triangles[fill[corners[c]]++] = i;
+		}
+	}
+
+	/// <summary>
+	/// FIFO post-transform cache. A vertex is cached if it was one of the last CacheSize vertices inserted.
+	/// </summary>
+	struct VertexCache
+	{
+		std::vector<uint32_t> Timestamps;
+		uint32_t Time = MeshOptimizer::CacheSize + 1;
+
+		VertexCache(uint32_t vertexCount)
+			: Timestamps(vertexCount, 0)
+		{
+		}
+
+		bool IsCached(uint32_t vertex) const { return Time - Timestamps[vertex] <= MeshOptimizer::CacheSize; }
+		void Flush() { Time += MeshOptimizer::CacheSize + 1; }
+
+		uint32_t Process(const Index& triangle)
+		{
+			uint32_t misses = 0;
+			const uint32_t* corners = &triangle.V1;
+			for (uint32_t c = 0; c < 3; c++)
+			{
+				if (!IsCached(corners[c]))
+				{
+					Timestamps[corners[c]] = Time++;
+					misses++;
+				}
+			}
+			return misses;
+		}
+	};
+
+	static uint32_t CountCacheMisses(const Index* triangles, uint32_t triangleCount, uint32_t vertexCount)
+	{
+		VertexCache cache(vertexCount);
+		uint32_t misses = 0;
+		for (uint32_t i = 0; i < triangleCount; i++)
+			misses += cache.Process(triangles[i]);
+		return misses;
+	}
+
+	/// <summary>
+	/// Tipsify (Sander et al. 2007). Fans around the vertex that stays in the cache while its remaining triangles
+	/// are emitted, clusters start where the walk reaches a dead end and jumps.
+	/// </summary>
+	static void OptimizeVertexCache(Index* triangles, uint32_t triangleCount, uint32_t vertexCount, std::vector<uint32_t>& clusters)
+	{
+		TriangleAdjacency adjacency;
+		BuildAdjacency(adjacency, triangles, triangleCount, vertexCount);
+
+		std::vector<uint32_t> liveTriangles = adjacency.Counts;
+		std::vector<bool> emitted(triangleCount, false);
+		std::vector<uint32_t> deadEnd;
+		deadEnd.reserve((size_t)triangleCount * 3);
+		std::vector<uint32_t> candidates;
+		std::vector<Index> result;
+		result.reserve(triangleCount);
+		VertexCache cache(vertexCount);
+
+		clusters.clear();
+		clusters.push_back(0);
+
+		uint32_t cursor = 0;
+		uint32_t current = 0;
+		while (current != UINT32_MAX)
+		{
+			const uint32_t* neighbours = adjacency.Triangles.data() + adjacency.Offsets[current];
+			for (uint32_t i = 0; i < adjacency.Counts[current]; i++)
+			{
+				uint32_t triangle = neighbours[i];
+				if (emitted[triangle])
+					continue;
+
+				const uint32_t* corners = &triangles[triangle].V1;
+				for (uint32_t c = 0; c < 3; c++)
+				{
+					deadEnd.push_back(corners[c]);
+					candidates.push_back(corners[c]);
+					liveTriangles[corners[c]]--;
+				}
+				cache.Process(triangles[triangle]);
+				emitted[triangle] = true;
+				result.push_back(triangles[triangle]);
+			}
+
+			//Prefer the oldest candidate that is still cached after fanning around it
+			uint32_t next = UINT32_MAX;
+			int64_t bestPriority = -1;
+			for (uint32_t vertex : candidates)
+			{
+				if (liveTriangles[vertex] == 0)
+					continue;
+
+				int64_t priority = 0;
+				uint32_t age = cache.Time - cache.Timestamps[vertex];
+				if (age + 2 * liveTriangles[vertex] <= MeshOptimizer::CacheSize)
+					priority = age;
+				if (priority > bestPriority)
+				{
+					bestPriority = priority;
+					next = vertex;
+				}
+			}
+			candidates.clear();
+
+			//Dead end: continue from a recently used vertex, otherwise from the next vertex with triangles left
+			if (next == UINT32_MAX)
+			{
+				while (!deadEnd.empty() && next == UINT32_MAX)
+				{
+					uint32_t vertex = deadEnd.back();
+					deadEnd.pop_back();
+					if (liveTriangles[vertex] > 0)
+						next = vertex;
+				}
+				for (; next == UINT32_MAX && cursor < vertexCount; cursor++)
+				{
+					if (liveTriangles[cursor] > 0)
+						next = cursor;
+				}
+				if (next != UINT32_MAX && result.size() > clusters.back())
+					clusters.push_back((uint32_t)result.size());
+			}
+			current = next;
+		}
+
+		ENGINE_ASSERT(result.size() == triangleCount, "Vertex cache optimization lost triangles!");
+		std::copy(result.begin(), result.end(), triangles);
+	}
+
+	/// <summary>
+	/// Split the clusters further where the cache is warm enough that a restart costs little, then draw the clusters
+	/// facing away from the mesh center first (Sander et al. 2007).
+	/// </summary>
+	static void OptimizeOverdraw(const Vertex* vertices, uint32_t vertexCount, Index* triangles, uint32_t triangleCount, const std::vector<uint32_t>& hardClusters)
+	{
+		std::vector<uint32_t> clusters;
+		VertexCache cache(vertexCount);
+		for (size_t i = 0; i < hardClusters.size(); i++)
+		{
+			uint32_t begin = hardClusters[i];
+			uint32_t end = i + 1 < hardClusters.size() ? hardClusters[i + 1] : triangleCount;
+
+			cache.Flush();
+			uint32_t clusterMisses = 0;
+			for (uint32_t t = begin; t < end; t++)
+				clusterMisses += cache.Process(triangles[t]);
+			float threshold = MeshOptimizer::OverdrawThreshold * clusterMisses / (float)(end - begin);
+
+			cache.Flush();
+			clusters.push_back(begin);
+			uint32_t runningMisses = 0;
+			uint32_t runningTriangles = 0;
+			for (uint32_t t = begin; t < end; t++)
+			{
+				runningMisses += cache.Process(triangles[t]);
+				runningTriangles++;
+				if (t + 1 < end && runningMisses <= threshold * runningTriangles)
+				{
+					clusters.push_back(t + 1);
+					cache.Flush();
+					runningMisses = 0;
+					runningTriangles = 0;
+				}
+			}
+		}
+
+		//Area weighted centroids and normals
+		struct ClusterSortKey
+		{
+			float Key;
+			uint32_t Cluster;
+		};
+		std::vector<glm::vec3> centroids(clusters.size(), glm::vec3(0.0f));
+		std::vector<glm::vec3> normals(clusters.size(), glm::vec3(0.0f));
+		std::vector<float> areas(clusters.size(), 0.0f);
+		glm::vec3 meshCentroid = glm::vec3(0.0f);
+		float meshArea = 0.0f;
+		for (size_t i = 0; i < clusters.size(); i++)
+		{
+			uint32_t end = i + 1 < clusters.size() ? clusters[i + 1] : triangleCount;
+			for (uint32_t t = clusters[i]; t < end; t++)
+			{
+				const glm::vec3& p0 = vertices[triangles[t].V1].Position;
+				const glm::vec3& p1 = vertices[triangles[t].V2].Position;
+				const glm::vec3& p2 = vertices[triangles[t].V3].Position;
+				glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+				float area = glm::length(normal);
+				centroids[i] += (p0 + p1 + p2) / 3.0f * area;
+				normals[i] += normal;
+				areas[i] += area;
+			}
+			meshCentroid += centroids[i];
+			meshArea += areas[i];
+		}
+		if (meshArea > 0.0f)
+			meshCentroid /= meshArea;
+
+		std::vector<ClusterSortKey> keys(clusters.size());
+		for (size_t i = 0; i < clusters.size(); i++)
+		{
+			float length = glm::length(normals[i]);
+			glm::vec3 centroid = areas[i] > 0.0f ? centroids[i] / areas[i] : meshCentroid;
+			keys[i].Key = length > 0.0f ? glm::dot(centroid - meshCentroid, normals[i] / length) : 0.0f;
+			keys[i].Cluster = (uint32_t)i;
+		}
+		std::stable_sort(keys.begin(), keys.end(), [](const ClusterSortKey& a, const ClusterSortKey& b) { return a.Key > b.Key; });
+
+		std::vector<Index> result;
+		result.reserve(triangleCount);
+		for (const ClusterSortKey& key : keys)
+		{
+			uint32_t begin = clusters[key.Cluster];
+			uint32_t end = key.Cluster + 1 < clusters.size() ? clusters[key.Cluster + 1] : triangleCount;
+			result.insert(result.end(), triangles + begin, triangles + end);
+		}
+		std::copy(result.begin(), result.end(), triangles);
+	}
+
+	/// <summary>
+	/// Renumber vertices in order of first use. Vertices no triangle uses are moved to the end.
+	/// remapOut, if not null, receives the new index of every vertex.
+	/// </summary>
+	static void OptimizeVertexFetch(Vertex* vertices, uint32_t vertexCount, Index* triangles, uint32_t triangleCount, uint32_t* remapOut)
+	{
+		std::vector<uint32_t> remap(vertexCount, UINT32_MAX);
+		uint32_t next = 0;
+		for (uint32_t i = 0; i < triangleCount; i++)
+		{
+			uint32_t* corners = &triangles[i].V1;
+			for (uint32_t c = 0; c < 3; c++)
+			{
+				if (remap[corners[c]] == UINT32_MAX)
+					remap[corners[c]] = next++;
+				corners[c] = remap[corners[c]];
+			}
+		}
+		for (uint32_t i = 0; i < vertexCount; i++)
+		{
+			if (remap[i] == UINT32_MAX)
+				remap[i] = next++;
+		}
+
+		std::vector<Vertex> result(vertexCount);
+		for (uint32_t i = 0; i < vertexCount; i++)
+			result[remap[i]] = vertices[i];
+		std::copy(result.begin(), result.end(), vertices);
+		if (remapOut)
+			std::copy(remap.begin(), remap.end(), remapOut);
+	}
+
+	/// <summary>
+	/// Depth tested rasterization of one triangle, xy in pixels. Returns the pixels that passed the depth test.
+	/// </summary>
+	static uint32_t RasterizeTriangle(std::vector<float>& depth, uint32_t size, const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2)
+	{
+		auto edge = [](const glm::vec3& a, const glm::vec3& b, float x, float y) { return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x); };
+		float area = edge(v0, v1, v2.x, v2.y);
+		if (area == 0.0f)
+			return 0;
+
+		int32_t minX = std::max(0, (int32_t)glm::floor(glm::min(v0.x, glm::min(v1.x, v2.x))));
+		int32_t minY = std::max(0, (int32_t)glm::floor(glm::min(v0.y, glm::min(v1.y, v2.y))));
+		int32_t maxX = std::min((int32_t)size - 1, (int32_t)glm::ceil(glm::max(v0.x, glm::max(v1.x, v2.x))));
+		int32_t maxY = std::min((int32_t)size - 1, (int32_t)glm::ceil(glm::max(v0.y, glm::max(v1.y, v2.y))));
+
+		uint32_t shaded = 0;
+		for (int32_t y = minY; y <= maxY; y++)
+		{
+			for (int32_t x = minX; x <= maxX; x++)
+			{
+				float px = x + 0.5f;
+				float py = y + 0.5f;
+				float w0 = edge(v1, v2, px, py) / area;
+				float w1 = edge(v2, v0, px, py) / area;
+				float w2 = edge(v0, v1, px, py) / area;
+				if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+					continue;
+
+				float z = w0 * v0.z + w1 * v1.z + w2 * v2.z;
+				float& pixel = depth[(size_t)y * size + x];
+				if (z < pixel)
+				{
+					pixel = z;
+					shaded++;
+				}
+			}
+		}
+		return shaded;
+	}
+
+	/// <summary>
+	/// Orthographic views along both directions of each axis, no back face culling like the mesh passes.
+	/// </summary>
+	static void MeasureOverdraw(const Vertex* vertices, uint32_t vertexCount, const Index* triangles, uint32_t triangleCount, uint64_t& shaded, uint64_t& covered)
+	{
+		if (vertexCount == 0 || triangleCount == 0)
+			return;
+
+		glm::vec3 min = glm::vec3(FLT_MAX);
+		glm::vec3 max = glm::vec3(-FLT_MAX);
+		for (uint32_t i = 0; i < vertexCount; i++)
+		{
+			min = glm::min(min, vertices[i].Position);
+			max = glm::max(max, vertices[i].Position);
+		}
+		glm::vec3 extent = max - min;
+		float maxExtent = glm::max(extent.x, glm::max(extent.y, extent.z));
+		if (maxExtent <= 0.0f)
+			return;
+
+		const uint32_t size = MeshOptimizer::OverdrawViewSize;
+		const float scale = size / maxExtent;
+		std::vector<float> depth((size_t)size * size);
+		for (uint32_t axis = 0; axis < 3; axis++)
+		{
+			uint32_t u = (axis + 1) % 3;
+			uint32_t v = (axis + 2) % 3;
+			for (float direction : { 1.0f, -1.0f })
+			{
+				std::fill(depth.begin(), depth.end(), FLT_MAX);
+				for (uint32_t i = 0; i < triangleCount; i++)
+				{
+					glm::vec3 points[3];
+					const uint32_t* corners = &triangles[i].V1;
+					for (uint32_t c = 0; c < 3; c++)
+					{
+						glm::vec3 position = (vertices[corners[c]].Position - min) * scale;
+						points[c] = { position[u], position[v], position[axis] * direction };
+					}
+					shaded += RasterizeTriangle(depth, size, points[0], points[1], points[2]);
+				}
+				for (float pixel : depth)
+				{
+					if (pixel != FLT_MAX)
+						covered++;
+				}
+			}
+		}
+	}
+
+	void MeshOptimizer::Optimize(std::vector<Vertex>& vertices, std::vector<Index>& indices, const std::vector<Submesh>& submeshes, std::vector<uint32_t>* vertexRemap)
+	{
+		if (vertexRemap)
+		{
+			vertexRemap->resize(vertices.size());
+			for (uint32_t i = 0; i < (uint32_t)vertices.size(); i++)
+				(*vertexRemap)[i] = i;
+		}
+
+		std::vector<uint32_t> clusters;
+		for (const Submesh& submesh : submeshes)
+		{
+			uint32_t triangleCount = submesh.IndexCount / 3;
+			if (triangleCount == 0)
+				continue;
+
+			Index* triangles = indices.data() + submesh.BaseIndex / 3;
+			Vertex* submeshVertices = vertices.data() + submesh.BaseVertex;
+			OptimizeVertexCache(triangles, triangleCount, submesh.VertexCount, clusters);
+			OptimizeOverdraw(submeshVertices, submesh.VertexCount, triangles, triangleCount, clusters);
+			uint32_t* remap = vertexRemap ? vertexRemap->data() + submesh.BaseVertex : nullptr;
+			OptimizeVertexFetch(submeshVertices, submesh.VertexCount, triangles, triangleCount, remap);
+			if (remap)
+			{
+				for (uint32_t i = 0; i < submesh.VertexCount; i++)
+					remap[i] += submesh.BaseVertex;
+			}
+		}
+	}
+
+	MeshOptimizerStatistics MeshOptimizer::Analyze(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, const std::vector<Submesh>& submeshes, bool measureOverdraw)
+	{
+		uint64_t misses = 0;
+		uint64_t triangleCount = 0;
+		uint64_t vertexCount = 0;
+		uint64_t shaded = 0;
+		uint64_t covered = 0;
+		for (const Submesh& submesh : submeshes)
+		{
+			const Index* triangles = indices.data() + submesh.BaseIndex / 3;
+			const Vertex* submeshVertices = vertices.data() + submesh.BaseVertex;
+			misses += CountCacheMisses(triangles, submesh.IndexCount / 3, submesh.VertexCount);
+			if (measureOverdraw)
+				MeasureOverdraw(submeshVertices, submesh.VertexCount, triangles, submesh.IndexCount / 3, shaded, covered);
+			triangleCount += submesh.IndexCount / 3;
+			vertexCount += submesh.VertexCount;
+		}
+
+		MeshOptimizerStatistics statistics;
+		statistics.ACMR = triangleCount ? (float)misses / triangleCount : 0.0f;
+		statistics.ATVR = vertexCount ? (float)misses / vertexCount : 0.0f;
+		statistics.Overdraw = covered ? (float)shaded / covered : 0.0f;
+		return statistics;
+	}
+
+	static bool s_OverdrawStatistics = false;
+
+	void MeshOptimizer::SetOverdrawStatisticsEnabled(bool enabled)
+	{
+		s_OverdrawStatistics = enabled;
+	}
+
+	bool MeshOptimizer::IsOverdrawStatisticsEnabled()
+	{
+		return s_OverdrawStatistics;
+	}
+}
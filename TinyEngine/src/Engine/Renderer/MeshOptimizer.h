@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Engine/Core/Core.h"
+#include "Engine/Renderer/Mesh.h"
+
+#include <vector>
+
+namespace Engine
+{
+	struct MeshOptimizerStatistics
+	{
+		//Post-transform cache misses per triangle and per vertex
+		float ACMR = 0.0f;
+		float ATVR = 0.0f;
+		//Shaded pixels per covered pixel, averaged over the six axis views. 0 if not measured.
+		float Overdraw = 0.0f;
+	};
+
+	/// <summary>
+	/// Import-time reordering of mesh geometry. Triangles are ordered for the post-transform vertex cache (Tipsify),
+	/// the cache clusters are then sorted front to back for less overdraw, and vertices are ordered by first use
+	/// for fetch locality. Every submesh is optimized in place, the submesh ranges do not change.
+	/// </summary>
+	class MeshOptimizer
+	{
+	public:
+		//Modeled FIFO post-transform cache
+		static constexpr uint32_t CacheSize = 16;
+		//Cache clusters are split where the running ACMR is within this factor of the cluster ACMR
+		static constexpr float OverdrawThreshold = 1.05f;
+		//Resolution of the views used to measure overdraw
+		static constexpr uint32_t OverdrawViewSize = 128;
+
+	public:
+		/// <summary>
+		/// vertexRemap, if not null, receives the new index of every vertex so per-vertex data kept elsewhere can follow.
+		/// </summary>
+		static void Optimize(std::vector<Vertex>& vertices, std::vector<Index>& indices, const std::vector<Submesh>& submeshes, std::vector<uint32_t>* vertexRemap = nullptr);
+		/// <summary>
+		/// Measure the cache statistics, and the overdraw if measureOverdraw is set. Overdraw is slow, it rasterizes every submesh from six views.
+		/// </summary>
+		static MeshOptimizerStatistics Analyze(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, const std::vector<Submesh>& submeshes, bool measureOverdraw = false);
+
+		/// <summary>
+		/// Whether imports measure the overdraw before and after optimizing. Off by default, for profiling.
+		/// </summary>
+		static void SetOverdrawStatisticsEnabled(bool enabled);
+		static bool IsOverdrawStatisticsEnabled();
+	};
+}
@@ -0,0 +1,318 @@
+#include "pch.h"
+#include "Meshlet.h"
+#include "Engine/Renderer/Renderer.h"
+
+namespace Engine
+{
+	//-----------------------------------------------------------------------------------
+	//MeshletBuilder
+	//-----------------------------------------------------------------------------------
+	static void CalculateBounds(const glm::vec3* positions, const Index* triangles, Meshlet& meshlet)
+	{
+		const Index* first = triangles + meshlet.FirstTriangle;
+
+		//Sphere around the box of the corners
+		glm::vec3 min(FLT_MAX), max(-FLT_MAX);
+		for (uint32_t i = 0; i < meshlet.TriangleCount; i++)
+		{
+			const uint32_t* corners = &first[i].V1;
+			for (uint32_t c = 0; c < 3; c++)
+			{
+				min = glm::min(min, positions[corners[c]]);
+				max = glm::max(max, positions[corners[c]]);
+			}
+		}
+		meshlet.Center = (min + max) * 0.5f;
+		meshlet.Radius = 0.0f;
+
+		glm::vec3 normalSum(0.0f);
+		for (uint32_t i = 0; i < meshlet.TriangleCount; i++)
+		{
+			const uint32_t* corners = &first[i].V1;
+			for (uint32_t c = 0; c < 3; c++)
+				meshlet.Radius = glm::max(meshlet.Radius, glm::distance(meshlet.Center, positions[corners[c]]));
+
+			glm::vec3 normal = glm::cross(positions[first[i].V2] - positions[first[i].V1], positions[first[i].V3] - positions[first[i].V1]);
+			float length = glm::length(normal);
+			if (length > 0.0f)
+				normalSum += normal / length;
+		}
+
+		//Normal cone, the widest angle between a triangle normal and the average normal
+		meshlet.ConeCutoff = 1.0f;
+		float axisLength = glm::length(normalSum);
+		if (axisLength <= 0.0f)
+			return;
+		meshlet.ConeAxis = normalSum / axisLength;
+
+		float minDot = 1.0f;
+		for (uint32_t i = 0; i < meshlet.TriangleCount; i++)
+		{
+			glm::vec3 normal = glm::cross(positions[first[i].V2] - positions[first[i].V1], positions[first[i].V3] - positions[first[i].V1]);
+			float length = glm::length(normal);
+			if (length > 0.0f)
+				minDot = glm::min(minDot, glm::dot(normal / length, meshlet.ConeAxis));
+		}
+
+		//Cones wider than about 85 degrees are never entirely backfacing
+		if (minDot <= 0.1f)
+			return;
+		//The view directions the meshlet is backfacing from form the cone widened by 90 degrees, sin of the cone angle
+		meshlet.ConeCutoff = glm::sqrt(1.0f - minDot * minDot);
+	}
+
+	void MeshletBuilder::Build(const glm::vec3* positions, uint32_t vertexCount, const Index* triangles, uint32_t triangleCount, std::vector<Meshlet>& meshlets)
+	{
+		if (triangleCount == 0)
+			return;
+
+		//Stamp of the meshlet a vertex was last added to
+		std::vector<uint32_t> stamps(vertexCount, UINT32_MAX);
+		uint32_t stamp = 0;
+
+		Meshlet meshlet;
+		for (uint32_t i = 0; i < triangleCount; i++)
+		{
+			const uint32_t* corners = &triangles[i].V1;
+			uint32_t newVertices = 0;
+			for (uint32_t c = 0; c < 3; c++)
+				newVertices += stamps[corners[c]] != stamp ? 1 : 0;
+
+			if (meshlet.VertexCount + newVertices > MaxVertices || meshlet.TriangleCount == MaxTriangles)
+			{
+				CalculateBounds(positions, triangles, meshlet);
+				meshlets.push_back(meshlet);
+
+				meshlet = Meshlet();
+				meshlet.FirstTriangle = i;
+				stamp++;
+				newVertices = 3;
+			}
+
+			for (uint32_t c = 0; c < 3; c++)
+				stamps[corners[c]] = stamp;
+			meshlet.VertexCount += newVertices;
+			meshlet.TriangleCount++;
+		}
+
+		CalculateBounds(positions, triangles, meshlet);
+		meshlets.push_back(meshlet);
+	}
+
+	//-----------------------------------------------------------------------------------
+	//MeshletCuller
+	//-----------------------------------------------------------------------------------
+	//DrawElementsIndirectCommand
+	struct IndirectCommand
+	{
+		uint32_t Count;
+		uint32_t InstanceCount;
+		uint32_t FirstIndex;
+		int32_t BaseVertex;
+		uint32_t BaseInstance;
+	};
+
+	//Layouts of MeshletCulling.glsl
+	struct CullingView
+	{
+		//Planes of the clip space box, normals point inside
+		glm::vec4 FrustumPlanes[6];
+		glm::vec4 CameraPosition;
+	};
+
+	struct CullingJob
+	{
+		glm::mat4 Transform;
+		//Meshlet offset, meshlet count, command offset, draw index
+		glm::uvec4 Draw;
+		//First index, base vertex, cone culling, view
+		glm::uvec4 Params;
+		float MaxScale;
+		float Padding[3];
+	};
+
+	//Submeshes culled for one view. Their dispatches run together before the draws of the view.
+	struct CullingPass
+	{
+		uint32_t View = 0;
+		CullingView ViewData;
+		bool ConeCulling = true;
+		uint32_t FirstCommand = 0;
+		uint32_t CommandCount = 0;
+		//Draw index of the first job
+		uint32_t FirstDraw = 0;
+		std::vector<CullingJob> Jobs;
+		std::vector<Ref<VertexBuffer>> MeshletBuffers;
+	};
+
+	static Ref<VertexBuffer> s_CommandBuffer;
+	//Visible meshlets of each culled submesh, the draw count of the indirect draw
+	static Ref<VertexBuffer> s_CountBuffer;
+	//One job per culled submesh, indexed like the counts
+	static Ref<VertexBuffer> s_JobBuffer;
+	static Ref<VertexBuffer> s_ViewBuffer;
+	static Ref<Shader> s_CullingShader;
+	static uint32_t s_CommandCount = 0;
+	static uint32_t s_DrawCount = 0;
+	static uint32_t s_ViewCount = 0;
+
+	static bool s_Enabled = true;
+	static bool s_HasView = false;
+	//Null if the submits of the current view are drawn whole
+	static Ref<CullingPass> s_Pass;
+
+	static void DispatchCullingPass(const Ref<Shader>& shader, const CullingPass& pass)
+	{
+		uint32_t jobCount = (uint32_t)pass.Jobs.size();
+		if (jobCount == 0)
+			return;
+
+		RendererAPI& api = Renderer::GetAPI();
+		//The commands and draws of the view are contiguous
+		api.ClearBuffer(s_CommandBuffer->GetRendererID(), pass.FirstCommand * sizeof(IndirectCommand), pass.CommandCount * sizeof(IndirectCommand));
+		api.ClearBuffer(s_CountBuffer->GetRendererID(), pass.FirstDraw * sizeof(uint32_t), jobCount * sizeof(uint32_t));
+		api.SetBufferData(s_JobBuffer->GetRendererID(), pass.Jobs.data(), jobCount * sizeof(CullingJob), pass.FirstDraw * sizeof(CullingJob));
+		api.SetBufferData(s_ViewBuffer->GetRendererID(), &pass.ViewData, sizeof(CullingView), pass.View * sizeof(CullingView));
+
+		api.BindStorageBuffer(1, s_CommandBuffer->GetRendererID());
+		api.BindStorageBuffer(2, s_CountBuffer->GetRendererID());
+		api.BindStorageBuffer(3, s_JobBuffer->GetRendererID());
+		api.BindStorageBuffer(4, s_ViewBuffer->GetRendererID());
+		uint32_t boundMeshlets = 0;
+		for (uint32_t i = 0; i < jobCount; i++)
+		{
+			//Submeshes of the same mesh follow each other
+			uint32_t meshlets = pass.MeshletBuffers[i]->GetRendererID();
+			if (meshlets != boundMeshlets)
+			{
+				api.BindStorageBuffer(0, meshlets);
+				boundMeshlets = meshlets;
+			}
+			shader->UploadUniform("u_Job", pass.FirstDraw + i);
+			api.DispatchCompute((pass.Jobs[i].Draw.y + MeshletCuller::GroupSize - 1) / MeshletCuller::GroupSize);
+		}
+
+		//The commands and the counts are read by the indirect draws of the view
+		api.Barrier((uint32_t)RendererBarrier::IndirectCommands);
+	}
+
+	void MeshletCuller::Init()
+	{
+		s_CommandBuffer = VertexBuffer::Create(MaxCommands * sizeof(IndirectCommand), VertexBufferUsage::Dynamic);
+		s_CountBuffer = VertexBuffer::Create(MaxDraws * sizeof(uint32_t), VertexBufferUsage::Dynamic);
+		s_JobBuffer = VertexBuffer::Create(MaxDraws * sizeof(CullingJob), VertexBufferUsage::Dynamic);
+		s_ViewBuffer = VertexBuffer::Create(MaxViews * sizeof(CullingView), VertexBufferUsage::Dynamic);
+	}
+
+	void MeshletCuller::Shutdown()
+	{
+		s_CommandBuffer.reset();
+		s_CountBuffer.reset();
+		s_JobBuffer.reset();
+		s_ViewBuffer.reset();
+		s_CullingShader.reset();
+		s_Pass.reset();
+	}
+
+	void MeshletCuller::BeginFrame()
+	{
+		s_CommandCount = 0;
+		s_DrawCount = 0;
+		s_ViewCount = 0;
+	}
+
+	void MeshletCuller::SetView(const MeshletCullingView* view)
+	{
+		s_HasView = view != nullptr;
+		s_Pass = nullptr;
+		//Out of views for this frame, the rest is drawn whole
+		if (!view || !s_Enabled || s_ViewCount >= MaxViews)
+			return;
+
+		if (!s_CullingShader)
+			s_CullingShader = Renderer::GetShaderLibrary().Get("MeshletCulling");
+		if (!s_CullingShader->IsReady())
+			return;
+
+		Ref<CullingPass> pass = CreateRef<CullingPass>();
+		pass->View = s_ViewCount++;
+		pass->ConeCulling = view->ConeCulling;
+		pass->FirstCommand = s_CommandCount;
+		pass->FirstDraw = s_DrawCount;
+
+		//Planes of the clip space box, normals point inside
+		const glm::mat4& m = view->ViewProjection;
+		glm::vec4 rows[4];
+		for (int i = 0; i < 4; i++)
+			rows[i] = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+		for (int i = 0; i < 3; i++)
+		{
+			pass->ViewData.FrustumPlanes[i * 2] = rows[3] + rows[i];
+			pass->ViewData.FrustumPlanes[i * 2 + 1] = rows[3] - rows[i];
+		}
+		for (auto& plane : pass->ViewData.FrustumPlanes)
+			plane /= glm::length(glm::vec3(plane));
+		pass->ViewData.CameraPosition = glm::vec4(view->CameraPosition, 1.0f);
+		s_Pass = pass;
+
+		//Cull adds the jobs while the view is recorded, the queue executes them all here, ahead of the draws
+		Ref<Shader> shader = s_CullingShader;
+		shader->Bind();
+		Renderer::Submit([shader, pass]()
+			{
+				DispatchCullingPass(shader, *pass);
+			});
+	}
+
+	bool MeshletCuller::HasView()
+	{
+		return s_HasView;
+	}
+
+	void MeshletCuller::SetEnabled(bool enabled)
+	{
+		s_Enabled = enabled;
+	}
+
+	bool MeshletCuller::IsEnabled()
+	{
+		return s_Enabled;
+	}
+
+	bool MeshletCuller::Cull(const Ref<Mesh>& mesh, uint32_t submeshIndex, const glm::mat4& transform, MeshletDraw& draw)
+	{
+		const Submesh& submesh = mesh->GetSubmeshes()[submeshIndex];
+		if (!s_Enabled || !s_Pass || submesh.MeshletCount < MinMeshlets || !mesh->GetMeshletBuffer())
+			return false;
+		//Out of commands for this frame, the rest is drawn whole
+		if (s_CommandCount + submesh.MeshletCount > MaxCommands || s_DrawCount >= MaxDraws)
+			return false;
+
+		draw.CommandOffset = s_CommandCount;
+		draw.MaxCommands = submesh.MeshletCount;
+		draw.DrawIndex = s_DrawCount;
+		s_CommandCount += submesh.MeshletCount;
+		s_DrawCount++;
+
+		glm::mat3 linear(transform);
+		//Mirrored transforms flip the winding, the cones would cull the front faces
+		bool coneCulling = s_Pass->ConeCulling && glm::determinant(linear) > 0.0f;
+
+		CullingJob job;
+		job.Transform = transform;
+		job.Draw = { submesh.MeshletOffset, submesh.MeshletCount, draw.CommandOffset, draw.DrawIndex };
+		job.Params = { submesh.IndexOffset / submesh.IndexSize, submesh.BaseVertex, coneCulling ? 1u : 0u, s_Pass->View };
+		job.MaxScale = glm::max(glm::length(linear[0]), glm::max(glm::length(linear[1]), glm::length(linear[2])));
+
+		s_Pass->Jobs.push_back(job);
+		s_Pass->MeshletBuffers.push_back(mesh->GetMeshletBuffer());
+		s_Pass->CommandCount += submesh.MeshletCount;
+		return true;
+	}
+
+	void MeshletCuller::DrawIndirect(const Submesh& submesh, const MeshletDraw& draw)
+	{
+		Renderer::GetAPI().DrawElementsIndirect(submesh.IndexSize, s_CommandBuffer->GetRendererID(), draw.CommandOffset * sizeof(IndirectCommand), draw.MaxCommands,
+			s_CountBuffer->GetRendererID(), draw.DrawIndex * sizeof(uint32_t));
+	}
+}
\ No newline at end of file
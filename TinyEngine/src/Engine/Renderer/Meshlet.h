@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Engine/Core/Core.h"
+#include "Engine/Renderer/Mesh.h"
+#include "Engine/Renderer/Shader.h"
+
+#include <vector>
+
+namespace Engine
+{
+	/// <summary>
+	/// Splits submeshes into meshlets. Triangles keep the order MeshOptimizer gave them, which already groups
+	/// neighbours, so every meshlet is a contiguous triangle range and draws straight from the mesh index buffer.
+	/// </summary>
+	class MeshletBuilder
+	{
+	public:
+		static constexpr uint32_t MaxVertices = 64;
+		static constexpr uint32_t MaxTriangles = 124;
+
+	public:
+		/// <summary>
+		/// Append the meshlets of one submesh to meshlets. Indices are relative to vertices.
+		/// </summary>
+		static void Build(const glm::vec3* positions, uint32_t vertexCount, const Index* triangles, uint32_t triangleCount, std::vector<Meshlet>& meshlets);
+	};
+
+	struct MeshletCullingView
+	{
+		glm::mat4 ViewProjection = glm::mat4(1.0f);
+		glm::vec3 CameraPosition = glm::vec3(0.0f);
+		//Backface cone test, off for shadow maps
+		bool ConeCulling = true;
+	};
+
+	/// <summary>
+	/// Indirect draw of one culled submesh, filled by MeshletCuller::Cull.
+	/// </summary>
+	struct MeshletDraw
+	{
+		uint32_t CommandOffset = 0;
+		uint32_t MaxCommands = 0;
+		uint32_t DrawIndex = 0;
+	};
+
+	/// <summary>
+	/// GPU culling of meshlets. A compute dispatch per submesh tests the meshlets against the frustum of the current
+	/// view and their normal cones, and writes the visible ones as compacted indirect draw commands.
+	/// Renderer::SubmitMesh culls submeshes with enough meshlets while a view is set. The dispatches of a view run
+	/// together ahead of its draws, with one clear of its commands and one barrier.
+	/// </summary>
+	class MeshletCuller
+	{
+	public:
+		//Submeshes with fewer meshlets are drawn whole, culling them costs more than it saves
+		static constexpr uint32_t MinMeshlets = 16;
+		//Per frame, over all views
+		static constexpr uint32_t MaxCommands = 1 << 17;
+		static constexpr uint32_t MaxDraws = 8192;
+		static constexpr uint32_t MaxViews = 64;
+		//Threads per group of the culling shader
+		static constexpr uint32_t GroupSize = 64;
+
+	public:
+		static void Init();
+		static void Shutdown();
+
+		/// <summary>
+		/// Release the commands of the last frame. Call before the passes are recorded.
+		/// </summary>
+		static void BeginFrame();
+
+		/// <summary>
+		/// View the following submits are culled for. Null draws everything. Binds the culling shader, so bind the material afterwards.
+		/// </summary>
+		static void SetView(const MeshletCullingView* view);
+		static bool HasView();
+
+		static void SetEnabled(bool enabled);
+		static bool IsEnabled();
+
+		/// <summary>
+		/// Add a submesh to the culling of the current view. Returns false if the submesh is not culled and must be drawn whole.
+		/// </summary>
+		static bool Cull(const Ref<Mesh>& mesh, uint32_t submeshIndex, const glm::mat4& transform, MeshletDraw& draw);
+		/// <summary>
+		/// Draw the visible meshlets of a culled submesh. Render thread only, with the mesh buffers bound.
+		/// </summary>
+		static void DrawIndirect(const Submesh& submesh, const MeshletDraw& draw);
+	};
+}
@@ -5,12 +5,17 @@
 namespace Engine
 {
 	const uint32_t RenderCommandQueue::MaxQueueSize = 10 * 1024 * 1024; //10MB
+	const uint32_t RenderCommandQueue::InitialFrameDataSize = 4 * 1024 * 1024; //4MB
 
 	RenderCommandQueue::RenderCommandQueue()
 	{
 		m_CommandBuffer = new uint8_t[MaxQueueSize];
 		m_CommandBufferPtr = m_CommandBuffer;
 		memset(m_CommandBuffer, 0, MaxQueueSize);
+
+		m_FrameDataSize = InitialFrameDataSize;
+		m_FrameData = new uint8_t[m_FrameDataSize];
+		m_FrameDataPtr = m_FrameData;
 	}
 
 	RenderCommandQueue::~RenderCommandQueue()
@@ -19,6 +24,9 @@ namespace Engine
 			Execute();
 
 		delete[] m_CommandBuffer;
+		delete[] m_FrameData;
+		for (uint8_t* data : m_FrameDataOverflow)
+			delete[] data;
 	}
 
 	void* RenderCommandQueue::Allocate(RenderCommandFn func, uint32_t size)
@@ -36,6 +44,24 @@ namespace Engine
 		return memory;
 	}
 
+	void* RenderCommandQueue::AllocateFrameData(uint32_t size)
+	{
+		//Keep allocations 16 byte aligned for matrices
+		size = (size + 15) & ~15u;
+		if (m_FrameDataPtr + size > m_FrameData + m_FrameDataSize)
+		{
+			//Commands point into the arena, it cannot move before they are executed
+			uint8_t* memory = new uint8_t[size];
+			m_FrameDataOverflow.push_back(memory);
+			m_FrameDataOverflowSize += size;
+			return memory;
+		}
+
+		void* memory = m_FrameDataPtr;
+		m_FrameDataPtr += size;
+		return memory;
+	}
+
 	void RenderCommandQueue::Execute()
 	{
 		uint8_t* buffer = m_CommandBuffer;
@@ -56,5 +82,21 @@ namespace Engine
 
 		m_CommandBufferPtr = m_CommandBuffer;
 		m_CommandCount = 0;
+
+		for (uint8_t* data : m_FrameDataOverflow)
+			delete[] data;
+		m_FrameDataOverflow.clear();
+		if (m_FrameDataOverflowSize)
+		{
+			//Big enough for this frame, so the next similar frames stay in the arena
+			uint64_t required = (uint64_t)m_FrameDataSize + m_FrameDataOverflowSize;
+			while (m_FrameDataSize < required)
+				m_FrameDataSize *= 2;
+			delete[] m_FrameData;
+			m_FrameData = new uint8_t[m_FrameDataSize];
+			m_FrameDataOverflowSize = 0;
+			ENGINE_WARN("Render command frame data grown to {0} bytes", m_FrameDataSize);
+		}
+		m_FrameDataPtr = m_FrameData;
 	}
 }
\ No newline at end of file
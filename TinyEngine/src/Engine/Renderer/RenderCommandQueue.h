@@ -6,6 +6,8 @@ namespace Engine
 	{
 	public:
 		static const uint32_t MaxQueueSize;
+		//Grows when a frame needs more
+		static const uint32_t InitialFrameDataSize;
 
 	public:
 		typedef void(*RenderCommandFn)(void*);
@@ -14,11 +16,23 @@ namespace Engine
 		~RenderCommandQueue();
 
 		void* Allocate(RenderCommandFn func, uint32_t size);
+		/// <summary>
+		/// Scratch memory for data referenced by commands. Valid until the queue is executed.
+		/// Frames that need more than the arena get heap memory, and the arena grows on Execute.
+		/// </summary>
+		void* AllocateFrameData(uint32_t size);
 		void Execute();
 
 	private:
 		uint8_t* m_CommandBuffer;
 		uint8_t* m_CommandBufferPtr;
 		uint32_t m_CommandCount = 0;
+
+		uint8_t* m_FrameData;
+		uint8_t* m_FrameDataPtr;
+		uint32_t m_FrameDataSize;
+		//Allocations that did not fit in the arena this frame
+		std::vector<uint8_t*> m_FrameDataOverflow;
+		uint32_t m_FrameDataOverflowSize = 0;
 	};
 }
\ No newline at end of file
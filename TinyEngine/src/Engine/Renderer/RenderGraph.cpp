@@ -0,0 +1,358 @@
+#include "pch.h"
+#include "RenderGraph.h"
+#include "Engine/Renderer/Renderer.h"
+
+#include <glad/glad.h>
+
+namespace Engine
+{
+	static bool IsSameSpecification(const RenderGraphTargetSpecification& a, const RenderGraphTargetSpecification& b)
+	{
+		const FrameBufferSpecification& fa = a.FrameBuffer;
+		const FrameBufferSpecification& fb = b.FrameBuffer;
+		if (a.ViewportSized != b.ViewportSized)
+			return false;
+		if (fa.Width != fb.Width || fa.Height != fb.Height || fa.Samples != fb.Samples)
+			return false;
+		if (fa.ClearColor != fb.ClearColor || fa.BorderColor != fb.BorderColor)
+			return false;
+		if (fa.Attachments.size() != fb.Attachments.size())
+			return false;
+		for (size_t i = 0; i < fa.Attachments.size(); i++)
+		{
+			if (fa.Attachments[i].TextureFormat != fb.Attachments[i].TextureFormat)
+				return false;
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////////////
+	// RenderGraphResources
+	//////////////////////////////////////////////////////////////////////////////////
+
+	Ref<RenderPass> RenderGraphResources::GetRenderPass(const std::string& name) const
+	{
+		return m_Graph->GetRenderPass(name);
+	}
+
+	Ref<FrameBuffer> RenderGraphResources::GetFrameBuffer(const std::string& name) const
+	{
+		return m_Graph->GetFrameBuffer(name);
+	}
+
+	//////////////////////////////////////////////////////////////////////////////////
+	// RenderGraphPass
+	//////////////////////////////////////////////////////////////////////////////////
+
+	RenderGraphPass& RenderGraphPass::Read(const std::string& name, RenderGraphAttachment attachment)
+	{
+		m_Reads.push_back({ m_Graph->GetTargetIndex(name), attachment });
+		return *this;
+	}
+
+	RenderGraphPass& RenderGraphPass::Write(const std::string& name)
+	{
+		m_Writes.push_back(m_Graph->GetTargetIndex(name));
+		return *this;
+	}
+
+	RenderGraphPass& RenderGraphPass::WriteStorage(const std::string& name)
+	{
+		uint32_t index = m_Graph->GetTargetIndex(name);
+		m_Writes.push_back(index);
+		m_StorageWrites.push_back(index);
+		return *this;
+	}
+
+	//////////////////////////////////////////////////////////////////////////////////
+	// RenderGraph
+	//////////////////////////////////////////////////////////////////////////////////
+
+	void RenderGraph::CreateTarget(const std::string& name, const RenderGraphTargetSpecification& spec)
+	{
+		ENGINE_ASSERT(m_TargetIndices.find(name) == m_TargetIndices.end(), "Render graph target already exists!");
+		m_TargetIndices[name] = (uint32_t)m_Targets.size();
+
+		Target target;
+		target.Name = name;
+		target.Specification = spec;
+		m_Targets.push_back(target);
+		m_Compiled = false;
+	}
+
+	RenderGraphPass& RenderGraph::AddPass(const std::string& name, const RenderGraphExecuteFn& execute)
+	{
+		auto pass = CreateScope<RenderGraphPass>();
+		pass->m_Graph = this;
+		pass->m_Name = name;
+		pass->m_Execute = execute;
+		m_Passes.push_back(std::move(pass));
+		m_Compiled = false;
+		return *m_Passes.back();
+	}
+
+	void RenderGraph::SetOutput(const std::string& name)
+	{
+		m_Targets[GetTargetIndex(name)].Output = true;
+		m_Compiled = false;
+	}
+
+	void RenderGraph::Compile()
+	{
+		//Producers and consumers
+		for (auto& target : m_Targets)
+		{
+			target.Producers.clear();
+			target.Consumers.clear();
+			target.FirstUse = target.LastUse = target.LastWrite = -1;
+			target.ColorRead = target.DepthRead = false;
+			target.PhysicalIndex = -1;
+		}
+		for (uint32_t p = 0; p < m_Passes.size(); p++)
+		{
+			auto& pass = m_Passes[p];
+			pass->m_Culled = false;
+			pass->m_BarrierBefore = false;
+			pass->m_DiscardsAfter.clear();
+
+			for (uint32_t t : pass->m_Writes)
+				m_Targets[t].Producers.push_back(p);
+			for (auto& [t, attachment] : pass->m_Reads)
+			{
+				ENGINE_ASSERT(m_Targets[t].Specification.Persistent || !m_Targets[t].Producers.empty(), "Render graph target is read before it is written!");
+				m_Targets[t].Consumers.push_back(p);
+			}
+		}
+
+		//Cull passes whose results never reach an output. Passes without writes are kept as side-effect passes.
+		std::vector<uint32_t> passRefs(m_Passes.size());
+		std::vector<uint32_t> targetRefs(m_Targets.size());
+		for (uint32_t p = 0; p < m_Passes.size(); p++)
+			passRefs[p] = (uint32_t)m_Passes[p]->m_Writes.size();
+		for (uint32_t t = 0; t < m_Targets.size(); t++)
+			targetRefs[t] = (uint32_t)m_Targets[t].Consumers.size() + (m_Targets[t].Output ? 1 : 0);
+
+		std::vector<uint32_t> unreferenced;
+		for (uint32_t t = 0; t < m_Targets.size(); t++)
+		{
+			if (targetRefs[t] == 0)
+				unreferenced.push_back(t);
+		}
+		while (!unreferenced.empty())
+		{
+			uint32_t t = unreferenced.back();
+			unreferenced.pop_back();
+			for (uint32_t p : m_Targets[t].Producers)
+			{
+				if (m_Passes[p]->m_Culled || --passRefs[p] > 0)
+					continue;
+
+				m_Passes[p]->m_Culled = true;
+				for (auto& [r, attachment] : m_Passes[p]->m_Reads)
+				{
+					if (--targetRefs[r] == 0)
+						unreferenced.push_back(r);
+				}
+			}
+		}
+
+		//Lifetimes
+		for (uint32_t p = 0; p < m_Passes.size(); p++)
+		{
+			auto& pass = m_Passes[p];
+			if (pass->m_Culled)
+				continue;
+
+			for (auto& [t, attachment] : pass->m_Reads)
+			{
+				auto& target = m_Targets[t];
+				if (target.FirstUse < 0)
+					target.FirstUse = p;
+				target.LastUse = p;
+				if (attachment == RenderGraphAttachment::Color)
+					target.ColorRead = true;
+				else
+					target.DepthRead = true;
+			}
+			for (uint32_t t : pass->m_Writes)
+			{
+				auto& target = m_Targets[t];
+				if (target.FirstUse < 0)
+					target.FirstUse = p;
+				target.LastUse = p;
+				target.LastWrite = p;
+			}
+		}
+
+		//Assign physical targets. Transient targets with the same specification and disjoint lifetimes share one.
+		std::vector<uint32_t> order;
+		for (uint32_t t = 0; t < m_Targets.size(); t++)
+		{
+			if (m_Targets[t].FirstUse >= 0)
+				order.push_back(t);
+		}
+		std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return m_Targets[a].FirstUse < m_Targets[b].FirstUse; });
+
+		struct PhysicalSlot
+		{
+			RenderGraphTargetSpecification Specification;
+			int32_t LastUse;
+		};
+		std::vector<PhysicalSlot> slots;
+		for (uint32_t t : order)
+		{
+			auto& target = m_Targets[t];
+			bool transient = !target.Specification.Persistent && !target.Output;
+			if (transient)
+			{
+				for (uint32_t s = 0; s < slots.size(); s++)
+				{
+					auto& slot = slots[s];
+					if (!slot.Specification.Persistent && slot.LastUse < target.FirstUse && IsSameSpecification(slot.Specification, target.Specification))
+					{
+						target.PhysicalIndex = s;
+						slot.LastUse = target.LastUse;
+						break;
+					}
+				}
+			}
+
+			if (target.PhysicalIndex < 0)
+			{
+				target.PhysicalIndex = (int32_t)slots.size();
+				RenderGraphTargetSpecification spec = target.Specification;
+				spec.Persistent = !transient;
+				slots.push_back({ spec, transient ? target.LastUse : INT32_MAX });
+			}
+		}
+
+		m_PhysicalTargets.clear();
+		for (auto& slot : slots)
+		{
+			RenderPassSpecification renderPassSpec;
+			renderPassSpec.TargetFramebuffer = FrameBuffer::Create(slot.Specification.FrameBuffer);
+			m_PhysicalTargets.push_back(RenderPass::Create(renderPassSpec));
+		}
+
+		//Discard attachments of transient targets as soon as nobody needs them
+		for (uint32_t t : order)
+		{
+			auto& target = m_Targets[t];
+			if (target.Specification.Persistent || target.Output || target.LastWrite < 0)
+				continue;
+
+			if (target.LastUse == target.LastWrite)
+			{
+				m_Passes[target.LastWrite]->m_DiscardsAfter.push_back({ t, true, true });
+				continue;
+			}
+
+			if (!target.ColorRead || !target.DepthRead)
+				m_Passes[target.LastWrite]->m_DiscardsAfter.push_back({ t, !target.ColorRead, !target.DepthRead });
+			m_Passes[target.LastUse]->m_DiscardsAfter.push_back({ t, target.ColorRead, target.DepthRead });
+		}
+
+		//Image stores must be visible to the next pass that reads the target
+		for (uint32_t p = 0; p < m_Passes.size(); p++)
+		{
+			auto& pass = m_Passes[p];
+			if (pass->m_Culled)
+				continue;
+
+			for (uint32_t t : pass->m_StorageWrites)
+			{
+				for (uint32_t c : m_Targets[t].Consumers)
+				{
+					if (c > p && !m_Passes[c]->m_Culled)
+					{
+						m_Passes[c]->m_BarrierBefore = true;
+						break;
+					}
+				}
+			}
+		}
+
+		uint32_t culledCount = 0;
+		for (auto& pass : m_Passes)
+		{
+			if (pass->m_Culled)
+			{
+				ENGINE_INFO("RenderGraph: Pass '{0}' culled", pass->m_Name);
+				culledCount++;
+			}
+		}
+		ENGINE_INFO("RenderGraph: {0} passes ({1} culled), {2} targets in {3} framebuffers", m_Passes.size(), culledCount, order.size(), m_PhysicalTargets.size());
+
+		m_Compiled = true;
+	}
+
+	void RenderGraph::Execute()
+	{
+		ENGINE_ASSERT(m_Compiled, "Render graph is not compiled!");
+
+		RenderGraphResources resources(this);
+		for (auto& pass : m_Passes)
+		{
+			if (pass->m_Culled)
+				continue;
+
+			if (pass->m_BarrierBefore)
+			{
+				Renderer::Submit([]()
+					{
+						glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+					});
+			}
+
+			const char* name = pass->m_Name.c_str();
+			Renderer::Submit([name]() {RENDERCOMMAND_TRACE("RenderCommand: {0} Begin:", name); });
+			pass->m_Execute(resources);
+			Renderer::Submit([name]() {RENDERCOMMAND_TRACE("RenderCommand: {0} End", name); });
+
+			for (auto& discard : pass->m_DiscardsAfter)
+			{
+				auto& frameBuffer = m_PhysicalTargets[m_Targets[discard.Target].PhysicalIndex]->GetSpecification().TargetFramebuffer;
+				frameBuffer->Discard(discard.Color, discard.Depth);
+			}
+		}
+	}
+
+	void RenderGraph::Resize(uint32_t width, uint32_t height)
+	{
+		std::vector<bool> resized(m_PhysicalTargets.size(), false);
+		for (auto& target : m_Targets)
+		{
+			if (!target.Specification.ViewportSized)
+				continue;
+
+			target.Specification.FrameBuffer.Width = width;
+			target.Specification.FrameBuffer.Height = height;
+			if (target.PhysicalIndex < 0 || resized[target.PhysicalIndex])
+				continue;
+
+			resized[target.PhysicalIndex] = true;
+			auto& frameBuffer = m_PhysicalTargets[target.PhysicalIndex]->GetSpecification().TargetFramebuffer;
+			if (frameBuffer->GetWidth() != width || frameBuffer->GetHeight() != height)
+				frameBuffer->Resize(width, height);
+		}
+	}
+
+	Ref<RenderPass> RenderGraph::GetRenderPass(const std::string& name) const
+	{
+		const Target& target = m_Targets[GetTargetIndex(name)];
+		ENGINE_ASSERT(target.PhysicalIndex >= 0, "Render graph target is not used by any pass!");
+		return m_PhysicalTargets[target.PhysicalIndex];
+	}
+
+	Ref<FrameBuffer> RenderGraph::GetFrameBuffer(const std::string& name) const
+	{
+		return GetRenderPass(name)->GetSpecification().TargetFramebuffer;
+	}
+
+	uint32_t RenderGraph::GetTargetIndex(const std::string& name) const
+	{
+		auto it = m_TargetIndices.find(name);
+		ENGINE_ASSERT(it != m_TargetIndices.end(), "Render graph target doesn't exist!");
+		return it->second;
+	}
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "Engine/Core/Core.h"
+#include "Engine/Core/Ref.h"
+#include "Engine/Renderer/RenderPass.h"
+#include "Engine/Renderer/FrameBuffer.h"
+
+#include <functional>
+#include <unordered_map>
+
+namespace Engine
+{
+	enum class RenderGraphAttachment
+	{
+		Color, Depth
+	};
+
+	struct RenderGraphTargetSpecification
+	{
+		FrameBufferSpecification FrameBuffer;
+		//Follows the size passed to RenderGraph::Resize
+		bool ViewportSized = false;
+		//Contents survive the frame (e.g. the final image shown by the editor). Never aliased or discarded.
+		bool Persistent = false;
+	};
+
+	class RenderGraph;
+
+	/// <summary>
+	/// Gives pass callbacks access to the physical targets backing their named targets.
+	/// </summary>
+	class RenderGraphResources
+	{
+	public:
+		RenderGraphResources(const RenderGraph* graph) : m_Graph(graph) {}
+
+		Ref<RenderPass> GetRenderPass(const std::string& name) const;
+		Ref<FrameBuffer> GetFrameBuffer(const std::string& name) const;
+	private:
+		const RenderGraph* m_Graph;
+	};
+
+	using RenderGraphExecuteFn = std::function<void(const RenderGraphResources&)>;
+
+	class RenderGraphPass
+	{
+	public:
+		/// <summary>
+		/// Pass samples an attachment of the target.
+		/// </summary>
+		RenderGraphPass& Read(const std::string& name, RenderGraphAttachment attachment = RenderGraphAttachment::Color);
+		/// <summary>
+		/// Pass renders into the target.
+		/// </summary>
+		RenderGraphPass& Write(const std::string& name);
+		/// <summary>
+		/// Pass writes the target with image stores, later readers need a memory barrier.
+		/// </summary>
+		RenderGraphPass& WriteStorage(const std::string& name);
+	private:
+		friend class RenderGraph;
+
+		RenderGraph* m_Graph = nullptr;
+		std::string m_Name;
+		RenderGraphExecuteFn m_Execute;
+
+		std::vector<std::pair<uint32_t, RenderGraphAttachment>> m_Reads;
+		std::vector<uint32_t> m_Writes;
+		std::vector<uint32_t> m_StorageWrites;
+
+		//Compiled
+		bool m_Culled = false;
+		bool m_BarrierBefore = false;
+		struct Discard
+		{
+			uint32_t Target;
+			bool Color, Depth;
+		};
+		std::vector<Discard> m_DiscardsAfter;
+	};
+
+	/// <summary>
+	/// Passes declare the named targets they read and write. Compile() culls passes that don't contribute to an output,
+	/// computes target lifetimes, lets transient targets with the same specification share one framebuffer
+	/// and schedules barriers and discards. Passes run in the order they were added.
+	/// </summary>
+	class RenderGraph
+	{
+	public:
+		void CreateTarget(const std::string& name, const RenderGraphTargetSpecification& spec);
+		RenderGraphPass& AddPass(const std::string& name, const RenderGraphExecuteFn& execute);
+		void SetOutput(const std::string& name);
+
+		void Compile();
+		void Execute();
+		void Resize(uint32_t width, uint32_t height);
+
+		Ref<RenderPass> GetRenderPass(const std::string& name) const;
+		Ref<FrameBuffer> GetFrameBuffer(const std::string& name) const;
+
+		uint32_t GetTargetCount() const { return (uint32_t)m_Targets.size(); }
+		uint32_t GetPhysicalTargetCount() const { return (uint32_t)m_PhysicalTargets.size(); }
+	private:
+		friend class RenderGraphPass;
+
+		uint32_t GetTargetIndex(const std::string& name) const;
+
+	private:
+		struct Target
+		{
+			std::string Name;
+			RenderGraphTargetSpecification Specification;
+			bool Output = false;
+
+			std::vector<uint32_t> Producers;
+			std::vector<uint32_t> Consumers;
+
+			//Compiled
+			int32_t FirstUse = -1;
+			int32_t LastUse = -1;
+			int32_t LastWrite = -1;
+			bool ColorRead = false;
+			bool DepthRead = false;
+			int32_t PhysicalIndex = -1;
+		};
+
+		std::vector<Target> m_Targets;
+		std::vector<Scope<RenderGraphPass>> m_Passes;
+		std::unordered_map<std::string, uint32_t> m_TargetIndices;
+
+		std::vector<Ref<RenderPass>> m_PhysicalTargets;
+		bool m_Compiled = false;
+	};
+}
@@ -6,6 +6,8 @@
 #include "Engine/Renderer/IndexBuffer.h"
 #include "Engine/Renderer/VertexArray.h"
 #include "Engine/Renderer/Pipeline.h"
+#include "Engine/Renderer/TextureStreamer.h"
+#include "Engine/Renderer/Meshlet.h"
 
 #include <glad/glad.h>
 
@@ -27,6 +29,10 @@ namespace Engine
 	};
 	static Scope<RendererData> s_Data;
 
+	static constexpr ShaderPropertyID s_TransformProperty("u_Transform");
+	//Texture bytes uploaded per frame once the frame's commands are done
+	static constexpr uint32_t s_TextureUploadBudget = 16 * 1024 * 1024;
+
 
 	RendererAPI& Renderer::GetAPI()
 	{
@@ -43,6 +49,16 @@ namespace Engine
 		return *(s_CommandQueue);
 	}
 
+	Buffer Renderer::CopyFrameData(Buffer buffer)
+	{
+		if (!buffer)
+			return Buffer();
+
+		uint8_t* data = (uint8_t*)s_CommandQueue->AllocateFrameData(buffer.Size);
+		memcpy(data, buffer.Data, buffer.Size);
+		return Buffer(data, buffer.Size);
+	}
+
 	void Renderer::Init()
 	{
 		s_Data = CreateScope<RendererData>();
@@ -54,16 +70,21 @@ namespace Engine
 		s_CommandQueue = CreateScope<RenderCommandQueue>();
 		s_ShaderLibrary = CreateScope<ShaderLibrary>();
 		
-		//Load shader
-		s_ShaderLibrary->Load("assets/shaders/PBR.glsl");
-		s_ShaderLibrary->Load("assets/shaders/Skybox.glsl");
+		//Load shader. Scene shaders compile in parallel and draw with a placeholder until ready.
 		s_ShaderLibrary->Load("assets/shaders/FullScreenQuad.glsl");
-		s_ShaderLibrary->Load("assets/shaders/ShadowMap.glsl");
-		s_ShaderLibrary->Load("assets/shaders/EquirectangularToCubeMap.glsl");
-		s_ShaderLibrary->Load("assets/shaders/EnvironmentMipFilter.glsl");
-		s_ShaderLibrary->Load("assets/shaders/EnvironmentIrradiance.glsl");
-		s_ShaderLibrary->Load("assets/shaders/EnvironmentIrradianceDiffuse.glsl");
-		s_ShaderLibrary->Load("assets/shaders/Collider.glsl");
+		s_ShaderLibrary->LoadBatch({
+			"assets/shaders/PBR.glsl",
+			"assets/shaders/Skybox.glsl",
+			"assets/shaders/ShadowMap.glsl",
+			"assets/shaders/Collider.glsl"
+		});
+		//Environment shaders are only needed once an environment map is loaded
+		s_ShaderLibrary->LoadDeferred("assets/shaders/EquirectangularToCubeMap.glsl");
+		s_ShaderLibrary->LoadDeferred("assets/shaders/EnvironmentMipFilter.glsl");
+		s_ShaderLibrary->LoadDeferred("assets/shaders/EnvironmentIrradiance.glsl");
+		s_ShaderLibrary->LoadDeferred("assets/shaders/EnvironmentIrradianceDiffuse.glsl");
+		s_ShaderLibrary->LoadDeferred("assets/shaders/Skinning.glsl");
+		s_ShaderLibrary->LoadDeferred("assets/shaders/MeshletCulling.glsl");
 
 		SceneRenderer::Init();
 
@@ -102,6 +123,18 @@ namespace Engine
 
 		auto shader = GetShaderLibrary().Get("FullScreenQuad");
 		s_Data->m_FullScreenQuadMaterial = MaterialInstance::Create(Material::Create(shader));
+
+		//Startup shader report, runs after the queued compiles
+		uint32_t deferredCount = s_ShaderLibrary->GetDeferredCount();
+		Renderer::Submit([deferredCount]()
+			{
+				const auto& stats = Shader::s_CacheStatistics;
+				uint32_t lookups = stats.Hits + stats.Misses;
+				float hitRate = lookups ? 100.0f * stats.Hits / lookups : 0.0f;
+				ENGINE_INFO("Shaders: {0} loaded at startup, {1} deferred. Program cache: {2}/{3} hits ({4:.1f}%)",
+					lookups, deferredCount, stats.Hits, lookups, hitRate);
+			}
+		);
 	}
 
 	void Renderer::Shutdown()
@@ -116,7 +149,11 @@ namespace Engine
 
 	void Renderer::WaitAndRender()
 	{
+		if (s_ShaderLibrary)
+			s_ShaderLibrary->Update();
 		s_CommandQueue->Execute();
+		Texture2D::ProcessPendingUploads(s_TextureUploadBudget);
+		TextureStreamer::Update();
 	}
 
 	void Renderer::BeginRenderPass(const Ref<RenderPass>& renderPass)
@@ -150,22 +187,48 @@ namespace Engine
 		s_RendererAPI->SetViewport(0, 0, width, height);
 	}
 
-	void Renderer::SubmitMesh(Ref<Mesh> mesh, const glm::mat4& transform, Ref<Pipeline> pipeline, Ref<MaterialInstance> overrideMaterial)
+	void Renderer::SubmitMesh(Ref<Mesh> mesh, const glm::mat4& transform, Ref<Pipeline> pipeline, Ref<MaterialInstance> overrideMaterial, const Ref<VertexBuffer>& vertexBuffer)
 	{
-		mesh->m_VertexBuffer->Bind();
+		static const std::vector<Ref<MaterialInstance>> noOverrides;
+		SubmitMesh(mesh, transform, pipeline, overrideMaterial, noOverrides, vertexBuffer);
+	}
+
+	void Renderer::SubmitMesh(Ref<Mesh> mesh, const glm::mat4& transform, Ref<Pipeline> pipeline, const std::vector<Ref<MaterialInstance>>& materialOverrides, const Ref<VertexBuffer>& vertexBuffer)
+	{
+		SubmitMesh(mesh, transform, pipeline, nullptr, materialOverrides, vertexBuffer);
+	}
+
+	void Renderer::SubmitMesh(const Ref<Mesh>& mesh, const glm::mat4& transform, const Ref<Pipeline>& pipeline, const Ref<MaterialInstance>& overrideMaterial, const std::vector<Ref<MaterialInstance>>& materialOverrides, const Ref<VertexBuffer>& vertexBuffer)
+	{
+		//Failed to load, or FinishLoading has not run
+		if (!mesh->m_VertexArray || !mesh->m_VertexBuffer)
+			return;
+
+		(vertexBuffer ? vertexBuffer : mesh->m_VertexBuffer)->Bind();
 		mesh->m_VertexArray->Bind();
 		pipeline->BindVertexLayout();
 		mesh->m_IndexBuffer->Bind();
 
-		auto materials = mesh->GetMaterials();
-		for (Submesh& submesh : mesh->m_Submeshes)
+		const auto& materials = mesh->GetMaterials();
+		for (uint32_t i = 0; i < (uint32_t)mesh->m_Submeshes.size(); i++)
 		{
+			//Commands already use the mesh buffers by pointer, the mesh outlives them. Point at the submesh, do not copy it
+			const Submesh* submesh = &mesh->m_Submeshes[i];
+			glm::mat4 submeshTransform = transform * submesh->Transform;
+
+			//Meshlet bounds are those of the bind pose, skinned vertices are drawn whole
+			MeshletDraw meshletDraw;
+			bool culled = !vertexBuffer && MeshletCuller::Cull(mesh, i, submeshTransform, meshletDraw);
+
 			//Material
-			auto material = overrideMaterial ? overrideMaterial : materials[submesh.MaterialIndex];
-			material->Set("u_Transform", transform * submesh.Transform);
+			uint32_t index = submesh->MaterialIndex;
+			auto material = overrideMaterial ? overrideMaterial : materials[index];
+			if (!overrideMaterial && index < materialOverrides.size() && materialOverrides[index])
+				material = materialOverrides[index];
+			material->Set(s_TransformProperty, submeshTransform);
 			material->Bind();
 
-			Renderer::Submit([submesh, material]
+			Renderer::Submit([submesh, material, culled, meshletDraw]
 				{
 					if (material->GetFlag(MaterialFlag::DepthTest))
 						glEnable(GL_DEPTH_TEST);
@@ -177,15 +240,22 @@ namespace Engine
 					else
 						glEnable(GL_CULL_FACE);
 					*/
-					glDrawElementsBaseVertex(
-						GL_TRIANGLES,
-						submesh.IndexCount,
-						GL_UNSIGNED_INT,
-						(void*)(sizeof(uint32_t) * submesh.BaseIndex),
-						submesh.BaseVertex
-					);
-
-					RENDERCOMMAND_TRACE("RenderCommand: Submit mesh. Mesh: '{0}', Node: '{1}'", submesh.MeshName, submesh.NodeName);
+					if (culled)
+					{
+						MeshletCuller::DrawIndirect(*submesh, meshletDraw);
+					}
+					else
+					{
+						glDrawElementsBaseVertex(
+							GL_TRIANGLES,
+							submesh->IndexCount,
+							submesh->IndexSize == sizeof(uint16_t) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT,
+							(void*)(uintptr_t)submesh->IndexOffset,
+							submesh->BaseVertex
+						);
+					}
+
+					RENDERCOMMAND_TRACE("RenderCommand: Submit mesh. Mesh: '{0}', Node: '{1}'", submesh->MeshName, submesh->NodeName);
 				}
 			);
 		}
@@ -38,6 +38,11 @@ namespace Engine
 			new (storageBuffer) FuncT(std::forward<FuncT>(func));
 		}
 
+		/// <summary>
+		/// Copies the buffer into memory owned by the command queue, so commands see its contents at submit time.
+		/// </summary>
+		static Buffer CopyFrameData(Buffer buffer);
+
 		static void Init();
 		static void Shutdown();
 		static void WaitAndRender();
@@ -47,7 +52,17 @@ namespace Engine
 
 		static void OnWindowResize(uint32_t width, uint32_t height);
 
-		static void SubmitMesh(Ref<Mesh> mesh, const glm::mat4& transform, Ref<Pipeline> pipeline, Ref<MaterialInstance> overrideMaterial = nullptr);
+		/// <summary>
+		/// vertexBuffer replaces the mesh vertex buffer if not null, e.g. the output of skinning.
+		/// </summary>
+		static void SubmitMesh(Ref<Mesh> mesh, const glm::mat4& transform, Ref<Pipeline> pipeline, Ref<MaterialInstance> overrideMaterial = nullptr, const Ref<VertexBuffer>& vertexBuffer = nullptr);
+		/// <summary>
+		/// Submit with per material overrides, e.g. the materials of one entity. Null or missing entries use the mesh material.
+		/// </summary>
+		static void SubmitMesh(Ref<Mesh> mesh, const glm::mat4& transform, Ref<Pipeline> pipeline, const std::vector<Ref<MaterialInstance>>& materialOverrides, const Ref<VertexBuffer>& vertexBuffer = nullptr);
 		static void SubmitFullScreenQuad(uint32_t textureID, Ref<MaterialInstance> overrideMaterial = nullptr);
+
+	private:
+		static void SubmitMesh(const Ref<Mesh>& mesh, const glm::mat4& transform, const Ref<Pipeline>& pipeline, const Ref<MaterialInstance>& overrideMaterial, const std::vector<Ref<MaterialInstance>>& materialOverrides, const Ref<VertexBuffer>& vertexBuffer);
 	};
 }
\ No newline at end of file
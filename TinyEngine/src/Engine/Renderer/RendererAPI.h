@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Engine/Core/Core.h"
+
 namespace Engine
 {
 	//TODO: More type
@@ -10,6 +12,16 @@ namespace Engine
 		Lines
 	};
 
+	/// <summary>
+	/// Reads that wait for the buffer writes of earlier compute dispatches
+	/// </summary>
+	enum class RendererBarrier
+	{
+		None				= 0,
+		VertexAttributes	= BIT(0),
+		IndirectCommands	= BIT(1)
+	};
+
 	class RendererAPI
 	{
 	public:
@@ -28,6 +40,27 @@ namespace Engine
 		virtual void Clear() = 0;
 		virtual void SetViewport(uint32_t x, uint32_t y, uint32_t width, uint32_t height) = 0;		
 		virtual void DrawElements(uint32_t count, PrimitiveType type, bool depthTest = true) = 0;
+		/// <summary>
+		/// Draw up to maxCommands indirect commands of the bound index buffer, starting at commandOffset bytes of commandBuffer.
+		/// The draw count is read from countOffset bytes of countBuffer where supported, otherwise all commands are drawn.
+		/// </summary>
+		virtual void DrawElementsIndirect(uint32_t indexSize, uint32_t commandBuffer, uint32_t commandOffset, uint32_t maxCommands, uint32_t countBuffer, uint32_t countOffset) = 0;
+
+		//Compute
+		virtual void BindStorageBuffer(uint32_t binding, uint32_t buffer) = 0;
+		virtual void SetBufferData(uint32_t buffer, const void* data, uint32_t size, uint32_t offset = 0) = 0;
+		/// <summary>
+		/// Fill size bytes at offset with zeros.
+		/// </summary>
+		virtual void ClearBuffer(uint32_t buffer, uint32_t offset, uint32_t size) = 0;
+		/// <summary>
+		/// Run the bound compute program.
+		/// </summary>
+		virtual void DispatchCompute(uint32_t groupsX, uint32_t groupsY = 1, uint32_t groupsZ = 1) = 0;
+		/// <summary>
+		/// barriers is a combination of RendererBarrier.
+		/// </summary>
+		virtual void Barrier(uint32_t barriers) = 0;
 
 	private:
 		static RendererAPIType s_API;
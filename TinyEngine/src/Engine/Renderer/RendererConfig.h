@@ -0,0 +1,8 @@
+#pragma once
+
+//--------------------------------------
+//Renderer build options
+//--------------------------------------
+
+//GPU vertex format of meshes, see PackedVertex. Shader stages that read mesh vertices see PACKED_VERTICES when it is enabled.
+#define MESH_PACKED_VERTICES 1
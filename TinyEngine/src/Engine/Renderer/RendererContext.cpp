@@ -2,6 +2,7 @@
 #include "RendererContext.h"
 #include "Engine/Renderer/Renderer.h"
 #include "Engine/Platforms/OpenGL/OpenGLContext.h"
+#include "Engine/Platforms/OpenGL/OpenGLHeadlessContext.h"
 
 namespace Engine
 {
@@ -19,4 +20,19 @@ namespace Engine
 			return nullptr;
 		}
     }
+
+    Ref<RendererContext> RendererContext::CreateHeadless()
+    {
+		switch (Renderer::GetAPIType())
+		{
+		case RendererAPI::RendererAPIType::None:
+			ENGINE_ASSERT(false, "RendererAPI::None is currently not supported!");
+			return nullptr;
+		case RendererAPI::RendererAPIType::OpenGL:
+			return CreateRef<OpenGLHeadlessContext>();
+		default:
+			ENGINE_ASSERT(false, "Unknown RendererAPI!");
+			return nullptr;
+		}
+    }
 }
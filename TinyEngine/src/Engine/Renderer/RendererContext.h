@@ -16,5 +16,9 @@ namespace Engine
 		virtual void SwapBuffers() = 0;
 
 		static Ref<RendererContext> Create(GLFWwindow* windowHandle);
+		/// <summary>
+		/// Create a context without window, used by offscreen/batch rendering
+		/// </summary>
+		static Ref<RendererContext> CreateHeadless();
 	};
 }
\ No newline at end of file
@@ -3,11 +3,15 @@
 #include "Engine/Core/Core.h"
 #include "Engine/Core/Ref.h"
 #include "Engine/Renderer/RenderPass.h"
+#include "Engine/Renderer/RenderGraph.h"
 #include "Engine/Renderer/Renderer.h"
 #include "Engine/Renderer/Pipeline.h"
 #include "Engine/Renderer/Shader.h"
 #include "Engine/Renderer/Light.h"
 #include "Engine/Renderer/MeshFactory.h"
+#include "Engine/Renderer/TextureStreamer.h"
+#include "Engine/Renderer/Animator.h"
+#include "Engine/Renderer/Meshlet.h"
 #include "Engine/Asset/AssetManager.h"
 
 #include <glad/glad.h>
@@ -26,14 +30,19 @@ namespace Engine
 			Ref<MaterialInstance> SkyboxMaterial;
 		}m_SceneData;
 
-		Ref<RenderPass> m_ShadowMapPass;
-		Ref<RenderPass> m_ShadowMapPasses[4];
-		Ref<RenderPass> m_GeometryPass;
-		Ref<RenderPass> m_CompositePass;
+		Ref<RenderGraph> m_RenderGraph;
+		uint32_t m_ViewportHeight = 720;
 
 		Ref<Mesh> m_SkyboxMesh;
+		//Unit collider shapes shared by all colliders, sized through the draw transform
+		Ref<Mesh> m_ColliderBoxMesh;
+		Ref<Mesh> m_ColliderSphereMesh;
+		Ref<Mesh> m_ColliderHemisphereMesh;
+		Ref<Mesh> m_ColliderCylinderMesh;
 
 		Ref<Material> m_ShadowMapMaterial;
+		//Used by every shadow draw, the values are copied when a draw is submitted
+		Ref<MaterialInstance> m_ShadowMapMaterialInstance;
 		uint32_t m_ShadowMapSampler;
 		glm::mat4 m_LightSpaceMatrix;
 		//CSM 
@@ -44,13 +53,20 @@ namespace Engine
 
 		struct DrawCommand
 		{
-			Ref<Mesh> Mesh;
+			Ref<Engine::Mesh> Mesh;
 			glm::mat4 Transform;
 			Ref<MaterialInstance> Material;
+			//Per material index, used when Material is null. Owned by the MeshComponent, which outlives the frame
+			const std::vector<Ref<MaterialInstance>>* MaterialOverrides = nullptr;
+			//Skinned vertices drawn instead of the mesh vertex buffer
+			Ref<VertexBuffer> SkinnedVertexBuffer = nullptr;
 		};
 		std::vector<DrawCommand> m_DrawList;
 		std::vector<DrawCommand> m_ShadowPassDrawList;
 		std::vector<DrawCommand> m_ColliderDrawList;
+		std::vector<Ref<Animator>> m_Animators;
+		//Base materials whose per frame values are set in this geometry pass
+		std::unordered_set<Material*> m_GeometryPassMaterials;
 
 		//Pipeline
 		Ref<Pipeline> m_SkyboxPipeline;
@@ -60,61 +76,125 @@ namespace Engine
 
 		//Editor Material
 		Ref<MaterialInstance> m_ColliderMaterial;
+
+		//Pass timing
+		bool m_PassTimingEnabled = false;
+		uint32_t m_PassTimerQueries[3][2] = {};
+		std::vector<SceneRendererPassTiming> m_PassTimings = { { "ShadowMapPass" }, { "GeometryPass" }, { "CompositePass" } };
 	};
 	static Scope<SceneRendererData> s_Data;
 
+	static const char* s_ShadowCascadeTargets[4] = { "ShadowCascade0", "ShadowCascade1", "ShadowCascade2", "ShadowCascade3" };
+
+	//Material properties set every frame, hashed at compile time
+	namespace Property
+	{
+		static constexpr ShaderPropertyID ViewProjectionMatrix("u_ViewProjectionMatrix");
+		static constexpr ShaderPropertyID Skybox("u_Skybox");
+		static constexpr ShaderPropertyID ViewMatrix("u_ViewMatrix");
+		static constexpr ShaderPropertyID ProjectionMatrix("u_ProjectionMatrix");
+		static constexpr ShaderPropertyID CameraPosition("u_CameraPosition");
+		static constexpr ShaderPropertyID LightSpaceMatrix("u_LightSpaceMatrix");
+		static constexpr ShaderPropertyID LightCascadeMatrix0("u_LightCascadeMatrix0");
+		static constexpr ShaderPropertyID LightCascadeMatrix1("u_LightCascadeMatrix1");
+		static constexpr ShaderPropertyID LightCascadeMatrix2("u_LightCascadeMatrix2");
+		static constexpr ShaderPropertyID LightCascadeMatrix3("u_LightCascadeMatrix3");
+		static constexpr ShaderPropertyID CascadeSplits("u_CascadeSplits");
+		//Struct uniforms are set per member
+		static constexpr ShaderPropertyID DirectionalLightDirection("u_DirectionalLight.Direction");
+		static constexpr ShaderPropertyID DirectionalLightRadiance("u_DirectionalLight.Radiance");
+		static constexpr ShaderPropertyID DirectionalLightIntensity("u_DirectionalLight.Intensity");
+		static constexpr ShaderPropertyID DirectionalLightSamplingRadius("u_DirectionalLight.SamplingRadius");
+		static constexpr ShaderPropertyID IrradianceMap("u_IrradianceMap");
+		static constexpr ShaderPropertyID EnvPrefliteredMap("u_EnvPrefliteredMap");
+		static constexpr ShaderPropertyID BRDFLUTMap("u_BRDFLUTMap");
+		static constexpr ShaderPropertyID ShadowMapTexture("u_ShadowMapTexture");
+		static constexpr ShaderPropertyID ShadowMapTextures("u_ShadowMapTextures");
+		static constexpr ShaderPropertyID ViewProjection("u_ViewProjection");
+	}
+
 	void SceneRenderer::Init()
 	{		
 		s_Data = CreateScope<SceneRendererData>();
+		s_Data->m_RenderGraph = CreateRef<RenderGraph>();
+		auto& graph = s_Data->m_RenderGraph;
 		
-		//ShadowMap pass
-		FrameBufferSpecification shadowMapFrameBufferSpec;
-		shadowMapFrameBufferSpec.Width = 2048;
-		shadowMapFrameBufferSpec.Height = 2048;
-		shadowMapFrameBufferSpec.ClearColor = { 0.0f,0.0f,0.0f,1.0f };
-		shadowMapFrameBufferSpec.Attachments = { FrameBufferTextureFormat::RGBA16F, FrameBufferTextureFormat::DEPTH32F };
-		RenderPassSpecification shadowMapRenderPassSpec;
-		shadowMapRenderPassSpec.TargetFramebuffer = FrameBuffer::Create(shadowMapFrameBufferSpec);
-		s_Data->m_ShadowMapPass = RenderPass::Create(shadowMapRenderPassSpec);
-
+		//ShadowMap targets
+		RenderGraphTargetSpecification shadowMapTargetSpec;
+		shadowMapTargetSpec.FrameBuffer.Width = 2048;
+		shadowMapTargetSpec.FrameBuffer.Height = 2048;
+		shadowMapTargetSpec.FrameBuffer.ClearColor = { 0.0f,0.0f,0.0f,1.0f };
+		shadowMapTargetSpec.FrameBuffer.Attachments = { FrameBufferTextureFormat::RGBA16F, FrameBufferTextureFormat::DEPTH32F };
+		graph->CreateTarget("ShadowMap", shadowMapTargetSpec);
 		for (int i = 0; i < 4; i++)
+			graph->CreateTarget(s_ShadowCascadeTargets[i], shadowMapTargetSpec);
+
+		//Geometry target
+		RenderGraphTargetSpecification geoTargetSpec;
+		geoTargetSpec.FrameBuffer.Width = 1280;
+		geoTargetSpec.FrameBuffer.Height = 720;
+		geoTargetSpec.FrameBuffer.ClearColor = { 0.1f, 0.1f, 0.1f, 1.0f };
+		geoTargetSpec.FrameBuffer.Attachments = { FrameBufferTextureFormat::RGBA16F, FrameBufferTextureFormat::DEPTH24STENCIL8 };
+		geoTargetSpec.ViewportSized = true;
+		graph->CreateTarget("SceneHDR", geoTargetSpec);
+		//Composite target, sampled by the editor viewport after the frame
+		RenderGraphTargetSpecification compTargetSpec;
+		compTargetSpec.FrameBuffer.Width = 1280;
+		compTargetSpec.FrameBuffer.Height = 720;
+		compTargetSpec.FrameBuffer.ClearColor = { 0.1f, 0.1f, 0.1f, 1.0f };
+		compTargetSpec.FrameBuffer.Attachments = { FrameBufferTextureFormat::RGBA16F };
+		compTargetSpec.ViewportSized = true;
+		compTargetSpec.Persistent = true;
+		graph->CreateTarget("SceneColor", compTargetSpec);
+
+		//Passes
 		{
-			FrameBufferSpecification shadowMapFrameBufferSpec;
-			shadowMapFrameBufferSpec.Width = 2048;
-			shadowMapFrameBufferSpec.Height = 2048;
-			shadowMapFrameBufferSpec.ClearColor = { 0.0f,0.0f,0.0f,1.0f };
-			shadowMapFrameBufferSpec.Attachments = { FrameBufferTextureFormat::RGBA16F, FrameBufferTextureFormat::DEPTH32F };
-			RenderPassSpecification shadowMapRenderPassSpec;
-			shadowMapRenderPassSpec.TargetFramebuffer = FrameBuffer::Create(shadowMapFrameBufferSpec);
-			s_Data->m_ShadowMapPasses[i] = RenderPass::Create(shadowMapRenderPassSpec);
+			auto& pass = graph->AddPass("ShadowMapPass", [](const RenderGraphResources& resources)
+				{
+					BeginPassTimer(0);
+					ShadowMapPass(resources);
+					EndPassTimer(0);
+				});
+			pass.Write("ShadowMap");
+			for (int i = 0; i < 4; i++)
+				pass.Write(s_ShadowCascadeTargets[i]);
 		}
-
-		//Geometry pass
-		FrameBufferSpecification geoFrameBufferSpec;
-		geoFrameBufferSpec.Width = 1280;
-		geoFrameBufferSpec.Height = 720;
-		geoFrameBufferSpec.ClearColor = { 0.1f, 0.1f, 0.1f, 1.0f };
-		geoFrameBufferSpec.Attachments = { FrameBufferTextureFormat::RGBA16F, FrameBufferTextureFormat::DEPTH24STENCIL8 };
-		RenderPassSpecification geoRenderPassSpec;
-		geoRenderPassSpec.TargetFramebuffer = FrameBuffer::Create(geoFrameBufferSpec);
-		s_Data->m_GeometryPass = RenderPass::Create(geoRenderPassSpec);
-		//Composite pass
-		FrameBufferSpecification compFrameBufferSpec;
-		compFrameBufferSpec.Width = 1280;
-		compFrameBufferSpec.Height = 720;
-		compFrameBufferSpec.ClearColor = { 0.1f, 0.1f, 0.1f, 1.0f };
-		compFrameBufferSpec.Attachments = { FrameBufferTextureFormat::RGBA16F };
-		RenderPassSpecification compRenderPassSpec;
-		compRenderPassSpec.TargetFramebuffer = FrameBuffer::Create(compFrameBufferSpec);
-		s_Data->m_CompositePass = RenderPass::Create(compRenderPassSpec);
+		{
+			auto& pass = graph->AddPass("GeometryPass", [](const RenderGraphResources& resources)
+				{
+					BeginPassTimer(1);
+					GeometryPass(resources);
+					EndPassTimer(1);
+				});
+			pass.Read("ShadowMap", RenderGraphAttachment::Depth);
+			for (int i = 0; i < 4; i++)
+				pass.Read(s_ShadowCascadeTargets[i], RenderGraphAttachment::Depth);
+			pass.Write("SceneHDR");
+		}
+		graph->AddPass("CompositePass", [](const RenderGraphResources& resources)
+			{
+				BeginPassTimer(2);
+				CompositePass(resources);
+				EndPassTimer(2);
+			})
+			.Read("SceneHDR")
+			.Write("SceneColor");
+		graph->SetOutput("SceneColor");
+		graph->Compile();
 
 		s_Data->m_SkyboxMesh = MeshFactory::CreateBox({ 2.0f, 2.0f, 2.0f });
 
+		s_Data->m_ColliderBoxMesh = MeshFactory::CreateBox({ 1.0f, 1.0f, 1.0f });
+		s_Data->m_ColliderSphereMesh = MeshFactory::CreateSphere(1.0f);
+		s_Data->m_ColliderHemisphereMesh = MeshFactory::CreateHemisphere(1.0f);
+		s_Data->m_ColliderCylinderMesh = MeshFactory::CreateCylinder(1.0f, 1.0f);
+
 		auto shadowMapShader = Renderer::GetShaderLibrary().Get("ShadowMap");
 		s_Data->m_ShadowMapMaterial = Material::Create(shadowMapShader);
 		s_Data->m_ShadowMapMaterial->SetFlags(MaterialFlag::DepthTest);
+		s_Data->m_ShadowMapMaterialInstance = MaterialInstance::Create(s_Data->m_ShadowMapMaterial, "ShadowMap");
 
-		s_Data->m_BRDFLUTMap = AssetManager::CreateNewAsset<Texture2D>("assets\\textures\\IBL_BRDF_LUT.png", true);
+		s_Data->m_BRDFLUTMap = AssetManager::LoadTexture("assets\\textures\\IBL_BRDF_LUT.png", true);
 
 		Renderer::Submit([]()
 			{
@@ -125,72 +205,51 @@ namespace Engine
 				glSamplerParameteri(s_Data->m_ShadowMapSampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 				glSamplerParameteri(s_Data->m_ShadowMapSampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 				glSamplerParameteri(s_Data->m_ShadowMapSampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+				glGenQueries(6, &(s_Data->m_PassTimerQueries[0][0]));
 			});
 
 		//ShadowMap pipeline
 		{
-			VertexBufferLayout vertexLayout;
-			vertexLayout = {
-				{ ShaderDataType::Float3, "a_Position" },
-				{ ShaderDataType::Float3, "a_Normal" },
-				{ ShaderDataType::Float3, "a_Tangent" },
-				{ ShaderDataType::Float3, "a_Binormal" },
-				{ ShaderDataType::Float2, "a_TexCoord" }
-			};
 			PipelineSpecification spec;
-			spec.Layout = vertexLayout;
+			spec.Layout = Mesh::GetVertexLayout();
 			s_Data->m_ShadowMapPipeline = Pipeline::Create(spec);
 		}
 		//Skybox pipeline
 		{
-			VertexBufferLayout vertexLayout;
-			vertexLayout = {
-				{ ShaderDataType::Float3, "a_Position" },
-				{ ShaderDataType::Float3, "a_Normal" },
-				{ ShaderDataType::Float3, "a_Tangent" },
-				{ ShaderDataType::Float3, "a_Binormal" },
-				{ ShaderDataType::Float2, "a_TexCoord" }
-			};
 			PipelineSpecification spec;
-			spec.Layout = vertexLayout;
+			spec.Layout = Mesh::GetVertexLayout();
 			s_Data->m_SkyboxPipeline = Pipeline::Create(spec);
 		}
 		//Geometry pipeline
 		{
-			VertexBufferLayout vertexLayout;
-			vertexLayout = {
-				{ ShaderDataType::Float3, "a_Position" },
-				{ ShaderDataType::Float3, "a_Normal" },
-				{ ShaderDataType::Float3, "a_Tangent" },
-				{ ShaderDataType::Float3, "a_Binormal" },
-				{ ShaderDataType::Float2, "a_TexCoord" }
-			};
 			PipelineSpecification spec;
-			spec.Layout = vertexLayout;
+			spec.Layout = Mesh::GetVertexLayout();
 			s_Data->m_GeometryPipeline = Pipeline::Create(spec);
 		}
 		//Collider pipeline
 		{
-			VertexBufferLayout vertexLayout;
-			vertexLayout = {
-				{ ShaderDataType::Float3, "a_Position" },
-				{ ShaderDataType::Float3, "a_Normal" },
-				{ ShaderDataType::Float3, "a_Tangent" },
-				{ ShaderDataType::Float3, "a_Binormal" },
-				{ ShaderDataType::Float2, "a_TexCoord" }
-			};
 			PipelineSpecification spec;
-			spec.Layout = vertexLayout;
+			spec.Layout = Mesh::GetVertexLayout();
 			s_Data->m_ColliderPipeline = Pipeline::Create(spec);
 		}
 
 		auto colliderShader = Renderer::GetShaderLibrary().Get("Collider");
 		s_Data->m_ColliderMaterial = MaterialInstance::Create(Material::Create(colliderShader), "Collider");
 		s_Data->m_ColliderMaterial->SetFlag(MaterialFlag::DepthTest, false);
+
+		MeshletCuller::Init();
 	}
 
 	void SceneRenderer::Shutdown()
 	{
+		Renderer::Submit([]()
+			{
+				glDeleteQueries(6, &(s_Data->m_PassTimerQueries[0][0]));
+			});
+		Renderer::WaitAndRender();
+
+		MeshletCuller::Shutdown();
 		s_Data.reset();
 	}
 
@@ -216,8 +275,18 @@ namespace Engine
 
 	void SceneRenderer::SetViewportSize(uint32_t width, uint32_t height)
 	{
-		s_Data->m_GeometryPass->GetSpecification().TargetFramebuffer->Resize(width, height);
-		s_Data->m_CompositePass->GetSpecification().TargetFramebuffer->Resize(width, height);
+		s_Data->m_RenderGraph->Resize(width, height);
+		s_Data->m_ViewportHeight = height;
+	}
+
+	void SceneRenderer::SetPassTimingEnabled(bool enabled)
+	{
+		s_Data->m_PassTimingEnabled = enabled;
+	}
+
+	const std::vector<SceneRendererPassTiming>& SceneRenderer::GetPassTimings()
+	{
+		return s_Data->m_PassTimings;
 	}
 
 	void SceneRenderer::SubmitMesh(Ref<Mesh>& mesh, const glm::mat4& transform, Ref<MaterialInstance> overrideMaterial)
@@ -226,19 +295,54 @@ namespace Engine
 		s_Data->m_ShadowPassDrawList.push_back({ mesh, transform, overrideMaterial });
 	}
 
+	void SceneRenderer::SubmitMesh(Ref<Mesh>& mesh, const glm::mat4& transform, const std::vector<Ref<MaterialInstance>>& materialOverrides)
+	{
+		//Shadows only need the geometry
+		s_Data->m_DrawList.push_back({ mesh, transform, nullptr, &materialOverrides });
+		s_Data->m_ShadowPassDrawList.push_back({ mesh, transform, nullptr });
+	}
+
+	void SceneRenderer::SubmitMesh(Ref<Mesh>& mesh, const glm::mat4& transform, const std::vector<Ref<MaterialInstance>>& materialOverrides, const Ref<Animator>& animator)
+	{
+		if (!animator)
+		{
+			SubmitMesh(mesh, transform, materialOverrides);
+			return;
+		}
+
+		//Entities sharing the mesh each have their own animator
+		s_Data->m_Animators.push_back(animator);
+		s_Data->m_DrawList.push_back({ mesh, transform, nullptr, &materialOverrides, animator->GetSkinnedVertexBuffer() });
+		s_Data->m_ShadowPassDrawList.push_back({ mesh, transform, nullptr, nullptr, animator->GetSkinnedVertexBuffer() });
+	}
+
 	void SceneRenderer::SubmitColliderMesh(const BoxColliderComponent& component, const glm::mat4& parentTransform)
 	{
-		s_Data->m_ColliderDrawList.push_back({ component.DebugMesh, glm::translate(parentTransform, component.Offset), nullptr });
+		glm::mat4 transform = glm::scale(glm::translate(parentTransform, component.Offset), component.Size);
+		s_Data->m_ColliderDrawList.push_back({ s_Data->m_ColliderBoxMesh, transform, nullptr });
 	}
 
 	void SceneRenderer::SubmitColliderMesh(const SphereColliderComponent& component, const glm::mat4& parentTransform)
 	{
-		s_Data->m_ColliderDrawList.push_back({ component.DebugMesh, parentTransform, nullptr });
+		glm::mat4 transform = glm::scale(parentTransform, glm::vec3(component.Radius));
+		s_Data->m_ColliderDrawList.push_back({ s_Data->m_ColliderSphereMesh, transform, nullptr });
 	}
 
 	void SceneRenderer::SubmitColliderMesh(const CapsuleColliderComponent& component, const glm::mat4& parentTransform)
 	{
-		s_Data->m_ColliderDrawList.push_back({ component.DebugMesh, parentTransform, nullptr });
+		//Height includes the caps
+		float halfHeight = glm::max((component.Height - component.Radius * 2.0f) * 0.5f, 0.0f);
+		glm::vec3 radius(component.Radius);
+
+		glm::mat4 top = glm::scale(glm::translate(parentTransform, { 0.0f, halfHeight, 0.0f }), radius);
+		glm::mat4 bottom = glm::scale(glm::rotate(glm::translate(parentTransform, { 0.0f, -halfHeight, 0.0f }), glm::pi<float>(), { 1.0f, 0.0f, 0.0f }), radius);
+		s_Data->m_ColliderDrawList.push_back({ s_Data->m_ColliderHemisphereMesh, top, nullptr });
+		s_Data->m_ColliderDrawList.push_back({ s_Data->m_ColliderHemisphereMesh, bottom, nullptr });
+		if (halfHeight > 0.0f)
+		{
+			glm::mat4 side = glm::scale(parentTransform, { component.Radius, halfHeight * 2.0f, component.Radius });
+			s_Data->m_ColliderDrawList.push_back({ s_Data->m_ColliderCylinderMesh, side, nullptr });
+		}
 	}
 
 	void SceneRenderer::SubmitColliderMesh(const MeshColliderComponent& component, const glm::mat4& parentTransform)
@@ -249,12 +353,12 @@ namespace Engine
 
 	uint32_t SceneRenderer::GetFinalColorBufferRendererID()
 	{
-		return s_Data->m_CompositePass->GetSpecification().TargetFramebuffer->GetColorAttachmentID();
+		return s_Data->m_RenderGraph->GetFrameBuffer("SceneColor")->GetColorAttachmentID();
 	}
 
 	Ref<FrameBuffer> SceneRenderer::GetFinalFrameBuffer()
 	{
-		return s_Data->m_CompositePass->GetSpecification().TargetFramebuffer;
+		return s_Data->m_RenderGraph->GetFrameBuffer("SceneColor");
 	}
 
 	struct FrustumBounds
@@ -441,19 +545,24 @@ namespace Engine
 		}
 	}
 
-	void SceneRenderer::ShadowMapPass()
+	void SceneRenderer::ShadowMapPass(const RenderGraphResources& resources)
 	{
+		Ref<RenderPass> shadowMapPass = resources.GetRenderPass("ShadowMap");
+		Ref<RenderPass> shadowCascadePasses[4];
+		for (int i = 0; i < 4; i++)
+			shadowCascadePasses[i] = resources.GetRenderPass(s_ShadowCascadeTargets[i]);
+
 		//Only use the first directional light to calculate shadow map
 		auto& directionalLights = s_Data->m_SceneData.SceneLightEnvironment.DirectionalLights;
 		if (directionalLights[0].Intensity == 0.0f || !directionalLights[0].CastShadows)
 		{
 			//Clear shadow map
-			Renderer::BeginRenderPass(s_Data->m_ShadowMapPass);
+			Renderer::BeginRenderPass(shadowMapPass);
 			Renderer::EndRenderPass();
 
 			for (int i = 0; i < 4; i++)
 			{
-				Renderer::BeginRenderPass(s_Data->m_ShadowMapPasses[i]);
+				Renderer::BeginRenderPass(shadowCascadePasses[i]);
 				Renderer::EndRenderPass();
 			}
 
@@ -466,15 +575,14 @@ namespace Engine
 
 			s_Data->m_LightSpaceMatrix = shadowMapVP;
 
-			Renderer::BeginRenderPass(s_Data->m_ShadowMapPass);
+			//Shadow casters may face away from the light, frustum only
+			MeshletCullingView cullingView{ shadowMapVP, glm::vec3(0.0f), false };
+			MeshletCuller::SetView(&cullingView);
+			Renderer::BeginRenderPass(shadowMapPass);
+			auto& mi = s_Data->m_ShadowMapMaterialInstance;
+			mi->Set(Property::ViewProjectionMatrix, shadowMapVP);
 			for (auto& dc : s_Data->m_ShadowPassDrawList)
-			{
-				auto& material = s_Data->m_ShadowMapMaterial;
-				auto mi = MaterialInstance::Create(material);
-				mi->Set("u_ViewProjectionMatrix", shadowMapVP);
-
-				Renderer::SubmitMesh(dc.Mesh, dc.Transform, s_Data->m_ShadowMapPipeline, mi);
-			}
+				Renderer::SubmitMesh(dc.Mesh, dc.Transform, s_Data->m_ShadowMapPipeline, mi, dc.SkinnedVertexBuffer);
 			Renderer::EndRenderPass();
 		}
 
@@ -488,25 +596,28 @@ namespace Engine
 				s_Data->m_LightCascadeMatrices[i] = cascades[i].ViewProjection;
 
 				glm::mat4 shadowMapVP = cascades[i].ViewProjection;
-				Renderer::BeginRenderPass(s_Data->m_ShadowMapPasses[i]);
+				MeshletCullingView cullingView{ shadowMapVP, glm::vec3(0.0f), false };
+				MeshletCuller::SetView(&cullingView);
+				Renderer::BeginRenderPass(shadowCascadePasses[i]);
+				auto& mi = s_Data->m_ShadowMapMaterialInstance;
+				mi->Set(Property::ViewProjectionMatrix, shadowMapVP);
 				for (auto& dc : s_Data->m_ShadowPassDrawList)
-				{
-					auto& material = s_Data->m_ShadowMapMaterial;
-					auto mi = MaterialInstance::Create(material);
-					mi->Set("u_ViewProjectionMatrix", shadowMapVP);
-
-					Renderer::SubmitMesh(dc.Mesh, dc.Transform, s_Data->m_ShadowMapPipeline, mi);
-				}
+					Renderer::SubmitMesh(dc.Mesh, dc.Transform, s_Data->m_ShadowMapPipeline, mi, dc.SkinnedVertexBuffer);
 				Renderer::EndRenderPass();
 			}
 		}
-		
+		MeshletCuller::SetView(nullptr);
 	}
 
-	void SceneRenderer::GeometryPass()
+	void SceneRenderer::GeometryPass(const RenderGraphResources& resources)
 	{
 		bool collider = !s_Data->m_ColliderDrawList.empty();
 
+		uint32_t shadowMapTexID = resources.GetFrameBuffer("ShadowMap")->GetDepthAttachmentID();
+		uint32_t shadowCascadeTexIDs[4];
+		for (int i = 0; i < 4; i++)
+			shadowCascadeTexIDs[i] = resources.GetFrameBuffer(s_ShadowCascadeTargets[i])->GetDepthAttachmentID();
+
 		if (collider)
 		{
 			Renderer::Submit([]() 
@@ -515,7 +626,7 @@ namespace Engine
 				});
 		}
 
-		Renderer::BeginRenderPass(s_Data->m_GeometryPass);
+		Renderer::BeginRenderPass(resources.GetRenderPass("SceneHDR"));
 
 		if (collider)
 		{
@@ -533,44 +644,58 @@ namespace Engine
 		//Render skybox
 		if(s_Data->m_SceneData.SceneEnvironment.SkyboxMap)
 		{
-			s_Data->m_SceneData.SkyboxMaterial->Set("u_Skybox", s_Data->m_SceneData.SceneEnvironment.SkyboxMap);
-			s_Data->m_SceneData.SkyboxMaterial->Set("u_ViewMatrix", glm::mat4(glm::mat3(sceneCamera.ViewMatrix)));
-			s_Data->m_SceneData.SkyboxMaterial->Set("u_ProjectionMatrix", sceneCamera.Camera.GetProjection());
+			s_Data->m_SceneData.SkyboxMaterial->Set(Property::Skybox, s_Data->m_SceneData.SceneEnvironment.SkyboxMap);
+			s_Data->m_SceneData.SkyboxMaterial->Set(Property::ViewMatrix, glm::mat4(glm::mat3(sceneCamera.ViewMatrix)));
+			s_Data->m_SceneData.SkyboxMaterial->Set(Property::ProjectionMatrix, sceneCamera.Camera.GetProjection());
 			
 			Renderer::SubmitMesh(s_Data->m_SkyboxMesh, glm::mat4(1.0f), s_Data->m_SkyboxPipeline, s_Data->m_SceneData.SkyboxMaterial);
 		}
 
 		//Render entities
+		MeshletCullingView cullingView{ viewProjection, cameraPosition, true };
+		MeshletCuller::SetView(&cullingView);
+		s_Data->m_GeometryPassMaterials.clear();
 		for (auto& dc : s_Data->m_DrawList)
 		{
 			auto baseMaterial = dc.Mesh->GetMaterial();
-			baseMaterial->Set("u_ViewProjectionMatrix", viewProjection);
-			baseMaterial->Set("u_ViewMatrix", sceneCamera.ViewMatrix);
-			baseMaterial->Set("u_CameraPosition", cameraPosition);
-			baseMaterial->Set("u_LightSpaceMatrix", s_Data->m_LightSpaceMatrix);
-			baseMaterial->Set("u_LightCascadeMatrix0", s_Data->m_LightCascadeMatrices[0]);
-			baseMaterial->Set("u_LightCascadeMatrix1", s_Data->m_LightCascadeMatrices[1]);
-			baseMaterial->Set("u_LightCascadeMatrix2", s_Data->m_LightCascadeMatrices[2]);
-			baseMaterial->Set("u_LightCascadeMatrix3", s_Data->m_LightCascadeMatrices[3]);
-			baseMaterial->Set("u_CascadeSplits", glm::vec4(s_Data->m_CascadeSplits[0], s_Data->m_CascadeSplits[1], s_Data->m_CascadeSplits[2], s_Data->m_CascadeSplits[3]));
-			//TODO: More uniforms 
+			//Values shared by every draw are set once per frame for each base material, so the keywords do not
+			//look up the shader variant per draw
+			if (s_Data->m_GeometryPassMaterials.insert(baseMaterial.get()).second)
+			{
+				baseMaterial->Set(Property::ViewProjectionMatrix, viewProjection);
+				baseMaterial->Set(Property::ViewMatrix, sceneCamera.ViewMatrix);
+				baseMaterial->Set(Property::CameraPosition, cameraPosition);
+				baseMaterial->Set(Property::LightSpaceMatrix, s_Data->m_LightSpaceMatrix);
+				baseMaterial->Set(Property::LightCascadeMatrix0, s_Data->m_LightCascadeMatrices[0]);
+				baseMaterial->Set(Property::LightCascadeMatrix1, s_Data->m_LightCascadeMatrices[1]);
+				baseMaterial->Set(Property::LightCascadeMatrix2, s_Data->m_LightCascadeMatrices[2]);
+				baseMaterial->Set(Property::LightCascadeMatrix3, s_Data->m_LightCascadeMatrices[3]);
+				baseMaterial->Set(Property::CascadeSplits, glm::vec4(s_Data->m_CascadeSplits[0], s_Data->m_CascadeSplits[1], s_Data->m_CascadeSplits[2], s_Data->m_CascadeSplits[3]));
+				//TODO: More uniforms 
 			
-			//Set lights 
-			//TODO: Ŀǰֻʹ1, ҪΪ4; ֱҪÿmesh, Ƴѭ
-			auto directionalLight = s_Data->m_SceneData.SceneLightEnvironment.DirectionalLights[0];
-			baseMaterial->Set("u_DirectionalLight", directionalLight); 
+				//Set lights 
+				//TODO: Ŀǰֻʹ1, ҪΪ4; ֱҪÿmesh, Ƴѭ
+				auto directionalLight = s_Data->m_SceneData.SceneLightEnvironment.DirectionalLights[0];
+				baseMaterial->Set(Property::DirectionalLightDirection, directionalLight.Direction);
+				baseMaterial->Set(Property::DirectionalLightRadiance, directionalLight.Radiance);
+				baseMaterial->Set(Property::DirectionalLightIntensity, directionalLight.Intensity);
+				baseMaterial->Set(Property::DirectionalLightSamplingRadius, directionalLight.SamplingRadius);
+				//Shadow filtering is compiled into the shader variant
+				baseMaterial->SetKeyword("SHADOWS_PCF", directionalLight.ShadowTypeEnum == 1);
+				baseMaterial->SetKeyword("SHADOWS_PCSS", directionalLight.ShadowTypeEnum == 2);
 			
-			//Set environment
-			baseMaterial->Set("u_IrradianceMap", s_Data->m_SceneData.SceneEnvironment.IrradianceMap);
-			baseMaterial->Set("u_EnvPrefliteredMap", s_Data->m_SceneData.SceneEnvironment.PrefliteredMap);
-			baseMaterial->Set("u_BRDFLUTMap", s_Data->m_BRDFLUTMap);
+				//Set environment
+				baseMaterial->Set(Property::IrradianceMap, s_Data->m_SceneData.SceneEnvironment.IrradianceMap);
+				baseMaterial->Set(Property::EnvPrefliteredMap, s_Data->m_SceneData.SceneEnvironment.PrefliteredMap);
+				baseMaterial->Set(Property::BRDFLUTMap, s_Data->m_BRDFLUTMap);
+			}
 
 			//Shadow map
-			auto resource = baseMaterial->FindShaderResource("u_ShadowMapTexture");
+			auto resource = baseMaterial->FindShaderResource(Property::ShadowMapTexture);
 			if (resource)
 			{
 				auto reg = resource->GetRegister();
-				uint32_t texID = s_Data->m_ShadowMapPass->GetSpecification().TargetFramebuffer->GetDepthAttachmentID();
+				uint32_t texID = shadowMapTexID;
 				
 				Renderer::Submit([reg, texID]() mutable
 					{
@@ -578,16 +703,16 @@ namespace Engine
 					});
 			}
 
-			auto res = baseMaterial->FindShaderResource("u_ShadowMapTextures");
+			auto res = baseMaterial->FindShaderResource(Property::ShadowMapTextures);
 			if (res)
 			{
 				auto reg = res->GetRegister();
 				uint32_t texID[] =
 				{
-					s_Data->m_ShadowMapPasses[0]->GetSpecification().TargetFramebuffer->GetDepthAttachmentID(),
-					s_Data->m_ShadowMapPasses[1]->GetSpecification().TargetFramebuffer->GetDepthAttachmentID(),
-					s_Data->m_ShadowMapPasses[2]->GetSpecification().TargetFramebuffer->GetDepthAttachmentID(),
-					s_Data->m_ShadowMapPasses[3]->GetSpecification().TargetFramebuffer->GetDepthAttachmentID()
+					shadowCascadeTexIDs[0],
+					shadowCascadeTexIDs[1],
+					shadowCascadeTexIDs[2],
+					shadowCascadeTexIDs[3]
 				};
 
 				Renderer::Submit([reg, texID]() mutable
@@ -599,8 +724,12 @@ namespace Engine
 					});
 			}
 
-			Renderer::SubmitMesh(dc.Mesh, dc.Transform, s_Data->m_GeometryPipeline, dc.Material);
+			if (dc.MaterialOverrides)
+				Renderer::SubmitMesh(dc.Mesh, dc.Transform, s_Data->m_GeometryPipeline, *dc.MaterialOverrides, dc.SkinnedVertexBuffer);
+			else
+				Renderer::SubmitMesh(dc.Mesh, dc.Transform, s_Data->m_GeometryPipeline, dc.Material, dc.SkinnedVertexBuffer);
 		}
+		MeshletCuller::SetView(nullptr);
 
 
 		if (collider)
@@ -626,7 +755,7 @@ namespace Engine
 					glDisable(GL_DEPTH_TEST);
 				});
 
-			s_Data->m_ColliderMaterial->Set("u_ViewProjection", viewProjection);
+			s_Data->m_ColliderMaterial->Set(Property::ViewProjection, viewProjection);
 			for (auto& dc : s_Data->m_ColliderDrawList)
 			{
 				if (dc.Mesh)
@@ -659,32 +788,135 @@ namespace Engine
 		Renderer::EndRenderPass();
 	}
 
-	void SceneRenderer::CompositePass()
+	void SceneRenderer::CompositePass(const RenderGraphResources& resources)
 	{
-		Renderer::BeginRenderPass(s_Data->m_CompositePass);
-		Renderer::SubmitFullScreenQuad(s_Data->m_GeometryPass->GetSpecification().TargetFramebuffer->GetColorAttachmentID());
+		Renderer::BeginRenderPass(resources.GetRenderPass("SceneColor"));
+		Renderer::SubmitFullScreenQuad(resources.GetFrameBuffer("SceneHDR")->GetColorAttachmentID());
 		Renderer::EndRenderPass();
 	}
 
+	//Texture streaming feedback. A texture needs the mip where one texel covers about one pixel
+	//at the point of the submesh bounds closest to the camera.
+	static void RequestTextureMips()
+	{
+		auto& sceneCamera = s_Data->m_SceneData.SceneCamera;
+		const glm::mat4& projection = sceneCamera.Camera.GetProjection();
+		glm::vec3 cameraPosition = glm::inverse(sceneCamera.ViewMatrix)[3];
+		bool perspective = projection[3][3] == 0.0f;
+		float viewportHeight = (float)s_Data->m_ViewportHeight;
+
+		for (auto& dc : s_Data->m_DrawList)
+		{
+			const auto& materials = dc.Mesh->GetMaterials();
+			for (const Submesh& submesh : dc.Mesh->GetSubmeshes())
+			{
+				if (submesh.UVDensity <= 0.0f)
+					continue;
+
+				//The smallest axis scale gives the highest density
+				glm::mat4 transform = dc.Transform * submesh.Transform;
+				float scale = glm::min(glm::length(glm::vec3(transform[0])), glm::min(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+				if (scale <= 0.0f)
+					continue;
+
+				float pixelsPerUnit = viewportHeight * projection[1][1] * 0.5f;
+				if (perspective)
+				{
+					glm::vec3 localCamera = glm::inverse(transform) * glm::vec4(cameraPosition, 1.0f);
+					glm::vec3 closest = glm::clamp(localCamera, submesh.BoundingBox.Min, submesh.BoundingBox.Max);
+					float distance = glm::distance(glm::vec3(transform * glm::vec4(closest, 1.0f)), cameraPosition);
+					pixelsPerUnit /= glm::max(distance, 0.01f);
+				}
+				float uvPerPixel = submesh.UVDensity / scale / pixelsPerUnit;
+
+				uint32_t index = submesh.MaterialIndex;
+				auto material = dc.Material ? dc.Material : materials[index];
+				if (!dc.Material && dc.MaterialOverrides && index < dc.MaterialOverrides->size() && (*dc.MaterialOverrides)[index])
+					material = (*dc.MaterialOverrides)[index];
+				for (auto& texture : material->GetTextureTable())
+				{
+					if (!texture)
+						continue;
+					float texelsPerPixel = uvPerPixel * std::max(texture->GetWidth(), texture->GetHeight());
+					TextureStreamer::Request(texture.get(), glm::log2(glm::max(texelsPerPixel, 1.0f)));
+				}
+			}
+		}
+	}
+
+	void SceneRenderer::SkinningPass()
+	{
+		if (s_Data->m_Animators.empty())
+			return;
+
+		auto shader = Renderer::GetShaderLibrary().Get("Skinning");
+		shader->Bind();
+		for (auto& animator : s_Data->m_Animators)
+			animator->Skin(shader);
+
+		//Skinned vertices are read as vertex attributes by every pass after this
+		Renderer::Submit([]()
+			{
+				Renderer::GetAPI().Barrier((uint32_t)RendererBarrier::VertexAttributes);
+			});
+	}
+
 	void SceneRenderer::FlushDrawList()
 	{
 		ENGINE_ASSERT(!s_Data->m_ActiveScene, "No active scene!");
 
-		Renderer::Submit([]() {RENDERCOMMAND_TRACE("RenderCommand: ShadowMapPass Begin:"); });
-		ShadowMapPass();
-		Renderer::Submit([]() {RENDERCOMMAND_TRACE("RenderCommand: ShadowMapPass End"); });
+		RequestTextureMips();
+		//Not a render graph pass, the graph culls passes that write no target
+		SkinningPass();
+		MeshletCuller::BeginFrame();
+		s_Data->m_RenderGraph->Execute();
 
-		Renderer::Submit([]() {RENDERCOMMAND_TRACE("RenderCommand: GeometryPass Begin:"); });
-		GeometryPass();
-		Renderer::Submit([]() {RENDERCOMMAND_TRACE("RenderCommand: GeometryPass End"); });
-
-		Renderer::Submit([]() {RENDERCOMMAND_TRACE("RenderCommand: CompositePass Begin:"); });
-		CompositePass();
-		Renderer::Submit([]() {RENDERCOMMAND_TRACE("RenderCommand: CompositePass End"); });
+		ResolvePassTimers();
 
 		s_Data->m_DrawList.clear();
 		s_Data->m_ShadowPassDrawList.clear();
 		s_Data->m_ColliderDrawList.clear();
+		s_Data->m_Animators.clear();
 		s_Data->m_SceneData = {};
 	}
+
+	void SceneRenderer::BeginPassTimer(uint32_t passIndex)
+	{
+		if (!s_Data->m_PassTimingEnabled)
+			return;
+
+		Renderer::Submit([passIndex]()
+			{
+				glQueryCounter(s_Data->m_PassTimerQueries[passIndex][0], GL_TIMESTAMP);
+			});
+	}
+
+	void SceneRenderer::EndPassTimer(uint32_t passIndex)
+	{
+		if (!s_Data->m_PassTimingEnabled)
+			return;
+
+		Renderer::Submit([passIndex]()
+			{
+				glQueryCounter(s_Data->m_PassTimerQueries[passIndex][1], GL_TIMESTAMP);
+			});
+	}
+
+	void SceneRenderer::ResolvePassTimers()
+	{
+		if (!s_Data->m_PassTimingEnabled)
+			return;
+
+		//Blocks until the GPU reaches the end of the frame, only used for profiling
+		Renderer::Submit([]()
+			{
+				for (uint32_t i = 0; i < s_Data->m_PassTimings.size(); i++)
+				{
+					GLuint64 begin = 0, end = 0;
+					glGetQueryObjectui64v(s_Data->m_PassTimerQueries[i][0], GL_QUERY_RESULT, &begin);
+					glGetQueryObjectui64v(s_Data->m_PassTimerQueries[i][1], GL_QUERY_RESULT, &end);
+					s_Data->m_PassTimings[i].GPUTime = (float)(end - begin) / 1000000.0f;
+				}
+			});
+	}
 }
\ No newline at end of file
@@ -9,12 +9,21 @@
 
 namespace Engine
 {
+	class RenderGraphResources;
+	class Animator;
+
 	struct SceneRendererCamera
 	{
-		Camera Camera;
+		Engine::Camera Camera;
 		glm::mat4 ViewMatrix;
 	};
 
+	struct SceneRendererPassTiming
+	{
+		std::string Name;
+		float GPUTime = 0.0f; //ms
+	};
+
 	class SceneRenderer
 	{
 		friend class Scene;
@@ -28,6 +37,14 @@ namespace Engine
 
 		static void SetViewportSize(uint32_t width, uint32_t height);
 		static void SubmitMesh(Ref<Mesh>& mesh, const glm::mat4& transform = glm::mat4(1.0f), Ref<MaterialInstance> overrideMaterial = nullptr);
+		/// <summary>
+		/// Submit a shared mesh with the materials of one entity, null entries use the mesh material.
+		/// </summary>
+		static void SubmitMesh(Ref<Mesh>& mesh, const glm::mat4& transform, const std::vector<Ref<MaterialInstance>>& materialOverrides);
+		/// <summary>
+		/// Submit an animated mesh. The animator skins it before the passes run and its vertices are drawn instead.
+		/// </summary>
+		static void SubmitMesh(Ref<Mesh>& mesh, const glm::mat4& transform, const std::vector<Ref<MaterialInstance>>& materialOverrides, const Ref<Animator>& animator);
 		
 		//Collider Debug Mesh
 		static void SubmitColliderMesh(const BoxColliderComponent& component, const glm::mat4& parentTransform = glm::mat4(1.0F));
@@ -37,11 +54,25 @@ namespace Engine
 
 		static uint32_t GetFinalColorBufferRendererID();
 		static Ref<FrameBuffer> GetFinalFrameBuffer();
+
+		/// <summary>
+		/// Enable GPU timer queries around each pass. Resolving the queries stalls the render thread, so keep it off outside profiling.
+		/// </summary>
+		static void SetPassTimingEnabled(bool enabled);
+		/// <summary>
+		/// GPU time of each pass in the last executed frame, valid after Renderer::WaitAndRender().
+		/// </summary>
+		static const std::vector<SceneRendererPassTiming>& GetPassTimings();
 	private:
-		static void ShadowMapPass();
-		static void GeometryPass();
-		static void CompositePass();
+		static void ShadowMapPass(const RenderGraphResources& resources);
+		static void GeometryPass(const RenderGraphResources& resources);
+		static void CompositePass(const RenderGraphResources& resources);
+
+		static void BeginPassTimer(uint32_t passIndex);
+		static void EndPassTimer(uint32_t passIndex);
+		static void ResolvePassTimers();
 
+		static void SkinningPass();
 		static void FlushDrawList();
 	};
 }
\ No newline at end of file
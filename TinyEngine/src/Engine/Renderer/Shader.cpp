@@ -4,12 +4,29 @@
 #include "Engine/Renderer/Renderer.h"
 #include "Engine/Platforms/OpenGL/OpenGLShader.h"
 
+#include <filesystem>
+#include <algorithm>
+#include <unordered_set>
+#include <mutex>
+
 namespace Engine
 {
 	//TODO: Move to resource manager
 	std::vector<Ref<Shader>> Shader::s_AllShaders;
+	ShaderCacheStatistics Shader::s_CacheStatistics;
 
-	Ref<Shader> Shader::Create(const std::string& filepath)
+#ifdef ENGINE_DEBUG
+	const char* ShaderPropertyID::InternName(const std::string& name)
+	{
+		//Node based, so the names never move
+		static std::unordered_set<std::string> s_Names;
+		static std::mutex s_NamesMutex;
+		std::lock_guard<std::mutex> lock(s_NamesMutex);
+		return s_Names.insert(name).first->c_str();
+	}
+#endif
+
+	Ref<Shader> Shader::Create(const std::string& filepath, bool async)
 	{
 		Ref<Shader> result = nullptr;
 		switch (Renderer::GetAPIType())
@@ -18,7 +35,7 @@ namespace Engine
 			ENGINE_ASSERT(false, "RendererAPI::None is currently not supported!");
 			return nullptr;
 		case RendererAPI::RendererAPIType::OpenGL:
-			result = CreateRef<OpenGLShader>(filepath);
+			result = CreateRef<OpenGLShader>(filepath, async);
 			break;
 		default:
 			ENGINE_ASSERT(false, "Unknown RendererAPI!");
@@ -30,7 +47,7 @@ namespace Engine
 
 	void ShaderLibrary::Add(const Ref<Shader>& shader)
 	{
-		auto& name = shader->GetName();
+		const auto& name = shader->GetName();
 		ENGINE_ASSERT(!Exists(name), "Shader already exists!");
 		m_Shaders[name] = shader;
 	}
@@ -42,13 +59,51 @@ namespace Engine
 		return shader;
 	}
 
+	std::vector<Ref<Shader>> ShaderLibrary::LoadBatch(const std::vector<std::string>& filepaths)
+	{
+		std::vector<Ref<Shader>> shaders;
+		shaders.reserve(filepaths.size());
+		for (auto& filepath : filepaths)
+		{
+			auto shader = Shader::Create(filepath, true);
+			Add(shader);
+			if (shader->IsCompiling())
+				m_CompilingShaders.push_back(shader);
+			shaders.push_back(shader);
+		}
+		return shaders;
+	}
+
+	void ShaderLibrary::Update()
+	{
+		m_CompilingShaders.erase(std::remove_if(m_CompilingShaders.begin(), m_CompilingShaders.end(),
+			[](const Ref<Shader>& shader) { return !shader->IsCompiling(); }), m_CompilingShaders.end());
+
+		for (auto& shader : m_CompilingShaders)
+			shader->PollCompile();
+	}
+
+	void ShaderLibrary::LoadDeferred(const std::string& filepath)
+	{
+		std::string name = std::filesystem::path(filepath).stem().string();
+		ENGINE_ASSERT(!Exists(name), "Shader already exists!");
+		m_DeferredShaders[name] = filepath;
+	}
+
 	Ref<Shader> ShaderLibrary::Get(const std::string& name)
 	{
 		ENGINE_ASSERT(Exists(name), "Shader not found!");
+		auto deferred = m_DeferredShaders.find(name);
+		if (deferred != m_DeferredShaders.end())
+		{
+			std::string filepath = deferred->second;
+			m_DeferredShaders.erase(deferred);
+			return Load(filepath);
+		}
 		return m_Shaders[name];
 	}
 	bool ShaderLibrary::Exists(const std::string& name) const
 	{
-		return m_Shaders.find(name) != m_Shaders.end();
+		return m_Shaders.find(name) != m_Shaders.end() || m_DeferredShaders.find(name) != m_DeferredShaders.end();
 	}
 }
\ No newline at end of file
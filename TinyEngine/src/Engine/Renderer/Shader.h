@@ -58,7 +58,6 @@ namespace Engine
 		template<typename T>
 		void Push(const std::string& name, const T& data) {}
 		
-		template<>
 		void Push(const std::string& name, const float& data)
 		{
 			Uniforms[Index++] = { UniformType::Float, Cursor, name };
@@ -66,7 +65,6 @@ namespace Engine
 			Cursor += sizeof(float);
 		}
 
-		template<>
 		void Push(const std::string& name, const glm::vec2& data)
 		{
 			Uniforms[Index++] = { UniformType::Float2, Cursor, name };
@@ -74,7 +72,6 @@ namespace Engine
 			Cursor += sizeof(glm::vec2);
 		}
 
-		template<>
 		void Push(const std::string& name, const glm::vec3& data)
 		{
 			Uniforms[Index++] = { UniformType::Float3, Cursor, name };
@@ -82,7 +79,6 @@ namespace Engine
 			Cursor += sizeof(glm::vec3);
 		}
 
-		template<>
 		void Push(const std::string& name, const glm::vec4& data)
 		{
 			Uniforms[Index++] = { UniformType::Float4, Cursor, name };
@@ -90,7 +86,6 @@ namespace Engine
 			Cursor += sizeof(glm::vec4);
 		}
 
-		template<>
 		void Push(const std::string& name, const glm::mat3& data)
 		{
 			Uniforms[Index++] = { UniformType::Matrix3x3, Cursor, name };
@@ -98,7 +93,6 @@ namespace Engine
 			Cursor += sizeof(glm::mat3);
 		}
 
-		template<>
 		void Push(const std::string& name, const glm::mat4& data)
 		{
 			Uniforms[Index++] = { UniformType::Matrix4x4, Cursor, name };
@@ -107,13 +101,26 @@ namespace Engine
 		}
 	};
 
+	class Texture;
+
+	struct ShaderCacheStatistics
+	{
+		uint32_t Hits = 0;
+		uint32_t Misses = 0;
+	};
+
 	class Shader
 	{
 	public:
 		static std::vector<Ref<Shader>> s_AllShaders;
+		//Program binary cache lookups since startup
+		static ShaderCacheStatistics s_CacheStatistics;
 	
 	public:
-		static Ref<Shader> Create(const std::string& filepath);
+		/// <summary>
+		/// With async the program is compiled in the background, see ShaderLibrary::LoadBatch.
+		/// </summary>
+		static Ref<Shader> Create(const std::string& filepath, bool async = false);
 
 	public:
 		using ShaderReloadedCallback = std::function<void()>;
@@ -123,6 +130,25 @@ namespace Engine
 		virtual void Reload() = 0;
 
 		virtual uint32_t GetRendererID() const = 0;
+		/// <summary>
+		/// False until the first program is linked. Meanwhile Bind uses a flat placeholder program.
+		/// </summary>
+		virtual bool IsReady() const = 0;
+		virtual bool IsCompiling() const = 0;
+		/// <summary>
+		/// Make the program current if the driver has finished an asynchronous compile.
+		/// </summary>
+		virtual void PollCompile() = 0;
+
+		/// <summary>
+		/// Keywords declared with '#pragma variant' in declaration order. Bit i of a variant mask defines keyword i.
+		/// </summary>
+		virtual const std::vector<std::string>& GetKeywords() const = 0;
+		virtual uint32_t GetKeywordMask(const std::string& keyword) const = 0;
+		/// <summary>
+		/// Program specialized for the keyword mask, created on first request. Variants share the uniform layout of this shader.
+		/// </summary>
+		virtual Shader* GetVariant(uint32_t keywords) = 0;
 		virtual void Bind() const = 0;
 		virtual void Unbind() const = 0;
 		virtual void UploadUniformBuffer(const UniformBufferBase& uniformBuffer) = 0;
@@ -131,6 +157,12 @@ namespace Engine
 
 		virtual void SetVSMaterialUniformBuffer(Buffer buffer) = 0;
 		virtual void SetPSMaterialUniformBuffer(Buffer buffer) = 0;
+		/// <summary>
+		/// Transforms of the placeholder program, which has a fixed layout because the reflected one does not exist
+		/// before the first link. Ignored once the shader is ready.
+		/// </summary>
+		virtual void SetPlaceholderTransforms(const glm::mat4& viewProjection, const glm::mat4& transform) = 0;
+		//Material layout reflected from the linked programs, empty until the first one is linked
 		virtual bool HasVSMaterialUniformBuffer() const = 0;
 		virtual bool HasPSMaterialUniformBuffer() const = 0;
 		virtual const ShaderUniformBuffer& GetVSMaterialUniformBuffer() const = 0;
@@ -147,10 +179,24 @@ namespace Engine
 		virtual void Set(const std::string& name, const glm::vec4& value) = 0;
 		virtual void Set(const std::string& name, const glm::mat3& matrix) = 0;
 		virtual void Set(const std::string& name, const glm::mat4& matrix) = 0;
+		/// <summary>
+		/// Set a uniform of the bound program right away, found by reflection. Render thread only, for commands that
+		/// dispatch or draw several times.
+		/// </summary>
+		virtual void UploadUniform(const std::string& name, uint32_t value) = 0;
 
 		virtual const ShaderResourceList& GetResources() const = 0;
-
-		virtual void AddShaderReloadedCallback(const ShaderReloadedCallback& callback) = 0;
+		/// <summary>
+		/// Bind textures by resource register with a single render command. Null entries leave the slot untouched.
+		/// </summary>
+		virtual void BindTextures(const std::vector<Ref<Texture>>& textures) = 0;
+
+		/// <summary>
+		/// Called whenever the uniform layout changes: after the first link, when a variant uses uniforms the layout
+		/// does not have yet and after a reload. Returns an id for RemoveShaderReloadedCallback.
+		/// </summary>
+		virtual uint32_t AddShaderReloadedCallback(const ShaderReloadedCallback& callback) = 0;
+		virtual void RemoveShaderReloadedCallback(uint32_t id) = 0;
 	};
 
 	class ShaderLibrary
@@ -158,12 +204,32 @@ namespace Engine
 	public:
 		void Add(const Ref<Shader>& shader);
 		Ref<Shader> Load(const std::string& filepath);
+		/// <summary>
+		/// Register a shader that is only loaded and compiled on its first Get.
+		/// </summary>
+		void LoadDeferred(const std::string& filepath);
+		/// <summary>
+		/// Queue all shaders at once so the driver can compile them in parallel. Returned shaders become ready over the next frames.
+		/// </summary>
+		std::vector<Ref<Shader>> LoadBatch(const std::vector<std::string>& filepaths);
+		/// <summary>
+		/// Poll shaders of pending batches. Called once per frame by the renderer.
+		/// </summary>
+		void Update();
 		Ref<Shader> Get(const std::string& name);
 		bool Exists(const std::string& name) const;
+		uint32_t GetDeferredCount() const { return (uint32_t)m_DeferredShaders.size(); }
+		/// <summary>
+		/// Shaders of batches still compiling, as of the last Update.
+		/// </summary>
+		uint32_t GetCompilingCount() const { return (uint32_t)m_CompilingShaders.size(); }
 
 		std::unordered_map<std::string, Ref<Shader>>& GetShaders() { return m_Shaders; }
 		const std::unordered_map<std::string, Ref<Shader>>& GetShaders() const { return m_Shaders; }
 	private:
 		std::unordered_map<std::string, Ref<Shader>> m_Shaders;
+		//Name -> filepath of shaders not loaded yet
+		std::unordered_map<std::string, std::string> m_DeferredShaders;
+		std::vector<Ref<Shader>> m_CompilingShaders;
 	};
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "Engine/Core/Core.h"
 #include "Engine/Core/Ref.h"
 #include "Engine/Core/Log.h"
+#include "Engine/Core/Hash.h"
 
 namespace Engine
 {
@@ -14,6 +15,47 @@ namespace Engine
 		Pixel = 1
 	};
 
+	/// <summary>
+	/// Hashed name of a shader uniform or resource.
+	/// Declare hot properties as static constexpr so the hash is computed at compile time.
+	/// </summary>
+	struct ShaderPropertyID
+	{
+		uint32_t Value = 0;
+#ifdef ENGINE_DEBUG
+		//For logging only. Literals are kept as is, strings are interned
+		const char* Name = "";
+#endif
+
+		constexpr ShaderPropertyID() = default;
+#ifdef ENGINE_DEBUG
+		constexpr ShaderPropertyID(const char* name) : Value(Hash::FNV(name)), Name(name) {}
+		ShaderPropertyID(const std::string& name) : Value(Hash::FNV(name.c_str())), Name(InternName(name)) {}
+#else
+		constexpr ShaderPropertyID(const char* name) : Value(Hash::FNV(name)) {}
+		ShaderPropertyID(const std::string& name) : Value(Hash::FNV(name.c_str())) {}
+#endif
+
+		bool operator==(const ShaderPropertyID& other) const { return Value == other.Value; }
+
+		/// <summary>
+		/// The uniform name in debug builds, the hash otherwise.
+		/// </summary>
+		std::string ToString() const
+		{
+#ifdef ENGINE_DEBUG
+			return Name;
+#else
+			return std::to_string(Value);
+#endif
+		}
+
+#ifdef ENGINE_DEBUG
+	private:
+		static const char* InternName(const std::string& name);
+#endif
+	};
+
 	/// <summary>
 	/// ShaderеUniform
 	/// </summary>
@@ -91,6 +133,8 @@ namespace Engine
 	class ShaderResource
 	{
 	public:
+		virtual ~ShaderResource() = default;
+
 		virtual const std::string& GetName() const = 0;
 		virtual uint32_t GetRegister() const = 0;
 		virtual uint32_t GetCount() const = 0;
@@ -39,6 +39,22 @@ namespace Engine
 		}
 	}
 
+	void Texture2D::ProcessPendingUploads(uint32_t byteBudget)
+	{
+		switch (Renderer::GetAPIType())
+		{
+		case RendererAPI::RendererAPIType::None:
+			ENGINE_ASSERT(false, "RendererAPI::None is currently not supported!");
+			return;
+		case RendererAPI::RendererAPIType::OpenGL:
+			OpenGLTexture2D::ProcessPendingUploads(byteBudget);
+			return;
+		default:
+			ENGINE_ASSERT(false, "Unknown RendererAPI!");
+			return;
+		}
+	}
+
 	uint32_t Texture::GetBPP(TextureFormat format)
 	{
 		switch (format)
@@ -48,9 +64,36 @@ namespace Engine
 		case Engine::TextureFormat::RGB:		return 3;
 		case Engine::TextureFormat::RGBA:
 		case Engine::TextureFormat::RGBA16F:	return 4;
+		default:
+			ENGINE_ASSERT(false, "Unknown texture format!");
+			return 0;
 		}
-		ENGINE_ASSERT(false, "Unknown texture format!");
-		return 0;
+	}
+
+	bool Texture::IsCompressed(TextureFormat format)
+	{
+		return GetBlockSize(format) != 0;
+	}
+
+	uint32_t Texture::GetBlockSize(TextureFormat format)
+	{
+		switch (format)
+		{
+		case Engine::TextureFormat::BC1:
+		case Engine::TextureFormat::BC4:	return 8;
+		case Engine::TextureFormat::BC3:
+		case Engine::TextureFormat::BC5:
+		case Engine::TextureFormat::BC7:	return 16;
+		//Not block compressed
+		default:							return 0;
+		}
+	}
+
+	uint32_t Texture::CalculateImageSize(TextureFormat format, uint32_t width, uint32_t height)
+	{
+		if (IsCompressed(format))
+			return ((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(format);
+		return width * height * GetBPP(format);
 	}
 
 	uint32_t Texture::CalculateMipMapCount(uint32_t width, uint32_t height)
@@ -78,6 +121,23 @@ namespace Engine
 		}
 	}
 
+	Ref<TextureCube> TextureCube::Create(const Ref<Texture2D>& equirectTexture)
+	{
+		Ref<TextureCube> result = nullptr;
+		switch (Renderer::GetAPIType())
+		{
+		case RendererAPI::RendererAPIType::None:
+			ENGINE_ASSERT(false, "RendererAPI::None is currently not supported!");
+			return nullptr;
+		case RendererAPI::RendererAPIType::OpenGL:
+			result = CreateRef<OpenGLTextureCube>(equirectTexture);
+			return result;
+		default:
+			ENGINE_ASSERT(false, "Unknown RendererAPI!");
+			return nullptr;
+		}
+	}
+
 	Ref<TextureCube> TextureCube::Create(TextureFormat format, uint32_t width, uint32_t height)
 	{
 		Ref<TextureCube> result = nullptr;
@@ -17,7 +17,14 @@ namespace Engine
 		RG16F,
 		RGB,
 		RGBA,
-		RGBA16F
+		RGBA16F,
+
+		//Block compressed, 4x4 texels per block
+		BC1,	//RGB, 8 bytes
+		BC3,	//RGBA, 16 bytes
+		BC4,	//R, 8 bytes
+		BC5,	//RG, 16 bytes
+		BC7		//RGBA, 16 bytes
 	};
 
 	enum class TextureWrap
@@ -33,10 +40,26 @@ namespace Engine
 		Vertical
 	};
 
+	/// <summary>
+	/// What the image stores. Picks the block compression of imported images.
+	/// </summary>
+	enum class TextureUsage
+	{
+		Default = 0,	//Uncompressed
+		Albedo,			//BC1, BC7 if the image has alpha
+		Normal,			//BC5, Z is reconstructed in the shader
+		Mask			//BC4, roughness/metalness/occlusion
+	};
+
 	struct TextureSpecification
 	{
 		TextureWrap Wrap = TextureWrap::Clamp;
 		TextureFlip Flip = TextureFlip::Vertical;
+		TextureUsage Usage = TextureUsage::Default;
+		//Decode files on the asset workers, the texture draws as a placeholder until uploaded
+		bool Async = true;
+		//Worker queue priority of the decode, higher first. See AssetLoadPriority.
+		uint32_t Priority = 0;
 	};
 
 	class Texture : public Asset
@@ -46,6 +69,15 @@ namespace Engine
 
 	public:
 		static uint32_t GetBPP(TextureFormat format);
+		static bool IsCompressed(TextureFormat format);
+		/// <summary>
+		/// Bytes of a 4x4 block, 0 for uncompressed formats.
+		/// </summary>
+		static uint32_t GetBlockSize(TextureFormat format);
+		/// <summary>
+		/// Bytes of one mip level.
+		/// </summary>
+		static uint32_t CalculateImageSize(TextureFormat format, uint32_t width, uint32_t height);
 		static uint32_t CalculateMipMapCount(uint32_t width, uint32_t height);
 
 	public:
@@ -59,6 +91,10 @@ namespace Engine
 		
 		virtual uint32_t GetRendererID() const = 0;
 		virtual void Bind(uint32_t slot = 0) const = 0;
+		/// <summary>
+		/// Resident bindless handle of the texture, created on first use. Render thread only, 0 if bindless textures are not supported.
+		/// </summary>
+		virtual uint64_t GetBindlessHandle() const = 0;
 	
 		virtual bool operator==(const Texture& other) = 0;
 	};
@@ -71,6 +107,11 @@ namespace Engine
 	public:
 		static Ref<Texture2D> Create(const std::string& path, bool srgb = false, TextureSpecification spec = {});
 		static Ref<Texture2D> Create(TextureFormat format, uint32_t width, uint32_t height, TextureSpecification spec = {});
+		/// <summary>
+		/// Upload decoded images of asynchronously loaded textures until byteBudget bytes are uploaded.
+		/// Called by the renderer after the frame's commands are executed.
+		/// </summary>
+		static void ProcessPendingUploads(uint32_t byteBudget);
 
 		virtual void Lock() = 0;
 		virtual void Unlock() = 0;
@@ -78,7 +119,29 @@ namespace Engine
 		virtual void Resize(uint32_t width, uint32_t height) = 0;
 		virtual Buffer& GetWritableBuffer() = 0;
 
+		/// <summary>
+		/// File header could be read. Size and channels are valid, the pixels may still be decoding.
+		/// </summary>
 		virtual bool IsLoaded() const = 0;
+		/// <summary>
+		/// Pixels are uploaded. Until then the texture binds a placeholder.
+		/// </summary>
+		virtual bool IsReady() const = 0;
+
+		/// <summary>
+		/// Mips are loaded on demand by the TextureStreamer. True for textures loaded from KTX2, including compressed imports.
+		/// </summary>
+		virtual bool IsStreamed() const = 0;
+		/// <summary>
+		/// Most detailed mip in video memory, the chain below it is always resident.
+		/// </summary>
+		virtual uint32_t GetResidentMip() const = 0;
+		/// <summary>
+		/// Make mips from mip down resident. Finer mips are read on the asset workers and uploaded with the pending uploads,
+		/// coarser residency frees the finer mips right away. Ignored while a load is in flight.
+		/// </summary>
+		virtual void SetResidentMip(uint32_t mip) = 0;
+		virtual bool IsStreaming() const = 0;
 
 		virtual const std::string& GetPath() const = 0;
 
@@ -93,6 +156,10 @@ namespace Engine
 
 	public:
 		static Ref<TextureCube> Create(const std::string& path, TextureSpecification spec = {});
+		/// <summary>
+		/// Cube map of an uploaded equirectangular HDR image, e.g. one loaded asynchronously.
+		/// </summary>
+		static Ref<TextureCube> Create(const Ref<Texture2D>& equirectTexture);
 		static Ref<TextureCube> Create(TextureFormat format, uint32_t width, uint32_t height);
 
 		virtual bool IsLoaded() const = 0;
@@ -0,0 +1,761 @@
+#include "pch.h"
+#include "TextureCompressor.h"
+#include "Engine/Core/Hash.h"
+
+#include "stb_image.h"
+#include <filesystem>
+#include <thread>
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+
+namespace Engine
+{
+	const char* TextureCompressor::CacheDirectory = "assets/cache/textures/";
+	//Bump to recompress every cached texture
+	static const uint32_t s_CacheVersion = 1;
+
+	uint32_t CompressedImage::GetSize() const
+	{
+		uint32_t size = 0;
+		for (auto& level : Levels)
+			size += (uint32_t)level.size();
+		return size;
+	}
+
+	//-------------------------------------------------------------
+	//Mips
+	//-------------------------------------------------------------
+	static const float* GetSRGBToLinearTable()
+	{
+		static const std::array<float, 256> table = []()
+		{
+			std::array<float, 256> result;
+			for (uint32_t i = 0; i < 256; i++)
+			{
+				float c = i / 255.0f;
+				result[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+			}
+			return result;
+		}();
+		return table.data();
+	}
+
+	static uint8_t LinearToSRGB(float c)
+	{
+		c = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+		return (uint8_t)(glm::clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f);
+	}
+
+	/// <summary>
+	/// 2x2 box filter of an RGBA8 image. Odd edges repeat the last texel.
+	/// </summary>
+	static std::vector<uint8_t> Downsample(const std::vector<uint8_t>& source, uint32_t width, uint32_t height, bool srgb)
+	{
+		uint32_t mipWidth = std::max(width / 2, 1u);
+		uint32_t mipHeight = std::max(height / 2, 1u);
+		std::vector<uint8_t> result((size_t)mipWidth * mipHeight * 4);
+
+		const float* toLinear = GetSRGBToLinearTable();
+		for (uint32_t y = 0; y < mipHeight; y++)
+		{
+			uint32_t y0 = std::min(y * 2, height - 1);
+			uint32_t y1 = std::min(y * 2 + 1, height - 1);
+			for (uint32_t x = 0; x < mipWidth; x++)
+			{
+				uint32_t x0 = std::min(x * 2, width - 1);
+				uint32_t x1 = std::min(x * 2 + 1, width - 1);
+				const uint8_t* texels[4] = {
+					&source[((size_t)y0 * width + x0) * 4], &source[((size_t)y0 * width + x1) * 4],
+					&source[((size_t)y1 * width + x0) * 4], &source[((size_t)y1 * width + x1) * 4]
+				};
+
+				uint8_t* out = &result[((size_t)y * mipWidth + x) * 4];
+				for (uint32_t c = 0; c < 4; c++)
+				{
+					if (srgb && c < 3)
+					{
+						float sum = toLinear[texels[0][c]] + toLinear[texels[1][c]] + toLinear[texels[2][c]] + toLinear[texels[3][c]];
+						out[c] = LinearToSRGB(sum * 0.25f);
+					}
+					else
+					{
+						out[c] = (uint8_t)((texels[0][c] + texels[1][c] + texels[2][c] + texels[3][c] + 2) / 4);
+					}
+				}
+			}
+		}
+		return result;
+	}
+
+	//-------------------------------------------------------------
+	//Block encoders
+	//-------------------------------------------------------------
+	typedef uint8_t Block[16][4];
+
+	static void FetchBlock(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, Block& block)
+	{
+		for (uint32_t y = 0; y < 4; y++)
+		{
+			uint32_t sourceY = std::min(blockY * 4 + y, height - 1);
+			for (uint32_t x = 0; x < 4; x++)
+			{
+				uint32_t sourceX = std::min(blockX * 4 + x, width - 1);
+				memcpy(block[y * 4 + x], rgba + ((size_t)sourceY * width + sourceX) * 4, 4);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Texels with the lowest and highest projection on the principal axis of the block.
+	/// </summary>
+	static void FindEndpoints(const Block& block, uint32_t channels, float start[4], float end[4])
+	{
+		float mean[4] = {};
+		for (uint32_t i = 0; i < 16; i++)
+			for (uint32_t c = 0; c < channels; c++)
+				mean[c] += block[i][c] / 16.0f;
+
+		float covariance[4][4] = {};
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			for (uint32_t a = 0; a < channels; a++)
+				for (uint32_t b = 0; b < channels; b++)
+					covariance[a][b] += (block[i][a] - mean[a]) * (block[i][b] - mean[b]);
+		}
+
+		//Power iteration
+		float axis[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		for (uint32_t iteration = 0; iteration < 8; iteration++)
+		{
+			float next[4] = {};
+			float length = 0.0f;
+			for (uint32_t a = 0; a < channels; a++)
+			{
+				for (uint32_t b = 0; b < channels; b++)
+					next[a] += covariance[a][b] * axis[b];
+				length = std::max(length, std::abs(next[a]));
+			}
+			//Uniform block, any axis works
+			if (length == 0.0f)
+				break;
+			for (uint32_t c = 0; c < channels; c++)
+				axis[c] = next[c] / length;
+		}
+
+		float minProjection = FLT_MAX, maxProjection = -FLT_MAX;
+		uint32_t minIndex = 0, maxIndex = 0;
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			float projection = 0.0f;
+			for (uint32_t c = 0; c < channels; c++)
+				projection += (block[i][c] - mean[c]) * axis[c];
+			if (projection < minProjection)
+			{
+				minProjection = projection;
+				minIndex = i;
+			}
+			if (projection > maxProjection)
+			{
+				maxProjection = projection;
+				maxIndex = i;
+			}
+		}
+
+		for (uint32_t c = 0; c < channels; c++)
+		{
+			start[c] = block[minIndex][c];
+			end[c] = block[maxIndex][c];
+		}
+	}
+
+	static uint16_t ToRGB565(const float color[3])
+	{
+		uint32_t r = (uint32_t)(color[0] * 31.0f / 255.0f + 0.5f);
+		uint32_t g = (uint32_t)(color[1] * 63.0f / 255.0f + 0.5f);
+		uint32_t b = (uint32_t)(color[2] * 31.0f / 255.0f + 0.5f);
+		return (uint16_t)((r << 11) | (g << 5) | b);
+	}
+
+	static void FromRGB565(uint16_t color, int result[3])
+	{
+		int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+		result[0] = (r << 3) | (r >> 2);
+		result[1] = (g << 2) | (g >> 4);
+		result[2] = (b << 3) | (b >> 2);
+	}
+
+	static void EncodeBC1(const Block& block, uint8_t* out)
+	{
+		float start[4], end[4];
+		FindEndpoints(block, 3, start, end);
+
+		//color0 > color1 selects the opaque four color mode
+		uint16_t color0 = ToRGB565(end);
+		uint16_t color1 = ToRGB565(start);
+		if (color0 < color1)
+			std::swap(color0, color1);
+		memcpy(out, &color0, 2);
+		memcpy(out + 2, &color1, 2);
+
+		uint32_t indices = 0;
+		if (color0 != color1)
+		{
+			int palette[4][3];
+			FromRGB565(color0, palette[0]);
+			FromRGB565(color1, palette[1]);
+			for (uint32_t c = 0; c < 3; c++)
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				uint32_t best = 0;
+				int bestError = INT_MAX;
+				for (uint32_t p = 0; p < 4; p++)
+				{
+					int error = 0;
+					for (uint32_t c = 0; c < 3; c++)
+						error += (block[i][c] - palette[p][c]) * (block[i][c] - palette[p][c]);
+					if (error < bestError)
+					{
+						bestError = error;
+						best = p;
+					}
+				}
+				indices |= best << (i * 2);
+			}
+		}
+		memcpy(out + 4, &indices, 4);
+	}
+
+	static void EncodeBC4(const Block& block, uint32_t channel, uint8_t* out)
+	{
+		uint8_t low = 255, high = 0;
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			low = std::min(low, block[i][channel]);
+			high = std::max(high, block[i][channel]);
+		}
+
+		//red0 > red1 selects the eight value mode
+		out[0] = high;
+		out[1] = low;
+
+		uint64_t indices = 0;
+		if (high != low)
+		{
+			int palette[8] = { high, low };
+			for (uint32_t p = 2; p < 8; p++)
+				palette[p] = ((8 - p) * high + (p - 1) * low + 3) / 7;
+
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				uint64_t best = 0;
+				int bestError = INT_MAX;
+				for (uint32_t p = 0; p < 8; p++)
+				{
+					int error = std::abs(block[i][channel] - palette[p]);
+					if (error < bestError)
+					{
+						bestError = error;
+						best = p;
+					}
+				}
+				indices |= best << (i * 3);
+			}
+		}
+		for (uint32_t i = 0; i < 6; i++)
+			out[2 + i] = (uint8_t)(indices >> (i * 8));
+	}
+
+	static void EncodeBC3(const Block& block, uint8_t* out)
+	{
+		EncodeBC4(block, 3, out);
+		EncodeBC1(block, out + 8);
+	}
+
+	static void EncodeBC5(const Block& block, uint8_t* out)
+	{
+		EncodeBC4(block, 0, out);
+		EncodeBC4(block, 1, out + 8);
+	}
+
+	struct BitWriter
+	{
+		uint8_t* Data;
+		uint32_t Offset = 0;
+
+		void Write(uint32_t value, uint32_t bits)
+		{
+			for (uint32_t i = 0; i < bits; i++, Offset++)
+			{
+				if ((value >> i) & 1)
+					Data[Offset / 8] |= 1 << (Offset % 8);
+			}
+		}
+	};
+
+	/// <summary>
+	/// BC7 mode 6 only: one subset, RGBA endpoints with 7 bits and a p-bit, 4 bit indices.
+	/// </summary>
+	static void EncodeBC7(const Block& block, uint8_t* out)
+	{
+		static const int weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+		float endpoints[2][4];
+		FindEndpoints(block, 4, endpoints[0], endpoints[1]);
+
+		//Quantize each endpoint with the p-bit giving the lower error
+		int quantized[2][4];
+		int pbits[2];
+		int decoded[2][4];
+		for (uint32_t e = 0; e < 2; e++)
+		{
+			float bestError = FLT_MAX;
+			for (int pbit = 0; pbit < 2; pbit++)
+			{
+				int q[4];
+				float error = 0.0f;
+				for (uint32_t c = 0; c < 4; c++)
+				{
+					q[c] = glm::clamp((int)std::round((endpoints[e][c] - pbit) / 2.0f), 0, 127);
+					float delta = (float)((q[c] << 1) | pbit) - endpoints[e][c];
+					error += delta * delta;
+				}
+				if (error < bestError)
+				{
+					bestError = error;
+					pbits[e] = pbit;
+					memcpy(quantized[e], q, sizeof(q));
+				}
+			}
+			for (uint32_t c = 0; c < 4; c++)
+				decoded[e][c] = (quantized[e][c] << 1) | pbits[e];
+		}
+
+		int palette[16][4];
+		for (uint32_t p = 0; p < 16; p++)
+			for (uint32_t c = 0; c < 4; c++)
+				palette[p][c] = ((64 - weights[p]) * decoded[0][c] + weights[p] * decoded[1][c] + 32) >> 6;
+
+		uint32_t indices[16];
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			int bestError = INT_MAX;
+			for (uint32_t p = 0; p < 16; p++)
+			{
+				int error = 0;
+				for (uint32_t c = 0; c < 4; c++)
+					error += (block[i][c] - palette[p][c]) * (block[i][c] - palette[p][c]);
+				if (error < bestError)
+				{
+					bestError = error;
+					indices[i] = p;
+				}
+			}
+		}
+
+		//The first index is stored without its top bit, swap endpoints so it is 0
+		if (indices[0] & 8)
+		{
+			std::swap(quantized[0], quantized[1]);
+			std::swap(pbits[0], pbits[1]);
+			for (uint32_t i = 0; i < 16; i++)
+				indices[i] = 15 - indices[i];
+		}
+
+		memset(out, 0, 16);
+		BitWriter writer{ out };
+		writer.Write(1 << 6, 7);
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			writer.Write(quantized[0][c], 7);
+			writer.Write(quantized[1][c], 7);
+		}
+		writer.Write(pbits[0], 1);
+		writer.Write(pbits[1], 1);
+		for (uint32_t i = 0; i < 16; i++)
+			writer.Write(indices[i], i == 0 ? 3 : 4);
+	}
+
+	//-------------------------------------------------------------
+	//TextureCompressor
+	//-------------------------------------------------------------
+	TextureFormat TextureCompressor::SelectFormat(TextureUsage usage, bool hasAlpha)
+	{
+		switch (usage)
+		{
+		case TextureUsage::Albedo:	return hasAlpha ? TextureFormat::BC7 : TextureFormat::BC1;
+		case TextureUsage::Normal:	return TextureFormat::BC5;
+		case TextureUsage::Mask:	return TextureFormat::BC4;
+		case TextureUsage::Default:	return TextureFormat::None;
+		default:
+			ENGINE_ASSERT(false, "Unknown texture usage!");
+			return TextureFormat::None;
+		}
+	}
+
+	CompressedImage TextureCompressor::Compress(const uint8_t* rgba, uint32_t width, uint32_t height, TextureFormat format, bool srgb)
+	{
+		ENGINE_ASSERT(Texture::IsCompressed(format), "Format is not block compressed!");
+
+		CompressedImage image;
+		image.Format = format;
+		image.SRGB = srgb;
+		image.Width = width;
+		image.Height = height;
+
+		uint32_t blockSize = Texture::GetBlockSize(format);
+		uint32_t levels = Texture::CalculateMipMapCount(width, height);
+		image.Levels.resize(levels);
+
+		std::vector<uint8_t> level(rgba, rgba + (size_t)width * height * 4);
+		for (uint32_t i = 0; i < levels; i++)
+		{
+			uint32_t blocksX = (width + 3) / 4;
+			uint32_t blocksY = (height + 3) / 4;
+			auto& data = image.Levels[i];
+			data.resize(Texture::CalculateImageSize(format, width, height));
+
+			Block block;
+			for (uint32_t y = 0; y < blocksY; y++)
+			{
+				for (uint32_t x = 0; x < blocksX; x++)
+				{
+					FetchBlock(level.data(), width, height, x, y, block);
+					uint8_t* out = data.data() + ((size_t)y * blocksX + x) * blockSize;
+					switch (format)
+					{
+					case TextureFormat::BC1: EncodeBC1(block, out); break;
+					case TextureFormat::BC3: EncodeBC3(block, out); break;
+					case TextureFormat::BC4: EncodeBC4(block, 0, out); break;
+					case TextureFormat::BC5: EncodeBC5(block, out); break;
+					case TextureFormat::BC7: EncodeBC7(block, out); break;
+					default:
+						ENGINE_ASSERT(false, "Format is not block compressed!");
+						break;
+					}
+				}
+			}
+
+			if (i + 1 < levels)
+			{
+				level = Downsample(level, width, height, srgb);
+				width = std::max(width / 2, 1u);
+				height = std::max(height / 2, 1u);
+			}
+		}
+		return image;
+	}
+
+	bool TextureCompressor::CompressFile(const std::string& source, const std::string& destination, TextureUsage usage, bool srgb, bool flip)
+	{
+		stbi_set_flip_vertically_on_load_thread(flip);
+
+		int width, height, channels;
+		uint8_t* pixels = stbi_load(source.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+		if (!pixels)
+		{
+			ENGINE_ERROR("Could not read image '{0}'", source);
+			return false;
+		}
+
+		bool hasAlpha = false;
+		for (size_t i = 3; i < (size_t)width * height * 4 && !hasAlpha; i += 4)
+			hasAlpha = pixels[i] != 255;
+
+		TextureFormat format = SelectFormat(usage, hasAlpha);
+		if (format == TextureFormat::None)
+		{
+			stbi_image_free(pixels);
+			return false;
+		}
+
+		CompressedImage image = Compress(pixels, width, height, format, srgb);
+		stbi_image_free(pixels);
+		return WriteKTX2(destination, image);
+	}
+
+	std::string TextureCompressor::GetCachePath(const std::string& source, TextureUsage usage, bool srgb, bool flip)
+	{
+		if (usage == TextureUsage::Default)
+			return std::string();
+
+		uint32_t options[] = { s_CacheVersion, (uint32_t)usage, srgb, flip };
+		uint32_t hash = Hash::FNV(source.data(), source.size());
+		hash = Hash::FNV(options, sizeof(options), hash);
+		return std::string(CacheDirectory) + std::filesystem::path(source).stem().string() + "_" + std::to_string(hash) + ".ktx2";
+	}
+
+	bool TextureCompressor::IsCacheValid(const std::string& source, const std::string& cachePath)
+	{
+		std::error_code error;
+		auto cacheTime = std::filesystem::last_write_time(cachePath, error);
+		if (error)
+			return false;
+		auto sourceTime = std::filesystem::last_write_time(source, error);
+		return !error && cacheTime >= sourceTime;
+	}
+
+	bool TextureCompressor::IsKTX2(const std::string& path)
+	{
+		std::string extension = std::filesystem::path(path).extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)std::tolower(c); });
+		return extension == ".ktx2";
+	}
+
+	//-------------------------------------------------------------
+	//KTX2
+	//-------------------------------------------------------------
+	static const uint8_t s_KTX2Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+#pragma pack(push, 1)
+	struct KTX2Header
+	{
+		uint32_t VkFormat;
+		uint32_t TypeSize;
+		uint32_t PixelWidth;
+		uint32_t PixelHeight;
+		uint32_t PixelDepth;
+		uint32_t LayerCount;
+		uint32_t FaceCount;
+		uint32_t LevelCount;
+		uint32_t SupercompressionScheme;
+
+		uint32_t DFDByteOffset;
+		uint32_t DFDByteLength;
+		uint32_t KVDByteOffset;
+		uint32_t KVDByteLength;
+		uint64_t SGDByteOffset;
+		uint64_t SGDByteLength;
+	};
+
+	struct KTX2LevelIndex
+	{
+		uint64_t ByteOffset;
+		uint64_t ByteLength;
+		uint64_t UncompressedByteLength;
+	};
+#pragma pack(pop)
+
+	//VkFormat values
+	enum KTX2Format : uint32_t
+	{
+		BC1_RGB_UNORM = 131, BC1_RGB_SRGB = 132, BC1_RGBA_UNORM = 133, BC1_RGBA_SRGB = 134,
+		BC3_UNORM = 137, BC3_SRGB = 138,
+		BC4_UNORM = 139,
+		BC5_UNORM = 141,
+		BC7_UNORM = 145, BC7_SRGB = 146
+	};
+
+	static uint32_t ToKTX2Format(TextureFormat format, bool srgb)
+	{
+		switch (format)
+		{
+		case TextureFormat::BC1: return srgb ? BC1_RGB_SRGB : BC1_RGB_UNORM;
+		case TextureFormat::BC3: return srgb ? BC3_SRGB : BC3_UNORM;
+		case TextureFormat::BC4: return BC4_UNORM;
+		case TextureFormat::BC5: return BC5_UNORM;
+		case TextureFormat::BC7: return srgb ? BC7_SRGB : BC7_UNORM;
+		default:
+			ENGINE_ASSERT(false, "Format is not block compressed!");
+			return 0;
+		}
+	}
+
+	static bool FromKTX2Format(uint32_t vkFormat, TextureFormat& format, bool& srgb)
+	{
+		srgb = vkFormat == BC1_RGB_SRGB || vkFormat == BC1_RGBA_SRGB || vkFormat == BC3_SRGB || vkFormat == BC7_SRGB;
+		switch (vkFormat)
+		{
+		case BC1_RGB_UNORM:
+		case BC1_RGB_SRGB:
+		case BC1_RGBA_UNORM:
+		case BC1_RGBA_SRGB:	format = TextureFormat::BC1; return true;
+		case BC3_UNORM:
+		case BC3_SRGB:		format = TextureFormat::BC3; return true;
+		case BC4_UNORM:		format = TextureFormat::BC4; return true;
+		case BC5_UNORM:		format = TextureFormat::BC5; return true;
+		case BC7_UNORM:
+		case BC7_SRGB:		format = TextureFormat::BC7; return true;
+		}
+		return false;
+	}
+
+	/// <summary>
+	/// Data format descriptor with a single basic block, required by the KTX2 specification.
+	/// </summary>
+	static std::vector<uint32_t> BuildDataFormatDescriptor(TextureFormat format, bool srgb)
+	{
+		struct Sample
+		{
+			uint32_t Channel, BitOffset, BitLength;
+		};
+		uint32_t colorModel = 0;
+		std::vector<Sample> samples;
+		switch (format)
+		{
+		case TextureFormat::BC1: colorModel = 128; samples = { { 0, 0, 64 } }; break;
+		case TextureFormat::BC3: colorModel = 130; samples = { { 15, 0, 64 }, { 0, 64, 64 } }; break;
+		case TextureFormat::BC4: colorModel = 131; samples = { { 0, 0, 64 } }; break;
+		case TextureFormat::BC5: colorModel = 132; samples = { { 0, 0, 64 }, { 1, 64, 64 } }; break;
+		case TextureFormat::BC7: colorModel = 134; samples = { { 0, 0, 128 } }; break;
+		default:
+			ENGINE_ASSERT(false, "Format is not block compressed!");
+			break;
+		}
+
+		const uint32_t primariesBT709 = 1;
+		const uint32_t transfer = srgb ? 2 : 1;
+		uint32_t blockSize = 24 + 16 * (uint32_t)samples.size();
+
+		std::vector<uint32_t> dfd;
+		dfd.push_back(4 + blockSize);
+		dfd.push_back(0);										//Khronos vendor, basic descriptor
+		dfd.push_back(2 | (blockSize << 16));					//Version 1.3
+		dfd.push_back(colorModel | (primariesBT709 << 8) | (transfer << 16));
+		dfd.push_back(3 | (3 << 8));							//4x4 texel blocks
+		dfd.push_back(Texture::GetBlockSize(format));			//Bytes of plane 0
+		dfd.push_back(0);
+		for (auto& sample : samples)
+		{
+			dfd.push_back(sample.BitOffset | ((sample.BitLength - 1) << 16) | (sample.Channel << 24));
+			dfd.push_back(0);
+			dfd.push_back(0);
+			dfd.push_back(0xFFFFFFFF);
+		}
+		return dfd;
+	}
+
+	bool TextureCompressor::ReadKTX2(const std::string& path, CompressedImage& image, uint32_t firstLevel, uint32_t lastLevel)
+	{
+		std::ifstream in(path, std::ios::in | std::ios::binary);
+		if (!in)
+			return false;
+
+		uint8_t identifier[12];
+		KTX2Header header;
+		in.read((char*)identifier, sizeof(identifier));
+		in.read((char*)&header, sizeof(header));
+		if (!in || memcmp(identifier, s_KTX2Identifier, sizeof(identifier)) != 0)
+		{
+			ENGINE_ERROR("'{0}' is not a KTX2 file", path);
+			return false;
+		}
+
+		if (!FromKTX2Format(header.VkFormat, image.Format, image.SRGB))
+		{
+			ENGINE_ERROR("KTX2 file '{0}': unsupported format {1}", path, header.VkFormat);
+			return false;
+		}
+		if (header.SupercompressionScheme != 0 || header.FaceCount != 1 || header.LayerCount > 1 || header.PixelDepth > 1)
+		{
+			ENGINE_ERROR("KTX2 file '{0}': only uncompressed 2D textures are supported", path);
+			return false;
+		}
+
+		image.Width = header.PixelWidth;
+		image.Height = header.PixelHeight;
+		image.Levels.clear();
+		image.Levels.resize(std::max(header.LevelCount, 1u));
+		lastLevel = std::min(lastLevel, (uint32_t)image.Levels.size());
+		if (firstLevel >= lastLevel)
+			return true;
+
+		std::vector<KTX2LevelIndex> levelIndex(image.Levels.size());
+		in.read((char*)levelIndex.data(), levelIndex.size() * sizeof(KTX2LevelIndex));
+		for (uint32_t i = firstLevel; i < lastLevel && in; i++)
+		{
+			uint32_t expected = Texture::CalculateImageSize(image.Format, std::max(image.Width >> i, 1u), std::max(image.Height >> i, 1u));
+			if (levelIndex[i].ByteLength != expected)
+			{
+				ENGINE_ERROR("KTX2 file '{0}': level {1} has {2} bytes, expected {3}", path, i, levelIndex[i].ByteLength, expected);
+				return false;
+			}
+
+			image.Levels[i].resize(expected);
+			in.seekg(levelIndex[i].ByteOffset);
+			in.read((char*)image.Levels[i].data(), expected);
+		}
+		if (!in)
+		{
+			ENGINE_ERROR("KTX2 file '{0}' is truncated", path);
+			return false;
+		}
+		return true;
+	}
+
+	bool TextureCompressor::WriteKTX2(const std::string& path, const CompressedImage& image)
+	{
+		uint32_t levelCount = (uint32_t)image.Levels.size();
+		uint32_t blockSize = Texture::GetBlockSize(image.Format);
+		std::vector<uint32_t> dfd = BuildDataFormatDescriptor(image.Format, image.SRGB);
+
+		KTX2Header header = {};
+		header.VkFormat = ToKTX2Format(image.Format, image.SRGB);
+		header.TypeSize = 1;
+		header.PixelWidth = image.Width;
+		header.PixelHeight = image.Height;
+		header.FaceCount = 1;
+		header.LevelCount = levelCount;
+		header.DFDByteOffset = sizeof(s_KTX2Identifier) + sizeof(KTX2Header) + levelCount * sizeof(KTX2LevelIndex);
+		header.DFDByteLength = (uint32_t)(dfd.size() * sizeof(uint32_t));
+
+		//Levels are stored smallest first, each aligned to a block
+		std::vector<KTX2LevelIndex> levelIndex(levelCount);
+		uint64_t offset = header.DFDByteOffset + header.DFDByteLength;
+		for (int32_t i = levelCount - 1; i >= 0; i--)
+		{
+			offset = (offset + blockSize - 1) / blockSize * blockSize;
+			levelIndex[i].ByteOffset = offset;
+			levelIndex[i].ByteLength = image.Levels[i].size();
+			levelIndex[i].UncompressedByteLength = image.Levels[i].size();
+			offset += image.Levels[i].size();
+		}
+
+		//Workers may import the same texture, write to a private file and move it in place
+		std::error_code error;
+		std::filesystem::path target(path);
+		if (target.has_parent_path())
+			std::filesystem::create_directories(target.parent_path(), error);
+		std::string temporary = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+		{
+			std::ofstream out(temporary, std::ios::out | std::ios::binary);
+			if (!out)
+			{
+				ENGINE_ERROR("Could not write texture '{0}'", path);
+				return false;
+			}
+
+			out.write((const char*)s_KTX2Identifier, sizeof(s_KTX2Identifier));
+			out.write((const char*)&header, sizeof(header));
+			out.write((const char*)levelIndex.data(), levelIndex.size() * sizeof(KTX2LevelIndex));
+			out.write((const char*)dfd.data(), dfd.size() * sizeof(uint32_t));
+
+			const char padding[16] = {};
+			uint64_t position = header.DFDByteOffset + header.DFDByteLength;
+			for (int32_t i = levelCount - 1; i >= 0; i--)
+			{
+				out.write(padding, levelIndex[i].ByteOffset - position);
+				out.write((const char*)image.Levels[i].data(), image.Levels[i].size());
+				position = levelIndex[i].ByteOffset + levelIndex[i].ByteLength;
+			}
+			if (!out)
+			{
+				ENGINE_ERROR("Could not write texture '{0}'", path);
+				return false;
+			}
+		}
+
+		std::filesystem::rename(temporary, path, error);
+		if (error)
+		{
+			std::filesystem::remove(temporary, error);
+			return false;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Engine/Core/Core.h"
+#include "Engine/Renderer/Texture.h"
+
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+	/// <summary>
+	/// Block compressed image with its full mip chain, level 0 first.
+	/// </summary>
+	struct CompressedImage
+	{
+		TextureFormat Format = TextureFormat::None;
+		bool SRGB = false;
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		std::vector<std::vector<uint8_t>> Levels;
+
+		uint32_t GetSize() const;
+	};
+
+	/// <summary>
+	/// Compresses images to BC1/BC4/BC5/BC7 with precomputed mips and reads/writes them as KTX2.
+	/// Textures with a TextureUsage compress their source on import and keep the result in the cache directory,
+	/// CompressFile does the same offline. Thread safe, used from the asset workers.
+	/// </summary>
+	class TextureCompressor
+	{
+	public:
+		static const char* CacheDirectory;
+
+	public:
+		static TextureFormat SelectFormat(TextureUsage usage, bool hasAlpha);
+
+		/// <summary>
+		/// Compress an RGBA8 image. Mips are box filtered, in linear space for sRGB images.
+		/// </summary>
+		static CompressedImage Compress(const uint8_t* rgba, uint32_t width, uint32_t height, TextureFormat format, bool srgb);
+		/// <summary>
+		/// Offline compression of an image file to a KTX2 file.
+		/// </summary>
+		static bool CompressFile(const std::string& source, const std::string& destination, TextureUsage usage, bool srgb, bool flip = true);
+
+		/// <summary>
+		/// KTX2 file of the compressed source image in the cache directory. Empty if the usage is not compressed.
+		/// </summary>
+		static std::string GetCachePath(const std::string& source, TextureUsage usage, bool srgb, bool flip);
+		/// <summary>
+		/// Cache file exists and is newer than the source.
+		/// </summary>
+		static bool IsCacheValid(const std::string& source, const std::string& cachePath);
+
+		static bool IsKTX2(const std::string& path);
+		/// <summary>
+		/// Read a KTX2 file without supercompression. Levels are sized to the whole chain, only levels
+		/// in [firstLevel, lastLevel) are read, an empty range reads the header only.
+		/// </summary>
+		static bool ReadKTX2(const std::string& path, CompressedImage& image, uint32_t firstLevel = 0, uint32_t lastLevel = UINT32_MAX);
+		static bool WriteKTX2(const std::string& path, const CompressedImage& image);
+	};
+}
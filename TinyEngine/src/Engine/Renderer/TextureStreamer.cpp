@@ -0,0 +1,168 @@
+#include "pch.h"
+#include "TextureStreamer.h"
+
+#include <mutex>
+#include <cfloat>
+
+namespace Engine
+{
+	struct StreamedTexture
+	{
+		Texture2D* Texture = nullptr;
+		//Finest mip requested this frame
+		float RequestedMip = FLT_MAX;
+		uint64_t LastRequestFrame = 0;
+		//Mip of the load in flight
+		uint32_t LoadingMip = 0;
+	};
+
+	static std::mutex s_Mutex;
+	static std::unordered_map<const Texture*, StreamedTexture> s_Textures;
+	static uint64_t s_Frame = 0;
+	//Every load reads its mips from disk on an asset worker, don't flood them when the camera cuts
+	static constexpr uint32_t s_MaxLoadsPerFrame = 4;
+
+	uint64_t TextureStreamer::s_Budget = 256ull * 1024 * 1024;
+	TextureStreamerStatistics TextureStreamer::s_Statistics;
+
+	void TextureStreamer::Register(Texture2D* texture)
+	{
+		std::lock_guard<std::mutex> lock(s_Mutex);
+		StreamedTexture& streamed = s_Textures[texture];
+		streamed.Texture = texture;
+		streamed.LastRequestFrame = s_Frame;
+	}
+
+	void TextureStreamer::Unregister(Texture2D* texture)
+	{
+		std::lock_guard<std::mutex> lock(s_Mutex);
+		s_Textures.erase(texture);
+	}
+
+	void TextureStreamer::Request(const Texture* texture, float mip)
+	{
+		std::lock_guard<std::mutex> lock(s_Mutex);
+		auto it = s_Textures.find(texture);
+		if (it != s_Textures.end())
+			it->second.RequestedMip = std::min(it->second.RequestedMip, mip);
+	}
+
+	void TextureStreamer::Update()
+	{
+		std::lock_guard<std::mutex> lock(s_Mutex);
+		s_Frame++;
+		s_Statistics = {};
+		s_Statistics.StreamedTextures = (uint32_t)s_Textures.size();
+
+		struct Candidate
+		{
+			StreamedTexture* Streamed;
+			uint32_t Mip;
+		};
+		std::vector<Candidate> loads;
+		std::vector<Candidate> evictions;
+
+		uint64_t residentBytes = 0;
+		for (auto& [key, streamed] : s_Textures)
+		{
+			Texture2D* texture = streamed.Texture;
+			float requestedMip = streamed.RequestedMip;
+			streamed.RequestedMip = FLT_MAX;
+			if (!texture->IsStreamed() || !texture->IsReady())
+				continue;
+
+			uint32_t residentMip = texture->GetResidentMip();
+			uint32_t initialMip = CalculateInitialMip(texture->GetWidth(), texture->GetHeight(), texture->GetMipLevelCount());
+			if (texture->IsStreaming())
+			{
+				//Count the load in flight as resident so it isn't oversubscribed
+				residentBytes += CalculateResidentSize(*texture, std::min(streamed.LoadingMip, residentMip));
+				s_Statistics.PendingLoads++;
+				continue;
+			}
+			residentBytes += CalculateResidentSize(*texture, residentMip);
+
+			//Textures that are not requested fall back to their initial mips when memory is needed
+			uint32_t wantedMip = initialMip;
+			if (requestedMip != FLT_MAX)
+			{
+				streamed.LastRequestFrame = s_Frame;
+				wantedMip = (uint32_t)std::clamp(std::floor(requestedMip), 0.0f, (float)initialMip);
+			}
+
+			if (wantedMip < residentMip)
+				loads.push_back({ &streamed, wantedMip });
+			else if (wantedMip > residentMip)
+				evictions.push_back({ &streamed, wantedMip });
+		}
+
+		//Largest missing detail first
+		std::sort(loads.begin(), loads.end(), [](const Candidate& a, const Candidate& b)
+			{
+				uint32_t gapA = a.Streamed->Texture->GetResidentMip() - a.Mip;
+				uint32_t gapB = b.Streamed->Texture->GetResidentMip() - b.Mip;
+				return gapA != gapB ? gapA > gapB : a.Mip > b.Mip;
+			});
+		//Least recently requested first
+		std::sort(evictions.begin(), evictions.end(), [](const Candidate& a, const Candidate& b)
+			{
+				return a.Streamed->LastRequestFrame < b.Streamed->LastRequestFrame;
+			});
+
+		size_t nextEviction = 0;
+		auto evictUntil = [&](uint64_t limit)
+		{
+			while (residentBytes > limit && nextEviction < evictions.size())
+			{
+				Candidate& eviction = evictions[nextEviction++];
+				Texture2D* texture = eviction.Streamed->Texture;
+				uint64_t freedBytes = CalculateResidentSize(*texture, texture->GetResidentMip()) - CalculateResidentSize(*texture, eviction.Mip);
+				texture->SetResidentMip(eviction.Mip);
+				residentBytes -= freedBytes;
+				s_Statistics.Evictions++;
+			}
+		};
+
+		evictUntil(s_Budget);
+		for (auto& load : loads)
+		{
+			if (s_Statistics.Loads == s_MaxLoadsPerFrame)
+				break;
+
+			Texture2D* texture = load.Streamed->Texture;
+			uint32_t residentMip = texture->GetResidentMip();
+			uint64_t residentSize = CalculateResidentSize(*texture, residentMip);
+			uint64_t neededBytes = CalculateResidentSize(*texture, load.Mip) - residentSize;
+			evictUntil(neededBytes < s_Budget ? s_Budget - neededBytes : 0);
+
+			//Load as much of the request as fits
+			uint32_t mip = load.Mip;
+			while (mip < residentMip && residentBytes + CalculateResidentSize(*texture, mip) - residentSize > s_Budget)
+				mip++;
+			if (mip == residentMip)
+				continue;
+
+			texture->SetResidentMip(mip);
+			load.Streamed->LoadingMip = mip;
+			residentBytes += CalculateResidentSize(*texture, mip) - residentSize;
+			s_Statistics.Loads++;
+		}
+		s_Statistics.ResidentBytes = residentBytes;
+	}
+
+	uint32_t TextureStreamer::CalculateInitialMip(uint32_t width, uint32_t height, uint32_t mipLevels)
+	{
+		uint32_t mip = 0;
+		while (mip + 1 < mipLevels && std::max(width >> mip, height >> mip) > InitialSize)
+			mip++;
+		return mip;
+	}
+
+	uint64_t TextureStreamer::CalculateResidentSize(const Texture2D& texture, uint32_t mip)
+	{
+		uint64_t size = 0;
+		for (uint32_t i = mip; i < texture.GetMipLevelCount(); i++)
+			size += Texture::CalculateImageSize(texture.GetFormat(), std::max(texture.GetWidth() >> i, 1u), std::max(texture.GetHeight() >> i, 1u));
+		return size;
+	}
+}
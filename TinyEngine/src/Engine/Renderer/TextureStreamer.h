@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Engine/Core/Core.h"
+#include "Engine/Renderer/Texture.h"
+
+namespace Engine
+{
+	struct TextureStreamerStatistics
+	{
+		uint32_t StreamedTextures = 0;
+		uint32_t PendingLoads = 0;
+		uint32_t Loads = 0;
+		uint32_t Evictions = 0;
+		uint64_t ResidentBytes = 0;
+	};
+
+	/// <summary>
+	/// Keeps the mips of streamed textures within a video memory budget. Streamed textures start with the mips up to
+	/// InitialSize, the scene renderer requests finer mips from their on-screen texel density every frame.
+	/// Requests are loaded most needed first, mips of textures that have not been requested for the longest time
+	/// are evicted to make room.
+	/// </summary>
+	class TextureStreamer
+	{
+	public:
+		//Mips up to this size are loaded with the texture and never evicted
+		static constexpr uint32_t InitialSize = 128;
+
+	public:
+		static void Register(Texture2D* texture);
+		static void Unregister(Texture2D* texture);
+
+		/// <summary>
+		/// Request mip of texture for this frame. Lower (finer) requests of the same frame win.
+		/// Textures that are not streamed are ignored.
+		/// </summary>
+		static void Request(const Texture* texture, float mip);
+		/// <summary>
+		/// Start loads and evictions for this frame's requests. Called by the renderer once per frame.
+		/// </summary>
+		static void Update();
+
+		static void SetBudget(uint64_t bytes) { s_Budget = bytes; }
+		static uint64_t GetBudget() { return s_Budget; }
+		static const TextureStreamerStatistics& GetStatistics() { return s_Statistics; }
+
+		static uint32_t CalculateInitialMip(uint32_t width, uint32_t height, uint32_t mipLevels);
+		/// <summary>
+		/// Bytes of the mips from mip down.
+		/// </summary>
+		static uint64_t CalculateResidentSize(const Texture2D& texture, uint32_t mip);
+
+	private:
+		static uint64_t s_Budget;
+		static TextureStreamerStatistics s_Statistics;
+	};
+}
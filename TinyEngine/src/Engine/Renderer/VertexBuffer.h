@@ -10,7 +10,9 @@ namespace Engine
 		Float, Float2, Float3, Float4,
 		Int, Int2, Int3, Int4,
 		Mat3, Mat4,
-		Bool
+		Bool,
+		//Packed vertex attributes, read as floats
+		Short2, Half2, Int1010102
 	};
 
 	/// <summary>
@@ -31,6 +33,9 @@ namespace Engine
 		case Engine::ShaderDataType::Mat3:		return 4 * 3 * 3;
 		case Engine::ShaderDataType::Mat4:		return 4 * 4 * 4;
 		case Engine::ShaderDataType::Bool:		return 1;
+		case Engine::ShaderDataType::Short2:	return 2 * 2;
+		case Engine::ShaderDataType::Half2:		return 2 * 2;
+		case Engine::ShaderDataType::Int1010102:return 4;
 		default:
 			ENGINE_ASSERT(false, "Unknown ShaderDataType!");
 			return 0;
@@ -75,6 +80,9 @@ namespace Engine
 			case Engine::ShaderDataType::Mat3:		return 3 * 3;
 			case Engine::ShaderDataType::Mat4:		return 4 * 4;
 			case Engine::ShaderDataType::Bool:		return 1;
+			case Engine::ShaderDataType::Short2:	return 2;
+			case Engine::ShaderDataType::Half2:		return 2;
+			case Engine::ShaderDataType::Int1010102:return 4;
 			default:
 				ENGINE_ASSERT(false, "Unknown ShaderDataType!");
 				return 0;
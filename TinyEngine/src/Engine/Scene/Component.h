@@ -2,6 +2,7 @@
 
 #include <string>
 #include <functional>
+#include <map>
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/glm.hpp>
@@ -11,6 +12,7 @@
 #include "Engine/Core/UUID.h"
 #include "Engine/Scene/SceneCamera.h"
 #include "Engine/Renderer/Mesh.h"
+#include "Engine/Renderer/Animator.h"
 
 namespace Engine
 {
@@ -59,12 +61,118 @@ namespace Engine
 		}
 	};
 
+	//Raw values of the overridden uniforms of a material, by uniform name
+	using MaterialOverrideValues = std::map<std::string, std::vector<uint8_t>>;
+
 	struct MeshComponent
 	{
+		//Shared by every entity that uses the file
 		Ref<Engine::Mesh> Mesh;
+		//Materials of this entity by mesh material index, null entries use the mesh material
+		std::vector<Ref<MaterialInstance>> MaterialOverrides;
+		//Mesh file still loading, Mesh is the placeholder until Scene::ResolvePendingMesh
+		AssetHandle PendingMesh = 0;
+		//Overrides read from the scene file while the mesh is still loading, by mesh material index
+		std::vector<MaterialOverrideValues> PendingOverrides;
+
 		MeshComponent() = default;
 		MeshComponent(const Ref<Engine::Mesh>& mesh)
 			:Mesh(mesh) {}
+		MeshComponent(const MeshComponent& other)
+			:Mesh(other.Mesh), PendingMesh(other.PendingMesh), PendingOverrides(other.PendingOverrides)
+		{
+			CopyMaterialOverrides(other);
+		}
+		MeshComponent(MeshComponent&& other) = default;
+		MeshComponent& operator=(const MeshComponent& other)
+		{
+			if (this == &other)
+				return *this;
+			Mesh = other.Mesh;
+			PendingMesh = other.PendingMesh;
+			PendingOverrides = other.PendingOverrides;
+			CopyMaterialOverrides(other);
+			return *this;
+		}
+		MeshComponent& operator=(MeshComponent&& other) = default;
+
+		Ref<MaterialInstance> GetMaterial(uint32_t index) const
+		{
+			if (index < MaterialOverrides.size() && MaterialOverrides[index])
+				return MaterialOverrides[index];
+			return Mesh->GetMaterials()[index];
+		}
+
+		/// <summary>
+		/// Give this entity its own copy of a mesh material. Remove it again by setting the entry to null.
+		/// </summary>
+		Ref<MaterialInstance> OverrideMaterial(uint32_t index)
+		{
+			if (MaterialOverrides.size() <= index)
+				MaterialOverrides.resize((size_t)index + 1);
+			if (!MaterialOverrides[index])
+			{
+				const auto& material = Mesh->GetMaterials()[index];
+				MaterialOverrides[index] = MaterialInstance::Copy(material, material->GetName());
+			}
+			return MaterialOverrides[index];
+		}
+
+		/// <summary>
+		/// Override the given values of the mesh materials, by mesh material index.
+		/// </summary>
+		void ApplyOverrideValues(const std::vector<MaterialOverrideValues>& overrides)
+		{
+			uint32_t count = std::min((uint32_t)overrides.size(), (uint32_t)Mesh->GetMaterials().size());
+			for (uint32_t i = 0; i < count; i++)
+			{
+				if (overrides[i].empty())
+					continue;
+				auto material = OverrideMaterial(i);
+				for (const auto& [name, data] : overrides[i])
+					material->SetData(name, data.data(), (uint32_t)data.size());
+			}
+		}
+
+	private:
+		//Overrides belong to one entity, a copied component gets its own instances
+		void CopyMaterialOverrides(const MeshComponent& other)
+		{
+			MaterialOverrides.clear();
+			MaterialOverrides.reserve(other.MaterialOverrides.size());
+			for (const auto& material : other.MaterialOverrides)
+				MaterialOverrides.push_back(material ? MaterialInstance::Copy(material, material->GetName()) : nullptr);
+		}
+	};
+
+	/// <summary>
+	/// Plays a clip of the animated mesh in the MeshComponent of the same entity.
+	/// </summary>
+	struct AnimationComponent
+	{
+		//Name of a clip of the mesh, empty for the bind pose
+		std::string Clip;
+		float Speed = 1.0f;
+		bool Loop = true;
+		bool Playing = true;
+
+		//Created by the scene for the mesh, never shared between entities
+		Ref<Engine::Animator> Animator;
+
+		AnimationComponent() = default;
+		AnimationComponent(const AnimationComponent& other)
+			:Clip(other.Clip), Speed(other.Speed), Loop(other.Loop), Playing(other.Playing) {}
+		AnimationComponent(AnimationComponent&& other) = default;
+		AnimationComponent& operator=(const AnimationComponent& other)
+		{
+			Clip = other.Clip;
+			Speed = other.Speed;
+			Loop = other.Loop;
+			Playing = other.Playing;
+			Animator = nullptr;
+			return *this;
+		}
+		AnimationComponent& operator=(AnimationComponent&& other) = default;
 	};
 
 	struct SpriteRendererComponent
@@ -121,18 +229,12 @@ namespace Engine
 		glm::vec3 Offset = { 0.0f, 0.0f, 0.0f };
 
 		bool IsTrigger = false;
-
-		//Collision bounds
-		Ref<Mesh> DebugMesh;
 	};
 
 	struct SphereColliderComponent
 	{
 		float Radius = 0.5f;
 		bool IsTrigger = false;
-
-		//Collision bounds
-		Ref<Mesh> DebugMesh;
 	};
 
 	struct CapsuleColliderComponent
@@ -140,9 +242,6 @@ namespace Engine
 		float Radius = 0.5f;
 		float Height = 1.0f;
 		bool IsTrigger = false;
-
-		//Collision bounds
-		Ref<Mesh> DebugMesh;
 	};
 
 	struct MeshColliderComponent
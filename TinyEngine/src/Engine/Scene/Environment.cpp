@@ -9,13 +9,37 @@ namespace Engine
 {
 	Environment Environment::Create(const std::string& filepath)
 	{
+		return Create(filepath, AssetManager::CreateNewAsset<TextureCube>(filepath));
+	}
+
+	Environment Environment::Create(const Ref<Texture2D>& equirectTexture)
+	{
+		return Create(equirectTexture->GetPath(), AssetManager::CreateMemoryAsset<TextureCube>(equirectTexture));
+	}
+
+	void Environment::LoadAsync(const std::string& filepath, const std::function<void(const Environment&)>& onLoaded)
+	{
+		TextureSpecification spec;
+		spec.Flip = TextureFlip::None;
+		AssetHandle handle = AssetManager::LoadTextureAsync(filepath, false, spec);
+		AssetManager::OnLoaded(handle, [filepath, onLoaded](const Ref<Asset>& asset)
+			{
+				auto equirectTexture = std::dynamic_pointer_cast<Texture2D>(asset);
+				if (!equirectTexture || equirectTexture->GetFormat() != TextureFormat::RGBA16F)
+				{
+					ENGINE_ERROR("Could not load environment '{0}'", filepath);
+					return;
+				}
+				onLoaded(Create(equirectTexture));
+			});
+	}
 
+	Environment Environment::Create(const std::string& filepath, const Ref<TextureCube>& envUnfiltered)
+	{
 		//Create skybox map and irradiance map from HDR image by using compute shader
 		const uint32_t cubemapSize = 2048;
 		const uint32_t irradianceMapSize = 32;
 
-		Ref<TextureCube> envUnfiltered = AssetManager::CreateNewAsset<TextureCube>(filepath);
-
 		//Prefliter
 		Ref<TextureCube> envFiltered = AssetManager::CreateMemoryAsset<TextureCube>(TextureFormat::RGBA16F, cubemapSize, cubemapSize);
 		auto envFilteringShader = Renderer::GetShaderLibrary().Get("EnvironmentMipFilter");
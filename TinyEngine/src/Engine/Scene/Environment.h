@@ -2,6 +2,8 @@
 
 #include "Engine/Renderer/Texture.h"
 
+#include <functional>
+
 namespace Engine
 {
 	/// <summary>
@@ -15,5 +17,17 @@ namespace Engine
 		Ref<TextureCube> PrefliteredMap;	//IBL Specular
 
 		static Environment Create(const std::string& filepath);
+		/// <summary>
+		/// Environment of an uploaded equirectangular HDR image.
+		/// </summary>
+		static Environment Create(const Ref<Texture2D>& equirectTexture);
+		/// <summary>
+		/// Decode the HDR image on the asset workers and call onLoaded on the main thread once the environment is created.
+		/// Not called if the image can't be loaded.
+		/// </summary>
+		static void LoadAsync(const std::string& filepath, const std::function<void(const Environment&)>& onLoaded);
+
+	private:
+		static Environment Create(const std::string& filepath, const Ref<TextureCube>& envUnfiltered);
 	};
 }
\ No newline at end of file
@@ -26,7 +26,29 @@ namespace Engine
 		return {};
 	}
 
-	static void OnScriptComponentConstruct(entt::registry& registry, entt::entity entity)
+	void Scene::ResolvePendingMesh(AssetHandle handle, const Ref<Mesh>& mesh)
+	{
+		for (auto& [sceneID, scene] : s_ActiveScenes)
+		{
+			auto view = scene->m_Registry.view<MeshComponent>();
+			for (auto entity : view)
+			{
+				auto& meshComponent = view.get<MeshComponent>(entity);
+				if (meshComponent.PendingMesh != handle)
+					continue;
+
+				//Failed loads keep the placeholder and the handle, so the path is still saved
+				if (!mesh)
+					continue;
+				meshComponent.Mesh = mesh;
+				meshComponent.PendingMesh = 0;
+				meshComponent.ApplyOverrideValues(meshComponent.PendingOverrides);
+				meshComponent.PendingOverrides.clear();
+			}
+		}
+	}
+
+	void OnScriptComponentConstruct(entt::registry& registry, entt::entity entity)
 	{
 		auto sceneView = registry.view<SceneComponent>();
 		UUID sceneID = registry.get<SceneComponent>(sceneView.front()).SceneID;
@@ -38,7 +60,7 @@ namespace Engine
 		ScriptEngine::InitScriptEntity(scene->m_EntityIDMap.at(entityID));
 	}
 
-	static void OnScriptComponentDestroy(entt::registry& registry, entt::entity entity)
+	void OnScriptComponentDestroy(entt::registry& registry, entt::entity entity)
 	{
 		auto sceneView = registry.view<SceneComponent>();
 		UUID sceneID = registry.get<SceneComponent>(sceneView.front()).SceneID;
@@ -81,7 +103,7 @@ namespace Engine
 	void Scene::Init()
 	{
 		//Skybox material
-		auto& skyboxShader = Renderer::GetShaderLibrary().Get("Skybox");
+		auto skyboxShader = Renderer::GetShaderLibrary().Get("Skybox");
 		m_SkyboxMaterial = MaterialInstance::Create(Material::Create(skyboxShader), "Skybox");
 		m_SkyboxMaterial->SetFlag(MaterialFlag::DepthTest, false);
 	}
@@ -145,6 +167,37 @@ namespace Engine
 		
 		// Update physics
 		Physics::Simulate(ts);
+
+		UpdateAnimation(ts);
+	}
+
+	void Scene::UpdateAnimation(Timestep ts)
+	{
+		auto view = m_Registry.view<AnimationComponent, MeshComponent>();
+		for (auto entity : view)
+		{
+			auto [animationComponent, meshComponent] = view.get<AnimationComponent, MeshComponent>(entity);
+			const Ref<Mesh>& mesh = meshComponent.Mesh;
+			if (!mesh || !mesh->IsAnimated())
+			{
+				animationComponent.Animator = nullptr;
+				continue;
+			}
+
+			if (!animationComponent.Animator || animationComponent.Animator->GetMesh() != mesh)
+				animationComponent.Animator = Animator::Create(mesh);
+
+			auto& animator = animationComponent.Animator;
+			auto clip = animationComponent.Clip.empty() ? nullptr : mesh->FindAnimation(animationComponent.Clip);
+			if (clip != animator->GetClip())
+			{
+				if (clip)
+					animator->Play(clip);
+				else
+					animator->Stop();
+			}
+			animator->Update(animationComponent.Playing ? ts * animationComponent.Speed : 0.0f, animationComponent.Loop);
+		}
 	}
 
 	void Scene::OnRenderRuntime(Timestep ts)
@@ -163,7 +216,7 @@ namespace Engine
 
 		//Process directional lights
 		m_LightEnvironment = LightEnvironment();
-		auto& lights = m_Registry.group<DirectionalLightComponent>(entt::get<TransformComponent>);
+		auto lights = m_Registry.group<DirectionalLightComponent>(entt::get<TransformComponent>);
 		uint32_t directionalLightIndex = 0;
 		for (auto entity : lights)
 		{
@@ -188,10 +241,13 @@ namespace Engine
 		auto group = m_Registry.group<MeshComponent>(entt::get<TransformComponent>);
 		for (auto entity : group)
 		{
-			auto& [meshComponent, transformComponent] = group.get<MeshComponent, TransformComponent>(entity);
+			auto [meshComponent, transformComponent] = group.get<MeshComponent, TransformComponent>(entity);
 			if (meshComponent.Mesh)
 			{
-				SceneRenderer::SubmitMesh(meshComponent.Mesh, transformComponent.GetTransform());
+				Ref<Animator> animator = m_Registry.has<AnimationComponent>(entity) ? m_Registry.get<AnimationComponent>(entity).Animator : nullptr;
+				if (animator && animator->GetMesh() != meshComponent.Mesh)
+					animator = nullptr;
+				SceneRenderer::SubmitMesh(meshComponent.Mesh, transformComponent.GetTransform(), meshComponent.MaterialOverrides, animator);
 			}
 		}
 		SceneRenderer::EndScene();
@@ -201,7 +257,7 @@ namespace Engine
 	{
 		//Process directional lights
 		m_LightEnvironment = LightEnvironment();
-		auto& lights = m_Registry.group<DirectionalLightComponent>(entt::get<TransformComponent>);
+		auto lights = m_Registry.group<DirectionalLightComponent>(entt::get<TransformComponent>);
 		uint32_t directionalLightIndex = 0;
 		for (auto entity : lights)
 		{
@@ -223,6 +279,9 @@ namespace Engine
 			};
 		}
 
+		//Animations play in the editor as well, as a preview
+		UpdateAnimation(ts);
+
 		SceneRenderer::BeginScene(this, {editorCamera, viewMatrix});	
 		//---------------------------------------------------
 		//Render mesh
@@ -230,10 +289,13 @@ namespace Engine
 		auto group = m_Registry.group<MeshComponent>(entt::get<TransformComponent>);
 		for (auto entity : group)
 		{
-			auto& [meshComponent, transformComponent] = group.get<MeshComponent, TransformComponent>(entity);
+			auto [meshComponent, transformComponent] = group.get<MeshComponent, TransformComponent>(entity);
 			if (meshComponent.Mesh)
 			{
-				SceneRenderer::SubmitMesh(meshComponent.Mesh, transformComponent.GetTransform());
+				Ref<Animator> animator = m_Registry.has<AnimationComponent>(entity) ? m_Registry.get<AnimationComponent>(entity).Animator : nullptr;
+				if (animator && animator->GetMesh() != meshComponent.Mesh)
+					animator = nullptr;
+				SceneRenderer::SubmitMesh(meshComponent.Mesh, transformComponent.GetTransform(), meshComponent.MaterialOverrides, animator);
 			}
 		}	
 		//---------------------------------------------------
@@ -381,6 +443,7 @@ namespace Engine
 		CopyComponent<TagComponent>(target->m_Registry, m_Registry, enttMap);
 		CopyComponent<TransformComponent>(target->m_Registry, m_Registry, enttMap);
 		CopyComponent<MeshComponent>(target->m_Registry, m_Registry, enttMap);
+		CopyComponent<AnimationComponent>(target->m_Registry, m_Registry, enttMap);
 		CopyComponent<DirectionalLightComponent>(target->m_Registry, m_Registry, enttMap);
 		CopyComponent<CameraComponent>(target->m_Registry, m_Registry, enttMap);
 		CopyComponent<RigidBodyComponent>(target->m_Registry, m_Registry, enttMap);
@@ -417,6 +480,7 @@ namespace Engine
 
 		CopyComponentIfExists<TransformComponent>(newEntity.m_EntityHandle, entity.m_EntityHandle, m_Registry);
 		CopyComponentIfExists<MeshComponent>(newEntity.m_EntityHandle, entity.m_EntityHandle, m_Registry);
+		CopyComponentIfExists<AnimationComponent>(newEntity.m_EntityHandle, entity.m_EntityHandle, m_Registry);
 		CopyComponentIfExists<DirectionalLightComponent>(newEntity.m_EntityHandle, entity.m_EntityHandle, m_Registry);
 		CopyComponentIfExists<ScriptComponent>(newEntity.m_EntityHandle, entity.m_EntityHandle, m_Registry);
 		CopyComponentIfExists<CameraComponent>(newEntity.m_EntityHandle, entity.m_EntityHandle, m_Registry);
@@ -15,6 +15,7 @@
 namespace Engine
 {
 	class Entity;
+	class Mesh;
 	using EntityMap = std::unordered_map<UUID, Entity>;
 
 	struct SceneComponent
@@ -34,6 +35,10 @@ namespace Engine
 
 	public:
 		static Scene* GetScene(UUID uuid);
+		/// <summary>
+		/// Put a mesh that finished loading into the components of every active scene that wait for it.
+		/// </summary>
+		static void ResolvePendingMesh(AssetHandle handle, const Ref<Mesh>& mesh);
 
 	public:
 		Scene(const std::string& name = "Untitled Scene", bool isEditorScene = false);
@@ -81,7 +86,7 @@ namespace Engine
 		Entity GetMainCameraEntity();
 
 		const Environment& GetEnvironment() const { return m_Environment; }
-		void SetEnvironment(Environment& environment) { m_Environment = environment; }
+		void SetEnvironment(const Environment& environment) { m_Environment = environment; }
 		void SetSkybox(const Ref<TextureCube>& skybox);
 
 		void CopeTo(Ref<Scene>& target);
@@ -91,6 +96,11 @@ namespace Engine
 	private:
 		template<typename T>
 		void OnComponentAdded(Entity entity, T& component);
+
+		/// <summary>
+		/// Advance the animators of animated meshes, creating them when the mesh changes.
+		/// </summary>
+		void UpdateAnimation(Timestep ts);
 	
 	private:
 		static std::unordered_map<UUID, Scene*> s_ActiveScenes;
@@ -3,7 +3,8 @@
 
 #include "Engine/Scene/Entity.h"
 #include "Engine/Scene/Component.h"
-#include "Engine/Renderer/MeshFactory.h"
+#include "Engine/Asset/AssetManager.h"
+#include "Engine/Core/Timer.h"
 #include "Engine/Physics/Physics.h"
 #include "Engine/Physics/PhysicsLayer.h"
 #include "Engine/Physics/PXPhysicsWrappers.h"
@@ -13,6 +14,10 @@
 #include <glm/gtx/matrix_decompose.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <mutex>
+#include <condition_variable>
+#include <unordered_set>
+
 #include "yaml-cpp/yaml.h"
 
 namespace YAML
@@ -189,10 +194,57 @@ namespace Engine
 
 			out << YAML::Key << "MeshComponent";
 			out << YAML::BeginMap; //MeshComponent
-			auto mesh = entity.GetComponent<MeshComponent>().Mesh;
-			out << YAML::Key << "AssetPath" << YAML::Value << mesh->GetFilePath();
+			auto& meshComponent = entity.GetComponent<MeshComponent>();
+			std::string meshPath = meshComponent.Mesh->GetFilePath();
+			//Still loading, the component holds the placeholder
+			if (const AssetMetadata* metadata = AssetManager::GetRegistry().Find(meshComponent.PendingMesh))
+				meshPath = metadata->FilePath;
+			out << YAML::Key << "AssetPath" << YAML::Value << meshPath;
+
+			//Overrides of a mesh that is still loading are the values read from the scene file
+			std::vector<MaterialOverrideValues> overrides = meshComponent.PendingOverrides;
+			for (uint32_t i = 0; i < meshComponent.MaterialOverrides.size(); i++)
+			{
+				if (!meshComponent.MaterialOverrides[i])
+					continue;
+				if (overrides.size() <= i)
+					overrides.resize((size_t)i + 1);
+				meshComponent.MaterialOverrides[i]->ForEachOverriddenValue([&](const std::string& name, const uint8_t* data, uint32_t size)
+					{
+						overrides[i][name].assign(data, data + size);
+					});
+			}
+			if (!overrides.empty())
+			{
+				out << YAML::Key << "MaterialOverrides" << YAML::Value << YAML::BeginSeq; //MaterialOverrides seq
+				for (uint32_t i = 0; i < overrides.size(); i++)
+				{
+					if (overrides[i].empty())
+						continue;
+					out << YAML::BeginMap;
+					out << YAML::Key << "Index" << YAML::Value << i;
+					out << YAML::Key << "Values" << YAML::Value << YAML::BeginMap;
+					//Raw bytes, the serializer does not know the uniform types
+					for (const auto& [name, data] : overrides[i])
+						out << YAML::Key << name << YAML::Value << YAML::Binary(data.data(), data.size());
+					out << YAML::EndMap;
+					out << YAML::EndMap;
+				}
+				out << YAML::EndSeq; //MaterialOverrides seq
+			}
 			out << YAML::EndMap; //MeshComponent
 		}
+		if (entity.HasComponent<AnimationComponent>())
+		{
+			out << YAML::Key << "AnimationComponent";
+			out << YAML::BeginMap; //AnimationComponent
+			auto& animationComponent = entity.GetComponent<AnimationComponent>();
+			out << YAML::Key << "Clip" << YAML::Value << animationComponent.Clip;
+			out << YAML::Key << "Speed" << YAML::Value << animationComponent.Speed;
+			out << YAML::Key << "Loop" << YAML::Value << animationComponent.Loop;
+			out << YAML::Key << "Playing" << YAML::Value << animationComponent.Playing;
+			out << YAML::EndMap; //AnimationComponent
+		}
 		if (entity.HasComponent<CameraComponent>())
 		{
 			out << YAML::Key << "CameraComponent";
@@ -379,7 +431,9 @@ namespace Engine
 		out << YAML::Value;
 		out << YAML::BeginMap; // Skybox		
 		out << YAML::Key << "AssetPath";
-		auto skyboxPath = scene->GetEnvironment().SkyboxMap->GetPath();
+		//The maps are empty while the image loads
+		auto& environment = scene->GetEnvironment();
+		auto skyboxPath = environment.SkyboxMap ? environment.SkyboxMap->GetPath() : environment.Path;
 		out << YAML::Value << skyboxPath;
 		out << YAML::EndMap; // Skybox		
 
@@ -444,6 +498,98 @@ namespace Engine
 		fout << out.c_str();
 	}
 
+	/// <summary>
+	/// Load every mesh file the colliders of the entities need, once per file, and share them through AssetManager. The imports
+	/// run on the asset worker pool, the main thread creates the GPU resources of each mesh as soon as its import is done.
+	/// Meshes that are only drawn load asynchronously, see Deserialize. Files that fail to import are left out.
+	/// </summary>
+	static std::unordered_map<std::string, Ref<Mesh>> LoadMeshes(const YAML::Node& entities)
+	{
+		std::vector<std::string> paths;
+		std::unordered_map<std::string, Ref<Mesh>> meshes;
+		//Collision meshes keep their positions for cooking
+		std::unordered_map<std::string, MeshRetention> retentions;
+		auto addPath = [&](const std::string& path, MeshRetention retention)
+		{
+			MeshRetention& pathRetention = retentions[path];
+			pathRetention = std::max(pathRetention, retention);
+
+			auto [it, inserted] = meshes.try_emplace(path);
+			if (!inserted)
+				return;
+			it->second = AssetManager::FindMesh(path);
+			if (!it->second)
+				paths.push_back(path);
+		};
+		for (auto entity : entities)
+		{
+			auto meshColliderComponent = entity["MeshColliderComponent"];
+			bool overrideMesh = meshColliderComponent && meshColliderComponent["OverrideMesh"] && meshColliderComponent["OverrideMesh"].as<bool>();
+			MeshRetention collisionRetention = std::max(Mesh::GetDefaultRetention(), MeshRetention::KeepPositionsForQueries);
+
+			//Cooked while deserializing, so they can't wait
+			auto meshComponent = entity["MeshComponent"];
+			if (meshComponent && meshColliderComponent && !overrideMesh)
+				addPath(meshComponent["AssetPath"].as<std::string>(), collisionRetention);
+
+			if (overrideMesh)
+				addPath(meshColliderComponent["AssetPath"].as<std::string>(), collisionRetention);
+		}
+		if (paths.empty())
+			return meshes;
+
+		Timer timer;
+		size_t loadedAlready = meshes.size() - paths.size();
+		uint32_t failed = 0;
+		std::vector<Ref<Mesh>> loaded(paths.size());
+		std::vector<uint32_t> completed;
+		std::mutex mutex;
+		std::condition_variable condition;
+
+		ThreadPool& pool = AssetManager::GetWorkerPool();
+		for (uint32_t i = 0; i < (uint32_t)paths.size(); i++)
+		{
+			pool.Enqueue([&, i]()
+				{
+					Ref<Mesh> mesh = Mesh::LoadGeometry(paths[i], retentions.at(paths[i]));
+					std::lock_guard<std::mutex> lock(mutex);
+					loaded[i] = mesh;
+					completed.push_back(i);
+					condition.notify_one();
+				});
+		}
+
+		//Renderer work stays on this thread, overlapped with the imports still running
+		for (size_t finished = 0; finished < paths.size();)
+		{
+			std::vector<uint32_t> ready;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				condition.wait(lock, [&]() { return !completed.empty(); });
+				ready.swap(completed);
+			}
+
+			for (uint32_t i : ready)
+			{
+				loaded[i]->FinishLoading();
+				AssetManager::AddMesh(paths[i], loaded[i]);
+				//No buffers to draw and no positions to cook, the entities fall back to the placeholder
+				if (loaded[i]->GetSubmeshes().empty())
+				{
+					meshes.erase(paths[i]);
+					failed++;
+					continue;
+				}
+				meshes[paths[i]] = loaded[i];
+			}
+			finished += ready.size();
+		}
+
+		ENGINE_INFO("Loaded {0} mesh files on {1} worker threads in {2:.1f} ms, {3} were loaded already, {4} failed",
+			paths.size() - failed, pool.GetThreadCount(), timer.ElapsedMillis(), loadedAlready, failed);
+		return meshes;
+	}
+
 	bool SceneSerializer::Deserialize(const std::string& filepath)
 	{
 		std::ifstream stream(filepath);
@@ -464,15 +610,29 @@ namespace Engine
 		{
 			auto skybox = environment["Skybox"];	
 			auto envAssetPath = skybox["AssetPath"].as<std::string>();
-			auto environment = Environment::Create(envAssetPath);
+			//The maps stay empty until the image is decoded, the path is kept for saving
+			Environment pendingEnvironment;
+			pendingEnvironment.Path = envAssetPath;
+			m_Scene->SetEnvironment(pendingEnvironment);
 
-			m_Scene->SetEnvironment(environment);
+			UUID sceneID = m_Scene->GetUUID();
+			Environment::LoadAsync(envAssetPath, [sceneID, envAssetPath](const Environment& environment)
+				{
+					//The scene may be closed, or have another environment by now
+					Scene* scene = Scene::GetScene(sceneID);
+					if (scene && !scene->GetEnvironment().SkyboxMap && scene->GetEnvironment().Path == envAssetPath)
+						scene->SetEnvironment(environment);
+				});
 		}
 
 		//Deserialize entities
 		auto entities = data["Entities"];
 		if (entities)
 		{
+			std::unordered_map<std::string, Ref<Mesh>> meshes = LoadMeshes(entities);
+			//Asynchronous meshes with a callback already
+			std::unordered_set<uint64_t> pendingMeshes;
+
 			for (auto entity : entities)
 			{
 				uint64_t uuid = entity["Entity"].as<uint64_t>();
@@ -499,11 +659,68 @@ namespace Engine
 				{
 					std::string meshPath = meshComponent["AssetPath"].as<std::string>();
 					if (!deserializedEntity.HasComponent<MeshComponent>())
-						deserializedEntity.AddComponent<MeshComponent>(CreateRef<Mesh>(meshPath));
+					{
+						auto& component = deserializedEntity.AddComponent<MeshComponent>();
+						auto it = meshes.find(meshPath);
+						if (it != meshes.end())
+						{
+							component.Mesh = it->second;
+						}
+						else
+						{
+							AssetHandle handle = AssetManager::LoadAsync<Mesh>(meshPath);
+							//Drawn as the placeholder until the import is done
+							component.Mesh = AssetManager::GetAssetOrPlaceholder<Mesh>(handle);
+							if (AssetManager::GetLoadState(handle) != AssetLoadState::Loaded)
+							{
+								component.PendingMesh = handle;
+								if (pendingMeshes.insert(handle).second)
+								{
+									AssetManager::OnLoaded(handle, [handle](const Ref<Asset>& asset)
+										{
+											Scene::ResolvePendingMesh(handle, std::dynamic_pointer_cast<Mesh>(asset));
+										});
+								}
+							}
+						}
+
+						if (auto materialOverrides = meshComponent["MaterialOverrides"])
+						{
+							std::vector<MaterialOverrideValues> overrides;
+							for (auto materialOverride : materialOverrides)
+							{
+								uint32_t index = materialOverride["Index"].as<uint32_t>();
+								if (overrides.size() <= index)
+									overrides.resize((size_t)index + 1);
+								for (auto value : materialOverride["Values"])
+								{
+									YAML::Binary data = value.second.as<YAML::Binary>();
+									overrides[index][value.first.as<std::string>()].assign(data.data(), data.data() + data.size());
+								}
+							}
+							//Applied when the mesh is loaded, the placeholder does not have the mesh materials
+							if (component.PendingMesh)
+								component.PendingOverrides = std::move(overrides);
+							else
+								component.ApplyOverrideValues(overrides);
+						}
+					}
 				
 					SERIALIZER_INFO("	MeshComponent");
 				}
 
+				auto animationComponent = entity["AnimationComponent"];
+				if (animationComponent)
+				{
+					auto& component = deserializedEntity.AddComponent<AnimationComponent>();
+					component.Clip = animationComponent["Clip"].as<std::string>();
+					component.Speed = animationComponent["Speed"] ? animationComponent["Speed"].as<float>() : 1.0f;
+					component.Loop = animationComponent["Loop"] ? animationComponent["Loop"].as<bool>() : true;
+					component.Playing = animationComponent["Playing"] ? animationComponent["Playing"].as<bool>() : true;
+
+					SERIALIZER_INFO("	AnimationComponent");
+				}
+
 				auto cameraComponent = entity["CameraComponent"];
 				if (cameraComponent)
 				{
@@ -595,7 +812,6 @@ namespace Engine
 					component.Offset = boxColliderComponent["Offset"].as<glm::vec3>();
 					component.Size = boxColliderComponent["Size"].as<glm::vec3>();
 					component.IsTrigger = boxColliderComponent["IsTrigger"] ? boxColliderComponent["IsTrigger"].as<bool>() : false;
-					component.DebugMesh = MeshFactory::CreateBox(component.Size);
 
 					SERIALIZER_INFO("	BoxColliderComponent");
 				}
@@ -606,7 +822,6 @@ namespace Engine
 					auto& component = deserializedEntity.AddComponent<SphereColliderComponent>();
 					component.Radius = sphereColliderComponent["Radius"].as<float>();
 					component.IsTrigger = sphereColliderComponent["IsTrigger"] ? sphereColliderComponent["IsTrigger"].as<bool>() : false;
-					component.DebugMesh = MeshFactory::CreateSphere(component.Radius);
 					
 					SERIALIZER_INFO("	SphereColliderComponent");
 				}
@@ -618,7 +833,6 @@ namespace Engine
 					component.Radius = capsuleColliderComponent["Radius"].as<float>();
 					component.Height = capsuleColliderComponent["Height"].as<float>();
 					component.IsTrigger = capsuleColliderComponent["IsTrigger"] ? capsuleColliderComponent["IsTrigger"].as<bool>() : false;
-					component.DebugMesh = MeshFactory::CreateCapsule(component.Radius, component.Height);
 
 					SERIALIZER_INFO("	CapsuleColliderComponent");
 				}
@@ -626,13 +840,17 @@ namespace Engine
 				auto meshColliderComponent = entity["MeshColliderComponent"];
 				if (meshColliderComponent)
 				{
-					Ref<Mesh> collisionMesh = deserializedEntity.HasComponent<MeshComponent>() ? deserializedEntity.GetComponent<MeshComponent>().Mesh : nullptr;
+					Ref<Mesh> collisionMesh = nullptr;
+					//A pending mesh failed in LoadMeshes, its placeholder is not the collision shape
+					if (deserializedEntity.HasComponent<MeshComponent>() && !deserializedEntity.GetComponent<MeshComponent>().PendingMesh)
+						collisionMesh = deserializedEntity.GetComponent<MeshComponent>().Mesh;
 					bool overrideMesh = meshColliderComponent["OverrideMesh"] ? meshColliderComponent["OverrideMesh"].as<bool>() : false;
 
 					if (overrideMesh)
 					{
 						std::string meshPath = meshColliderComponent["AssetPath"].as<std::string>();
-						collisionMesh = CreateRef<Mesh>(meshPath);
+						auto it = meshes.find(meshPath);
+						collisionMesh = it != meshes.end() ? it->second : nullptr;
 					}
 
 					if (collisionMesh)
@@ -5,8 +5,6 @@
 #include <chrono>
 #include <thread>
 
-#include <winioctl.h>
-
 #include <mono/jit/jit.h>
 #include <mono/metadata/assembly.h>
 #include <mono/metadata/debug-helpers.h>
@@ -130,44 +128,26 @@ namespace Engine
 			return NULL;
 		}
 
-		HANDLE file = CreateFileA(filepath, FILE_READ_ACCESS, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
-		if (file == INVALID_HANDLE_VALUE)
-		{
-			return NULL;
-		}
-
-		DWORD file_size = GetFileSize(file, NULL);
-		if (file_size == INVALID_FILE_SIZE)
-		{
-			CloseHandle(file);
-			return NULL;
-		}
-
-		void* file_data = malloc(file_size);
-		if (file_data == NULL)
+		std::ifstream stream(filepath, std::ios::binary | std::ios::ate);
+		if (!stream)
 		{
-			CloseHandle(file);
 			return NULL;
 		}
 
-		DWORD read = 0;
-		ReadFile(file, file_data, file_size, &read, NULL);
-		if (file_size != read)
+		std::vector<char> fileData((size_t)stream.tellg());
+		stream.seekg(0, std::ios::beg);
+		if (!stream.read(fileData.data(), fileData.size()))
 		{
-			free(file_data);
-			CloseHandle(file);
 			return NULL;
 		}
 
 		MonoImageOpenStatus status;
-		MonoImage* image = mono_image_open_from_data_full(reinterpret_cast<char*>(file_data), file_size, 1, &status, 0);
+		MonoImage* image = mono_image_open_from_data_full(fileData.data(), (uint32_t)fileData.size(), 1, &status, 0);
 		if (status != MONO_IMAGE_OK)
 		{
 			return NULL;
 		}
 		auto assemb = mono_assembly_load_from_full(image, filepath, &status, 0);
-		free(file_data);
-		CloseHandle(file);
 		mono_image_close(image);
 		return assemb;
 	}
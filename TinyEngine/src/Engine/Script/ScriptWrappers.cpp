@@ -3,6 +3,7 @@
 
 #include "Engine/Scene/Scene.h"
 #include "Engine/Scene/Entity.h"
+#include "Engine/Asset/AssetManager.h"
 #include "Engine/Physics/PhysicsUtil.h"
 #include "Engine/Physics/PhysicsActor.h"
 #include "Engine/Physics/PXPhysicsWrappers.h"
@@ -29,28 +30,28 @@ namespace Script
 	//-------------------------------------------------------------------------------------
 	// Input
 	//-------------------------------------------------------------------------------------
-	bool Engine::Script::Engine_Input_IsKeyPressed(int key)
+	bool Engine_Input_IsKeyPressed(int key)
 	{
 		return Input::IsKeyPressed(key);
 	}
 
-	bool Engine::Script::Engine_Input_IsMouseButtonPressed(int button)
+	bool Engine_Input_IsMouseButtonPressed(int button)
 	{
 		return Input::IsMouseButtonPressed(button);
 	}
 
-	void Engine::Script::Engine_Input_GetMousePosition(glm::vec2* outPosition)
+	void Engine_Input_GetMousePosition(glm::vec2* outPosition)
 	{
 		auto [x, y] = Input::GetMousePosition();
 		*outPosition = { x, y };
 	}
 
-	void Engine::Script::Engine_Input_SetCursorMode(CursorMode mode)
+	void Engine_Input_SetCursorMode(CursorMode mode)
 	{
 		Input::SetCursorMode(mode);
 	}
 
-	CursorMode Engine::Script::Engine_Input_GetCursorMode()
+	CursorMode Engine_Input_GetCursorMode()
 	{
 		return Input::GetCursorMode();
 	}
@@ -58,7 +59,7 @@ namespace Script
 	//-------------------------------------------------------------------------------------
 	// Physics
 	//-------------------------------------------------------------------------------------
-	bool Engine::Script::Engine_Physics_Raycast(glm::vec3* origin, glm::vec3* direction, float maxDistance, RaycastHit* hit)
+	bool Engine_Physics_Raycast(glm::vec3* origin, glm::vec3* direction, float maxDistance, RaycastHit* hit)
 	{
 		return PXPhysicsWrappers::Raycast(*origin, *direction, maxDistance, hit);
 	}
@@ -70,13 +71,14 @@ namespace Script
 		for (uint32_t i = 0; i < count; i++)
 		{
 			Entity& entity = *(Entity*)hits[i].actor->userData;
+			UUID entityID = entity.ID();
 
 			if (entity.HasComponent<BoxColliderComponent>() && arrayIndex < arrayLength)
 			{
 				auto& boxCollider = entity.GetComponent<BoxColliderComponent>();
 
 				void* data[] = {
-					&entity.ID(),
+					&entityID,
 					&boxCollider.IsTrigger,
 					&boxCollider.Size,
 					&boxCollider.Offset
@@ -91,7 +93,7 @@ namespace Script
 				auto& sphereCollider = entity.GetComponent<SphereColliderComponent>();
 
 				void* data[] = {
-					&entity.ID(),
+					&entityID,
 					&sphereCollider.IsTrigger,
 					&sphereCollider.Radius
 				};
@@ -105,7 +107,7 @@ namespace Script
 				auto& capsuleCollider = entity.GetComponent<CapsuleColliderComponent>();
 
 				void* data[] = {
-					&entity.ID(),
+					&entityID,
 					&capsuleCollider.IsTrigger,
 					&capsuleCollider.Radius,
 					&capsuleCollider.Height
@@ -121,7 +123,7 @@ namespace Script
 
 				Ref<Mesh>* mesh = new Ref<Mesh>(meshCollider.CollisionMesh);
 				void* data[] = {
-					&entity.ID(),
+					&entityID,
 					&meshCollider.IsTrigger,
 					&mesh
 				};
@@ -135,7 +137,7 @@ namespace Script
 	static std::array<physx::PxOverlapHit, OVERLAP_MAX_COLLIDERS> s_OverlapBuffer;
 
 
-	MonoArray* Engine::Script::Engine_Physics_OverlapBox(glm::vec3* origin, glm::vec3* halfSize)
+	MonoArray* Engine_Physics_OverlapBox(glm::vec3* origin, glm::vec3* halfSize)
 	{
 		MonoArray* outColliders = nullptr;
 		memset(s_OverlapBuffer.data(), 0, OVERLAP_MAX_COLLIDERS * sizeof(physx::PxOverlapHit));
@@ -150,7 +152,7 @@ namespace Script
 		return outColliders;
 	}
 
-	MonoArray* Engine::Script::Engine_Physics_OverlapCapsule(glm::vec3* origin, float radius, float halfHeight)
+	MonoArray* Engine_Physics_OverlapCapsule(glm::vec3* origin, float radius, float halfHeight)
 	{
 		MonoArray* outColliders = nullptr;
 		memset(s_OverlapBuffer.data(), 0, OVERLAP_MAX_COLLIDERS * sizeof(physx::PxOverlapHit));
@@ -165,7 +167,7 @@ namespace Script
 		return outColliders;
 	}
 
-	MonoArray* Engine::Script::Engine_Physics_OverlapSphere(glm::vec3* origin, float radius)
+	MonoArray* Engine_Physics_OverlapSphere(glm::vec3* origin, float radius)
 	{
 		MonoArray* outColliders = nullptr;
 		memset(s_OverlapBuffer.data(), 0, OVERLAP_MAX_COLLIDERS * sizeof(physx::PxOverlapHit));
@@ -180,7 +182,7 @@ namespace Script
 		return outColliders;
 	}
 
-	int32_t Engine::Script::Engine_Physics_OverlapBoxNonAlloc(glm::vec3* origin, glm::vec3* halfSize, MonoArray* outColliders)
+	int32_t Engine_Physics_OverlapBoxNonAlloc(glm::vec3* origin, glm::vec3* halfSize, MonoArray* outColliders)
 	{
 		memset(s_OverlapBuffer.data(), 0, OVERLAP_MAX_COLLIDERS * sizeof(physx::PxOverlapHit));
 
@@ -198,7 +200,7 @@ namespace Script
 		return count;
 	}
 
-	int32_t Engine::Script::Engine_Physics_OverlapCapsuleNonAlloc(glm::vec3* origin, float radius, float halfHeight, MonoArray* outColliders)
+	int32_t Engine_Physics_OverlapCapsuleNonAlloc(glm::vec3* origin, float radius, float halfHeight, MonoArray* outColliders)
 	{
 		memset(s_OverlapBuffer.data(), 0, OVERLAP_MAX_COLLIDERS * sizeof(physx::PxOverlapHit));
 
@@ -215,7 +217,7 @@ namespace Script
 		return count;
 	}
 
-	int32_t Engine::Script::Engine_Physics_OverlapSphereNonAlloc(glm::vec3* origin, float radius, MonoArray* outColliders)
+	int32_t Engine_Physics_OverlapSphereNonAlloc(glm::vec3* origin, float radius, MonoArray* outColliders)
 	{
 		memset(s_OverlapBuffer.data(), 0, OVERLAP_MAX_COLLIDERS * sizeof(physx::PxOverlapHit));
 
@@ -236,7 +238,7 @@ namespace Script
 	//-------------------------------------------------------------------------------------
 	// Entiny
 	//-------------------------------------------------------------------------------------
-	void Engine::Script::Engine_Entity_CreateComponent(uint64_t entityID, void* type)
+	void Engine_Entity_CreateComponent(uint64_t entityID, void* type)
 	{
 		Ref<Scene> scene = ScriptEngine::GetCurrentSceneContext();
 		ENGINE_ASSERT(scene, "No active scene!");
@@ -248,7 +250,7 @@ namespace Script
 		s_CreateComponentFuncs[monoType](entity);
 	}
 
-	bool Engine::Script::Engine_Entity_HasComponent(uint64_t entityID, void* type)
+	bool Engine_Entity_HasComponent(uint64_t entityID, void* type)
 	{
 		Ref<Scene> scene = ScriptEngine::GetCurrentSceneContext();
 		ENGINE_ASSERT(scene, "No active scene!");
@@ -261,7 +263,7 @@ namespace Script
 		return result;
 	}
 
-	uint64_t Engine::Script::Engine_Entity_FindEntityByTag(MonoString* tag)
+	uint64_t Engine_Entity_FindEntityByTag(MonoString* tag)
 	{
 		Ref<Scene> scene = ScriptEngine::GetCurrentSceneContext();
 		ENGINE_ASSERT(scene, "No active scene!");
@@ -273,7 +275,7 @@ namespace Script
 		return 0;
 	}
 
-	void Engine::Script::Engine_TransformComponent_GetTransform(uint64_t entityID, ScriptTransform* outTransform)
+	void Engine_TransformComponent_GetTransform(uint64_t entityID, ScriptTransform* outTransform)
 	{
 		Ref<Scene> scene = ScriptEngine::GetCurrentSceneContext();
 		ENGINE_ASSERT(scene, "No active scene!");
@@ -294,7 +296,7 @@ namespace Script
 		};
 	}
 
-	void Engine::Script::Engine_TransformComponent_SetTransform(uint64_t entityID, ScriptTransform* inTransform)
+	void Engine_TransformComponent_SetTransform(uint64_t entityID, ScriptTransform* inTransform)
 	{
 		Ref<Scene> scene = ScriptEngine::GetCurrentSceneContext();
 		ENGINE_ASSERT(scene, "No active scene!");
@@ -308,7 +310,7 @@ namespace Script
 		transform.Scale = inTransform->Scale;
 	}
 
-	void* Engine::Script::Engine_MeshComponent_GetMesh(uint64_t entityID)
+	void* Engine_MeshComponent_GetMesh(uint64_t entityID)
 	{
 		Ref<Scene> scene = ScriptEngine::GetCurrentSceneContext();
 		ENGINE_ASSERT(scene, "No active scene!");
@@ -320,7 +322,7 @@ namespace Script
 		return new Ref<Mesh>(meshComponent.Mesh);
 	}
 
-	void Engine::Script::Engine_MeshComponent_SetMesh(uint64_t entityID, Ref<Mesh>* inMesh)
+	void Engine_MeshComponent_SetMesh(uint64_t entityID, Ref<Mesh>* inMesh)
 	{
 		Ref<Scene> scene = ScriptEngine::GetCurrentSceneContext();
 		ENGINE_ASSERT(scene, "No active scene!");
@@ -330,14 +332,17 @@ namespace Script
 		Entity entity = entityMap.at(entityID);
 		auto& meshComponent = entity.GetComponent<MeshComponent>();
 		meshComponent.Mesh = inMesh ? *inMesh : nullptr;
+		meshComponent.PendingMesh = 0;
+		//Overrides are per material index of the previous mesh
+		meshComponent.MaterialOverrides.clear();
 	}
 
-	Engine::RigidBodyComponent::Type Engine::Script::Engine_RigidBodyComponent_GetBodyType(uint64_t entityID)
+	Engine::RigidBodyComponent::Type Engine_RigidBodyComponent_GetBodyType(uint64_t entityID)
 	{
 		return RigidBodyComponent::Type();
 	}
 
-	void Engine::Script::Engine_RigidBodyComponent_AddForce(uint64_t entityID, glm::vec3* force, ForceMode forceMode)
+	void Engine_RigidBodyComponent_AddForce(uint64_t entityID, glm::vec3* force, ForceMode forceMode)
 	{
 		Ref<Scene> scene = ScriptEngine::GetCurrentSceneContext();
 		ENGINE_ASSERT(scene, "No active scene!");
@@ -358,7 +363,7 @@ namespace Script
 		actor->AddForce(*force, forceMode);
 	}
 
-	void Engine::Script::Engine_RigidBodyComponent_AddTorque(uint64_t entityID, glm::vec3* torque, ForceMode forceMode)
+	void Engine_RigidBodyComponent_AddTorque(uint64_t entityID, glm::vec3* torque, ForceMode forceMode)
 	{
 		Ref<Scene> scene = ScriptEngine::GetCurrentSceneContext();
 		ENGINE_ASSERT(scene, "No active scene!");
@@ -379,7 +384,7 @@ namespace Script
 		actor->AddTorque(*torque, forceMode);
 	}
 
-	void Engine::Script::Engine_RigidBodyComponent_GetLinearVelocity(uint64_t entityID, glm::vec3* outVelocity)
+	void Engine_RigidBodyComponent_GetLinearVelocity(uint64_t entityID, glm::vec3* outVelocity)
 	{
 		Ref<Scene> scene = ScriptEngine::GetCurrentSceneContext();
 		ENGINE_ASSERT(scene, "No active scene!");
@@ -394,7 +399,7 @@ namespace Script
 		*outVelocity = actor->GetLinearVelocity();
 	}
 
-	void Engine::Script::Engine_RigidBodyComponent_SetLinearVelocity(uint64_t entityID, glm::vec3* velocity)
+	void Engine_RigidBodyComponent_SetLinearVelocity(uint64_t entityID, glm::vec3* velocity)
 	{
 		Ref<Scene> scene = ScriptEngine::GetCurrentSceneContext();
 		ENGINE_ASSERT(scene, "No active scene!");
@@ -409,7 +414,7 @@ namespace Script
 		actor->SetLinearVelocity(*velocity);
 	}
 
-	void Engine::Script::Engine_RigidBodyComponent_GetAngularVelocity(uint64_t entityID, glm::vec3* outVelocity)
+	void Engine_RigidBodyComponent_GetAngularVelocity(uint64_t entityID, glm::vec3* outVelocity)
 	{
 		Ref<Scene> scene = ScriptEngine::GetCurrentSceneContext();
 		ENGINE_ASSERT(scene, "No active scene!");
@@ -424,7 +429,7 @@ namespace Script
 		*outVelocity = actor->GetAngularVelocity();
 	}
 
-	void Engine::Script::Engine_RigidBodyComponent_SetAngularVelocity(uint64_t entityID, glm::vec3* velocity)
+	void Engine_RigidBodyComponent_SetAngularVelocity(uint64_t entityID, glm::vec3* velocity)
 	{
 		Ref<Scene> scene = ScriptEngine::GetCurrentSceneContext();
 		ENGINE_ASSERT(scene, "No active scene!");
@@ -439,7 +444,7 @@ namespace Script
 		actor->SetAngularVelocity(*velocity);
 	}
 
-	void Engine::Script::Engine_RigidBodyComponent_Rotate(uint64_t entityID, glm::vec3* rotation)
+	void Engine_RigidBodyComponent_Rotate(uint64_t entityID, glm::vec3* rotation)
 	{
 		Ref<Scene> scene = ScriptEngine::GetCurrentSceneContext();
 		ENGINE_ASSERT(scene, "No active scene!");
@@ -454,7 +459,7 @@ namespace Script
 		actor->Rotate(*rotation);
 	}
 
-	uint32_t Engine::Script::Engine_RigidBodyComponent_GetLayer(uint64_t entityID)
+	uint32_t Engine_RigidBodyComponent_GetLayer(uint64_t entityID)
 	{
 		Ref<Scene> scene = ScriptEngine::GetCurrentSceneContext();
 		ENGINE_ASSERT(scene, "No active scene!");
@@ -467,7 +472,7 @@ namespace Script
 		return component.Layer;
 	}
 
-	float Engine::Script::Engine_RigidBodyComponent_GetMass(uint64_t entityID)
+	float Engine_RigidBodyComponent_GetMass(uint64_t entityID)
 	{
 		Ref<Scene> scene = ScriptEngine::GetCurrentSceneContext();
 		ENGINE_ASSERT(scene, "No active scene!");
@@ -477,11 +482,11 @@ namespace Script
 		Entity entity = entityMap.at(entityID);
 		ENGINE_ASSERT(entity.HasComponent<RigidBodyComponent>(),"");
 		auto& component = entity.GetComponent<RigidBodyComponent>();
-		Ref<PhysicsActor>& actor = Physics::GetActorForEntity(entity);
+		Ref<PhysicsActor> actor = Physics::GetActorForEntity(entity);
 		return actor->GetMass();
 	}
 
-	void Engine::Script::Engine_RigidBodyComponent_SetMass(uint64_t entityID, float mass)
+	void Engine_RigidBodyComponent_SetMass(uint64_t entityID, float mass)
 	{
 		Ref<Scene> scene = ScriptEngine::GetCurrentSceneContext();
 		ENGINE_ASSERT(scene, "No active scene!");
@@ -491,25 +496,25 @@ namespace Script
 		Entity entity = entityMap.at(entityID);
 		ENGINE_ASSERT(entity.HasComponent<RigidBodyComponent>(),"");
 		auto& component = entity.GetComponent<RigidBodyComponent>();
-		Ref<PhysicsActor>& actor = Physics::GetActorForEntity(entity);
+		Ref<PhysicsActor> actor = Physics::GetActorForEntity(entity);
 		actor->SetMass(mass);
 	}
 
 	//---------------------------------------------------------------------------------
 	// Render
 	//---------------------------------------------------------------------------------
-	void* Engine::Script::Engine_Texture2D_Constructor(uint32_t width, uint32_t height)
+	void* Engine_Texture2D_Constructor(uint32_t width, uint32_t height)
 	{
 		auto result = Texture2D::Create(TextureFormat::RGBA, width, height);
 		return new Ref<Texture2D>(result);
 	}
 
-	void Engine::Script::Engine_Texture2D_Destructor(Ref<Texture2D>* _this)
+	void Engine_Texture2D_Destructor(Ref<Texture2D>* _this)
 	{
 		delete _this;
 	}
 
-	void Engine::Script::Engine_Texture2D_SetData(Ref<Texture2D>* _this, MonoArray* inData, int32_t count)
+	void Engine_Texture2D_SetData(Ref<Texture2D>* _this, MonoArray* inData, int32_t count)
 	{
 		Ref<Texture2D>& instance = *_this;
 
@@ -533,70 +538,70 @@ namespace Script
 		instance->Unlock();
 	}
 
-	void Engine::Script::Engine_Material_Destructor(Ref<Material>* _this)
+	void Engine_Material_Destructor(Ref<Material>* _this)
 	{
 		delete _this;
 	}
 
-	void Engine::Script::Engine_Material_SetFloat(Ref<Material>* _this, MonoString* uniform, float value)
+	void Engine_Material_SetFloat(Ref<Material>* _this, MonoString* uniform, float value)
 	{
 		Ref<Material>& instance = *(Ref<Material>*)_this;
 		instance->Set(mono_string_to_utf8(uniform), value);
 	}
 
-	void Engine::Script::Engine_Material_SetTexture(Ref<Material>* _this, MonoString* uniform, Ref<Texture2D>* texture)
+	void Engine_Material_SetTexture(Ref<Material>* _this, MonoString* uniform, Ref<Texture2D>* texture)
 	{
 		Ref<Material>& instance = *(Ref<Material>*)_this;
 		instance->Set(mono_string_to_utf8(uniform), *texture);
 	}
 
-	void Engine::Script::Engine_MaterialInstance_Destructor(Ref<MaterialInstance>* _this)
+	void Engine_MaterialInstance_Destructor(Ref<MaterialInstance>* _this)
 	{
 		delete _this;
 	}
 
-	void Engine::Script::Engine_MaterialInstance_SetFloat(Ref<MaterialInstance>* _this, MonoString* uniform, float value)
+	void Engine_MaterialInstance_SetFloat(Ref<MaterialInstance>* _this, MonoString* uniform, float value)
 	{
 		Ref<MaterialInstance>& instance = *(Ref<MaterialInstance>*)_this;
 		instance->Set(mono_string_to_utf8(uniform), value);
 	}
 
-	void Engine::Script::Engine_MaterialInstance_SetVector3(Ref<MaterialInstance>* _this, MonoString* uniform, glm::vec3* value)
+	void Engine_MaterialInstance_SetVector3(Ref<MaterialInstance>* _this, MonoString* uniform, glm::vec3* value)
 	{
 		Ref<MaterialInstance>& instance = *(Ref<MaterialInstance>*)_this;
 		instance->Set(mono_string_to_utf8(uniform), *value);
 	}
 
-	void Engine::Script::Engine_MaterialInstance_SetVector4(Ref<MaterialInstance>* _this, MonoString* uniform, glm::vec4* value)
+	void Engine_MaterialInstance_SetVector4(Ref<MaterialInstance>* _this, MonoString* uniform, glm::vec4* value)
 	{
 		Ref<MaterialInstance>& instance = *(Ref<MaterialInstance>*)_this;
 		instance->Set(mono_string_to_utf8(uniform), *value);
 	}
 
-	void Engine::Script::Engine_MaterialInstance_SetTexture(Ref<MaterialInstance>* _this, MonoString* uniform, Ref<Texture2D>* texture)
+	void Engine_MaterialInstance_SetTexture(Ref<MaterialInstance>* _this, MonoString* uniform, Ref<Texture2D>* texture)
 	{
 		Ref<MaterialInstance>& instance = *(Ref<MaterialInstance>*)_this;
 		instance->Set(mono_string_to_utf8(uniform), *texture);
 	}
 
-	Engine::Ref<Engine::Mesh>* Engine::Script::Engine_Mesh_Constructor(MonoString* filepath)
+	Engine::Ref<Engine::Mesh>* Engine_Mesh_Constructor(MonoString* filepath)
 	{
-		return new Ref<Mesh>(new Mesh(mono_string_to_utf8(filepath)));
+		return new Ref<Mesh>(AssetManager::LoadMesh(mono_string_to_utf8(filepath)));
 	}
 
-	void Engine::Script::Engine_Mesh_Destructor(Ref<Mesh>* _this)
+	void Engine_Mesh_Destructor(Ref<Mesh>* _this)
 	{
 		Ref<Mesh>* instance = (Ref<Mesh>*)_this;
 		delete _this;
 	}
 
-	Engine::Ref<Engine::Material>* Engine::Script::Engine_Mesh_GetMaterial(Ref<Mesh>* inMesh)
+	Engine::Ref<Engine::Material>* Engine_Mesh_GetMaterial(Ref<Mesh>* inMesh)
 	{
 		Ref<Mesh>& mesh = *(Ref<Mesh>*)inMesh;
 		return new Ref<Material>(mesh->GetMaterial());
 	}
 
-	Engine::Ref<Engine::MaterialInstance>* Engine::Script::Engine_Mesh_GetMaterialByIndex(Ref<Mesh>* inMesh, int index)
+	Engine::Ref<Engine::MaterialInstance>* Engine_Mesh_GetMaterialByIndex(Ref<Mesh>* inMesh, int index)
 	{
 		Ref<Mesh>& mesh = *(Ref<Mesh>*)inMesh;
 		const auto& materials = mesh->GetMaterials();
@@ -605,17 +610,17 @@ namespace Script
 		return new Ref<MaterialInstance>(materials[index]);
 	}
 
-	int Engine::Script::Engine_Mesh_GetMaterialCount(Ref<Mesh>* inMesh)
+	int Engine_Mesh_GetMaterialCount(Ref<Mesh>* inMesh)
 	{
 		Ref<Mesh>& mesh = *(Ref<Mesh>*)inMesh;
 		const auto& materials = mesh->GetMaterials();
 		return materials.size();
 	}
 
-	void* Engine::Script::Engine_MeshFactory_CreatePlane(float width, float height)
+	void* Engine_MeshFactory_CreatePlane(float width, float height)
 	{
 		// TODO: Implement properly with MeshFactory class
-		return new Ref<Mesh>(new Mesh("assets/models/Plane/Plane.fbx"));
+		return new Ref<Mesh>(AssetManager::LoadMesh("assets/models/Plane/Plane.fbx"));
 	}
 }
 }
\ No newline at end of file
@@ -0,0 +1,81 @@
+#type compute
+#version 450 core
+
+// Culls the meshlets of one submesh against the view frustum and their normal cones.
+// Visible meshlets are appended as indirect draw commands, see MeshletCuller.
+
+layout(local_size_x = 64) in;
+
+struct Meshlet
+{
+	vec4 Sphere;	//Center, radius
+	vec4 Cone;		//Axis, cutoff
+	uvec4 Range;	//First triangle, triangle count, vertex count
+};
+
+struct DrawCommand
+{
+	uint Count;
+	uint InstanceCount;
+	uint FirstIndex;
+	int BaseVertex;
+	uint BaseInstance;
+};
+
+struct CullingView
+{
+	vec4 FrustumPlanes[6];
+	vec4 CameraPosition;
+};
+
+struct CullingJob
+{
+	mat4 Transform;
+	uvec4 Draw;		//Meshlet offset, meshlet count, command offset, draw index
+	uvec4 Params;	//First index, base vertex, cone culling, view
+	float MaxScale;
+};
+
+layout(std430, binding = 0) readonly buffer Meshlets { Meshlet u_Meshlets[]; };
+layout(std430, binding = 1) writeonly buffer Commands { DrawCommand u_Commands[]; };
+layout(std430, binding = 2) buffer Counts { uint u_Counts[]; };
+layout(std430, binding = 3) readonly buffer Jobs { CullingJob u_Jobs[]; };
+layout(std430, binding = 4) readonly buffer Views { CullingView u_Views[]; };
+
+uniform uint u_Job;
+
+void main()
+{
+	CullingJob job = u_Jobs[u_Job];
+	uint index = gl_GlobalInvocationID.x;
+	if (index >= job.Draw.y)
+		return;
+
+	CullingView cullingView = u_Views[job.Params.w];
+	Meshlet meshlet = u_Meshlets[job.Draw.x + index];
+	vec3 center = vec3(job.Transform * vec4(meshlet.Sphere.xyz, 1.0));
+	float radius = meshlet.Sphere.w * job.MaxScale;
+
+	for (int i = 0; i < 6; i++)
+	{
+		if (dot(cullingView.FrustumPlanes[i].xyz, center) + cullingView.FrustumPlanes[i].w < -radius)
+			return;
+	}
+
+	if (job.Params.z != 0 && meshlet.Cone.w < 1.0)
+	{
+		vec3 axis = normalize(mat3(job.Transform) * meshlet.Cone.xyz);
+		vec3 view = center - cullingView.CameraPosition.xyz;
+		if (dot(view, axis) >= meshlet.Cone.w * length(view) + radius)
+			return;
+	}
+
+	uint slot = atomicAdd(u_Counts[job.Draw.w], 1);
+	DrawCommand command;
+	command.Count = meshlet.Range.y * 3;
+	command.InstanceCount = 1;
+	command.FirstIndex = job.Params.x + meshlet.Range.x * 3;
+	command.BaseVertex = int(job.Params.y);
+	command.BaseInstance = 0;
+	u_Commands[job.Draw.z + slot] = command;
+}
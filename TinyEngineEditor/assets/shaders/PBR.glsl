@@ -1,11 +1,27 @@
 #type vertex
 #version 430
 
+#ifdef PACKED_VERTICES
+layout(location = 0) in vec3 a_Position;
+layout(location = 1) in vec2 a_Normal;		//Octahedral encoded
+layout(location = 2) in vec4 a_Tangent;		//Binormal sign in w
+layout(location = 3) in vec2 a_TexCoord;
+
+vec3 OctahedralDecode(vec2 e)
+{
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	float t = max(-n.z, 0.0);
+	n.x += n.x >= 0.0 ? -t : t;
+	n.y += n.y >= 0.0 ? -t : t;
+	return normalize(n);
+}
+#else
 layout(location = 0) in vec3 a_Position;
 layout(location = 1) in vec3 a_Normal;
 layout(location = 2) in vec3 a_Tangent;
 layout(location = 3) in vec3 a_Bitangent;
 layout(location = 4) in vec2 a_TexCoord;
+#endif
 
 out VertexOutput
 {
@@ -31,15 +47,25 @@ uniform mat4 u_LightCascadeMatrix3;
 
 void main()
 {
+#ifdef PACKED_VERTICES
+	vec3 normal = OctahedralDecode(a_Normal);
+	vec3 tangent = a_Tangent.xyz;
+	vec3 bitangent = cross(normal, tangent) * a_Tangent.w;
+#else
+	vec3 normal = a_Normal;
+	vec3 tangent = a_Tangent;
+	vec3 bitangent = a_Bitangent;
+#endif
+
 	gl_Position = u_ViewProjectionMatrix * u_Transform * vec4(a_Position, 1.0);
 
 	vs_Output.WorldPosition = vec3(u_Transform * vec4(a_Position, 1.0));
-    vs_Output.Normal = mat3(u_Transform) * a_Normal;
-    vs_Output.Binormal = a_Bitangent;
+    vs_Output.Normal = mat3(u_Transform) * normal;
+    vs_Output.Binormal = bitangent;
 	vs_Output.TexCoord = a_TexCoord;	
 	vs_Output.LightSpacePosition = u_LightSpaceMatrix * vec4(vs_Output.WorldPosition, 1.0);
 	vs_Output.WorldTransform = mat3(u_Transform);
-	vs_Output.WorldNormals = mat3(u_Transform) * mat3(a_Tangent, a_Bitangent, a_Normal);
+	vs_Output.WorldNormals = mat3(u_Transform) * mat3(tangent, bitangent, normal);
 
 	vs_Output.LightCascadePosition[0] = u_LightCascadeMatrix0 * vec4(vs_Output.WorldPosition, 1.0);
 	vs_Output.LightCascadePosition[1] = u_LightCascadeMatrix1 * vec4(vs_Output.WorldPosition, 1.0);
@@ -51,6 +77,10 @@ void main()
 #type fragment
 #version 430
 
+//Material maps and shadow filtering are compiled into variants instead of branching at runtime
+#pragma variant ALBEDO_MAP NORMAL_MAP ROUGHNESS_MAP METALNESS_MAP
+#pragma variant SHADOWS_PCF SHADOWS_PCSS
+
 layout(location = 0) out vec4 fragColor;
 
 in VertexOutput
@@ -71,7 +101,6 @@ struct DirectionalLight
 	vec3 Direction;
 	vec3 Radiance;
 	float Intensity;
-	int ShadowsType;
 	int SamplingRadius;
 };
 
@@ -82,18 +111,14 @@ uniform vec3 u_CameraPosition;
 //Material textures
 //-------------------------------------------------------------
 uniform vec3 u_AlbedoColor;
-uniform float u_AlbedoTexToggle;
 uniform sampler2D u_AlbedoTexture;
 
-uniform float u_NormalTexToggle;
 uniform sampler2D u_NormalTexture;
 
 uniform float u_Roughness;
-uniform float u_RoughnessTexToggle;
 uniform sampler2D u_RoughnessTexture;
 
 uniform float u_Metalness;
-uniform float u_MetalnessTexToggle;
 uniform sampler2D u_MetalnessTexture;
 //-------------------------------------------------------------
 
@@ -399,20 +424,13 @@ float CalculateShadow(sampler2D shadowMapTexture, vec4 lightSpacePosition)
 	vec3 projCoords = lightSpacePosition.xyz / lightSpacePosition.w;	
 	projCoords = projCoords * 0.5 + 0.5;
 
-	float shadow;
-	switch(u_DirectionalLight.ShadowsType)
-	{
-		case 0:
-			shadow = HardShadows(shadowMapTexture, projCoords);
-			break;
-		case 1:
-			shadow = PCF(shadowMapTexture, projCoords, u_DirectionalLight.SamplingRadius);
-			break;
-		case 2:
-			shadow = PCSS(shadowMapTexture, projCoords, u_DirectionalLight.SamplingRadius);
-			break;
-	}		
-	return shadow;
+#if defined(SHADOWS_PCSS)
+	return PCSS(shadowMapTexture, projCoords, u_DirectionalLight.SamplingRadius);
+#elif defined(SHADOWS_PCF)
+	return PCF(shadowMapTexture, projCoords, u_DirectionalLight.SamplingRadius);
+#else
+	return HardShadows(shadowMapTexture, projCoords);
+#endif
 }
 
 float CalculateShadow_CSM()
@@ -465,17 +483,31 @@ float CalculateShadow_CSM()
 
 void main()
 {
-	params.Albedo = u_AlbedoTexToggle > 0.5 ? texture2D(u_AlbedoTexture, fs_Input.TexCoord).rgb : u_AlbedoColor;
-	params.Roughness = u_RoughnessTexToggle > 0.5 ? texture2D(u_RoughnessTexture, fs_Input.TexCoord).r : u_Roughness;
-	params.Metalness = u_MetalnessTexToggle > 0.5 ? texture2D(u_MetalnessTexture, fs_Input.TexCoord).r : u_Metalness; 
+#ifdef ALBEDO_MAP
+	params.Albedo = texture2D(u_AlbedoTexture, fs_Input.TexCoord).rgb;
+#else
+	params.Albedo = u_AlbedoColor;
+#endif
+#ifdef ROUGHNESS_MAP
+	params.Roughness = texture2D(u_RoughnessTexture, fs_Input.TexCoord).r;
+#else
+	params.Roughness = u_Roughness;
+#endif
+#ifdef METALNESS_MAP
+	params.Metalness = texture2D(u_MetalnessTexture, fs_Input.TexCoord).r;
+#else
+	params.Metalness = u_Metalness;
+#endif
 	params.F0 = mix(Fdielectric, params.Albedo, vec3(params.Metalness));
 
+#ifdef NORMAL_MAP
+	//Z is rebuilt from XY, BC5 normal maps only store two channels
+	vec2 normalXY = 2.0 * texture2D(u_NormalTexture, fs_Input.TexCoord).rg - 1.0;
+	params.Normal = vec3(normalXY, sqrt(max(1.0 - dot(normalXY, normalXY), 0.0)));
+	params.Normal = normalize(fs_Input.WorldNormals * params.Normal);
+#else
 	params.Normal = normalize(fs_Input.Normal);
-	if(u_NormalTexToggle > 0.5)
-	{
-		params.Normal = normalize(2.0 * texture2D(u_NormalTexture, fs_Input.TexCoord).rgb - 1.0);
-		params.Normal = normalize(fs_Input.WorldNormals * params.Normal);
-	}
+#endif
 	params.View = normalize(u_CameraPosition - fs_Input.WorldPosition);
 
 	//Ambient
@@ -0,0 +1,105 @@
+#type compute
+#version 450 core
+
+// Linear blend skinning of one mesh vertex buffer into another with the same layout.
+// Vertices without weights are copied unchanged.
+
+layout(local_size_x = 64) in;
+
+#ifdef PACKED_VERTICES
+const uint VertexStride = 6;	//See PackedVertex
+#else
+const uint VertexStride = 14;	//See Vertex
+#endif
+
+layout(std430, binding = 0) readonly buffer InputVertices { uint u_InputVertices[]; };
+//Two joints per uint in 16 bits each, then four unorm8 weights
+layout(std430, binding = 1) readonly buffer Influences { uint u_Influences[]; };
+layout(std430, binding = 2) readonly buffer Bones { mat4 u_Bones[]; };
+layout(std430, binding = 3) writeonly buffer OutputVertices { uint u_OutputVertices[]; };
+
+uniform uint u_VertexCount;
+
+#ifdef PACKED_VERTICES
+vec3 OctahedralDecode(vec2 e)
+{
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	float t = max(-n.z, 0.0);
+	n.x += n.x >= 0.0 ? -t : t;
+	n.y += n.y >= 0.0 ? -t : t;
+	return normalize(n);
+}
+
+vec2 OctahedralEncode(vec3 n)
+{
+	vec2 e = n.xy / (abs(n.x) + abs(n.y) + abs(n.z));
+	if (n.z < 0.0)
+		e = (1.0 - abs(e.yx)) * vec2(e.x >= 0.0 ? 1.0 : -1.0, e.y >= 0.0 ? 1.0 : -1.0);
+	return e;
+}
+
+//snorm10 xyz, w in the top two bits
+vec4 UnpackTangent(uint v)
+{
+	ivec4 i = ivec4(bitfieldExtract(int(v), 0, 10), bitfieldExtract(int(v), 10, 10), bitfieldExtract(int(v), 20, 10), bitfieldExtract(int(v), 30, 2));
+	return vec4(max(vec3(i.xyz) / 511.0, -1.0), float(i.w));
+}
+
+uint PackTangent(vec4 t)
+{
+	ivec3 i = ivec3(round(clamp(t.xyz, -1.0, 1.0) * 511.0));
+	return uint(i.x & 0x3FF) | (uint(i.y & 0x3FF) << 10) | (uint(i.z & 0x3FF) << 20) | (uint(int(t.w) & 0x3) << 30);
+}
+#endif
+
+vec3 ReadVec3(uint offset)
+{
+	return uintBitsToFloat(uvec3(u_InputVertices[offset], u_InputVertices[offset + 1], u_InputVertices[offset + 2]));
+}
+
+void WriteVec3(uint offset, vec3 v)
+{
+	uvec3 bits = floatBitsToUint(v);
+	u_OutputVertices[offset] = bits.x;
+	u_OutputVertices[offset + 1] = bits.y;
+	u_OutputVertices[offset + 2] = bits.z;
+}
+
+void main()
+{
+	uint vertex = gl_GlobalInvocationID.x;
+	if (vertex >= u_VertexCount)
+		return;
+
+	uint base = vertex * VertexStride;
+	vec4 weights = unpackUnorm4x8(u_Influences[vertex * 3 + 2]);
+	if (dot(weights, vec4(1.0)) == 0.0)
+	{
+		for (uint i = 0; i < VertexStride; i++)
+			u_OutputVertices[base + i] = u_InputVertices[base + i];
+		return;
+	}
+
+	uint joints01 = u_Influences[vertex * 3];
+	uint joints23 = u_Influences[vertex * 3 + 1];
+	mat4 skin = u_Bones[joints01 & 0xFFFF] * weights.x
+		+ u_Bones[joints01 >> 16] * weights.y
+		+ u_Bones[joints23 & 0xFFFF] * weights.z
+		+ u_Bones[joints23 >> 16] * weights.w;
+	mat3 skinNormal = mat3(skin);
+
+	WriteVec3(base, vec3(skin * vec4(ReadVec3(base), 1.0)));
+#ifdef PACKED_VERTICES
+	vec3 normal = normalize(skinNormal * OctahedralDecode(unpackSnorm2x16(u_InputVertices[base + 3])));
+	vec4 tangent = UnpackTangent(u_InputVertices[base + 4]);
+	u_OutputVertices[base + 3] = packSnorm2x16(OctahedralEncode(normal));
+	u_OutputVertices[base + 4] = PackTangent(vec4(normalize(skinNormal * tangent.xyz), tangent.w));
+	u_OutputVertices[base + 5] = u_InputVertices[base + 5];
+#else
+	WriteVec3(base + 3, normalize(skinNormal * ReadVec3(base + 3)));
+	WriteVec3(base + 6, normalize(skinNormal * ReadVec3(base + 6)));
+	WriteVec3(base + 9, normalize(skinNormal * ReadVec3(base + 9)));
+	u_OutputVertices[base + 12] = u_InputVertices[base + 12];
+	u_OutputVertices[base + 13] = u_InputVertices[base + 13];
+#endif
+}
@@ -8,9 +8,17 @@
 
 namespace Engine
 {
+	//Same settings as the maps imported with meshes, so picking a file a mesh uses shares its texture
+	static Ref<Texture2D> LoadMaterialTexture(const std::string& path, bool srgb, TextureUsage usage)
+	{
+		TextureSpecification spec;
+		spec.Usage = usage;
+		return AssetManager::LoadTexture(path, srgb, spec);
+	}
+
 	MaterialEditorPanel::MaterialEditorPanel()
 	{
-		m_CheckerboardTex = AssetManager::CreateNewAsset<Texture2D>("resources\\textures\\Checkerboard.tga");
+		m_CheckerboardTex = AssetManager::LoadTexture("resources\\textures\\Checkerboard.tga");
 	}
 
 	void MaterialEditorPanel::OnImGuiRender()
@@ -21,17 +29,18 @@ namespace Engine
 			{
 				if (m_SelectedEntity.HasComponent<MeshComponent>())	
 				{
-					auto mesh = m_SelectedEntity.GetComponent<MeshComponent>().Mesh;
+					auto& meshComponent = m_SelectedEntity.GetComponent<MeshComponent>();
+					auto mesh = meshComponent.Mesh;
 					if (mesh)
 					{
-						auto& materials = mesh->GetMaterials();
+						const auto& materials = mesh->GetMaterials();
 						uint32_t selectedMaterialIndex = 0;
 						for (uint32_t i = 0; i < materials.size(); i++)
 						{
-							auto& materialInstance = materials[i];
+							auto materialInstance = meshComponent.GetMaterial(i);
 
 							ImGuiTreeNodeFlags node_flags = (selectedMaterialIndex == i ? ImGuiTreeNodeFlags_Selected : 0) | ImGuiTreeNodeFlags_Leaf;
-							bool opened = ImGui::TreeNodeEx((void*)(&materialInstance), node_flags, materialInstance->GetName().c_str());
+							bool opened = ImGui::TreeNodeEx((void*)materialInstance.get(), node_flags, materialInstance->GetName().c_str());
 							if (ImGui::IsItemClicked())
 							{
 								selectedMaterialIndex = i;
@@ -43,7 +52,17 @@ namespace Engine
 						// Selected material
 						if (selectedMaterialIndex < materials.size())
 						{
-							auto& materialInstance = materials[selectedMaterialIndex];
+							//The mesh is shared by every entity using the file, edit a copy to change this entity only
+							bool overridden = selectedMaterialIndex < meshComponent.MaterialOverrides.size() && meshComponent.MaterialOverrides[selectedMaterialIndex];
+							if (ImGui::Checkbox("Override for this entity", &overridden))
+							{
+								if (overridden)
+									meshComponent.OverrideMaterial(selectedMaterialIndex);
+								else
+									meshComponent.MaterialOverrides[selectedMaterialIndex] = nullptr;
+							}
+
+							auto materialInstance = meshComponent.GetMaterial(selectedMaterialIndex);
 							ImGui::Text("Shader: %s", materialInstance->GetShader()->GetName().c_str());
 
 							ImGui::Separator();
@@ -56,7 +75,7 @@ namespace Engine
 							{
 								ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(10, 10));
 								auto& albedoColor = materialInstance->Get<glm::vec3>("u_AlbedoColor");
-								bool useAlbedoMap = materialInstance->Get<float>("u_AlbedoTexToggle");
+								bool useAlbedoMap = materialInstance->IsKeywordEnabled("ALBEDO_MAP");
 								auto albedoMap = materialInstance->TryGetResource<Texture2D>("u_AlbedoTexture");
 
 								ImGui::Image(albedoMap ? (void*)albedoMap->GetRendererID() : (void*)m_CheckerboardTex->GetRendererID(), textureSize, { 0, 1 }, { 1, 0 });
@@ -75,7 +94,7 @@ namespace Engine
 										std::string filename = Application::Get().OpenFile("");
 										if (filename != "")
 										{
-											albedoMap = Texture2D::Create(filename, true);
+											albedoMap = LoadMaterialTexture(filename, true, TextureUsage::Albedo);
 											materialInstance->Set("u_AlbedoTexture", albedoMap);
 										}
 									}
@@ -83,7 +102,7 @@ namespace Engine
 								ImGui::SameLine();
 								ImGui::BeginGroup();
 								if (ImGui::Checkbox("Use##AlbedoMap", &useAlbedoMap))
-									materialInstance->Set<float>("u_AlbedoTexToggle", useAlbedoMap ? 1.0f : 0.0f);
+									materialInstance->SetKeyword("ALBEDO_MAP", useAlbedoMap);
 								ImGui::EndGroup();
 								ImGui::SameLine();
 								ImGui::ColorEdit3("Color##Albedo", glm::value_ptr(albedoColor), ImGuiColorEditFlags_NoInputs);
@@ -93,7 +112,7 @@ namespace Engine
 							if (ImGui::CollapsingHeader("Normals", nullptr, ImGuiTreeNodeFlags_DefaultOpen))
 							{
 								ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(10, 10));
-								bool useNormalMap = materialInstance->Get<float>("u_NormalTexToggle");
+								bool useNormalMap = materialInstance->IsKeywordEnabled("NORMAL_MAP");
 								auto normalMap = materialInstance->TryGetResource<Texture2D>("u_NormalTexture");
 								ImGui::Image(normalMap ? (void*)normalMap->GetRendererID() : (void*)m_CheckerboardTex->GetRendererID(), textureSize, { 0, 1 }, { 1, 0 });
 								ImGui::PopStyleVar();
@@ -111,14 +130,14 @@ namespace Engine
 										std::string filename = Application::Get().OpenFile("");
 										if (filename != "")
 										{
-											normalMap = Texture2D::Create(filename);
+											normalMap = LoadMaterialTexture(filename, false, TextureUsage::Normal);
 											materialInstance->Set("u_NormalTexture", normalMap);
 										}
 									}
 								}
 								ImGui::SameLine();
 								if (ImGui::Checkbox("Use##NormalMap", &useNormalMap))
-									materialInstance->Set<float>("u_NormalTexToggle", useNormalMap ? 1.0f : 0.0f);
+									materialInstance->SetKeyword("NORMAL_MAP", useNormalMap);
 							}
 
 							// Metalness
@@ -126,7 +145,7 @@ namespace Engine
 							{
 								ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(10, 10));
 								float& metalnessValue = materialInstance->Get<float>("u_Metalness");
-								bool useMetalnessMap = materialInstance->Get<float>("u_MetalnessTexToggle");
+								bool useMetalnessMap = materialInstance->IsKeywordEnabled("METALNESS_MAP");
 								Ref<Texture2D> metalnessMap = materialInstance->TryGetResource<Texture2D>("u_MetalnessTexture");
 								ImGui::Image(metalnessMap ? (void*)metalnessMap->GetRendererID() : (void*)m_CheckerboardTex->GetRendererID(), textureSize, { 0, 1 }, { 1, 0 });
 								ImGui::PopStyleVar();
@@ -143,14 +162,14 @@ namespace Engine
 										std::string filename = Application::Get().OpenFile("");
 										if (filename != "")
 										{
-											metalnessMap = Texture2D::Create(filename);
+											metalnessMap = LoadMaterialTexture(filename, false, TextureUsage::Mask);
 											materialInstance->Set("u_MetalnessTexture", metalnessMap);
 										}
 									}
 								}
 								ImGui::SameLine();
 								if (ImGui::Checkbox("Use##MetalnessMap", &useMetalnessMap))
-									materialInstance->Set<float>("u_MetalnessTexToggle", useMetalnessMap ? 1.0f : 0.0f);
+									materialInstance->SetKeyword("METALNESS_MAP", useMetalnessMap);
 								ImGui::SameLine();
 								ImGui::SliderFloat("##MetalnessInput", &metalnessValue, 0.0f, 1.0f);
 							}
@@ -160,7 +179,7 @@ namespace Engine
 							{
 								ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(10, 10));
 								float& roughnessValue = materialInstance->Get<float>("u_Roughness");
-								bool useRoughnessMap = materialInstance->Get<float>("u_RoughnessTexToggle");
+								bool useRoughnessMap = materialInstance->IsKeywordEnabled("ROUGHNESS_MAP");
 								Ref<Texture2D> roughnessMap = materialInstance->TryGetResource<Texture2D>("u_RoughnessTexture");
 								ImGui::Image(roughnessMap ? (void*)roughnessMap->GetRendererID() : (void*)m_CheckerboardTex->GetRendererID(), textureSize, { 0, 1 }, { 1, 0 });
 								ImGui::PopStyleVar();
@@ -177,14 +196,14 @@ namespace Engine
 										std::string filename = Application::Get().OpenFile("");
 										if (filename != "")
 										{
-											roughnessMap = Texture2D::Create(filename);
+											roughnessMap = LoadMaterialTexture(filename, false, TextureUsage::Mask);
 											materialInstance->Set("u_RoughnessTexture", roughnessMap);
 										}
 									}
 								}
 								ImGui::SameLine();
 								if (ImGui::Checkbox("Use##RoughnessMap", &useRoughnessMap))
-									materialInstance->Set<float>("u_RoughnessTexToggle", useRoughnessMap ? 1.0f : 0.0f);
+									materialInstance->SetKeyword("ROUGHNESS_MAP", useRoughnessMap);
 								ImGui::SameLine();
 								ImGui::SliderFloat("##RoughnessInput", &roughnessValue, 0.0f, 1.0f);
 							}
@@ -20,7 +20,7 @@
 #include "Engine/Scene/Component.h"
 #include "Engine/ImGui/ImGuiUI.h"
 
-#include "Engine/Renderer/MeshFactory.h"
+#include "Engine/Asset/AssetManager.h"
 
 #include "Engine/Script/ScriptEngine.h"
 
@@ -142,7 +142,9 @@ namespace Engine
 						//Environment settings
 						if (ImGui::TreeNode("Source"))
 						{
-							auto path = m_Context->GetEnvironment().SkyboxMap->GetPath();
+							//The maps are empty while the image loads
+							auto& environment = m_Context->GetEnvironment();
+							auto path = environment.SkyboxMap ? environment.SkyboxMap->GetPath() : environment.Path;
 
 							int width1 = 60, width2 = 250, width3 = 40;
 							{
@@ -336,10 +338,41 @@ namespace Engine
 				{
 					std::string file = Application::Get().OpenFile();
 					if (!file.empty())
-						mc.Mesh = CreateRef<Mesh>(file);
+					{
+						mc.Mesh = AssetManager::LoadMesh(file);
+						mc.PendingMesh = 0;
+						mc.MaterialOverrides.clear();
+					}
 				}
 				ImGui::Columns(1);
 			});
+		DrawComponent<AnimationComponent>("Animation", entity, [&](AnimationComponent& ac)
+			{
+				Ref<Mesh> mesh = entity.HasComponent<MeshComponent>() ? entity.GetComponent<MeshComponent>().Mesh : nullptr;
+				if (!mesh || !mesh->IsAnimated())
+				{
+					ImGui::Text("The mesh of the entity is not animated");
+					return;
+				}
+
+				//Clips of the mesh, "None" holds the bind pose
+				std::vector<const char*> clips = { "None" };
+				int32_t selected = 0;
+				for (auto& clip : mesh->GetAnimations())
+				{
+					if (clip->GetName() == ac.Clip)
+						selected = (int32_t)clips.size();
+					clips.push_back(clip->GetName().c_str());
+				}
+
+				UI::BeginPropertyGrid();
+				if (UI::PropertyDropdown("Clip", clips.data(), (int32_t)clips.size(), &selected))
+					ac.Clip = selected > 0 ? clips[selected] : "";
+				UI::Property("Speed", ac.Speed, 0.05f, 0.0f, 10.0f);
+				UI::Property("Loop", ac.Loop);
+				UI::Property("Playing", ac.Playing);
+				UI::EndPropertyGrid();
+			});
 		DrawComponent<CameraComponent>("Camera", entity, [](CameraComponent& cc)
 			{
 				// Projection Type
@@ -519,36 +552,23 @@ namespace Engine
 		DrawComponent<BoxColliderComponent>("Box Collider", entity, [](BoxColliderComponent& bcc)
 			{
 				UI::BeginPropertyGrid();
-				if (UI::Property("Size", bcc.Size))
-				{
-					bcc.DebugMesh = MeshFactory::CreateBox(bcc.Size);
-				}
+				UI::Property("Size", bcc.Size);
 				UI::Property("Is Trigger", bcc.IsTrigger);
 				UI::EndPropertyGrid();
 			});
 		DrawComponent<SphereColliderComponent>("Sphere Collider", entity, [](SphereColliderComponent& scc)
 			{
 				UI::BeginPropertyGrid();
-				if (UI::Property("Radius", scc.Radius))
-				{
-					scc.DebugMesh = MeshFactory::CreateSphere(scc.Radius);
-				}
+				UI::Property("Radius", scc.Radius);
 				UI::Property("Is Trigger", scc.IsTrigger);
 				UI::EndPropertyGrid();
 			});
 		DrawComponent<CapsuleColliderComponent>("Capsule Collider", entity, [=](CapsuleColliderComponent& ccc)
 			{
 				UI::BeginPropertyGrid();
-				bool changed = false;
-				if (UI::Property("Radius", ccc.Radius))
-					changed = true;
-				if (UI::Property("Height", ccc.Height))
-					changed = true;
+				UI::Property("Radius", ccc.Radius);
+				UI::Property("Height", ccc.Height);
 				UI::Property("Is Trigger", ccc.IsTrigger);
-				if (changed)
-				{
-					ccc.DebugMesh = MeshFactory::CreateCapsule(ccc.Radius, ccc.Height);
-				}
 				UI::EndPropertyGrid();
 			});
 		DrawComponent<MeshColliderComponent>("Mesh Collider", entity, [&](MeshColliderComponent& mcc)
@@ -573,7 +593,7 @@ namespace Engine
 						std::string file = Application::Get().OpenFile();
 						if (!file.empty())
 						{
-							mcc.CollisionMesh = CreateRef<Mesh>(file);
+							mcc.CollisionMesh = AssetManager::LoadMesh(file, MeshRetention::KeepPositionsForQueries);
 							if (mcc.IsConvex)
 								PXPhysicsWrappers::CreateConvexMesh(mcc, entity.GetTransformComponent().Scale, true);
 							else
@@ -713,6 +733,7 @@ namespace Engine
 		{
 			DrawAddComponentButton<CameraComponent>("Camera");
 			DrawAddComponentButton<MeshComponent>("Mesh");
+			DrawAddComponentButton<AnimationComponent>("Animation");
 			DrawAddComponentButton<DirectionalLightComponent>("Directional Light");	
 			DrawAddComponentButton<RigidBodyComponent>("RigidBody");
 			DrawAddComponentButton<PhysicsMaterialComponent>("Physics Material");
@@ -29,18 +29,21 @@ namespace Engine
     EditorLayer::EditorLayer():
 	    Layer("EditorLayer"), m_EditorCamera(45.0f, 1600.0f, 900.0f, 0.1f, 1000.0f)
     {
+        //Mouse picking raycasts the meshes
+        Mesh::SetDefaultRetention(MeshRetention::KeepPositionsForQueries);
+
         m_SceneHierarchyPanel.SetSelectionChangedCallback(std::bind(&EditorLayer::SelectEntity, this, std::placeholders::_1));
         m_SceneHierarchyPanel.SetEntityDeletedCallback(std::bind(&EditorLayer::OnEntityDeleted, this, std::placeholders::_1));
 
         //Load editor icons 
-        m_SelectIcon = AssetManager::CreateNewAsset<Texture2D>("resources\\icons\\GizmosTools\\View.png");
-        m_MoveIcon = AssetManager::CreateNewAsset<Texture2D>("resources\\icons\\GizmosTools\\Move.png");
-        m_RotateIcon = AssetManager::CreateNewAsset<Texture2D>("resources\\icons\\GizmosTools\\Rotate.png");
-        m_ScaleIcon = AssetManager::CreateNewAsset<Texture2D>("resources\\icons\\GizmosTools\\Scale.png");
+        m_SelectIcon = AssetManager::LoadTexture("resources\\icons\\GizmosTools\\View.png");
+        m_MoveIcon = AssetManager::LoadTexture("resources\\icons\\GizmosTools\\Move.png");
+        m_RotateIcon = AssetManager::LoadTexture("resources\\icons\\GizmosTools\\Rotate.png");
+        m_ScaleIcon = AssetManager::LoadTexture("resources\\icons\\GizmosTools\\Scale.png");
     
-        m_PlayIcon = AssetManager::CreateNewAsset<Texture2D>("resources\\icons\\ToolBar\\Play.png");
-        m_StopIcon = AssetManager::CreateNewAsset<Texture2D>("resources\\icons\\ToolBar\\Stop.png");
-        m_PauseIcon = AssetManager::CreateNewAsset<Texture2D>("resources\\icons\\ToolBar\\Pause.png");
+        m_PlayIcon = AssetManager::LoadTexture("resources\\icons\\ToolBar\\Play.png");
+        m_StopIcon = AssetManager::LoadTexture("resources\\icons\\ToolBar\\Stop.png");
+        m_PauseIcon = AssetManager::LoadTexture("resources\\icons\\ToolBar\\Pause.png");
     }
 
     void EditorLayer::OnAttach()
@@ -50,17 +53,21 @@ namespace Engine
 
         //TEMP
         
-        auto environment = Environment::Create("assets\\environment\\InDoor.hdr");
-        m_EditorScene->SetEnvironment(environment);
+        UUID sceneID = m_EditorScene->GetUUID();
+        Environment::LoadAsync("assets\\environment\\InDoor.hdr", [sceneID](const Environment& environment)
+            {
+                if (Scene* scene = Scene::GetScene(sceneID))
+                    scene->SetEnvironment(environment);
+            });
         {
-            auto mesh = AssetManager::CreateNewAsset<Mesh>("assets\\models\\Sphere\\Sphere.fbx");
+            auto mesh = AssetManager::LoadMesh("assets\\models\\Sphere\\Sphere.fbx");
             auto& meshEntity = m_EditorScene->CreateEntity("Sphere");
             meshEntity.AddComponent<MeshComponent>();
             meshEntity.GetComponent<MeshComponent>().Mesh = mesh;
             meshEntity.GetComponent<TransformComponent>().Translation = glm::vec3(0.0f, 10.0f, 0.0f);
         }
         {
-            auto mesh = AssetManager::CreateNewAsset<Mesh>("assets\\models\\Plane\\Plane.fbx");
+            auto mesh = AssetManager::LoadMesh("assets\\models\\Plane\\Plane.fbx");
             auto& meshEntity = m_EditorScene->CreateEntity("Plane");
             meshEntity.AddComponent<MeshComponent>();
             meshEntity.GetComponent<MeshComponent>().Mesh = mesh;
@@ -363,31 +370,10 @@ namespace Engine
                     if (!mesh)
                         continue;
 
-                    //ѯRayײAABB
-                    auto& submeshes = mesh->GetSubmeshes();
-                    for (uint32_t i = 0; i < submeshes.size(); i++)
-                    {
-                        auto& submesh = submeshes[i];
-                        Ray ray(
-                            glm::inverse(entity.GetTransformComponent().GetTransform() * submesh.Transform) * glm::vec4(origin, 1.0f),
-                            glm::inverse(glm::mat3(entity.GetTransformComponent().GetTransform()) * glm::mat3(submesh.Transform)) * direction
-                        );
-
-                        float t;
-                        bool intersects = ray.IntersectsAABB(submesh.BoundingBox, t);
-                        if (intersects)
-                        {
-                            const auto& triangleCache = mesh->GetTriangleCache(i);
-                            for (const auto& triangle : triangleCache)
-                            {
-                                if (ray.IntersectsTriangle(triangle.V0.Position, triangle.V1.Position, triangle.V2.Position, t))
-                                {
-                                    m_SelectionContext.push_back({ entity, &submesh, t });
-                                    break;
-                                }
-                            }
-                        }
-                    }
+                    //Closest hit over the submeshes, distances are in world space
+                    MeshRaycastHit hit;
+                    if (mesh->Raycast(Ray(origin, direction), entity.GetTransformComponent().GetTransform(), hit))
+                        m_SelectionContext.push_back({ entity, &mesh->GetSubmeshes()[hit.Submesh], hit.Distance });
                 }
 
                 //С, ѡEntity
@@ -0,0 +1,92 @@
+-- Headless scene runner.
+-- Included from the workspace premake5.lua with: include "TinyEngineRunner"
+-- On Linux the runner and the engine render through an EGL context without a window,
+-- PhysX and mono are taken from the system (only Windows binaries are vendored).
+
+local runneroutputdir = outputdir or "%{cfg.buildcfg}-%{cfg.system}-%{cfg.architecture}"
+local enginedir = "%{wks.location}/TinyEngine"
+
+project "TinyEngineRunner"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++17"
+	staticruntime "off"
+
+	targetdir ("%{wks.location}/bin/" .. runneroutputdir .. "/%{prj.name}")
+	objdir ("%{wks.location}/bin-int/" .. runneroutputdir .. "/%{prj.name}")
+
+	files
+	{
+		"src/**.h",
+		"src/**.cpp"
+	}
+
+	includedirs
+	{
+		enginedir .. "/src",
+		enginedir .. "/vendor",
+		enginedir .. "/vendor/spdlog/include",
+		enginedir .. "/vendor/glm",
+		enginedir .. "/vendor/entt/include",
+		enginedir .. "/vendor/Glad/include",
+		enginedir .. "/vendor/yaml-cpp/include",
+		enginedir .. "/vendor/assimp/include",
+		enginedir .. "/vendor/PhysX/include",
+		enginedir .. "/vendor/PhysX/include/PhysX",
+		enginedir .. "/vendor/mono/include"
+	}
+
+	links
+	{
+		"TinyEngine"
+	}
+
+	defines
+	{
+		"GLFW_INCLUDE_NONE"
+	}
+
+	filter "system:windows"
+		systemversion "latest"
+		defines { "ENGINE_PLATFORM_WINDOWS" }
+
+	filter "system:linux"
+		pic "On"
+		defines { "ENGINE_PLATFORM_LINUX" }
+		links
+		{
+			"GLFW",
+			"Glad",
+			"ImGui",
+			"yaml-cpp",
+			"assimp",
+			"PhysXExtensions_static_64",
+			"PhysXCharacterKinematic_static_64",
+			"PhysXCooking_static_64",
+			"PhysX_static_64",
+			"PhysXPvdSDK_static_64",
+			"PhysXCommon_static_64",
+			"PhysXFoundation_static_64",
+			"monosgen-2.0",
+			"EGL",
+			"GL",
+			"pthread",
+			"dl"
+		}
+
+	filter "configurations:Debug"
+		defines "ENGINE_DEBUG"
+		runtime "Debug"
+		symbols "on"
+
+	filter "configurations:Release"
+		defines "ENGINE_RELEASE"
+		runtime "Release"
+		optimize "on"
+
+	--PhysX needs exactly one of them, MSVC only defines them for the Windows runtime
+	filter { "system:linux", "configurations:Debug" }
+		defines "_DEBUG"
+
+	filter { "system:linux", "configurations:Release" }
+		defines "NDEBUG"
@@ -0,0 +1,193 @@
+#include <TinyEngine.h>
+#include "Engine/Core/Timer.h"
+#include "Engine/Core/Buffer.h"
+#include "Engine/Renderer/RendererContext.h"
+#include "Engine/Renderer/ImageWriter.h"
+#include "Engine/Scene/SceneSerializer.h"
+#include "Engine/Asset/AssetManager.h"
+#include "Engine/Physics/Physics.h"
+#include "Engine/Script/ScriptEngine.h"
+
+#include <cstdlib>
+#include <cstring>
+
+/// <summary>
+/// Headless scene runner.
+/// Loads a scene, renders a fixed number of frames from the primary camera without a window,
+/// writes the final frame to an image and reports per-pass timings.
+///
+/// Usage: TinyEngineRunner --scene <file.scene> [--frames N] [--width W] [--height H] [--output <file.png|file.exr>]
+/// </summary>
+namespace Engine
+{
+	struct RunnerOptions
+	{
+		std::string ScenePath;
+		std::string OutputPath = "output.png";
+		uint32_t Frames = 1;
+		uint32_t Width = 1280;
+		uint32_t Height = 720;
+	};
+
+	static bool ParseArguments(int argc, char** argv, RunnerOptions& options)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			bool hasValue = i + 1 < argc;
+			if (!strcmp(argv[i], "--scene") && hasValue)
+				options.ScenePath = argv[++i];
+			else if (!strcmp(argv[i], "--output") && hasValue)
+				options.OutputPath = argv[++i];
+			else if (!strcmp(argv[i], "--frames") && hasValue)
+				options.Frames = (uint32_t)atoi(argv[++i]);
+			else if (!strcmp(argv[i], "--width") && hasValue)
+				options.Width = (uint32_t)atoi(argv[++i]);
+			else if (!strcmp(argv[i], "--height") && hasValue)
+				options.Height = (uint32_t)atoi(argv[++i]);
+			else
+			{
+				APP_ERROR("Unknown argument '{0}'", argv[i]);
+				return false;
+			}
+		}
+
+		return !options.ScenePath.empty() && options.Frames > 0 && options.Width > 0 && options.Height > 0;
+	}
+
+	//Longest wait for the scene assets before the measured frames
+	static const float s_WarmupTimeout = 60000.0f;
+
+	static bool EndsWith(const std::string& str, const std::string& suffix)
+	{
+		return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+	}
+
+	static int Run(const RunnerOptions& options)
+	{
+		//Init systems
+		Ref<RendererContext> context = RendererContext::CreateHeadless();
+		context->Init();
+
+		ScriptEngine::Init("assets/scripts/SandBox.dll");
+		Physics::Init();
+		//Renderer decodes textures on the asset workers
+		AssetManager::Init();
+
+		Renderer::Init();
+		Renderer::WaitAndRender();
+
+		int result = 0;
+		{
+			Ref<Scene> scene = CreateRef<Scene>("Runner Scene");
+			SceneSerializer serializer(scene);
+			if (!serializer.Deserialize(options.ScenePath))
+			{
+				APP_ERROR("Failed to load scene '{0}'", options.ScenePath);
+				result = 1;
+			}
+			else if (!scene->GetMainCameraEntity())
+			{
+				APP_ERROR("Scene '{0}' does not have a primary camera", options.ScenePath);
+				result = 1;
+			}
+			else
+			{
+				SceneRenderer::SetViewportSize(options.Width, options.Height);
+				scene->SetViewportSize(options.Width, options.Height);
+				SceneRenderer::SetPassTimingEnabled(true);
+
+				Timestep ts = 1.0f / 60.0f;
+
+				//Asynchronous loads and shader compiles would be timed, and drawn as placeholders
+				Timer warmup;
+				uint32_t warmupFrames = 0;
+				while (AssetManager::GetPendingLoadCount() > 0 || Renderer::GetShaderLibrary().GetCompilingCount() > 0)
+				{
+					if (warmup.ElapsedMillis() > s_WarmupTimeout)
+					{
+						APP_WARN("{0} asset loads and {1} shader compiles still pending after {2:.0f} ms, rendering anyway",
+							AssetManager::GetPendingLoadCount(), Renderer::GetShaderLibrary().GetCompilingCount(), s_WarmupTimeout);
+						break;
+					}
+
+					scene->OnRenderRuntime(ts);
+					Renderer::WaitAndRender();
+					context->SwapBuffers();
+					AssetManager::Update();
+					warmupFrames++;
+				}
+				APP_INFO("Loaded the scene assets in {0} frame(s), {1:.1f} ms", warmupFrames, warmup.ElapsedMillis());
+
+				std::vector<float> passTimes(SceneRenderer::GetPassTimings().size(), 0.0f);
+				float cpuTime = 0.0f;
+				float frameTime = 0.0f;
+				for (uint32_t frame = 0; frame < options.Frames; frame++)
+				{
+					Timer timer;
+					scene->OnRenderRuntime(ts);
+					cpuTime += timer.ElapsedMillis();
+
+					Renderer::WaitAndRender();
+					context->SwapBuffers();
+					frameTime += timer.ElapsedMillis();
+
+					auto& timings = SceneRenderer::GetPassTimings();
+					for (uint32_t i = 0; i < timings.size(); i++)
+						passTimes[i] += timings[i].GPUTime;
+
+					AssetManager::Update();
+				}
+
+				//Report
+				float frames = (float)options.Frames;
+				APP_INFO("Rendered {0} frame(s) of '{1}' at {2}x{3}", options.Frames, options.ScenePath, options.Width, options.Height);
+				APP_INFO("  Frame:      {0:.3f} ms", frameTime / frames);
+				APP_INFO("  Submission: {0:.3f} ms (CPU)", cpuTime / frames);
+				auto& timings = SceneRenderer::GetPassTimings();
+				for (uint32_t i = 0; i < timings.size(); i++)
+					APP_INFO("  {0}: {1:.3f} ms (GPU)", timings[i].Name, passTimes[i] / frames);
+
+				//Read back final image
+				Buffer pixels;
+				SceneRenderer::GetFinalFrameBuffer()->ReadColorAttachment(pixels);
+				Renderer::WaitAndRender();
+
+				bool written = false;
+				if (EndsWith(options.OutputPath, ".exr"))
+					written = ImageWriter::WriteEXR(options.OutputPath, (const float*)pixels.Data, options.Width, options.Height);
+				else
+					written = ImageWriter::WritePNG(options.OutputPath, (const float*)pixels.Data, options.Width, options.Height);
+				delete[] pixels.Data;
+
+				if (written)
+					APP_INFO("Saved image to '{0}'", options.OutputPath);
+				else
+				{
+					APP_ERROR("Failed to write image '{0}'", options.OutputPath);
+					result = 1;
+				}
+			}
+		}
+
+		Physics::Shutdown();
+		AssetManager::Shutdown();
+		Renderer::Shutdown();
+		ScriptEngine::Shutdown();
+
+		return result;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Engine::Log::Init();
+
+	Engine::RunnerOptions options;
+	if (!Engine::ParseArguments(argc, argv, options))
+	{
+		APP_ERROR("Usage: TinyEngineRunner --scene <file.scene> [--frames N] [--width W] [--height H] [--output <file.png|file.exr>]");
+		return 1;
+	}
+
+	return Engine::Run(options);
+}